@@ -1,7 +1,10 @@
 #include <cmath>
+#include <vector>
 
 #include <ardour/dB.h>
+#include <ardour/meter_snapshot.h>
 #include <ardour/route.h>
+#include <ardour/session.h>
 
 #import "PSMixerStrip.h"
 #import "PSFastMeter.h"
@@ -96,11 +99,17 @@
 	PSFastMeter *fm = nil;
 	int index = 0;
 	float peak, mpeak;
+	
+	/* all of this route's levels, in one go, from the session's snapshot */
+	std::vector<float> peaks ([meterArray count]);
+	std::vector<float> maxPeaks ([meterArray count]);
+	uint32_t const nchans = peaks.empty() ? 0 : session->meter_snapshot().read (route, &peaks[0], &maxPeaks[0], peaks.size());
+	
 	while (fm = [en nextObject]) {
-		peak = route->peak_input_power (index);
+		peak = index < (int) nchans ? peaks[index] : minus_infinity();
 		[fm setLevel:log_meter(peak)];
 		
-		mpeak = route->max_peak_power (index);
+		mpeak = index < (int) nchans ? maxPeaks[index] : minus_infinity();
 		
 		if (mpeak > maxPeak) {
 			maxPeak = mpeak;
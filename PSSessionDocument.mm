@@ -65,8 +65,9 @@
 
 - (void)saveSession
 {
-	sess->save_state ([[[[self fileURL] path] lastPathComponent] UTF8String]);
-	[self updateChangeCount:NSChangeCleared];
+	if (sess->save_state ([[[[self fileURL] path] lastPathComponent] UTF8String]) == 0) {
+		[self updateChangeCount:NSChangeCleared];
+	}
 }
 
 - (BOOL)readFromURL:(NSURL *)absoluteURL ofType:(NSString *)typeName error:(NSError **)outError
@@ -29,6 +29,7 @@
 #include "ardour/configuration.h"
 #include "ardour/io.h"
 #include "ardour/midi_buffer.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/session.h"
 
 #include "i18n.h"
@@ -83,10 +84,7 @@ Amp::run (BufferSet& bufs, sframes_t /*start_frame*/, sframes_t /*end_frame*/, n
 			gain_t* gab = _session.gain_automation_buffer ();
 
 			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-				Sample* const sp = i->data();
-				for (nframes_t nx = 0; nx < nframes; ++nx) {
-					sp[nx] *= gab[nx];
-				}
+				apply_gain_curve_to_buffer (i->data(), nframes, gab);
 			}
 			
 			_current_gain = gab[nframes-1];
@@ -127,23 +125,17 @@ Amp::run (BufferSet& bufs, sframes_t /*start_frame*/, sframes_t /*end_frame*/, n
 	_active = _pending_active;
 }
 
-void
-Amp::apply_gain (BufferSet& bufs, nframes_t nframes, gain_t initial, gain_t target)
-{
-        /** Apply a (potentially) declicked gain to the buffers of @a bufs
-	 */
+const nframes_t Amp::declick_frames;
 
-	if (nframes == 0 || bufs.count().n_total() == 0) {
-		return;
-	}
-
-	// if we don't need to declick, defer to apply_simple_gain
-	if (initial == target) {
-		apply_simple_gain (bufs, nframes, target);
-		return;
-	}
-
-	const nframes_t declick = std::min ((nframes_t)128, nframes);
+/** Fill ramp with the gains of a declick from initial to target over the
+ *  first declick_frames frames of a buffer of nframes frames.
+ *  @param ramp Buffer of at least declick_frames gains.
+ *  @return Number of frames in the ramp.
+ */
+nframes_t
+Amp::declick_ramp (gain_t* ramp, nframes_t nframes, gain_t initial, gain_t target)
+{
+	const nframes_t declick = std::min (declick_frames, nframes);
 	gain_t         delta;
 	double         fractional_shift = -1.0/declick;
 	double         fractional_pos;
@@ -156,10 +148,25 @@ Amp::apply_gain (BufferSet& bufs, nframes_t nframes, gain_t initial, gain_t targ
 		delta = target - initial;
 	}
 
-	/* MIDI Gain */
+	fractional_pos = 1.0;
 
-	for (BufferSet::midi_iterator i = bufs.midi_begin(); i != bufs.midi_end(); ++i) {
+	for (nframes_t nx = 0; nx < declick; ++nx) {
+		ramp[nx] = initial + (delta * (0.5 + 0.5 * cos (M_PI * fractional_pos)));
+		fractional_pos += fractional_shift;
+	}
+
+	return declick;
+}
+
+/** Scale the velocity of note-ons in the MIDI buffers of @a bufs by a
+ *  gain moving linearly from initial to target over nframes.
+ */
+void
+Amp::apply_gain_to_midi (BufferSet& bufs, nframes_t nframes, gain_t initial, gain_t target)
+{
+	gain_t const delta = target - initial;
 
+	for (BufferSet::midi_iterator i = bufs.midi_begin(); i != bufs.midi_end(); ++i) {
 
 		MidiBuffer& mb (*i);
 
@@ -172,29 +179,35 @@ Amp::apply_gain (BufferSet& bufs, nframes_t nframes, gain_t initial, gain_t targ
 			}
 		}
 	}
+}
 
-	/* Audio Gain */
+void
+Amp::apply_gain (BufferSet& bufs, nframes_t nframes, gain_t initial, gain_t target)
+{
+        /** Apply a (potentially) declicked gain to the buffers of @a bufs
+	 */
 
-	for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-		Sample* const buffer = i->data();
+	if (nframes == 0 || bufs.count().n_total() == 0) {
+		return;
+	}
 
-		fractional_pos = 1.0;
+	// if we don't need to declick, defer to apply_simple_gain
+	if (initial == target) {
+		apply_simple_gain (bufs, nframes, target);
+		return;
+	}
 
-		for (nframes_t nx = 0; nx < declick; ++nx) {
-			buffer[nx] *= (initial + (delta * (0.5 + 0.5 * cos (M_PI * fractional_pos))));
-			fractional_pos += fractional_shift;
-		}
+	/* MIDI Gain */
 
-		/* now ensure the rest of the buffer has the target value applied, if necessary. */
+	apply_gain_to_midi (bufs, nframes, initial, target);
 
-		if (declick != nframes) {
+	/* Audio Gain */
 
-			if (target == 0.0) {
-				memset (&buffer[declick], 0, sizeof (Sample) * (nframes - declick));
-			} else if (target != 1.0) {
-				apply_gain_to_buffer (&buffer[declick], nframes - declick, target);
-			}
-		}
+	gain_t ramp[declick_frames];
+	const nframes_t declick = declick_ramp (ramp, nframes, initial, target);
+
+	for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
+		apply_declick (i->data(), nframes, ramp, declick, target);
 	}
 }
 
@@ -214,39 +227,30 @@ Amp::apply_gain (AudioBuffer& buf, nframes_t nframes, gain_t initial, gain_t tar
 		return;
 	}
 
-	const nframes_t declick = std::min ((nframes_t)128, nframes);
-	gain_t         delta;
-	double         fractional_shift = -1.0/declick;
-	double         fractional_pos;
+	gain_t ramp[declick_frames];
+	const nframes_t declick = declick_ramp (ramp, nframes, initial, target);
 
-	if (target < initial) {
-		/* fade out: remove more and more of delta from initial */
-		delta = -(initial - target);
-	} else {
-		/* fade in: add more and more of delta from initial */
-		delta = target - initial;
-	}
+	apply_declick (buf.data(), nframes, ramp, declick, target);
+}
+
+/** Apply a declick ramp of declick frames to the start of buffer, and
+ *  target to the rest of it.
+ */
+void
+Amp::apply_declick (Sample* buffer, nframes_t nframes, gain_t const * ramp, nframes_t declick, gain_t target)
+{
+	scale_and_offset_buffer (buffer, declick, ramp, declick, target, 1.0f, 0.0f);
+
+	/* now ensure the rest of the buffer has the target value applied, if necessary. */
 
+	if (declick != nframes) {
 
-        Sample* const buffer = buf.data();
-        
-        fractional_pos = 1.0;
-        
-        for (nframes_t nx = 0; nx < declick; ++nx) {
-                buffer[nx] *= (initial + (delta * (0.5 + 0.5 * cos (M_PI * fractional_pos))));
-                fractional_pos += fractional_shift;
-        }
-        
-        /* now ensure the rest of the buffer has the target value applied, if necessary. */
-        
-        if (declick != nframes) {
-                
-                if (target == 0.0) {
-                        memset (&buffer[declick], 0, sizeof (Sample) * (nframes - declick));
-                } else if (target != 1.0) {
-                        apply_gain_to_buffer (&buffer[declick], nframes - declick, target);
-                }
-        }
+		if (target == 0.0) {
+			memset (&buffer[declick], 0, sizeof (Sample) * (nframes - declick));
+		} else if (target != 1.0) {
+			apply_gain_to_buffer (&buffer[declick], nframes - declick, target);
+		}
+	}
 }
 
 void
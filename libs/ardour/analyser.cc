@@ -19,9 +19,12 @@
 
 #include "ardour/analyser.h"
 #include "ardour/audiofilesource.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/session_event.h"
 #include "ardour/transient_detector.h"
 
+#include "pbd/cpus.h"
+#include "pbd/failed_constructor.h"
 #include "pbd/pthread_utils.h"
 #include "pbd/convert.h"
 
@@ -32,7 +35,9 @@ using namespace PBD;
 Analyser* Analyser::the_analyser = 0;
 Glib::StaticMutex Analyser::analysis_queue_lock = GLIBMM_STATIC_MUTEX_INIT;
 Glib::Cond* Analyser::SourcesToAnalyse = 0;
-list<boost::weak_ptr<Source> > Analyser::analysis_queue;
+list<Analyser::Job> Analyser::analysis_queue;
+map<PBD::ID, Analyser::Analysis> Analyser::running;
+Glib::StaticMutex Analyser::detector_creation_lock = GLIBMM_STATIC_MUTEX_INIT;
 
 Analyser::Analyser ()
 {
@@ -43,6 +48,15 @@ Analyser::~Analyser ()
 {
 }
 
+Analyser::Job::Job (boost::shared_ptr<Source> s, bool f, Priority p)
+	: source (s)
+	, id (s->id ())
+	, force (f)
+	, priority (p)
+{
+
+}
+
 static void
 analyser_work ()
 {
@@ -53,11 +67,21 @@ void
 Analyser::init ()
 {
 	SourcesToAnalyse = new Glib::Cond();
-	Glib::Thread::create (sigc::ptr_fun (analyser_work), false);
+
+	uint32_t threads = Config->get_analysis_threads ();
+
+	if (threads == 0) {
+		/* leave a processor for everything else */
+		threads = max (hardware_concurrency (), (uint32_t) 2) - 1;
+	}
+
+	for (uint32_t i = 0; i < threads; ++i) {
+		Glib::Thread::create (sigc::ptr_fun (analyser_work), false);
+	}
 }
 
 void
-Analyser::queue_source_for_analysis (boost::shared_ptr<Source> src, bool force)
+Analyser::queue_source_for_analysis (boost::shared_ptr<Source> src, bool force, Priority priority)
 {
 	if (!src->can_be_analysed()) {
 		return;
@@ -68,36 +92,119 @@ Analyser::queue_source_for_analysis (boost::shared_ptr<Source> src, bool force)
 	}
 
 	Glib::Mutex::Lock lm (analysis_queue_lock);
-	analysis_queue.push_back (boost::weak_ptr<Source>(src));
+
+	/* a source which is already queued keeps its place, but becomes as
+	   urgent as the more urgent of the two requests
+	*/
+
+	for (list<Job>::iterator i = analysis_queue.begin(); i != analysis_queue.end(); ++i) {
+		if (i->id == src->id()) {
+			i->force = i->force || force;
+			i->priority = max (i->priority, priority);
+			return;
+		}
+	}
+
+	if (!force && running.find (src->id()) != running.end()) {
+		return;
+	}
+
+	analysis_queue.push_back (Job (src, force, priority));
 	SourcesToAnalyse->broadcast ();
 }
 
+/** Stop any analysis of a source, whether it is queued or in progress.
+ *  @param id ID of the source.
+ */
+void
+Analyser::cancel (PBD::ID id)
+{
+	Glib::Mutex::Lock lm (analysis_queue_lock);
+
+	for (list<Job>::iterator i = analysis_queue.begin(); i != analysis_queue.end(); ) {
+		list<Job>::iterator tmp = i;
+		++tmp;
+		if (i->id == id) {
+			analysis_queue.erase (i);
+		}
+		i = tmp;
+	}
+
+	map<PBD::ID, Analysis>::iterator r = running.find (id);
+
+	if (r != running.end()) {
+		r->second.cancelled = true;
+		if (r->second.detector) {
+			r->second.detector->cancel ();
+		}
+	}
+}
+
 void
 Analyser::work ()
 {
 	SessionEvent::create_per_thread_pool ("Analyser", 64);
 
 	while (true) {
+
 		analysis_queue_lock.lock ();
 
-	  wait:
-		if (analysis_queue.empty()) {
+		/* take the earliest of the most urgent jobs, leaving any for sources
+		   which another thread is already analysing until it has finished.
+		*/
+
+		list<Job>::iterator job;
+
+		while (true) {
+
+			job = analysis_queue.end ();
+
+			for (list<Job>::iterator i = analysis_queue.begin(); i != analysis_queue.end(); ++i) {
+				if ((job == analysis_queue.end() || i->priority > job->priority) && running.find (i->id) == running.end()) {
+					job = i;
+				}
+			}
+
+			if (job != analysis_queue.end()) {
+				break;
+			}
+
 			SourcesToAnalyse->wait (analysis_queue_lock);
 		}
 
-		if (analysis_queue.empty()) {
-			goto wait;
+		boost::shared_ptr<Source> src (job->source.lock());
+		bool const force = job->force;
+		PBD::ID const id = job->id;
+
+		analysis_queue.erase (job);
+
+		if (src) {
+			running[id] = Analysis ();
 		}
 
-		boost::shared_ptr<Source> src (analysis_queue.front().lock());
-		analysis_queue.pop_front();
 		analysis_queue_lock.unlock ();
 
-		boost::shared_ptr<AudioFileSource> afs = boost::dynamic_pointer_cast<AudioFileSource> (src);
+		if (!src) {
+			continue;
+		}
+
+		/* analysis results are kept on disk, keyed by the source's ID, so
+		   unless we are forced there is no need to do it again
+		*/
+
+		if (force || !(src->has_been_analysed() || src->check_for_analysis_data_on_disk())) {
+
+			boost::shared_ptr<AudioFileSource> afs = boost::dynamic_pointer_cast<AudioFileSource> (src);
 
-		if (afs && afs->length(afs->timeline_position())) {
-			analyse_audio_file_source (afs);
+			if (afs && afs->length(afs->timeline_position())) {
+				analyse_audio_file_source (afs);
+			}
 		}
+
+		analysis_queue_lock.lock ();
+		running.erase (id);
+		SourcesToAnalyse->broadcast ();
+		analysis_queue_lock.unlock ();
 	}
 }
 
@@ -105,14 +212,38 @@ void
 Analyser::analyse_audio_file_source (boost::shared_ptr<AudioFileSource> src)
 {
 	AnalysisFeatureList results;
+	TransientDetector* td = 0;
+
+	try {
+		/* the VAMP host may not be safe to load plugins from more than one thread at once */
+		Glib::Mutex::Lock lm (detector_creation_lock);
+		td = new TransientDetector (src->sample_rate());
+	}
+
+	catch (failed_constructor& err) {
+		src->set_been_analysed (false);
+		return;
+	}
 
-	TransientDetector td (src->sample_rate());
+	bool cancelled;
+
+	{
+		Glib::Mutex::Lock lm (analysis_queue_lock);
+		Analysis& a (running[src->id()]);
+		a.detector = td;
+		cancelled = a.cancelled;
+	}
 
-	if (td.run (src->get_transients_path(), src.get(), 0, results) == 0) {
+	if (!cancelled && td->run (src->get_transients_path(), src.get(), 0, results) == 0) {
 		src->set_been_analysed (true);
 	} else {
 		src->set_been_analysed (false);
 	}
 
-}
+	{
+		Glib::Mutex::Lock lm (analysis_queue_lock);
+		running[src->id()].detector = 0;
+	}
 
+	delete td;
+}
@@ -62,6 +62,12 @@ public:
         static void apply_gain (AudioBuffer& buf, nframes_t nframes, gain_t initial, gain_t target);
 	static void apply_simple_gain(AudioBuffer& buf, nframes_t nframes, gain_t target);
 
+	/** maximum length of a declick, in frames */
+	static const nframes_t declick_frames = 128;
+
+	static nframes_t declick_ramp (gain_t* ramp, nframes_t nframes, gain_t initial, gain_t target);
+	static void apply_gain_to_midi (BufferSet& bufs, nframes_t nframes, gain_t initial, gain_t target);
+
 	gain_t         gain () const { return _gain_control->user_float(); }
 
 	virtual void   set_gain (gain_t g, void *src);
@@ -94,6 +100,8 @@ public:
 	}
 
 private:
+	static void apply_declick (Sample* buffer, nframes_t nframes, gain_t const * ramp, nframes_t declick, gain_t target);
+
 	bool   _denormal_protection;
 	bool   _apply_gain;
 	bool   _apply_gain_automation;
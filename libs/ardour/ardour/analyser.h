@@ -1,8 +1,13 @@
 #ifndef __ardour_analyser_h__
 #define __ardour_analyser_h__
 
+#include <list>
+#include <map>
 #include <glibmm/thread.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "pbd/id.h"
 
 namespace ARDOUR {
 
@@ -10,26 +15,58 @@ class AudioFileSource;
 class Source;
 class TransientDetector;
 
+/** Analyses sources for transients, on a pool of threads.  The number of
+ *  threads is set by the analysis-threads configuration variable.
+ */
 class Analyser {
 
   public:
 	Analyser();
 	~Analyser ();
 
+	/** How soon a source should be analysed; sources of the same priority
+	 *  are analysed in the order in which they were queued.
+	 */
+	enum Priority {
+		Background, ///< when there is nothing more urgent
+		Visible,    ///< the source is on show
+		Selected    ///< the source is selected
+	};
+
 	static void init ();
-	static void queue_source_for_analysis (boost::shared_ptr<Source>, bool force);
+	static void queue_source_for_analysis (boost::shared_ptr<Source>, bool force, Priority priority = Background);
+	static void cancel (PBD::ID);
 	static void work ();
 
   private:
+	struct Job {
+		Job (boost::shared_ptr<Source>, bool, Priority);
+
+		boost::weak_ptr<Source> source;
+		PBD::ID id;
+		bool force;
+		Priority priority;
+	};
+
+	/** An analysis which one of our threads is doing */
+	struct Analysis {
+		Analysis () : detector (0), cancelled (false) {}
+
+		TransientDetector* detector; ///< or 0 if it has not been created yet
+		bool cancelled;
+	};
+
 	static Analyser* the_analyser;
 	static Glib::StaticMutex analysis_queue_lock;
 	static Glib::Cond* SourcesToAnalyse;
-	static std::list<boost::weak_ptr<Source> > analysis_queue;
+	static std::list<Job> analysis_queue;
+	/** analyses in progress, by the ID of their source */
+	static std::map<PBD::ID, Analysis> running;
+	static Glib::StaticMutex detector_creation_lock;
 
 	static void analyse_audio_file_source (boost::shared_ptr<AudioFileSource>);
 };
 
-
 }
 
 #endif /* __ardour_analyser_h__ */
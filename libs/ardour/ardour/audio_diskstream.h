@@ -148,6 +148,12 @@ class AudioDiskstream : public Diskstream
 	}
 
 	CubicInterpolation interpolation;
+	SincInterpolation sinc_interpolation;
+	/** space for each channel's buffer pointers to pass to sinc_interpolation,
+	    grown as channels are added so that process() need not allocate
+	*/
+	std::vector<Sample*> sinc_inputs;
+	std::vector<Sample*> sinc_outputs;
 
 	XMLNode* deprecated_io_node;
 
@@ -224,7 +230,7 @@ class AudioDiskstream : public Diskstream
 
 	typedef std::vector<ChannelInfo*> ChannelList;
 
-	void process_varispeed_playback(nframes_t nframes, boost::shared_ptr<ChannelList> c);
+	void process_varispeed_playback(nframes_t nframes, boost::shared_ptr<ChannelList> c, bool sinc);
 
 	/* The two central butler operations */
 	int do_flush (RunContext context, bool force = false);
@@ -24,6 +24,7 @@
 #include <string>
 #include <ostream>
 #include <fstream>
+#include <glib.h>
 #include "vamp-sdk/Plugin.h"
 #include <boost/utility.hpp>
 #include "ardour/audioregion.h"
@@ -51,6 +52,11 @@ class AudioAnalyser : public boost::noncopyable {
 
 	void reset ();
 
+	/** Stop an analysis which is running in another thread, or make the
+	 *  next one stop straight away; the analysis will fail.
+	 */
+	void cancel () { g_atomic_int_set (&_cancelled, 1); }
+
   protected:
 	float sample_rate;
 	AnalysisPlugin* plugin;
@@ -59,6 +65,8 @@ class AudioAnalyser : public boost::noncopyable {
 	nframes64_t bufsize;
 	nframes64_t stepsize;
 
+	gint _cancelled; ///< atomic; non-zero if cancel() has been called
+
 	int initialize_plugin (AnalysisPluginKey name, float sample_rate);
 	int analyse (const std::string& path, Readable*, uint32_t channel);
 
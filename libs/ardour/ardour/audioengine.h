@@ -42,6 +42,7 @@
 #include <jack/transport.h>
 
 #include "ardour/data_type.h"
+#include "ardour/dummy_backend.h"
 #include "ardour/session_handle.h"
 #include "ardour/types.h"
 
@@ -63,10 +64,14 @@ class AudioEngine : public SessionHandlePtr
 	typedef std::set<Port*> Ports;
 
 	AudioEngine (std::string client_name, std::string session_uuid);
+	AudioEngine (std::string client_name, DummyBackend::Parameters const &);
 	virtual ~AudioEngine ();
 
 	jack_client_t* jack() const;
-	bool connected() const { return _jack != 0; }
+	bool connected() const { return _jack != 0 || _dummy != 0; }
+
+	/** @return the dummy backend, if we are running without JACK, otherwise 0 */
+	DummyBackend* dummy_backend() const { return _dummy; }
 
 	bool is_realtime () const;
 
@@ -96,17 +101,20 @@ class AudioEngine : public SessionHandlePtr
 	bool get_sync_offset (nframes_t& offset) const;
 
 	nframes_t frames_since_cycle_start () {
+		if (_dummy) return _running ? _dummy->frames_since_cycle_start () : 0;
   	        jack_client_t* _priv_jack = _jack;
 		if (!_running || !_priv_jack) return 0;
 		return jack_frames_since_cycle_start (_priv_jack);
 	}
 	nframes_t frame_time () {
+		if (_dummy) return _running ? _dummy->frame_time () : 0;
   	        jack_client_t* _priv_jack = _jack;
 		if (!_running || !_priv_jack) return 0;
 		return jack_frame_time (_priv_jack);
 	}
 
 	nframes_t frame_time_at_cycle_start () {
+		if (_dummy) return _running ? _dummy->frame_time_at_cycle_start () : 0;
   	        jack_client_t* _priv_jack = _jack;
 		if (!_running || !_priv_jack) return 0;
 		return jack_last_frame_time (_priv_jack);
@@ -124,6 +132,7 @@ class AudioEngine : public SessionHandlePtr
 	nframes_t processed_frames() const { return _processed_frames; }
 
 	float get_cpu_load() {
+		if (_dummy) return _running ? _dummy->dsp_load () : 0;
   	        jack_client_t* _priv_jack = _jack;
 		if (!_running || !_priv_jack) return 0;
 		return jack_cpu_load (_priv_jack);
@@ -251,6 +260,7 @@ _	   the regular process() call to session->process() is not made.
 	static AudioEngine*       _instance;
 
 	jack_client_t* volatile   _jack; /* could be reset to null by SIGPIPE or another thread */
+	DummyBackend*             _dummy; /* non-null if we are running without JACK */
 	std::string                jack_client_name;
 	Glib::Mutex               _process_lock;
 	Glib::Cond                 session_removed;
@@ -305,7 +315,10 @@ _	   the regular process() call to session->process() is not made.
 	int  jack_bufsize_callback (nframes_t);
 	int  jack_sample_rate_callback (nframes_t);
 
+	void init ();
 	int connect_to_jack (std::string client_name, std::string session_uuid);
+	void dummy_thread_init ();
+	int  start_dummy ();
 
 	static void halted (void *);
 	static void halted_info (jack_status_t,const char*,void *);
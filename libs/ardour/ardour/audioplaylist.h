@@ -51,6 +51,7 @@ class AudioPlaylist : public ARDOUR::Playlist
         nframes_t read (Sample *dst, Sample *mixdown, float *gain_buffer, nframes_t start, nframes_t cnt, uint32_t chan_n=0);
 
 	int set_state (const XMLNode&, int version);
+	uint32_t full_state_generation () const;
 
 	PBD::Signal1<void,boost::shared_ptr<Crossfade> >  NewCrossfade;
 	
@@ -23,6 +23,8 @@
 #include <vector>
 #include <list>
 
+#include <glibmm/thread.h>
+
 #include "pbd/fastlog.h"
 #include "pbd/undo.h"
 
@@ -30,6 +32,7 @@
 #include "ardour/automatable_controls.h"
 #include "ardour/gain.h"
 #include "ardour/logcurve.h"
+#include "ardour/peak_scan.h"
 #include "ardour/region.h"
 
 class XMLNode;
@@ -235,6 +238,41 @@ class AudioRegion : public Region
 	uint32_t                          _fade_in_suspended;
 	uint32_t                          _fade_out_suspended;
 
+	/** One of our curves rendered at a fixed resolution, so that a read
+	    need only interpolate it rather than evaluate the curve.
+	*/
+	struct GainTable {
+		GainTable () : length (0), scale (0), generation (-1) {}
+
+		std::vector<gain_t> points;
+		framecnt_t          length;     ///< length of the curve, or 0 if it is not tabulated
+		double              scale;      ///< points per frame
+		gint                generation; ///< generation of the curve that the points came from
+	};
+
+	/* each generation is bumped whenever its curve is edited, even inside
+	   a freeze, which makes the corresponding table out of date until the
+	   curve has finished changing and the table has been rebuilt.
+	*/
+	mutable gint                      _envelope_generation;
+	mutable gint                      _fade_in_generation;
+	mutable gint                      _fade_out_generation;
+	mutable Glib::Mutex               _gain_table_lock;
+	GainTable                         _envelope_table;
+	GainTable                         _fade_in_table;
+	GainTable                         _fade_out_table;
+
+	static void curve_dirty (gint*);
+	void update_gain_tables ();
+	void rebuild_gain_table (GainTable&, AutomationList&, gint&, bool);
+	static bool gain_table_current (GainTable const &, gint&);
+	static void read_gain_table (GainTable const &, framecnt_t, framecnt_t, gain_t*, gain_t, bool);
+	static void read_gain_curve (AutomationList&, framecnt_t, framecnt_t, gain_t*, gain_t, bool);
+
+	void file_peaks (uint32_t, std::vector<Sample>&) const;
+	void find_channel_silence (uint32_t, Sample, framecnt_t, InterThreadInfo*, std::vector<PeakScan::Periods>*) const;
+	void find_channel_maximum_amplitude (uint32_t, std::vector<double>*) const;
+
   protected:
 	/* default constructor for derived (compound) types */
 
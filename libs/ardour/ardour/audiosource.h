@@ -76,6 +76,9 @@ class AudioSource : virtual public Source,
 
 	int  build_peaks ();
 	bool peaks_ready (boost::function<void()> callWhenReady, PBD::ScopedConnection** connection_created_if_not_ready, PBD::EventLoop* event_loop) const;
+	bool peaks_built () const;
+
+	static framecnt_t frames_per_peak ();
 
 	mutable PBD::Signal0<void>  PeaksReady;
 	mutable PBD::Signal2<void,framepos_t,framepos_t>  PeakRangeReady;
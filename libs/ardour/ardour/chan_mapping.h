@@ -24,6 +24,7 @@
 #include <cassert>
 #include <ostream>
 #include <utility>
+#include <vector>
 
 #include "ardour/data_type.h"
 #include "ardour/chan_count.h"
@@ -33,13 +34,22 @@ namespace ARDOUR {
 
 /** A mapping from one set of channels to another
  * (e.g. how to 'connect' two BufferSets).
+ *
+ * Mappings are stored as one flat table per type, indexed by `from', so
+ * that get() is a bounds check and an array lookup; it is called for
+ * every plugin port in every process cycle.
  */
 class ChanMapping {
 public:
 	ChanMapping() {}
 	ChanMapping(ARDOUR::ChanCount identity);
 
-	uint32_t get(DataType t, uint32_t from);
+	uint32_t get(DataType t, uint32_t from) const {
+		assert(t != DataType::NIL);
+		assert(from < _map[t].size() && _map[t][from] != unmapped);
+		return _map[t][from];
+	}
+
 	void     set(DataType t, uint32_t from, uint32_t to);
 	void     offset_from(DataType t, int32_t delta);
 	void     offset_to(DataType t, int32_t delta);
@@ -47,11 +57,14 @@ public:
 	typedef std::map<uint32_t, uint32_t>    TypeMapping;
 	typedef std::map<DataType, TypeMapping> Mappings;
 
-	Mappings       mappings()       { return _mappings; }
-	const Mappings mappings() const { return _mappings; }
+	/** @return the mappings in map form; this allocates, so is not for use in the process thread */
+	Mappings mappings() const;
 
 private:
-	Mappings _mappings;
+	static const uint32_t unmapped = ~((uint32_t) 0);
+
+	/** _map[t][from] is `to', or unmapped */
+	std::vector<uint32_t> _map[DataType::num_types];
 };
 
 } // namespace ARDOUR
@@ -23,6 +23,7 @@
 #include <vector>
 #include <algorithm>
 #include <boost/shared_ptr.hpp>
+#include <glibmm/thread.h>
 
 
 #include "pbd/undo.h"
@@ -165,10 +166,29 @@ class Crossfade : public ARDOUR::AudioRegion
 	mutable AutomationList _fade_in;
 	mutable AutomationList _fade_out;
 
+	/** The fade curves rendered over the whole crossfade, so that read_at()
+	    need not evaluate them on every call.  They are rebuilt outside the
+	    process thread, and only used while they match _length and
+	    _fade_generation; read_at() renders the curves itself otherwise.
+	*/
+	mutable Glib::Mutex _fade_table_lock;
+	std::vector<gain_t> _fade_in_table;
+	std::vector<gain_t> _fade_out_table;
+	framecnt_t          _fade_table_length;
+	gint                _fade_table_generation;
+	/** bumped by any change to the fade curves */
+	mutable gint        _fade_generation;
+
+	static const framecnt_t max_fade_table_length;
+
 	static Sample* crossfade_buffer_out;
 	static Sample* crossfade_buffer_in;
 
 	void initialize ();
+	void connect_fades ();
+	void fades_changed ();
+	void fades_dirty ();
+	void rebuild_fade_tables ();
 	int  compute (boost::shared_ptr<ARDOUR::AudioRegion>, boost::shared_ptr<ARDOUR::AudioRegion>, CrossfadeModel);
 	bool update ();
 
@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_dummy_backend_h__
+#define __ardour_dummy_backend_h__
+
+#include <string>
+#include <pthread.h>
+
+#include <glib.h>
+#include <boost/function.hpp>
+
+#include "ardour/data_type.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** A backend which runs AudioEngine's process cycle from a thread of its
+ *  own instead of from a JACK server.  There is no audio hardware behind
+ *  it: capture ports deliver silence (or low-level noise) and playback
+ *  ports are discarded.  It exists so that the session's DSP can be run,
+ *  and timed, on machines without JACK or a sound card.
+ */
+class DummyBackend
+{
+  public:
+	struct Parameters {
+		Parameters ();
+
+		nframes_t sample_rate;
+		nframes_t period_size;
+		uint32_t  n_audio_inputs;  ///< number of "physical" audio capture ports
+		uint32_t  n_audio_outputs; ///< number of "physical" audio playback ports
+		uint32_t  n_midi_inputs;   ///< number of "physical" MIDI capture ports
+		uint32_t  n_midi_outputs;  ///< number of "physical" MIDI playback ports
+		bool      realtime;        ///< true to pace cycles at the sample rate, false to run them back-to-back
+		bool      noise_input;     ///< true to fill capture buffers with noise rather than silence
+	};
+
+	/** largest period size that port buffers are allocated for */
+	static const nframes_t max_period_size = 8192;
+
+	DummyBackend (Parameters const &, boost::function<void()> thread_init, boost::function<int(nframes_t)> process);
+	~DummyBackend ();
+
+	Parameters const & parameters () const { return _params; }
+
+	int  start ();
+	int  stop ();
+	bool running () const { return _running; }
+
+	int  set_period_size (nframes_t);
+	void set_freewheel (bool);
+
+	nframes_t frame_time () const;
+	nframes_t frame_time_at_cycle_start () const { return _cycle_start_frame; }
+	nframes_t frames_since_cycle_start () const;
+
+	/** @return DSP load of recent cycles, as a percentage of the period duration */
+	float dsp_load () const { return _dsp_load; }
+	/** @return number of process cycles run since start() */
+	uint64_t cycles () const { return _cycles; }
+	/** @return number of cycles whose processing took longer than one period */
+	uint64_t overruns () const { return _overruns; }
+
+	uint32_t n_physical (DataType, bool input) const;
+	std::string nth_physical (DataType, bool input, uint32_t n) const;
+
+	void* allocate_port_buffer (DataType, bool input) const;
+	void  release_port_buffer (void *) const;
+
+	static const char* const physical_client_name;
+
+  private:
+	Parameters _params;
+	boost::function<void()> _thread_init;
+	boost::function<int(nframes_t)> _process;
+
+	pthread_t _thread;
+	bool      _running;
+	gint      _should_stop;
+	gint      _freewheeling;
+
+	volatile nframes_t _cycle_start_frame;
+	microseconds_t     _cycle_start_usecs;
+	float              _dsp_load;
+	uint64_t           _cycles;
+	uint64_t           _overruns;
+
+	static void* _driver_thread (void *);
+	void  driver_thread ();
+
+	microseconds_t period_usecs () const;
+	static microseconds_t microseconds ();
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_dummy_backend_h__ */
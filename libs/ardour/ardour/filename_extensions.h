@@ -7,6 +7,7 @@ namespace ARDOUR {
 extern const char* const template_suffix;
 extern const char* const statefile_suffix;
 extern const char* const pending_suffix;
+extern const char* const statecache_suffix;
 extern const char* const peakfile_suffix;
 extern const char* const backup_suffix;
 extern const char* const temp_suffix;
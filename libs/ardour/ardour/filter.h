@@ -22,6 +22,8 @@
 #define __ardour_filter_h__
 
 #include <vector>
+#include <algorithm>
+#include <boost/function.hpp>
 #include "ardour/region.h"
 
 namespace ARDOUR {
@@ -35,6 +37,63 @@ class Filter {
 	virtual ~Filter() {}
 
 	virtual int run (boost::shared_ptr<ARDOUR::Region>) = 0;
+
+	/** Scratch space for process().  Someone who runs several filters
+	    in turn can give each the same Buffers, so that it is only
+	    allocated once.
+	*/
+	struct Buffers {
+		/** make sure that there are at least some number of channels of some length */
+		void ensure (uint32_t n, nframes_t length) {
+			if (channels.size() < n) {
+				channels.resize (n);
+			}
+			pointers.resize (channels.size());
+			for (size_t i = 0; i < channels.size(); ++i) {
+				if (channels[i].size() < length) {
+					channels[i].resize (length);
+				}
+				pointers[i] = &channels[i][0];
+			}
+			if (gain.size() < length) {
+				gain.resize (length);
+			}
+		}
+
+		/** reads frames of one channel: (buffer, gain buffer, position, count, channel) */
+		typedef boost::function<framecnt_t (Sample*, gain_t*, framepos_t, framecnt_t, uint32_t)> ChannelReader;
+
+		/** read cnt frames of some channels, so that channel first + n ends up in channels[n],
+		    making room for them if need be
+		    @return frames read; less than cnt if one of the channels could not be read
+		*/
+		framecnt_t read (ChannelReader reader, framepos_t position, framecnt_t cnt, uint32_t first, uint32_t n) {
+			ensure (n, cnt);
+			for (uint32_t i = 0; i < n; ++i) {
+				framecnt_t const got = reader (pointers[i], &gain[0], position, cnt, first + i);
+				if (got != cnt) {
+					return std::min (got, cnt);
+				}
+			}
+			return cnt;
+		}
+
+		std::vector<std::vector<Sample> > channels;
+		std::vector<Sample*> pointers; ///< to the start of each channel
+		std::vector<gain_t> gain;
+	};
+
+	/* run() may also be done in three steps: prepare() makes new sources,
+	   process() fills them and complete() makes the results.  Only process()
+	   may be called while other filters are running, so that several
+	   filters can process at once.  By default prepare() does all of the
+	   work.
+	*/
+
+	virtual int prepare (boost::shared_ptr<ARDOUR::Region> r) { return run (r); }
+	virtual int process (Buffers&) { return 0; }
+	/** @param status 0 if prepare() and process() succeeded */
+	virtual int complete (int status) { return status; }
 	std::vector<boost::shared_ptr<ARDOUR::Region> > results;
 
   protected:
@@ -48,6 +48,50 @@ class CubicInterpolation : public Interpolation {
      nframes_t interpolate (int channel, nframes_t nframes, Sample* input, Sample* output);
 };
 
+/** Band-limited interpolation with a windowed sinc, which is much cleaner
+ *  than CubicInterpolation away from speed 1, and lowpasses the input when
+ *  speeding up so that it does not alias.
+ *
+ *  All channels are interpolated together: they move at the same speed, so
+ *  the filter for each output frame is worked out once and then applied to
+ *  every channel.  For this reason there is one phase, kept in phase[0],
+ *  rather than one per channel.
+ */
+class SincInterpolation : public Interpolation {
+ public:
+     SincInterpolation ();
+
+     void add_channel_to (int input_buffer_size, int output_buffer_size);
+     void remove_channel_from ();
+     void reset ();
+
+     /** Interpolate nframes of each channel.
+      *  @param inputs Input for each channel; these must have lookahead() frames
+      *  available beyond those which the call will consume.
+      *  @return number of input frames consumed.
+      */
+     nframes_t interpolate (uint32_t nchannels, nframes_t nframes, Sample* const * inputs, Sample* const * outputs);
+
+     /** Note that nframes of each channel have been played without being
+      *  interpolated, so that our history is right if we are asked to
+      *  interpolate from the frame after them.
+      */
+     void pass_through (uint32_t nchannels, nframes_t nframes, Sample* const * inputs);
+
+     /** number of frames, either side of the output position, that the filter reads */
+     static const int half_taps = 8;
+
+     static nframes_t lookahead () { return half_taps; }
+
+ private:
+     /** for each channel, the last half_taps input frames that we have moved past */
+     std::vector<std::vector<Sample> > _history;
+     /** scratch space for the history and the start of the input for each channel */
+     std::vector<std::vector<Sample> > _edge;
+
+     void keep_history (uint32_t nchannels, nframes_t consumed, Sample* const * inputs);
+};
+
 } // namespace ARDOUR
 
 #endif
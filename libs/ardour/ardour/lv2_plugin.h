@@ -97,7 +97,7 @@ class LV2Plugin : public ARDOUR::Plugin
 	void set_block_size (nframes_t /*nframes*/) {}
 
 	int connect_and_run (BufferSet& bufs,
-			ChanMapping in, ChanMapping out,
+			ChanMapping const & in, ChanMapping const & out,
 			nframes_t nframes, nframes_t offset);
 
 	std::string describe_parameter (Evoral::Parameter);
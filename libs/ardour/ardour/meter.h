@@ -20,6 +20,7 @@
 #define __ardour_meter_h__
 
 #include <vector>
+#include <glib.h>
 #include "ardour/types.h"
 #include "ardour/processor.h"
 #include "pbd/signals.h"
@@ -45,7 +46,7 @@ class Metering {
  */
 class PeakMeter : public Processor {
 public:
-	PeakMeter(Session& s) : Processor(s, "Meter") {}
+	PeakMeter(Session& s) : Processor(s, "Meter"), _rms (false) {}
 
 	void meter();
 	void reset ();
@@ -74,31 +75,67 @@ public:
 	ChanCount output_streams () const { return current_meters; }
 
 	float peak_power (uint32_t n) {
-		if (n < _visible_peak_power.size()) {
-			return _visible_peak_power[n];
+		if (n < _levels.size()) {
+			return _levels[n].visible_peak;
 		} else {
 			return minus_infinity();
 		}
 	}
 
 	float max_peak_power (uint32_t n) {
-		if (n < _max_peak_power.size()) {
-			return _max_peak_power[n];
+		if (n < _levels.size()) {
+			return _levels[n].max_peak;
 		} else {
 			return minus_infinity();
 		}
 	}
 
+	/** @return RMS level (dB) of the loudest process cycle since the previous
+	 *  meter(), or minus_infinity() if RMS metering is off.
+	 */
+	float rms_power (uint32_t n) {
+		if (_rms && n < _levels.size()) {
+			return _levels[n].rms;
+		} else {
+			return minus_infinity();
+		}
+	}
+
+	/** RMS costs a multiply and an add per sample, so it is off by default */
+	void set_rms (bool yn);
+	bool rms () const { return _rms; }
+
 	XMLNode& state (bool full);
 	
 private:
 	friend class IO;
 	
 	ChanCount current_meters;
-	
-	std::vector<float> _peak_power;
-	std::vector<float> _visible_peak_power;
-	std::vector<float> _max_peak_power;
+
+	/** Everything about one channel, kept together.  peak and mean_square
+	    are float bit patterns, raised by run() in the process thread and
+	    taken (and zeroed) by meter() using compare-and-exchange, so that
+	    neither thread ever waits for the other.
+	*/
+	struct Level {
+		Level ();
+
+		gint  peak;         ///< linear peak since the last meter()
+		gint  mean_square;  ///< largest per-cycle mean square since the last meter()
+		float visible_peak; ///< dB, with falloff applied
+		float max_peak;     ///< dB
+		float rms;          ///< dB
+	};
+
+	std::vector<Level> _levels;
+
+	/* scratch for run(), sized with _levels so that run() never allocates */
+
+	std::vector<const Sample*> _buffers;
+	std::vector<float>         _peaks;
+	std::vector<float>         _powers;
+
+	bool _rms;
 };
 
 
@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_meter_snapshot_h__
+#define __ardour_meter_snapshot_h__
+
+#include <vector>
+
+#include <glib.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include "pbd/rcu.h"
+
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class Route;
+
+/** A copy of the peak and maximum peak levels of every route's meter,
+ *  kept in one contiguous array.
+ *
+ *  update() is called by the metering thread once per metering interval,
+ *  straight after the meters themselves have been updated.  It writes into
+ *  one of two buffers while readers use the other, then publishes it.
+ *  Readers in any thread get a consistent copy of a route's levels without
+ *  taking a lock, and without touching the route's PeakMeter.
+ */
+class MeterSnapshot
+{
+  public:
+	MeterSnapshot ();
+
+	void update (boost::shared_ptr<RouteList>);
+
+	/** Copy a route's levels, as of the most recent update().
+	 *  @param peaks filled in with up to @a n peak levels (dB), or 0.
+	 *  @param max_peaks filled in with up to @a n maximum peak levels (dB), or 0.
+	 *  @return number of meter channels that the route has; 0 if it is not
+	 *  (or not yet) in the snapshot.
+	 */
+	uint32_t read (boost::shared_ptr<Route const>, float* peaks, float* max_peaks, uint32_t n) const;
+
+	/** @return level of one channel of a route's meter, or minus_infinity() */
+	float peak_power (boost::shared_ptr<Route const>, uint32_t chn) const;
+	float max_peak_power (boost::shared_ptr<Route const>, uint32_t chn) const;
+
+	/** @return number of update()s so far; a reader can poll this to see if
+	 *  there is anything new to display.
+	 */
+	uint32_t generation () const;
+
+  private:
+	struct Slot {
+		Slot () : offset (0), channels (0) {}
+		Slot (uint32_t o, uint32_t c) : offset (o), channels (c) {}
+
+		uint32_t offset;   ///< index of this route's first value in a buffer
+		uint32_t channels; ///< number of meter channels
+	};
+
+	struct Layout {
+		Layout () : generation (0) {}
+
+		boost::weak_ptr<RouteList> routes;         ///< route list that this layout was built for
+		std::vector<boost::weak_ptr<Route> > order; ///< routes, in `routes' order
+		std::vector<uint32_t> channels;             ///< meter channels of each route in `order'
+		boost::unordered_map<Route const *, Slot> slots;
+
+		/** two buffers of (peak, max peak) pairs; update() writes to
+		    buffer[(generation + 1) & 1] and then increments generation.
+		*/
+		std::vector<float> buffer[2];
+		mutable gint generation;
+	};
+
+	SerializedRCUManager<Layout> _layout;
+
+	bool layout_stale (Layout const &, boost::shared_ptr<RouteList>) const;
+	void rebuild (boost::shared_ptr<RouteList>);
+	float level (boost::shared_ptr<Route const>, uint32_t chn, uint32_t which) const;
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_meter_snapshot_h__ */
@@ -91,6 +91,27 @@ public:
                 DiffCommand& operator+= (const DiffCommand& other);
                 boost::shared_ptr<MidiModel> model() const { return _model; }
 
+		/** A change as it is saved: the contents of the note that it
+		 *  changes, and the old and new values of the changed property.
+		 *  The note's own value of that property is taken to be the new one.
+		 */
+		struct SavedChange {
+			Property property;
+			uint8_t  channel;
+			uint8_t  note;
+			uint8_t  velocity;
+			TimeType time;
+			TimeType length;
+			double   old_value;
+			double   new_value;
+		};
+
+		typedef std::list<SavedChange> SavedChanges;
+
+		static std::string pack_changes (const SavedChanges&);
+		static SavedChanges unpack_changes (const std::string&);
+		static SavedChange read_change (const XMLNode&);
+
           private:
 		boost::shared_ptr<MidiModel> _model;
 		const std::string            _name;
@@ -117,8 +138,16 @@ public:
 
                 std::set<NotePtr> side_effect_removals;
 
-		XMLNode &marshal_change(const NoteChange&);
 		NoteChange unmarshal_change(XMLNode *xml_note);
+		NoteChange make_change(const SavedChange&);
+
+		XMLNode &marshal_changes();
+		void unmarshal_changes(const XMLNode&);
+
+		NotePtr find_model_note(NotePtr);
+
+		void find_reordered_notes (std::set<NotePtr>&) const;
+		void apply_changes (bool undo);
 
 		XMLNode &marshal_note(const NotePtr note);
 		NotePtr unmarshal_note(XMLNode *xml_note);
@@ -33,6 +33,36 @@ extern "C" {
 }
 
 void  x86_sse_find_peaks               (const ARDOUR::Sample * buf, ARDOUR::nframes_t nsamples, float *min, float *max);
+void  x86_sse_compute_meter            (const ARDOUR::Sample * const * bufs, uint32_t nchannels, ARDOUR::nframes_t nframes, float *peaks, float *powers);
+void  x86_sse_pan_buffers              (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  x86_sse_pan_equal_power_stereo   (ARDOUR::Sample * left, ARDOUR::Sample * right, const ARDOUR::Sample * src, const ARDOUR::pan_t * positions, ARDOUR::nframes_t nframes, float scale, float gain);
+void  x86_sse_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * gains);
+void  x86_sse_copy_buffer_with_gain    (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
+void  x86_sse_interleave               (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes);
+void  x86_sse_deinterleave             (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes);
+void  x86_sse_scale_and_offset_buffer  (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * ramp, ARDOUR::nframes_t ramp_frames, float gain, float scale, float offset);
+void  x86_sse_crossfade_buffers        (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains, const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes);
+
+/* AVX functions; only called if the CPU and OS support AVX */
+
+float x86_sse_avx_compute_peak         (const ARDOUR::Sample * buf, ARDOUR::nframes_t nsamples, float current);
+void  x86_sse_avx_find_peaks           (const ARDOUR::Sample * buf, ARDOUR::nframes_t nsamples, float *min, float *max);
+void  x86_sse_avx_apply_gain_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, float gain);
+void  x86_sse_avx_mix_buffers_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
+void  x86_sse_avx_mix_buffers_no_gain  (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  x86_sse_avx_compute_meter        (const ARDOUR::Sample * const * bufs, uint32_t nchannels, ARDOUR::nframes_t nframes, float *peaks, float *powers);
+void  x86_sse_avx_pan_buffers          (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  x86_sse_avx_pan_equal_power_stereo (ARDOUR::Sample * left, ARDOUR::Sample * right, const ARDOUR::Sample * src, const ARDOUR::pan_t * positions, ARDOUR::nframes_t nframes, float scale, float gain);
+void  x86_sse_avx_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * gains);
+void  x86_sse_avx_copy_buffer_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
+void  x86_sse_avx_scale_and_offset_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * ramp, ARDOUR::nframes_t ramp_frames, float gain, float scale, float offset);
+void  x86_sse_avx_crossfade_buffers    (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains, const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes);
+
+/* FMA functions; only called if the CPU supports FMA and the OS supports AVX */
+
+void  x86_fma_mix_buffers_with_gain    (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
+void  x86_fma_pan_buffers              (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  x86_fma_crossfade_buffers        (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains, const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes);
 
 /* debug wrappers for SSE functions */
 
@@ -50,6 +80,13 @@ void veclib_find_peaks                 (const ARDOUR::Sample * buf, ARDOUR::nfra
 void  veclib_apply_gain_to_buffer      (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, float gain);
 void  veclib_mix_buffers_with_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
 void  veclib_mix_buffers_no_gain       (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  veclib_compute_meter             (const ARDOUR::Sample * const * bufs, uint32_t nchannels, ARDOUR::nframes_t nframes, float *peaks, float *powers);
+void  veclib_pan_buffers               (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  veclib_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * gains);
+void  veclib_copy_buffer_with_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
+void  veclib_interleave                (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes);
+void  veclib_deinterleave              (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes);
+void  veclib_crossfade_buffers         (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains, const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes);
 
 #endif
 
@@ -60,5 +97,14 @@ void  default_find_peaks                (const ARDOUR::Sample * buf, ARDOUR::nfr
 void  default_apply_gain_to_buffer      (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, float gain);
 void  default_mix_buffers_with_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
 void  default_mix_buffers_no_gain       (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  default_compute_meter             (const ARDOUR::Sample * const * bufs, uint32_t nchannels, ARDOUR::nframes_t nframes, float *peaks, float *powers);
+void  default_pan_buffers               (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes);
+void  default_pan_equal_power_stereo    (ARDOUR::Sample * left, ARDOUR::Sample * right, const ARDOUR::Sample * src, const ARDOUR::pan_t * positions, ARDOUR::nframes_t nframes, float scale, float gain);
+void  default_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * gains);
+void  default_copy_buffer_with_gain     (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain);
+void  default_interleave                (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes);
+void  default_deinterleave              (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes);
+void  default_scale_and_offset_buffer   (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * ramp, ARDOUR::nframes_t ramp_frames, float gain, float scale, float offset);
+void  default_crossfade_buffers         (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains, const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes);
 
 #endif /* __ardour_mix_h__ */
@@ -193,6 +193,12 @@ class Multi2dPanner : public StreamPanner
 
   private:
 	void update ();
+
+	/* one per output, for do_distribute(); the parent's outputs do not
+	   change without its stream panners being made again.
+	*/
+	std::vector<Sample*> _dsts;
+	std::vector<float>   _gains;
 };
 
 
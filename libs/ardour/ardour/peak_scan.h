@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_peak_scan_h__
+#define __ardour_peak_scan_h__
+
+#include <list>
+#include <vector>
+#include <boost/function.hpp>
+
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+/** Scans of one channel of a region which use the peaks from its source's
+ *  peakfile to avoid reading frames which cannot change the result.
+ */
+class PeakScan
+{
+  public:
+	/** first and last frames of some periods of the region, as offsets from its start */
+	typedef std::list<std::pair<frameoffset_t, frameoffset_t> > Periods;
+
+	/** reads frames of the source into a buffer; the same as AudioSource::read() */
+	typedef boost::function<framecnt_t (Sample*, framepos_t, framecnt_t)> Reader;
+
+	/** @param peaks Absolute value of each of the source's peaks which overlap the
+	 *  region, starting with the one containing its first frame; -1 where not known.
+	 *  @param frames_per_peak Frames of the source covered by each peak.
+	 *  @param start Start of the region in its source.
+	 *  @param length Length of the region.
+	 */
+	PeakScan (std::vector<Sample> const & peaks, framecnt_t frames_per_peak, framepos_t start, framecnt_t length, Reader read)
+		: _peaks (peaks)
+		, _frames_per_peak (frames_per_peak)
+		, _start (start)
+		, _length (length)
+		, _read (read)
+	{}
+
+	Periods find_silence (Sample threshold, framecnt_t min_length, InterThreadInfo& itt, bool report_progress) const;
+	double maximum_amplitude () const;
+
+	static Periods intersect (std::vector<Periods> const &, framecnt_t min_length);
+
+  private:
+	std::vector<Sample> const & _peaks;
+	framecnt_t _frames_per_peak;
+	framepos_t _start;
+	framecnt_t _length;
+	Reader _read;
+};
+
+} /* namespace */
+
+#endif /* __ardour_peak_scan_h__ */
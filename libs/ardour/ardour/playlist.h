@@ -174,6 +174,7 @@ class Playlist : public SessionObject
 	XMLNode& get_state ();
 	int set_state (const XMLNode&, int version);
 	XMLNode& get_template ();
+	virtual uint32_t full_state_generation () const;
 
 	PBD::Signal1<void,bool> InUse;
 	PBD::Signal0<void>      ContentsChanged;
@@ -198,7 +199,7 @@ class Playlist : public SessionObject
 
 	/* XXX: use of diskstream here is a little unfortunate */
 	const PBD::ID& get_orig_diskstream_id () const { return _orig_diskstream_id; }
-	void set_orig_diskstream_id (const PBD::ID& did) { _orig_diskstream_id = did; }
+	void set_orig_diskstream_id (const PBD::ID& did) { _orig_diskstream_id = did; state_changed (); }
 
 	/* destructive editing */
 
@@ -113,7 +113,7 @@ class Plugin : public PBD::StatefulDestructible, public Latent
 	virtual void set_block_size (nframes_t nframes) = 0;
 
 	virtual int connect_and_run (BufferSet& bufs,
-			ChanMapping in, ChanMapping out,
+			ChanMapping const & in, ChanMapping const & out,
 			nframes_t nframes, nframes_t offset) = 0;
 
 	virtual std::set<Evoral::Parameter> automatable() const = 0;
@@ -25,8 +25,11 @@
 
 #include <boost/weak_ptr.hpp>
 
+#include "pbd/rcu.h"
+
 #include "ardour/ardour.h"
 #include "ardour/types.h"
+#include "ardour/chan_mapping.h"
 #include "ardour/processor.h"
 #include "ardour/automation_control.h"
 
@@ -129,6 +132,24 @@ class PluginInsert : public Processor
 	BufferSet _signal_analysis_inputs;
 	BufferSet _signal_analysis_outputs;
 
+	/** buffer mappings for each plugin instance, built by configure_io()
+	    so that the process thread need not build them every cycle.
+	*/
+	std::vector<ChanMapping> _in_maps;
+	std::vector<ChanMapping> _out_maps;
+
+	void setup_channel_maps ();
+
+	/** the controls whose automation may be played back; rebuilt whenever
+	    an automation state changes, so that the process thread need not
+	    search all controls every cycle.
+	*/
+	typedef std::vector<boost::shared_ptr<AutomationControl> > AutomatedControls;
+	SerializedRCUManager<AutomatedControls> _automated_controls;
+
+	void update_automated_controls ();
+	bool find_next_automation_event (AutomatedControls const &, nframes_t now, nframes_t end, nframes_t& next) const;
+
 	void automation_run (BufferSet& bufs, nframes_t nframes);
 	void connect_and_run (BufferSet& bufs, nframes_t nframes, nframes_t offset, bool with_auto, nframes_t now = 0);
 
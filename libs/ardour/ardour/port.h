@@ -133,7 +133,15 @@ protected:
 
 	Port (std::string const &, DataType, Flags);
 
-	jack_port_t* _jack_port; ///< JACK port
+	/** @return the backend's buffer for this port; either the JACK port buffer
+	 *  or, when running with the dummy backend, one of our own.
+	 */
+	void* port_buffer (nframes_t nframes) const {
+		return _jack_port ? jack_port_get_buffer (_jack_port, nframes) : _dummy_buffer;
+	}
+
+	jack_port_t* _jack_port; ///< JACK port, or 0 if we are running with the dummy backend
+	void*        _dummy_buffer; ///< buffer used in place of the JACK port's by the dummy backend
 
 	static nframes_t _port_offset;
 	static nframes_t _buffer_size;
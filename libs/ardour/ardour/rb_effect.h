@@ -20,6 +20,8 @@
 #ifndef __ardour_rbeffect_h__
 #define __ardour_rbeffect_h__
 
+#include <string>
+
 #include "ardour/filter.h"
 
 namespace ARDOUR {
@@ -33,8 +35,20 @@ class RBEffect : public Filter {
 
 	int run (boost::shared_ptr<ARDOUR::Region>);
 
+	int prepare (boost::shared_ptr<ARDOUR::Region>);
+	int process (Buffers&);
+	int complete (int);
+
   private:
 	TimeFXRequest& tsr;
+
+	boost::shared_ptr<AudioRegion> _region;
+	SourceList _new_sources;
+	nframes_t _read_start;    ///< position in the master sources to read from
+	nframes_t _read_duration; ///< number of frames to read from the master sources
+	double _stretch;          ///< overall stretch from the master sources
+	double _shift;            ///< overall pitch shift from the master sources
+	std::string _suffix;      ///< to add to the names of things that we make
 };
 
 } /* namespace */
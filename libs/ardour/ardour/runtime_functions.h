@@ -29,12 +29,67 @@ namespace ARDOUR {
 	typedef void  (*apply_gain_to_buffer_t)		(ARDOUR::Sample *, nframes_t, float);
 	typedef void  (*mix_buffers_with_gain_t)	(ARDOUR::Sample *, const ARDOUR::Sample *, nframes_t, float);
 	typedef void  (*mix_buffers_no_gain_t)		(ARDOUR::Sample *, const ARDOUR::Sample *, nframes_t);
+	typedef void  (*compute_meter_t)		(const ARDOUR::Sample * const *, uint32_t, nframes_t, float *, float *);
+	typedef void  (*pan_buffers_t)			(ARDOUR::Sample * const *, const float *, uint32_t, const ARDOUR::Sample *, nframes_t);
+	typedef void  (*pan_equal_power_stereo_t)	(ARDOUR::Sample *, ARDOUR::Sample *, const ARDOUR::Sample *, const ARDOUR::pan_t *, nframes_t, float, float);
+	typedef void  (*apply_gain_curve_to_buffer_t)	(ARDOUR::Sample *, nframes_t, const ARDOUR::gain_t *);
+	typedef void  (*copy_buffer_with_gain_t)	(ARDOUR::Sample *, const ARDOUR::Sample *, nframes_t, float);
+	typedef void  (*interleave_t)			(ARDOUR::Sample *, const ARDOUR::Sample *, uint32_t, uint32_t, nframes_t);
+	typedef void  (*deinterleave_t)			(ARDOUR::Sample *, const ARDOUR::Sample *, uint32_t, uint32_t, nframes_t);
+	typedef void  (*scale_and_offset_buffer_t)	(ARDOUR::Sample *, nframes_t, const ARDOUR::gain_t *, nframes_t, float, float, float);
+	typedef void  (*crossfade_buffers_t)		(ARDOUR::Sample *, const ARDOUR::Sample *, const ARDOUR::gain_t *, const ARDOUR::Sample *, const ARDOUR::gain_t *, nframes_t);
 
 	extern compute_peak_t		compute_peak;
 	extern find_peaks_t             find_peaks;
 	extern apply_gain_to_buffer_t	apply_gain_to_buffer;
 	extern mix_buffers_with_gain_t	mix_buffers_with_gain;
 	extern mix_buffers_no_gain_t	mix_buffers_no_gain;
+
+	/** Meter several channels in one pass: for each channel c, raise peaks[c]
+	    to the largest absolute sample value and, if powers is non-zero, add
+	    the sum of the squared samples to powers[c].
+	*/
+	extern compute_meter_t		compute_meter;
+
+	/** Mix one source into several outputs in one pass: for each output o,
+	    add src scaled by gains[o] to dsts[o].
+	*/
+	extern pan_buffers_t		pan_buffers;
+
+	/** Mix src into left and right using the equal-power coefficients of the
+	    per-frame pan positions (0 is hard left, 1 hard right), computed with
+	    the given pan law scale, multiplied by gain.
+	*/
+	extern pan_equal_power_stereo_t	pan_equal_power_stereo;
+
+	/** Multiply each frame of a buffer by its own gain, as given by an
+	    automation or fade curve.
+	*/
+	extern apply_gain_curve_to_buffer_t	apply_gain_curve_to_buffer;
+
+	/** dst = src * gain */
+	extern copy_buffer_with_gain_t	copy_buffer_with_gain;
+
+	/** Write nframes of src into one channel of an interleaved buffer of
+	    nchannels channels; the other channels are left alone.
+	*/
+	extern interleave_t		interleave;
+
+	/** Read nframes of one channel of an interleaved buffer of nchannels
+	    channels into dst.
+	*/
+	extern deinterleave_t		deinterleave;
+
+	/** buf[i] = buf[i] * g[i] * scale + offset, where g[i] is ramp[i] for
+	    the first ramp_frames frames and gain for the rest.  Declick, phase
+	    invert (scale -1) and denormal protection (a tiny offset) in one pass.
+	*/
+	extern scale_and_offset_buffer_t	scale_and_offset_buffer;
+
+	/** dst[i] = out[i] * out_gains[i] + in[i] * in_gains[i]; the two
+	    sides of a crossfade, each under its own fade curve, in one pass.
+	*/
+	extern crossfade_buffers_t	crossfade_buffers;
 }
 
 #endif /* __ardour_runtime_functions_h__ */
@@ -0,0 +1,68 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_saved_state_cache_h__
+#define __ardour_saved_state_cache_h__
+
+#include <map>
+#include <stdint.h>
+
+#include <glibmm/thread.h>
+
+#include "pbd/id.h"
+
+class XMLNode;
+
+namespace PBD {
+	class Stateful;
+}
+
+namespace ARDOUR {
+
+/** The state of some objects as it was when the session was last saved,
+ *  so that objects which have not changed since then need not be asked
+ *  for their state again.  Each entry is tagged with a generation (see
+ *  PBD::Stateful::state_generation()) which must change whenever the
+ *  object's state does.
+ */
+class SavedStateCache
+{
+  public:
+	~SavedStateCache ();
+
+	XMLNode& get_state (PBD::Stateful&, uint32_t generation);
+
+	void sweep ();
+	void clear ();
+
+  private:
+	struct Entry {
+		uint32_t generation;
+		XMLNode* state;
+		bool     used; ///< true if asked for since the last sweep()
+	};
+
+	typedef std::map<PBD::ID, Entry> Entries;
+	Entries _entries;
+	Glib::Mutex _lock;
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_saved_state_cache_h__ */
@@ -30,6 +30,7 @@
 
 #include <boost/dynamic_bitset.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/utility.hpp>
 
@@ -49,6 +50,7 @@
 #include "ardour/rc_configuration.h"
 #include "ardour/session_configuration.h"
 #include "ardour/session_event.h"
+#include "ardour/session_state_writer.h"
 #include "ardour/location.h"
 #include "ardour/timecode.h"
 #include "ardour/interpolation.h"
@@ -95,6 +97,7 @@ class ExportHandler;
 class ExportStatus;
 class IO;
 class IOProcessor;
+class MeterSnapshot;
 class ImportStatus;
 class MidiRegion;
 class MidiSource;
@@ -112,6 +115,7 @@ class Return;
 class Route;
 class RouteGroup;
 class SMFSource;
+class SavedStateCache;
 class Send;
 class SessionDirectory;
 class SessionMetadata;
@@ -157,7 +161,7 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 	bool writable() const { return _writable; }
 	void set_dirty ();
 	void set_clean ();
-	bool dirty() const { return _state_of_the_state & Dirty; }
+	bool dirty() const { return (_state_of_the_state & Dirty) || g_atomic_int_get (&_state_write_failed); }
 	void set_deletion_in_progress ();
 	void clear_deletion_in_progress ();
 	bool deletion_in_progress() const { return _state_of_the_state & Deletion; }
@@ -238,6 +242,10 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 	boost::shared_ptr<Route> route_by_id (PBD::ID);
 	boost::shared_ptr<Route> route_by_remote_id (uint32_t id);
 
+	/** levels of all routes' meters, for UIs and control surfaces */
+	MeterSnapshot const & meter_snapshot () const { return *_meter_snapshot; }
+	void update_meter_snapshot ();
+
 	bool route_name_unique (std::string) const;
 	bool route_name_internal (std::string) const;
 
@@ -352,7 +360,7 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 #ifdef HAVE_JACK_SESSION 
 	void jack_session_event (jack_session_event_t* event);
 #endif
-	int save_state (std::string snapshot_name, bool pending = false, bool switch_to_snapshot = false);
+	int save_state (std::string snapshot_name, bool pending = false, bool switch_to_snapshot = false, bool background = false);
 	int restore_state (std::string snapshot_name);
 	int save_template (std::string template_name);
 	int save_history (std::string snapshot_name = "");
@@ -702,6 +710,7 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 	// these commands are implemented in libs/ardour/session_command.cc
 	Command* memento_command_factory(XMLNode* n);
 	Command* stateful_diff_command_factory (XMLNode *);
+	Command* delta_memento_command_factory (XMLNode *);
 	void register_with_memento_command_factory(PBD::ID, PBD::StatefulDestructible*);
 
 	/* clicking */
@@ -1193,6 +1202,31 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 
 	SerializedRCUManager<RouteList>  routes;
 
+	/** Hashed lookups into `routes', for control surfaces which look routes
+	    up by remote control ID or name on every message they receive.
+	    Rebuilt whenever the route list, a route's name or a route's remote
+	    control ID changes, and published via RCU so that readers in any
+	    thread never take a lock.  Where more than one route has the same
+	    key, the first in `routes' wins, as it would with a linear search.
+	*/
+	struct RouteIndex {
+		boost::unordered_map<uint32_t, boost::weak_ptr<Route> >    by_remote_id;
+		boost::unordered_map<std::string, boost::weak_ptr<Route> > by_name;
+	};
+
+	SerializedRCUManager<RouteIndex> route_index;
+
+	void rebuild_route_index ();
+	void route_property_changed (const PBD::PropertyChange&);
+
+	MeterSnapshot* _meter_snapshot;
+
+	SessionStateWriter* _state_writer;
+	SavedStateCache* _saved_state_cache;
+	mutable gint _state_write_failed; /* set by the state writer's thread, accessed only atomic ops */
+	void state_write_failed ();
+	void prepare_history (SessionStateWriter::Job &, std::string const &);
+
 	void add_routes (RouteList&, bool save);
 	uint32_t destructive_index;
 
@@ -1408,6 +1442,7 @@ class Session : public PBD::StatefulDestructible, public PBD::ScopedConnectionLi
 	XMLNode& get_control_protocol_state ();
 
 	void set_history_depth (uint32_t depth);
+	void set_history_memory_budget (uint32_t mb);
 	void sync_order_keys ();
 
 	static bool _disable_all_loaded_plugins;
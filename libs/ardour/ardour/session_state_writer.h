@@ -0,0 +1,86 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_session_state_writer_h__
+#define __ardour_session_state_writer_h__
+
+#include <list>
+#include <string>
+#include <pthread.h>
+
+#include <glibmm/thread.h>
+#include <boost/function.hpp>
+
+class XMLTree;
+
+namespace ARDOUR {
+
+/** Writes session state and history files to disk.  A write can either be
+ *  done straight away, or queued for the writer's own thread, in which case
+ *  the thread that saves the session need only collect its state; turning
+ *  that into XML text and writing it out is done elsewhere.
+ */
+class SessionStateWriter
+{
+  public:
+	/** Description of one save; it owns its trees */
+	struct Job {
+		Job ();
+		~Job ();
+
+		XMLTree*    state;        ///< session state, or 0 to leave the file at path alone
+		std::string path;         ///< where the session state goes
+		std::string tmp_path;     ///< where the session state is written before being renamed to path
+		bool        backup;       ///< true to back up any existing file at path first
+		std::string cache_path;   ///< where to write a binary cache of the file at path, or empty
+
+		std::string history_path; ///< where the history goes, or empty to leave the history alone
+		std::string history_backup_path;
+		XMLTree*    history;      ///< history, or 0 to just move the old history file out of the way
+	};
+
+	/** @param failed Called, from the writer's thread, if a queued job could not be written */
+	SessionStateWriter (boost::function<void()> failed);
+	~SessionStateWriter ();
+
+	void queue (Job *);
+	void wait ();
+
+	static int write (Job &);
+	static int write_history (Job &);
+
+  private:
+	boost::function<void()> _failed;
+
+	pthread_t        _thread;
+	bool             _running;
+	bool             _quit;
+	bool             _busy;
+	std::list<Job*>  _jobs;
+	Glib::Mutex      _lock;
+	Glib::Cond       _work;
+	Glib::Cond       _done;
+
+	static void* _thread_work (void *);
+	void thread_work ();
+};
+
+} // namespace ARDOUR
+
+#endif /* __ardour_session_state_writer_h__ */
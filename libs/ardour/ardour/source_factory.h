@@ -39,7 +39,7 @@ class SourceFactory {
 
 	static PBD::Signal1<void,boost::shared_ptr<Source> > SourceCreated;
 
-	static boost::shared_ptr<Source> create (Session&, const XMLNode& node, bool async = false);
+	static boost::shared_ptr<Source> create (Session&, const XMLNode& node, bool async = false, bool announce = true);
 	static boost::shared_ptr<Source> createSilent (Session&, const XMLNode& node,
 			nframes_t nframes, float sample_rate);
 
@@ -46,6 +46,8 @@ class RBStretch : public RBEffect {
 
 namespace ARDOUR {
 
+class AudioRegion;
+
 class STStretch : public Filter {
   public:
 	STStretch (ARDOUR::Session&, TimeFXRequest&);
@@ -53,10 +55,18 @@ class STStretch : public Filter {
 
 	int run (boost::shared_ptr<ARDOUR::Region>);
 
+	int prepare (boost::shared_ptr<ARDOUR::Region>);
+	int process (Buffers&);
+	int complete (int);
+
   private:
 	TimeFXRequest& tsr;
 
 	soundtouch::SoundTouch st;
+
+	boost::shared_ptr<AudioRegion> _region;
+	SourceList _new_sources;
+	std::string _suffix; ///< to add to the names of things that we make
 };
 
 } /* namespace */
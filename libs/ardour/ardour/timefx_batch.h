@@ -0,0 +1,77 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __ardour_timefx_batch_h__
+#define __ardour_timefx_batch_h__
+
+#include <vector>
+#include <glib.h>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "pbd/transmitter.h"
+
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class Filter;
+class Region;
+
+/** Runs a time-stretch, pitch-shift or other filter over several regions,
+ *  processing as many of them at once as there are processors.
+ *
+ *  Each region gets its own filter and its own copy of the request, so that
+ *  its progress can be followed separately; the request given to the batch
+ *  shows overall progress, and setting its cancel flag stops everything.
+ */
+class TimeFXBatch
+{
+  public:
+	/** Makes a filter for one region, given the request that it should use */
+	typedef boost::function<Filter* (TimeFXRequest&)> FilterFactory;
+
+	TimeFXBatch (TimeFXRequest &, FilterFactory, std::vector<boost::shared_ptr<Region> > const &);
+	~TimeFXBatch ();
+
+	int run ();
+
+	/** @return progress of region n; this may be looked at while run() is running */
+	InterThreadInfo const & region_progress (size_t n) const {
+		return _requests[n];
+	}
+
+	/** results for each region, in the order that they were given; empty for a region which failed */
+	std::vector<std::vector<boost::shared_ptr<Region> > > results;
+
+  private:
+	TimeFXRequest& _request;
+	std::vector<boost::shared_ptr<Region> > _regions;
+	std::vector<TimeFXRequest> _requests;
+	std::vector<Filter*> _filters;
+	std::vector<int> _status;
+	std::vector<TransmitterMessages> _messages; ///< anything said while processing each region
+	gint _next; ///< the next region to be picked up by a thread
+
+	void work ();
+};
+
+} /* namespace */
+
+#endif /* __ardour_timefx_batch_h__ */
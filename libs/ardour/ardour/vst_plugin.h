@@ -67,7 +67,7 @@ class VSTPlugin : public ARDOUR::Plugin
 	void set_block_size (nframes_t nframes);
 
 	int connect_and_run (BufferSet&,
-			ChanMapping in, ChanMapping out,
+			ChanMapping const & in, ChanMapping const & out,
 			nframes_t nframes, nframes_t offset);
 
 	std::string describe_parameter (Evoral::Parameter);
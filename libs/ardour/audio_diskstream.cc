@@ -592,11 +592,16 @@ AudioDiskstream::process (nframes_t transport_frame, nframes_t nframes, bool can
 		/* we're doing playback */
 
 		nframes_t necessary_samples;
+		bool const sinc = (Config->get_varispeed_interpolation() == SincVarispeed);
 
 		/* no varispeed playback if we're recording, because the output .... TBD */
 
 		if (rec_nframes == 0 && _actual_speed != 1.0f) {
 			necessary_samples = (nframes_t) floor ((nframes * fabs (_actual_speed))) + 1;
+			if (sinc) {
+				/* the sinc filter reads a little way beyond the frames that it consumes */
+				necessary_samples += SincInterpolation::lookahead ();
+			}
 		} else {
 			necessary_samples = nframes;
 		}
@@ -640,9 +645,24 @@ AudioDiskstream::process (nframes_t transport_frame, nframes_t nframes, bool can
 		}
 
 		if (rec_nframes == 0 && _actual_speed != 1.0f && _actual_speed != -1.0f) {
-			process_varispeed_playback(nframes, c);
+			process_varispeed_playback(nframes, c, sinc);
 		} else {
 			playback_distance = nframes;
+
+			if (sinc && !c->empty()) {
+				/* keep the filter's history up to date, so that it is
+				   right if we start varispeeding from here
+				*/
+				uint32_t const n = c->size ();
+				assert (sinc_inputs.size() >= n);
+
+				uint32_t channel = 0;
+				for (chan = c->begin(); chan != c->end(); ++chan, ++channel) {
+					sinc_inputs[channel] = (*chan)->current_playback_buffer;
+				}
+
+				sinc_interpolation.pass_through (n, nframes, &sinc_inputs[0]);
+			}
 		}
 
 		_speed = _target_speed;
@@ -660,10 +680,35 @@ AudioDiskstream::process (nframes_t transport_frame, nframes_t nframes, bool can
 }
 
 void
-AudioDiskstream::process_varispeed_playback(nframes_t nframes, boost::shared_ptr<ChannelList> c)
+AudioDiskstream::process_varispeed_playback(nframes_t nframes, boost::shared_ptr<ChannelList> c, bool sinc)
 {
 	ChannelList::iterator chan;
 
+	if (sinc && !c->empty()) {
+
+		/* interpolate all channels together, so that the filter coefficients
+		   for each output frame are only worked out once
+		*/
+
+		uint32_t const n = c->size ();
+		assert (sinc_inputs.size() >= n && sinc_outputs.size() >= n);
+
+		uint32_t channel = 0;
+		for (chan = c->begin(); chan != c->end(); ++chan, ++channel) {
+			sinc_inputs[channel] = (*chan)->current_playback_buffer;
+			sinc_outputs[channel] = (*chan)->speed_buffer;
+		}
+
+		sinc_interpolation.set_speed (_target_speed);
+		playback_distance = sinc_interpolation.interpolate (n, nframes, &sinc_inputs[0], &sinc_outputs[0]);
+
+		for (chan = c->begin(); chan != c->end(); ++chan) {
+			(*chan)->current_playback_buffer = (*chan)->speed_buffer;
+		}
+
+		return;
+	}
+
 	interpolation.set_speed (_target_speed);
 
 	int channel = 0;
@@ -820,6 +865,11 @@ AudioDiskstream::seek (nframes_t frame, bool complete_refill)
 		(*chan)->capture_buf->reset ();
 	}
 
+	/* the interpolators' history is from before the seek */
+
+	interpolation.reset ();
+	sinc_interpolation.reset ();
+
 	/* can't rec-enable in destructive mode if transport is before start */
 
 	if (destructive() && record_enabled() && frame < _session.current_start_frame()) {
@@ -1996,7 +2046,7 @@ AudioDiskstream::allocate_temporary_buffers ()
 	*/
 
 	double const sp = max (fabsf (_actual_speed), 1.2f);
-	nframes_t required_wrap_size = (nframes_t) floor (_session.get_block_size() * sp) + 1;
+	nframes_t required_wrap_size = (nframes_t) floor (_session.get_block_size() * sp) + 1 + SincInterpolation::lookahead ();
 
 	if (required_wrap_size > wrap_buffer_size) {
 
@@ -2063,6 +2113,13 @@ AudioDiskstream::add_channel_to (boost::shared_ptr<ChannelList> c, uint32_t how_
                                               _session.butler()->audio_diskstream_capture_buffer_size(),
                                               speed_buffer_size, wrap_buffer_size));
 		interpolation.add_channel_to (_session.butler()->audio_diskstream_playback_buffer_size(), speed_buffer_size);
+		sinc_interpolation.add_channel_to (_session.butler()->audio_diskstream_playback_buffer_size(), speed_buffer_size);
+	}
+
+	/* never shrunk, so that a process() still using a longer list is safe */
+	if (sinc_inputs.size() < c->size()) {
+		sinc_inputs.resize (c->size());
+		sinc_outputs.resize (c->size());
 	}
 
 	_n_channels.set(DataType::AUDIO, c->size());
@@ -2086,6 +2143,7 @@ AudioDiskstream::remove_channel_from (boost::shared_ptr<ChannelList> c, uint32_t
 		delete c->back();
 		c->pop_back();
 		interpolation.remove_channel_from ();
+		sinc_interpolation.remove_channel_from ();
 	}
 
 	_n_channels.set(DataType::AUDIO, c->size());
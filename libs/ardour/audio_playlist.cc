@@ -233,6 +233,7 @@ AudioPlaylist::remove_dependents (boost::shared_ptr<Region> region)
 
 		if ((*i)->involves (r)) {
 			i = _crossfades.erase (i);
+			state_changed ();
 		} else {
 			++i;
 		}
@@ -334,6 +335,7 @@ AudioPlaylist::finalize_split_region (boost::shared_ptr<Region> o, boost::shared
 
 		if (fade) {
 			_crossfades.remove (*x);
+			state_changed ();
 			add_crossfade (fade);
 		}
 		x = tmp;
@@ -526,6 +528,7 @@ AudioPlaylist::add_crossfade (boost::shared_ptr<Crossfade> xfade)
 		// it will just go away
 	} else {
 		_crossfades.push_back (xfade);
+		state_changed ();
 
 		xfade->Invalidated.connect_same_thread (*this, boost::bind (&AudioPlaylist::crossfade_invalidated, this, _1));
 		xfade->PropertyChanged.connect_same_thread (*this, boost::bind (&AudioPlaylist::crossfade_changed, this, _1));
@@ -554,6 +557,7 @@ AudioPlaylist::crossfade_invalidated (boost::shared_ptr<Region> r)
 
 	if ((i = find (_crossfades.begin(), _crossfades.end(), xfade)) != _crossfades.end()) {
 		_crossfades.erase (i);
+		state_changed ();
 	}
 }
 
@@ -606,9 +610,22 @@ void
 AudioPlaylist::clear (bool with_signals)
 {
 	_crossfades.clear ();
+	state_changed ();
 	Playlist::clear (with_signals);
 }
 
+uint32_t
+AudioPlaylist::full_state_generation () const
+{
+	uint32_t g = Playlist::full_state_generation ();
+
+	for (Crossfades::const_iterator i = _crossfades.begin(); i != _crossfades.end(); ++i) {
+		g = max (g, (*i)->state_generation ());
+	}
+
+	return g;
+}
+
 XMLNode&
 AudioPlaylist::state (bool full_state)
 {
@@ -713,6 +730,7 @@ AudioPlaylist::destroy_region (boost::shared_ptr<Region> region)
 		if ((*c)->involves (r)) {
 			unique_xfades.insert (*c);
 			_crossfades.erase (c);
+			state_changed ();
 		}
 
 		c = ctmp;
@@ -729,6 +747,8 @@ AudioPlaylist::destroy_region (boost::shared_ptr<Region> region)
 void
 AudioPlaylist::crossfade_changed (const PropertyChange&)
 {
+	state_changed ();
+
 	if (in_flush || in_set_state) {
 		return;
 	}
@@ -57,7 +57,7 @@ AudioPort::cycle_start (nframes_t nframes)
 		   address where we will write data later in the process cycle.
 		*/
 
-		_buffer->set_data ((Sample *) jack_port_get_buffer (_jack_port, nframes), nframes);
+		_buffer->set_data ((Sample *) port_buffer (nframes), nframes);
 		_buffer->prepare ();
 	}
 }
@@ -88,7 +88,7 @@ AudioPort::get_audio_buffer (nframes_t nframes, nframes_t offset)
 		   Note that offset is expected to be zero in almost all cases.
 		*/
 
-		_buffer->set_data ((Sample *) jack_port_get_buffer (_jack_port, nframes) + offset + _port_offset, nframes);
+		_buffer->set_data ((Sample *) port_buffer (nframes) + offset + _port_offset, nframes);
 	}
 
 	/* output ports set their _buffer data information during ::cycle_start()
@@ -41,6 +41,7 @@
 #include "ardour/processor.h"
 #include "ardour/region_factory.h"
 #include "ardour/route_group_specialized.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/session.h"
 #include "ardour/utils.h"
 #include "ardour/session_playlists.h"
@@ -445,11 +446,7 @@ AudioTrack::roll (nframes_t nframes, sframes_t start_frame, sframes_t end_frame,
 				   the output buffer.
 				*/
 
-				Sample* bb = bufs.get_audio (i).data();
-
-				for (nframes_t xx = 0; xx < nframes; ++xx) {
-					bb[xx] = b[xx] * scaling;
-				}
+				copy_buffer_with_gain (bufs.get_audio (i).data(), b, nframes, scaling);
 
 				if (n < diskstream->n_channels().n_audio()) {
 					tmpb = diskstream->playback_buffer(n);
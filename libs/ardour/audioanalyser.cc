@@ -24,6 +24,7 @@ using namespace ARDOUR;
 AudioAnalyser::AudioAnalyser (float sr, AnalysisPluginKey key)
 	: sample_rate (sr)
 	, plugin_key (key)
+	, _cancelled (0)
 {
 	/* create VAMP plugin and initialize */
 
@@ -113,6 +114,10 @@ AudioAnalyser::analyse (const string& path, Readable* src, uint32_t channel)
 
 		nframes64_t to_read;
 
+		if (g_atomic_int_get (&_cancelled)) {
+			goto out;
+		}
+
 		/* read from source */
 
 		to_read = min ((len - pos), bufsize);
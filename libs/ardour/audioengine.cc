@@ -69,6 +69,32 @@ AudioEngine* AudioEngine::_instance = 0;
 
 AudioEngine::AudioEngine (string client_name, string session_uuid)
 	: ports (new Ports)
+{
+	init ();
+
+	if (connect_to_jack (client_name, session_uuid)) {
+		throw NoBackendAvailable ();
+	}
+
+	Port::set_engine (this);
+}
+
+/** Create an engine which is driven by a DummyBackend rather than by JACK */
+AudioEngine::AudioEngine (string client_name, DummyBackend::Parameters const & params)
+	: ports (new Ports)
+{
+	init ();
+
+	jack_client_name = client_name;
+	_dummy = new DummyBackend (params,
+				   boost::bind (&AudioEngine::dummy_thread_init, this),
+				   boost::bind (&AudioEngine::process_callback, this, _1));
+
+	Port::set_engine (this);
+}
+
+void
+AudioEngine::init ()
 {
 	_instance = this; /* singleton */
 
@@ -80,6 +106,7 @@ AudioEngine::AudioEngine (string client_name, string session_uuid)
 	_processed_frames = 0;
 	_usecs_per_cycle = 0;
 	_jack = 0;
+	_dummy = 0;
 	_frame_rate = 0;
 	_buffer_size = 0;
 	_freewheeling = false;
@@ -88,12 +115,6 @@ AudioEngine::AudioEngine (string client_name, string session_uuid)
 	m_meter_thread = 0;
 	g_atomic_int_set (&m_meter_exit, 0);
 
-	if (connect_to_jack (client_name, session_uuid)) {
-		throw NoBackendAvailable ();
-	}
-
-	Port::set_engine (this);
-
 	// Initialize parameter metadata (e.g. ranges)
 	Evoral::Parameter p(NullAutomation);
 	p = EventTypeMap::instance().new_parameter(NullAutomation);
@@ -118,13 +139,21 @@ AudioEngine::~AudioEngine ()
 		Glib::Mutex::Lock tm (_process_lock);
 		session_removed.signal ();
 
-		if (_running) {
+		if (_running && _jack) {
 			jack_client_close (_jack);
 			_jack = 0;
 		}
 
 		stop_metering_thread ();
 	}
+
+	if (_dummy) {
+		_dummy->stop ();
+		delete _dummy;
+		_dummy = 0;
+	}
+
+	delete _main_thread;
 }
 
 jack_client_t*
@@ -172,6 +201,10 @@ ardour_jack_error (const char* msg)
 int
 AudioEngine::start ()
 {
+	if (_dummy) {
+		return start_dummy ();
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
 
 	if (!_running) {
@@ -254,6 +287,15 @@ AudioEngine::start ()
 int
 AudioEngine::stop (bool forever)
 {
+	if (_dummy) {
+		if (_running) {
+			_dummy->stop ();
+			_running = false;
+			Stopped(); /* EMIT SIGNAL */
+		}
+		return 0;
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
 
 	if (_priv_jack) {
@@ -451,7 +493,12 @@ AudioEngine::process_thread ()
 int
 AudioEngine::process_callback (nframes_t nframes)
 {
-	GET_PRIVATE_JACK_POINTER_RET(_jack,0);
+	jack_client_t* _priv_jack = (jack_client_t*) _jack;
+
+	if (!_priv_jack && !_dummy) {
+		return 0;
+	}
+
 	// CycleTimer ct ("AudioEngine::process");
 	Glib::Mutex::Lock tm (_process_lock, Glib::TRY_LOCK);
 
@@ -500,7 +547,12 @@ AudioEngine::process_callback (nframes_t nframes)
 		 */
                 boost::optional<int> r = Freewheel (nframes);
 		if (r.get_value_or (0)) {
-			jack_set_freewheel (_priv_jack, false);
+			if (_dummy) {
+				_freewheeling = false;
+				_dummy->set_freewheel (false);
+			} else {
+				jack_set_freewheel (_priv_jack, false);
+			}
 		}
 
 	} else {
@@ -673,6 +725,10 @@ AudioEngine::meter_thread ()
 			break;
 		}
 		Metering::Meter ();
+
+		if (_session) {
+			_session->update_meter_snapshot ();
+		}
 	}
 }
 
@@ -687,7 +743,7 @@ AudioEngine::set_session (Session *s)
 
 		start_metering_thread ();
 		
-		nframes_t blocksize = jack_get_buffer_size (_jack);
+		nframes_t blocksize = frames_per_cycle ();
 		
 		/* page in as much of the session process code as we
 		   can before we really start running.
@@ -916,7 +972,9 @@ AudioEngine::disconnect (const string& source, const string& destination)
 int
 AudioEngine::disconnect (Port& port)
 {
-	GET_PRIVATE_JACK_POINTER_RET (_jack,-1);
+	if (!_jack && !_dummy) {
+		return -1;
+	}
 
 	if (!_running) {
 		if (!_has_run) {
@@ -933,6 +991,10 @@ AudioEngine::disconnect (Port& port)
 ARDOUR::nframes_t
 AudioEngine::frame_rate () const
 {
+	if (_dummy) {
+		return _dummy->parameters().sample_rate;
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack,0);
 	if (_frame_rate == 0) {
 	  return (_frame_rate = jack_get_sample_rate (_priv_jack));
@@ -951,6 +1013,10 @@ AudioEngine::raw_buffer_size (DataType t)
 ARDOUR::nframes_t
 AudioEngine::frames_per_cycle () const
 {
+	if (_dummy) {
+		return _dummy->parameters().period_size;
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack,0);
 	if (_buffer_size == 0) {
 	  return (_buffer_size = jack_get_buffer_size (_jack));
@@ -1093,6 +1159,10 @@ AudioEngine::died ()
 bool
 AudioEngine::can_request_hardware_monitoring ()
 {
+	if (_dummy) {
+		return false;
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack,false);
 	const char ** ports;
 
@@ -1109,6 +1179,10 @@ AudioEngine::can_request_hardware_monitoring ()
 uint32_t
 AudioEngine::n_physical_outputs (DataType type) const
 {
+	if (_dummy) {
+		return _dummy->n_physical (type, false);
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack,0);
 	const char ** ports;
 	uint32_t cnt = 0;
@@ -1131,6 +1205,10 @@ AudioEngine::n_physical_outputs (DataType type) const
 uint32_t
 AudioEngine::n_physical_inputs (DataType type) const
 {
+	if (_dummy) {
+		return _dummy->n_physical (type, true);
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack,0);
 	const char ** ports;
 	uint32_t cnt = 0;
@@ -1153,6 +1231,13 @@ AudioEngine::n_physical_inputs (DataType type) const
 void
 AudioEngine::get_physical_inputs (DataType type, vector<string>& ins)
 {
+	if (_dummy) {
+		for (uint32_t n = 0; n < _dummy->n_physical (type, true); ++n) {
+			ins.push_back (_dummy->nth_physical (type, true, n));
+		}
+		return;
+	}
+
 	GET_PRIVATE_JACK_POINTER (_jack);
 	const char ** ports;
 
@@ -1174,6 +1259,13 @@ AudioEngine::get_physical_inputs (DataType type, vector<string>& ins)
 void
 AudioEngine::get_physical_outputs (DataType type, vector<string>& outs)
 {
+	if (_dummy) {
+		for (uint32_t n = 0; n < _dummy->n_physical (type, false); ++n) {
+			outs.push_back (_dummy->nth_physical (type, false, n));
+		}
+		return;
+	}
+
 	GET_PRIVATE_JACK_POINTER (_jack);
 	const char ** ports;
 	uint32_t i = 0;
@@ -1194,6 +1286,11 @@ AudioEngine::get_physical_outputs (DataType type, vector<string>& outs)
 string
 AudioEngine::get_nth_physical (DataType type, uint32_t n, int flag)
 {
+	if (_dummy) {
+		/* physical inputs are the ones that JACK calls outputs */
+		return _dummy->nth_physical (type, (flag & JackPortIsOutput), n);
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack,"");
 	const char ** ports;
 	uint32_t i;
@@ -1274,6 +1371,12 @@ AudioEngine::reset_timebase ()
 int
 AudioEngine::freewheel (bool onoff)
 {
+	if (_dummy) {
+		_freewheeling = onoff;
+		_dummy->set_freewheel (onoff);
+		return 0;
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
 
 	if (onoff != _freewheeling) {
@@ -1306,6 +1409,62 @@ AudioEngine::remove_all_ports ()
 	ports.flush ();
 }
 
+/** Called by the dummy backend's process thread before the first cycle, to
+ *  do the setup that JACK's thread init callback and process_thread() do.
+ *  The backend may be stopped and started many times, so one ProcessThread
+ *  is kept for all of its threads; it holds nothing specific to a thread.
+ */
+void
+AudioEngine::dummy_thread_init ()
+{
+	_thread_init_callback (0);
+
+	if (!_main_thread) {
+		_main_thread = new ProcessThread;
+	}
+}
+
+int
+AudioEngine::start_dummy ()
+{
+	if (_running) {
+		return 0;
+	}
+
+	nframes_t const blocksize = _dummy->parameters().period_size;
+
+	_buffer_size = blocksize;
+	_frame_rate = _dummy->parameters().sample_rate;
+	_usecs_per_cycle = (int) floor ((((double) blocksize / _frame_rate)) * 1000000.0);
+	monitor_check_interval = _frame_rate / 10;
+
+	_raw_buffer_sizes[DataType::AUDIO] = blocksize * sizeof (Sample);
+	_raw_buffer_sizes[DataType::MIDI] = blocksize * 4 - (blocksize/2);
+
+	if (_session) {
+		BootMessage (_("Connect session to engine"));
+		_session->set_block_size (blocksize);
+		_session->set_frame_rate (_frame_rate);
+	}
+
+	_processed_frames = 0;
+	last_monitor_check = 0;
+
+	/* set these before the backend thread can call process_callback() */
+
+	_running = true;
+	_has_run = true;
+
+	if (_dummy->start ()) {
+		_running = false;
+		return -1;
+	}
+
+	Running(); /* EMIT SIGNAL */
+
+	return 0;
+}
+
 int
 AudioEngine::connect_to_jack (string client_name, string session_uuid)
 {
@@ -1338,6 +1497,10 @@ AudioEngine::connect_to_jack (string client_name, string session_uuid)
 int
 AudioEngine::disconnect_from_jack ()
 {
+	if (_dummy) {
+		return stop ();
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
 
 	if (_running) {
@@ -1366,6 +1529,10 @@ AudioEngine::disconnect_from_jack ()
 int
 AudioEngine::reconnect_to_jack ()
 {
+	if (_dummy) {
+		return _running ? 0 : start ();
+	}
+
 	if (_running) {
 		disconnect_from_jack ();
 		/* XXX give jackd a chance */
@@ -1449,6 +1616,27 @@ AudioEngine::reconnect_to_jack ()
 int
 AudioEngine::request_buffer_size (nframes_t nframes)
 {
+	if (_dummy) {
+		if (nframes == _dummy->parameters().period_size) {
+			return 0;
+		}
+
+		bool const was_running = _dummy->running ();
+
+		_dummy->stop ();
+
+		if (_dummy->set_period_size (nframes)) {
+			if (was_running) {
+				_dummy->start ();
+			}
+			return -1;
+		}
+
+		jack_bufsize_callback (nframes);
+
+		return was_running ? _dummy->start () : 0;
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack, -1);
 
 	if (nframes == jack_get_buffer_size (_priv_jack)) {
@@ -1507,6 +1695,10 @@ AudioEngine::make_port_name_non_relative (string portname)
 bool
 AudioEngine::is_realtime () const
 {
+	if (_dummy) {
+		return false;
+	}
+
 	GET_PRIVATE_JACK_POINTER_RET (_jack,false);
 	return jack_is_realtime (_priv_jack);
 }
@@ -1514,8 +1706,28 @@ AudioEngine::is_realtime () const
 pthread_t
 AudioEngine::create_process_thread (boost::function<void()> f, size_t stacksize)
 {
-        GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
         pthread_t thread;
+
+        if (_dummy) {
+                pthread_attr_t attr;
+                ThreadData* td = new ThreadData (this, f, stacksize);
+
+                pthread_attr_init (&attr);
+                pthread_attr_setstacksize (&attr, stacksize);
+
+                int const r = pthread_create (&thread, &attr, _start_process_thread, td);
+
+                pthread_attr_destroy (&attr);
+
+                if (r) {
+                        delete td;
+                        return -1;
+                }
+
+                return thread;
+        }
+
+        GET_PRIVATE_JACK_POINTER_RET (_jack, 0);
         ThreadData* td = new ThreadData (this, f, stacksize);
 
         if (jack_client_create_thread (_priv_jack, &thread, jack_client_real_time_priority (_priv_jack), 
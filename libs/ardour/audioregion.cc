@@ -21,17 +21,23 @@
 #include <climits>
 #include <cfloat>
 #include <algorithm>
+#include <functional>
 
 #include <set>
 
 
 #include <glibmm/thread.h>
 
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+
 #include "pbd/basename.h"
 #include "pbd/xml++.h"
 #include "pbd/stacktrace.h"
 #include "pbd/enumwriter.h"
 #include "pbd/convert.h"
+#include "pbd/cpus.h"
+#include "pbd/transmitter.h"
 
 #include "evoral/Curve.hpp"
 
@@ -110,6 +116,11 @@ AudioRegion::register_properties ()
         , _fade_out_active (other->_fade_out_active) \
 	, _scale_amplitude (other->_scale_amplitude) 
 
+#define AUDIOREGION_GAIN_TABLE_DEFAULT \
+	_envelope_generation (0) \
+	, _fade_in_generation (0) \
+	, _fade_out_generation (0)
+
 /* a Session will reset these to its chosen defaults by calling AudioRegion::set_default_fade() */
 
 void
@@ -135,6 +146,7 @@ AudioRegion::AudioRegion (Session& s, framepos_t start, framecnt_t len, std::str
 	, _envelope (new AutomationList(Evoral::Parameter(EnvelopeAutomation)))
 	, _fade_in_suspended (0)
 	, _fade_out_suspended (0)
+	, AUDIOREGION_GAIN_TABLE_DEFAULT
 {
 	init ();
 	assert (_sources.size() == _master_sources.size());
@@ -150,6 +162,7 @@ AudioRegion::AudioRegion (const SourceList& srcs)
 	, _envelope (new AutomationList(Evoral::Parameter(EnvelopeAutomation)))
 	, _fade_in_suspended (0)
 	, _fade_out_suspended (0)
+	, AUDIOREGION_GAIN_TABLE_DEFAULT
 {
 	init ();
 	assert (_sources.size() == _master_sources.size());
@@ -165,6 +178,7 @@ AudioRegion::AudioRegion (boost::shared_ptr<const AudioRegion> other, nframes64_
 	, _envelope (new AutomationList (*other->_envelope, _start, _start + _length))
 	, _fade_in_suspended (0)
 	, _fade_out_suspended (0)
+	, AUDIOREGION_GAIN_TABLE_DEFAULT
 {
 	/* don't use init here, because we got fade in/out from the other region
 	*/
@@ -186,6 +200,7 @@ AudioRegion::AudioRegion (boost::shared_ptr<const AudioRegion> other, const Sour
 	, _envelope (new AutomationList (*other->_envelope))
 	, _fade_in_suspended (0)
 	, _fade_out_suspended (0)
+	, AUDIOREGION_GAIN_TABLE_DEFAULT
 {
 	/* make-a-sort-of-copy-with-different-sources constructor (used by audio filter) */
 
@@ -207,6 +222,7 @@ AudioRegion::AudioRegion (SourceList& srcs)
 	, _envelope (new AutomationList(Evoral::Parameter(EnvelopeAutomation)))
 	, _fade_in_suspended (0)
 	, _fade_out_suspended (0)
+	, AUDIOREGION_GAIN_TABLE_DEFAULT
 {
 	init ();
 
@@ -246,6 +262,9 @@ AudioRegion::post_set ()
 
 	/* If _length changed, adjust our gain envelope accordingly */
 	_envelope->truncate_end (_length);
+
+	/* the envelope or fades may have been (de)activated */
+	update_gain_tables ();
 }
 
 void
@@ -282,6 +301,16 @@ AudioRegion::listen_to_my_curves ()
 	_envelope->StateChanged.connect_same_thread (*this, boost::bind (&AudioRegion::envelope_changed, this));
 	_fade_in->StateChanged.connect_same_thread (*this, boost::bind (&AudioRegion::fade_in_changed, this));
 	_fade_out->StateChanged.connect_same_thread (*this, boost::bind (&AudioRegion::fade_out_changed, this));
+
+	/* Dirty is emitted for every edit, even inside a freeze, so the gain
+	   tables are never used after the curves have started to change.
+	*/
+
+	_envelope->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::curve_dirty, &_envelope_generation));
+	_fade_in->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::curve_dirty, &_fade_in_generation));
+	_fade_out->Dirty.connect_same_thread (*this, boost::bind (&AudioRegion::curve_dirty, &_fade_out_generation));
+
+	update_gain_tables ();
 }
 
 void
@@ -289,6 +318,7 @@ AudioRegion::set_envelope_active (bool yn)
 {
 	if (envelope_active() != yn) {
 		_envelope_active = yn;
+		rebuild_gain_table (_envelope_table, *_envelope, _envelope_generation, yn);
 		send_change (PropertyChange (Properties::envelope_active));
 	}
 }
@@ -409,112 +439,261 @@ AudioRegion::_read_at (const SourceList& /*srcs*/, framecnt_t limit,
 		memset (mixdown_buffer, 0, sizeof (Sample) * cnt);
 	}
 
-	if (rops & ReadOpsFades) {
+	/* Work out the gain to apply to each frame from the envelope, the fades
+	   and the scale amplitude, and then apply it all in one pass.
+	*/
 
-		/* fade in */
+	gain_t const scale = (rops & ReadOpsOwnScaling) ? _scale_amplitude.val() : 1.0f;
+	bool const envelope = (rops & ReadOpsOwnAutomation) && envelope_active();
+	bool const fades = (rops & ReadOpsFades) && _session.config.get_use_region_fades();
 
-		if (_fade_in_active && _session.config.get_use_region_fades()) {
+	/* see if this read is within the fade in */
 
-			nframes_t fade_in_length = (nframes_t) _fade_in->back()->when;
+	nframes_t fi_limit = 0;
 
-			/* see if this read is within the fade in */
+	if (fades && _fade_in_active) {
 
-			if (internal_offset < fade_in_length) {
+		nframes_t fade_in_length = (nframes_t) _fade_in->back()->when;
 
-				nframes_t fi_limit;
+		if (internal_offset < fade_in_length) {
+			fi_limit = min (to_read, fade_in_length - internal_offset);
+		}
+	}
 
-				fi_limit = min (to_read, fade_in_length - internal_offset);
+	/* see if some part of this read is within the fade out */
 
+	/* .................        >|            REGION
+	                             limit
 
-				_fade_in->curve().get_vector (internal_offset, internal_offset+fi_limit, gain_buffer, fi_limit);
+	                 {           }            FADE
+	                             fade_out_length
+	                 ^
+	                 limit - fade_out_length
+	        |--------------|
+	        ^internal_offset
+	                       ^internal_offset + to_read
 
-				for (nframes_t n = 0; n < fi_limit; ++n) {
-					mixdown_buffer[n] *= gain_buffer[n];
-				}
+	   we need the intersection of [internal_offset,internal_offset+to_read] with
+	   [limit - fade_out_length, limit]
+	*/
+
+	nframes_t fo_limit = 0;
+	nframes_t curve_offset = 0;
+	nframes_t fade_offset = 0;
+
+	if (fades && _fade_out_active) {
+
+		nframes_t fade_out_length = (nframes_t) _fade_out->back()->when;
+		nframes_t fade_interval_start = max(internal_offset, limit-fade_out_length);
+		nframes_t fade_interval_end   = min(internal_offset + to_read, limit);
+
+		if (fade_interval_end > fade_interval_start) {
+			/* (part of the) the fade out is  in this buffer */
+
+			fo_limit = fade_interval_end - fade_interval_start;
+			curve_offset = fade_interval_start - (limit-fade_out_length);
+			fade_offset = fade_interval_start - internal_offset;
+		}
+	}
+
+	if (envelope || fi_limit || fo_limit) {
+
+		/* use the gain tables if they are up to date, otherwise evaluate
+		   the curves directly.  Don't wait for the tables, as they may
+		   be being rebuilt and we are probably in a butler thread.
+		*/
+
+		Glib::Mutex::Lock lm (_gain_table_lock, Glib::TRY_LOCK);
+		bool const tables = lm.locked ();
+
+		if (!envelope) {
+			for (nframes_t n = 0; n < to_read; ++n) {
+				gain_buffer[n] = scale;
+			}
+		} else if (tables && gain_table_current (_envelope_table, _envelope_generation)) {
+			read_gain_table (_envelope_table, internal_offset, to_read, gain_buffer, scale, false);
+		} else {
+			read_gain_curve (*_envelope, internal_offset, to_read, gain_buffer, scale, false);
+		}
+
+		if (fi_limit) {
+			if (tables && gain_table_current (_fade_in_table, _fade_in_generation)) {
+				read_gain_table (_fade_in_table, internal_offset, fi_limit, gain_buffer, 1.0f, true);
+			} else {
+				read_gain_curve (*_fade_in, internal_offset, fi_limit, gain_buffer, 1.0f, true);
 			}
 		}
 
-		/* fade out */
+		if (fo_limit) {
+			if (tables && gain_table_current (_fade_out_table, _fade_out_generation)) {
+				read_gain_table (_fade_out_table, curve_offset, fo_limit, gain_buffer + fade_offset, 1.0f, true);
+			} else {
+				read_gain_curve (*_fade_out, curve_offset, fo_limit, gain_buffer + fade_offset, 1.0f, true);
+			}
+		}
 
-		if (_fade_out_active && _session.config.get_use_region_fades()) {
+		apply_gain_curve_to_buffer (mixdown_buffer, to_read, gain_buffer);
 
-			/* see if some part of this read is within the fade out */
+	} else if (scale != 1.0f) {
+		apply_gain_to_buffer (mixdown_buffer, to_read, scale);
+	}
 
-		/* .................        >|            REGION
-		                             limit
+	if (!opaque()) {
 
-                                 {           }            FADE
-				             fade_out_length
-                                 ^
-                                 limit - fade_out_length
-                        |--------------|
-                        ^internal_offset
-                                       ^internal_offset + to_read
+		/* gack. the things we do for users.
+		 */
 
-				       we need the intersection of [internal_offset,internal_offset+to_read] with
-				       [limit - fade_out_length, limit]
+		mix_buffers_no_gain (buf + buf_offset, mixdown_buffer, to_read);
+	}
 
-		*/
+	return to_read;
+}
 
+/* Fade and envelope curves are rendered with a point every gain_table_step
+   frames, or min_gain_table_points points if that is more (but never more
+   than one per frame), and interpolated linearly between them.  Only
+   active curves are rendered, and a curve that would need more than
+   max_gain_table_points (such as the envelope of a long region) is
+   evaluated on each read instead.
+*/
 
-			nframes_t fade_out_length = (nframes_t) _fade_out->back()->when;
-			nframes_t fade_interval_start = max(internal_offset, limit-fade_out_length);
-			nframes_t fade_interval_end   = min(internal_offset + to_read, limit);
+static const framecnt_t gain_table_step = 16;
+static const framecnt_t min_gain_table_points = 256;
+static const framecnt_t max_gain_table_points = 65536;
 
-			if (fade_interval_end > fade_interval_start) {
-				/* (part of the) the fade out is  in this buffer */
+/** Called when one of our curves has been edited */
+void
+AudioRegion::curve_dirty (gint* generation)
+{
+	g_atomic_int_inc (generation);
+}
 
-				nframes_t fo_limit = fade_interval_end - fade_interval_start;
-				nframes_t curve_offset = fade_interval_start - (limit-fade_out_length);
-				nframes_t fade_offset = fade_interval_start - internal_offset;
+/** Bring each gain table into line with its curve: render those of active
+ *  curves which are out of date, and free those of inactive ones.
+ */
+void
+AudioRegion::update_gain_tables ()
+{
+	rebuild_gain_table (_envelope_table, *_envelope, _envelope_generation, envelope_active());
+	rebuild_gain_table (_fade_in_table, *_fade_in, _fade_in_generation, _fade_in_active);
+	rebuild_gain_table (_fade_out_table, *_fade_out, _fade_out_generation, _fade_out_active);
+}
 
-				_fade_out->curve().get_vector (curve_offset, curve_offset+fo_limit, gain_buffer, fo_limit);
+/** Render a curve into its gain table, ready for _read_at().  Must be called
+ *  whenever the curve has finished changing, or has been (de)activated.
+ *  @param generation Counter which is bumped whenever the curve is edited.
+ *  @param active true if the curve is in use; if not, the table is freed.
+ */
+void
+AudioRegion::rebuild_gain_table (GainTable& table, AutomationList& curve, gint& generation, bool active)
+{
+	/* note the generation first, so that an edit made while we are
+	   rendering leaves the table out of date.
+	*/
 
-				for (nframes_t n = 0, m = fade_offset; n < fo_limit; ++n, ++m) {
-					mixdown_buffer[m] *= gain_buffer[n];
-				}
-			}
+	gint const current = g_atomic_int_get (&generation);
 
-		}
+	Glib::Mutex::Lock lm (_gain_table_lock);
+
+	if (active && gain_table_current (table, generation)) {
+		return;
 	}
 
-	/* Regular gain curves and scaling */
+	framecnt_t const length = curve.empty() ? 0 : (framecnt_t) curve.back()->when;
+	framecnt_t const segments = max (length / gain_table_step, min (length, min_gain_table_points));
 
-	if ((rops & ReadOpsOwnAutomation) && envelope_active())  {
-		_envelope->curve().get_vector (internal_offset, internal_offset + to_read, gain_buffer, to_read);
+	table.generation = current;
 
-		if ((rops & ReadOpsOwnScaling) && _scale_amplitude != 1.0f) {
-			for (nframes_t n = 0; n < to_read; ++n) {
-				mixdown_buffer[n] *= gain_buffer[n] * _scale_amplitude;
-			}
+	if (!active || length <= 0 || segments + 2 > max_gain_table_points) {
+		std::vector<gain_t>().swap (table.points);
+		table.length = 0;
+		return;
+	}
+
+	/* one more point than segments, and a copy of the last point so that
+	   interpolation never needs to check for the end of the table.
+	*/
+
+	table.points.resize (segments + 2);
+	curve.curve().get_vector (0, length, &table.points[0], segments + 1);
+	table.points[segments + 1] = table.points[segments];
+
+	table.length = length;
+	table.scale = segments / (double) length;
+}
+
+/** @return true if a gain table holds the current state of its curve.
+ *  Call with _gain_table_lock held.
+ */
+bool
+AudioRegion::gain_table_current (GainTable const & table, gint& generation)
+{
+	return table.length > 0 && table.generation == g_atomic_int_get (&generation);
+}
+
+/** Interpolate a gain table from a point in its curve.
+ *  @param offset Offset into the curve, in frames.
+ *  @param n Number of frames.
+ *  @param gains Gains to write.
+ *  @param gain Gain to apply to the curve.
+ *  @param multiply true to multiply gains by the curve, false to overwrite them.
+ */
+void
+AudioRegion::read_gain_table (GainTable const & table, framecnt_t offset, framecnt_t n, gain_t* gains, gain_t gain, bool multiply)
+{
+	gain_t const * p = &table.points[0];
+
+	/* past the end of the curve its last value holds, as in Curve::get_vector() */
+
+	framecnt_t const inside = max ((framecnt_t) 0, min (n, table.length - offset));
+
+	for (framecnt_t i = 0; i < inside; ++i) {
+		double const x = (offset + i) * table.scale;
+		framecnt_t const j = (framecnt_t) x;
+		gain_t const g = (p[j] + (p[j+1] - p[j]) * (gain_t) (x - j)) * gain;
+
+		if (multiply) {
+			gains[i] *= g;
 		} else {
-			for (nframes_t n = 0; n < to_read; ++n) {
-				mixdown_buffer[n] *= gain_buffer[n];
-			}
+			gains[i] = g;
 		}
-	} else if ((rops & ReadOpsOwnScaling) && _scale_amplitude != 1.0f) {
+	}
 
-		// XXX this should be using what in 2.0 would have been:
-		// Session::apply_gain_to_buffer (mixdown_buffer, to_read, _scale_amplitude);
+	gain_t const last = p[table.points.size() - 1] * gain;
 
-		for (nframes_t n = 0; n < to_read; ++n) {
-			mixdown_buffer[n] *= _scale_amplitude;
+	for (framecnt_t i = inside; i < n; ++i) {
+		if (multiply) {
+			gains[i] *= last;
+		} else {
+			gains[i] = last;
 		}
 	}
+}
 
-	if (!opaque()) {
+/** As read_gain_table(), but evaluating the curve itself */
+void
+AudioRegion::read_gain_curve (AutomationList& curve, framecnt_t offset, framecnt_t n, gain_t* gains, gain_t gain, bool multiply)
+{
+	gain_t chunk[256];
 
-		/* gack. the things we do for users.
-		 */
+	while (n) {
+
+		framecnt_t const this_time = min (n, (framecnt_t) (sizeof (chunk) / sizeof (chunk[0])));
 
-		buf += buf_offset;
+		curve.curve().get_vector (offset, offset + this_time, chunk, this_time);
 
-		for (nframes_t n = 0; n < to_read; ++n) {
-			buf[n] += mixdown_buffer[n];
+		for (framecnt_t i = 0; i < this_time; ++i) {
+			if (multiply) {
+				gains[i] *= chunk[i] * gain;
+			} else {
+				gains[i] = chunk[i] * gain;
+			}
 		}
-	}
 
-	return to_read;
+		offset += this_time;
+		gains += this_time;
+		n -= this_time;
+	}
 }
 
 XMLNode&
@@ -860,6 +1039,7 @@ AudioRegion::set_fade_in_active (bool yn)
 	}
 
 	_fade_in_active = yn;
+	rebuild_gain_table (_fade_in_table, *_fade_in, _fade_in_generation, yn);
 	send_change (PropertyChange (Properties::fade_in_active));
 }
 
@@ -870,6 +1050,7 @@ AudioRegion::set_fade_out_active (bool yn)
 		return;
 	}
 	_fade_out_active = yn;
+	rebuild_gain_table (_fade_out_table, *_fade_out, _fade_out_generation, yn);
 	send_change (PropertyChange (Properties::fade_out_active));
 }
 
@@ -1101,14 +1282,76 @@ AudioRegion::set_scale_amplitude (gain_t g)
 	send_change (PropertyChange (Properties::scale_amplitude));
 }
 
+namespace {
+
+/** State shared by the threads of run_per_channel() */
+struct ChannelWork {
+	ChannelWork (uint32_t c, boost::function<void (uint32_t)> w)
+		: channels (c)
+		, work (w)
+		, messages (c)
+		, next (0)
+	{}
+
+	uint32_t channels;
+	boost::function<void (uint32_t)> work;
+	std::vector<TransmitterMessages> messages; ///< anything said while working on each channel
+	gint next; ///< the next channel to be picked up by a thread
+};
+
+void
+channel_work (ChannelWork* cw)
+{
+	while (true) {
+
+		uint32_t const n = g_atomic_int_exchange_and_add (&cw->next, 1);
+
+		if (n >= cw->channels) {
+			break;
+		}
+
+		Transmitter::hold_messages (&cw->messages[n]);
+		cw->work (n);
+		Transmitter::hold_messages (0);
+	}
+}
+
+/** Call work for each of a number of channels, on as many threads as there
+ *  are processors (this one included), and return once it has been called for
+ *  them all.  Any messages are delivered on this thread, in channel order,
+ *  once all the work is done.
+ */
+void
+run_per_channel (uint32_t channels, boost::function<void (uint32_t)> work)
+{
+	ChannelWork cw (channels, work);
+	uint32_t const threads = min (channels, hardware_concurrency ());
+	vector<Glib::Thread*> workers;
+
+	for (uint32_t i = 1; i < threads; ++i) {
+		try {
+			workers.push_back (Glib::Thread::create (boost::bind (channel_work, &cw), true));
+		} catch (Glib::ThreadError& err) {
+			break;
+		}
+	}
+
+	channel_work (&cw);
+
+	for (vector<Glib::Thread*>::iterator i = workers.begin(); i != workers.end(); ++i) {
+		(*i)->join ();
+	}
+
+	for (uint32_t n = 0; n < channels; ++n) {
+		cw.messages[n].deliver ();
+	}
+}
+
+}
+
 void
 AudioRegion::normalize_to (float target_dB)
 {
-	const framecnt_t blocksize = 64 * 1024;
-	Sample buf[blocksize];
-	framepos_t fpos;
-	framepos_t fend;
-	framecnt_t to_read;
 	double maxamp = 0;
 	gain_t target = dB_to_coefficient (target_dB);
 
@@ -1119,30 +1362,18 @@ AudioRegion::normalize_to (float target_dB)
 		target -= FLT_EPSILON;
 	}
 
-	fpos = _start;
-	fend = _start + _length;
-
 	/* first pass: find max amplitude */
 
-	while (fpos < fend) {
-
-		uint32_t n;
-
-		to_read = min (fend - fpos, blocksize);
-
-		for (n = 0; n < n_channels(); ++n) {
+	vector<double> channel_maxamp (n_channels(), 0);
+	run_per_channel (n_channels(), boost::bind (&AudioRegion::find_channel_maximum_amplitude, this, _1, &channel_maxamp));
 
-			/* read it in */
-
-			if (read_raw_internal (buf, fpos, to_read, 0) != to_read) {
-				return;
-			}
-
-			maxamp = compute_peak (buf, to_read, maxamp);
+	for (vector<double>::const_iterator i = channel_maxamp.begin(); i != channel_maxamp.end(); ++i) {
+		if (*i < 0) {
+			/* a source could not be read */
+			return;
 		}
-
-		fpos += to_read;
-	};
+		maxamp = max (maxamp, *i);
+	}
 
 	if (maxamp == 0.0f) {
 		/* don't even try */
@@ -1174,18 +1405,24 @@ AudioRegion::normalize_to (float target_dB)
 void
 AudioRegion::fade_in_changed ()
 {
+	curve_dirty (&_fade_in_generation);
+	rebuild_gain_table (_fade_in_table, *_fade_in, _fade_in_generation, _fade_in_active);
 	send_change (PropertyChange (Properties::fade_in));
 }
 
 void
 AudioRegion::fade_out_changed ()
 {
+	curve_dirty (&_fade_out_generation);
+	rebuild_gain_table (_fade_out_table, *_fade_out, _fade_out_generation, _fade_out_active);
 	send_change (PropertyChange (Properties::fade_out));
 }
 
 void
 AudioRegion::envelope_changed ()
 {
+	curve_dirty (&_envelope_generation);
+	rebuild_gain_table (_envelope_table, *_envelope, _envelope_generation, envelope_active());
 	send_change (PropertyChange (Properties::envelope));
 }
 
@@ -1400,68 +1637,96 @@ regular basis, you should probably enable \"auto-analyse-audio\"\n\
  *
  *  @param threshold Threshold below which signal is considered silence (as a sample value)
  *  @param min_length Minimum length of silent period to be reported.
- *  @return Silent periods; first of pair is the offset within the region, second is the length of the period
+ *  @return Silent periods; first of pair is the offset within the region of the first silent frame,
+ *  second is the offset of the last.
  */
 
 std::list<std::pair<frameoffset_t, framecnt_t> >
 AudioRegion::find_silence (Sample threshold, framecnt_t min_length, InterThreadInfo& itt) const
 {
-	framecnt_t const block_size = 64 * 1024;
-	Sample loudest[block_size];
-	Sample buf[block_size];
+	vector<PeakScan::Periods> channel_silence (n_channels());
+	run_per_channel (n_channels(), boost::bind (&AudioRegion::find_channel_silence, this, _1, threshold, min_length, &itt, &channel_silence));
 
-	framepos_t pos = _start;
-	framepos_t const end = _start + _length - 1;
+	/* the region is silent where all of its channels are */
 
-	std::list<std::pair<frameoffset_t, framecnt_t> > silent_periods;
+	PeakScan::Periods silent_periods = PeakScan::intersect (channel_silence, min_length);
 
-	bool in_silence = false;
-	frameoffset_t silence_start = 0;
-	bool silence;
+        itt.done = true;
 
-	while (pos < end && !itt.cancel) {
+	return silent_periods;
+}
 
-		/* fill `loudest' with the loudest absolute sample at each instant, across all channels */
-		memset (loudest, 0, sizeof (Sample) * block_size);
-		for (uint32_t n = 0; n < n_channels(); ++n) {
+/** Get the absolute value of each of the peaks in one of our channels' peakfile
+ *  which overlap the region.  Element i is the peak of the source's frames from
+ *  (_start / frames_per_peak + i) * frames_per_peak; it is -1 where it is not
+ *  known, or where those frames are not all within the region.
+ */
+void
+AudioRegion::file_peaks (uint32_t channel, vector<Sample>& peaks) const
+{
+	framecnt_t const fpp = AudioSource::frames_per_peak ();
+	framepos_t const first = _start / fpp;
+	framepos_t const last = (_start + _length - 1) / fpp;
 
-			read_raw_internal (buf, pos, block_size, n);
-			for (framecnt_t i = 0; i < block_size; ++i) {
-				loudest[i] = max (loudest[i], abs (buf[i]));
-			}
-		}
+	peaks.assign (last - first + 1, -1);
 
-		/* now look for silence */
-		for (framecnt_t i = 0; i < block_size; ++i) {
-			silence = abs (loudest[i]) < threshold;
-			if (silence && !in_silence) {
-				/* non-silence to silence */
-				in_silence = true;
-				silence_start = pos + i;
-			} else if (!silence && in_silence) {
-				/* silence to non-silence */
-				in_silence = false;
-				if (pos + i - 1 - silence_start >= min_length) {
-					silent_periods.push_back (std::make_pair (silence_start, pos + i - 1));
-				}
-			}
-		}
+	boost::shared_ptr<AudioSource> src = audio_source (channel);
 
-		pos += block_size;
-                itt.progress = (end-pos)/(double)_length;
+	if (!src->peaks_built ()) {
+		return;
 	}
 
-	if (in_silence && end - 1 - silence_start >= min_length) {
-		/* last block was silent, so finish off the last period */
-		silent_periods.push_back (std::make_pair (silence_start, end));
+	/* peaks whose frames are all within the region */
+
+	framepos_t const inside_first = (_start + fpp - 1) / fpp;
+	framepos_t const inside_end = (_start + _length) / fpp;
+
+	framecnt_t const chunk = 4096;
+	vector<PeakData> data (chunk);
+
+	for (framepos_t p = inside_first; p < inside_end; p += chunk) {
+
+		framecnt_t const n = min (chunk, inside_end - p);
+
+		if (src->read_peaks (&data[0], n, p * fpp, n * fpp, fpp) != 0) {
+			peaks.assign (peaks.size(), -1);
+			return;
+		}
+
+		for (framecnt_t i = 0; i < n; ++i) {
+			peaks[p - first + i] = max (fabsf (data[i].min), fabsf (data[i].max));
+		}
 	}
+}
 
-        itt.done = true;
+/** Find the periods of at least min_length frames in which one of our channels
+ *  is silent, for find_silence().
+ *  @param periods Periods for each channel; this channel's are filled in.
+ */
+void
+AudioRegion::find_channel_silence (uint32_t channel, Sample threshold, framecnt_t min_length, InterThreadInfo* itt, vector<PeakScan::Periods>* periods) const
+{
+	vector<Sample> peaks;
+	file_peaks (channel, peaks);
 
-	return silent_periods;
+	PeakScan scan (peaks, AudioSource::frames_per_peak (), _start, _length, boost::bind (&AudioSource::read, audio_source (channel), _1, _2, _3, 0));
+	(*periods)[channel] = scan.find_silence (threshold, min_length, *itt, channel == 0);
 }
 
+/** Find the largest absolute sample value in one of our channels, for
+ *  normalize_to().
+ *  @param maxamp Value for each channel; this channel's is set, or set to -1
+ *  if the source cannot be read.
+ */
+void
+AudioRegion::find_channel_maximum_amplitude (uint32_t channel, vector<double>* maxamp) const
+{
+	vector<Sample> peaks;
+	file_peaks (channel, peaks);
 
+	PeakScan scan (peaks, AudioSource::frames_per_peak (), _start, _length, boost::bind (&AudioSource::read, audio_source (channel), _1, _2, _3, 0));
+	(*maxamp)[channel] = scan.maximum_amplitude ();
+}
 
 extern "C" {
 
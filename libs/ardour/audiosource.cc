@@ -178,6 +178,25 @@ AudioSource::peaks_ready (boost::function<void()> doThisWhenReady, ScopedConnect
 	return ret;
 }
 
+/** @return true if our peakfile is complete, so that read_peaks() will not
+ *  return partial data.
+ */
+bool
+AudioSource::peaks_built () const
+{
+	Glib::Mutex::Lock lm (_peaks_ready_lock);
+	return _peaks_built;
+}
+
+/** @return the number of frames summarised by each peak in a peakfile; peak n
+ *  covers frames n * frames_per_peak() up to (n + 1) * frames_per_peak().
+ */
+framecnt_t
+AudioSource::frames_per_peak ()
+{
+	return _FPP;
+}
+
 void
 AudioSource::touch_peakfile ()
 {
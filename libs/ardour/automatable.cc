@@ -269,6 +269,11 @@ Automatable::set_automation_state (const XMLNode& node, Evoral::Parameter legacy
 				newcontrol->set_list(al);
 			}
 
+			/* add_control() connected to the list the control had before; follow the new one */
+			al->automation_state_changed.connect_same_thread (
+				_control_connections, boost::bind (&Automatable::automation_state_changed, this, param)
+				);
+
 		} else {
 			error << "Expected AutomationList node, got '" << (*niter)->name() << endmsg;
 		}
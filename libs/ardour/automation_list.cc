@@ -431,6 +431,8 @@ AutomationList::set_state (const XMLNode& node, int version)
 		_style = Absolute;
 	}
 
+	AutoState const old_state = _state;
+
 	if ((prop = node.property (X_("state"))) != 0) {
 		_state = string_to_auto_state (prop->value());
 	} else {
@@ -461,6 +463,10 @@ AutomationList::set_state (const XMLNode& node, int version)
 		}
 	}
 
+	if (_state != old_state) {
+		automation_state_changed (); /* EMIT SIGNAL */
+	}
+
 	return 0;
 }
 
@@ -27,6 +27,8 @@ using namespace std;
 
 namespace ARDOUR {
 
+const uint32_t ChanMapping::unmapped;
+
 ChanMapping::ChanMapping(ChanCount identity)
 {
 	if (identity == ChanCount::INFINITE) {
@@ -40,59 +42,78 @@ ChanMapping::ChanMapping(ChanCount identity)
 	}
 }
 
-uint32_t
-ChanMapping::get(DataType t, uint32_t from)
-{
-	Mappings::iterator tm = _mappings.find(t);
-	assert(tm != _mappings.end());
-	TypeMapping::iterator m = tm->second.find(from);
-	assert(m != tm->second.end());
-	return m->second;
-}
-
+/** Map `from' to `to', unless `from' is already mapped */
 void
 ChanMapping::set(DataType t, uint32_t from, uint32_t to)
 {
 	assert(t != DataType::NIL);
-	Mappings::iterator tm = _mappings.find(t);
-	if (tm == _mappings.end()) {
-		tm = _mappings.insert(std::make_pair(t, TypeMapping())).first;
+	std::vector<uint32_t>& m (_map[t]);
+	if (from >= m.size()) {
+		m.resize(from + 1, unmapped);
+	}
+	if (m[from] == unmapped) {
+		m[from] = to;
 	}
-	tm->second.insert(std::make_pair(from, to));
 }
 
 /** Offset the 'from' field of every mapping for type @a t by @a delta */
 void
 ChanMapping::offset_from(DataType t, int32_t delta)
 {
-	Mappings::iterator tm = _mappings.find(t);
-	if (tm != _mappings.end()) {
-		TypeMapping new_map;
-		for (TypeMapping::iterator m = tm->second.begin(); m != tm->second.end(); ++m) {
-			new_map.insert(make_pair(m->first + delta, m->second));
+	std::vector<uint32_t> new_map;
+	const std::vector<uint32_t>& m (_map[t]);
+
+	for (uint32_t from = 0; from < m.size(); ++from) {
+		if (m[from] != unmapped) {
+			const uint32_t new_from = from + delta;
+			if (new_from >= new_map.size()) {
+				new_map.resize(new_from + 1, unmapped);
+			}
+			new_map[new_from] = m[from];
 		}
-		tm->second = new_map;
 	}
+
+	_map[t].swap(new_map);
 }
 
 /** Offset the 'to' field of every mapping for type @a t by @a delta */
 void
 ChanMapping::offset_to(DataType t, int32_t delta)
 {
-	Mappings::iterator tm = _mappings.find(t);
-	if (tm != _mappings.end()) {
-		for (TypeMapping::iterator m = tm->second.begin(); m != tm->second.end(); ++m) {
-			m->second += delta;
+	std::vector<uint32_t>& m (_map[t]);
+
+	for (std::vector<uint32_t>::iterator i = m.begin(); i != m.end(); ++i) {
+		if (*i != unmapped) {
+			*i += delta;
+		}
+	}
+}
+
+ChanMapping::Mappings
+ChanMapping::mappings() const
+{
+	Mappings mappings;
+
+	for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
+		const std::vector<uint32_t>& m (_map[*t]);
+		for (uint32_t from = 0; from < m.size(); ++from) {
+			if (m[from] != unmapped) {
+				mappings[*t].insert(std::make_pair(from, m[from]));
+			}
 		}
 	}
+
+	return mappings;
 }
 
 } // namespace ARDOUR
 
 std::ostream& operator<<(std::ostream& o, const ARDOUR::ChanMapping& cm)
 {
-	for (ARDOUR::ChanMapping::Mappings::const_iterator tm = cm.mappings().begin();
-			tm != cm.mappings().end(); ++tm) {
+	const ARDOUR::ChanMapping::Mappings mappings = cm.mappings();
+
+	for (ARDOUR::ChanMapping::Mappings::const_iterator tm = mappings.begin();
+			tm != mappings.end(); ++tm) {
 		o << tm->first.to_string() << endl;
 		for (ARDOUR::ChanMapping::TypeMapping::const_iterator i = tm->second.begin();
 				i != tm->second.end(); ++i) {
@@ -24,6 +24,7 @@
 
 #include "pbd/error.h"
 #include "ardour/coreaudiosource.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/utils.h"
 
 #include <appleutility/CAAudioFile.h>
@@ -190,14 +191,7 @@ CoreAudioSource::read_unlocked (Sample *dst, sframes_t start, nframes_t cnt) con
 
 	_read_data_count = cnt * sizeof(float);
 
-	Sample *ptr = interleave_buf + _channel;
-
-	/* stride through the interleaved data */
-
-	for (uint32_t n = 0; n < file_cnt; ++n) {
-		dst[n] = *ptr;
-		ptr += n_channels;
-	}
+	deinterleave (dst, interleave_buf, n_channels, _channel, file_cnt);
 
 	return cnt;
 }
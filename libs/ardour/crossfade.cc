@@ -22,6 +22,7 @@
 
 #include "ardour/debug.h"
 #include "ardour/types.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/crossfade.h"
 #include "ardour/crossfade_compare.h"
 #include "ardour/audioregion.h"
@@ -46,11 +47,18 @@ framecnt_t Crossfade::_short_xfade_length = 0;
 Sample* Crossfade::crossfade_buffer_out = 0;
 Sample* Crossfade::crossfade_buffer_in = 0;
 
+/* longer crossfades (about 6 seconds at 44.1kHz) have their curves rendered on each read */
+const framecnt_t Crossfade::max_fade_table_length = 262144;
 
 #define CROSSFADE_DEFAULT_PROPERTIES \
 	_active (Properties::active, _session.config.get_xfades_active ()) \
 	, _follow_overlap (Properties::follow_overlap, false)
 
+#define CROSSFADE_DEFAULT_FADE_TABLES \
+	_fade_table_length (0) \
+	, _fade_table_generation (0) \
+	, _fade_generation (0)
+
 
 namespace ARDOUR {
 	namespace Properties {
@@ -94,7 +102,7 @@ Crossfade::Crossfade (boost::shared_ptr<AudioRegion> in, boost::shared_ptr<Audio
 	, CROSSFADE_DEFAULT_PROPERTIES
 	, _fade_in (Evoral::Parameter(FadeInAutomation)) // linear (gain coefficient) => -inf..+6dB
 	, _fade_out (Evoral::Parameter(FadeOutAutomation)) // linear (gain coefficient) => -inf..+6dB
-
+	, CROSSFADE_DEFAULT_FADE_TABLES
 {
 	_in = in;
 	_out = out;
@@ -110,6 +118,7 @@ Crossfade::Crossfade (boost::shared_ptr<AudioRegion> a, boost::shared_ptr<AudioR
 	, CROSSFADE_DEFAULT_PROPERTIES
 	, _fade_in (Evoral::Parameter(FadeInAutomation)) // linear (gain coefficient) => -inf..+6dB
 	, _fade_out (Evoral::Parameter(FadeOutAutomation)) // linear (gain coefficient) => -inf..+6dB
+	, CROSSFADE_DEFAULT_FADE_TABLES
 {
 	_in_update = false;
 	_fixed = false;
@@ -129,7 +138,7 @@ Crossfade::Crossfade (const Playlist& playlist, XMLNode& node)
 	, CROSSFADE_DEFAULT_PROPERTIES
 	, _fade_in (Evoral::Parameter(FadeInAutomation)) // linear (gain coefficient) => -inf..+6dB
 	, _fade_out (Evoral::Parameter(FadeOutAutomation)) // linear (gain coefficient) => -inf..+6dB
-
+	, CROSSFADE_DEFAULT_FADE_TABLES
 {
 	boost::shared_ptr<Region> r;
 	XMLProperty* prop;
@@ -185,6 +194,7 @@ Crossfade::Crossfade (boost::shared_ptr<Crossfade> orig, boost::shared_ptr<Audio
 	, CROSSFADE_DEFAULT_PROPERTIES
 	, _fade_in (orig->_fade_in)
 	, _fade_out (orig->_fade_out)
+	, CROSSFADE_DEFAULT_FADE_TABLES
 {
 	_active           = orig->_active;
 	_in_update        = orig->_in_update;
@@ -198,6 +208,8 @@ Crossfade::Crossfade (boost::shared_ptr<Crossfade> orig, boost::shared_ptr<Audio
 	// copied from Crossfade::initialize()
 	_in_update = false;
 
+	connect_fades ();
+
 	_out->suspend_fade_out ();
 	_in->suspend_fade_in ();
 
@@ -216,6 +228,8 @@ Crossfade::~Crossfade ()
 void
 Crossfade::initialize ()
 {
+	connect_fades ();
+
 	/* merge source lists from regions */
 
 	_sources = _in->sources();
@@ -287,6 +301,67 @@ Crossfade::initialize ()
 	layer_relation = (int32_t) (_in->layer() - _out->layer());
 }
 
+void
+Crossfade::connect_fades ()
+{
+	/* our state includes the fade curves, so edits to them are changes to us */
+
+	_fade_in.StateChanged.connect_same_thread (*this, boost::bind (&Crossfade::fades_changed, this));
+	_fade_out.StateChanged.connect_same_thread (*this, boost::bind (&Crossfade::fades_changed, this));
+
+	/* Dirty is emitted for every edit, even inside a freeze, so the fade
+	   tables are never used after the curves have started to change.
+	*/
+
+	_fade_in.Dirty.connect_same_thread (*this, boost::bind (&Crossfade::fades_dirty, this));
+	_fade_out.Dirty.connect_same_thread (*this, boost::bind (&Crossfade::fades_dirty, this));
+}
+
+void
+Crossfade::fades_changed ()
+{
+	state_changed ();
+	rebuild_fade_tables ();
+}
+
+void
+Crossfade::fades_dirty ()
+{
+	g_atomic_int_inc (&_fade_generation);
+}
+
+/** Render the fade curves over the whole of the crossfade, ready for read_at().
+ *  Must be called whenever the curves have finished changing or _length has changed.
+ */
+void
+Crossfade::rebuild_fade_tables ()
+{
+	/* note the generation first, so that an edit made while we are
+	   rendering leaves the tables marked as out of date.
+	*/
+
+	gint const generation = g_atomic_int_get (&_fade_generation);
+	framecnt_t const length = _length;
+
+	Glib::Mutex::Lock lm (_fade_table_lock);
+
+	if (length <= 0 || length > max_fade_table_length) {
+		_fade_in_table.clear ();
+		_fade_out_table.clear ();
+		_fade_table_length = 0;
+		return;
+	}
+
+	_fade_in_table.resize (length);
+	_fade_out_table.resize (length);
+
+	_fade_in.curve().get_vector (0, length, &_fade_in_table[0], length);
+	_fade_out.curve().get_vector (0, length, &_fade_out_table[0], length);
+
+	_fade_table_length = length;
+	_fade_table_generation = generation;
+}
+
 framecnt_t
 Crossfade::read_raw_internal (Sample* buf, framecnt_t start, framecnt_t cnt, int channel) const
 {
@@ -350,11 +425,33 @@ Crossfade::read_at (Sample *buf, Sample *mixdown_buffer,
 	_out->read_at (crossfade_buffer_out, mixdown_buffer, gain_buffer, start, to_write, chan_n, read_frames, skip_frames);
 	_in->read_at (crossfade_buffer_in, mixdown_buffer, gain_buffer, start, to_write, chan_n, read_frames, skip_frames);
 
-	float* fiv = new float[to_write];
-	float* fov = new float[to_write];
+	/* use the prepared fade tables if they are up to date, otherwise
+	   render the part of the curves that we need into the mixdown and
+	   gain buffers, which the regions have finished with by now.  Never
+	   wait for the tables, as we are probably in the process thread.
+	*/
+
+	Glib::Mutex::Lock lm (_fade_table_lock, Glib::TRY_LOCK);
+
+	const gain_t* fiv;
+	const gain_t* fov;
 
-	_fade_in.curve().get_vector (offset, offset+to_write, fiv, to_write);
-	_fade_out.curve().get_vector (offset, offset+to_write, fov, to_write);
+	if (lm.locked()
+	    && _fade_table_length == _length
+	    && _fade_table_generation == g_atomic_int_get (&_fade_generation)
+	    && offset + to_write <= _fade_table_length) {
+
+		fiv = &_fade_in_table[offset];
+		fov = &_fade_out_table[offset];
+
+	} else {
+
+		_fade_in.curve().get_vector (offset, offset+to_write, gain_buffer, to_write);
+		_fade_out.curve().get_vector (offset, offset+to_write, mixdown_buffer, to_write);
+
+		fiv = gain_buffer;
+		fov = mixdown_buffer;
+	}
 
 	/* note: although we have not explicitly taken into account the return values
 	   from _out->read_at() or _in->read_at(), the length() function does this
@@ -362,12 +459,7 @@ Crossfade::read_at (Sample *buf, Sample *mixdown_buffer,
 	   position and length, and so we know precisely how much data they could return.
 	*/
 
-	for (framecnt_t n = 0; n < to_write; ++n) {
-		buf[n] = (crossfade_buffer_out[n] * fov[n]) + (crossfade_buffer_in[n] * fiv[n]);
-	}
-
-	delete [] fov;
-	delete [] fiv;
+	crossfade_buffers (buf, crossfade_buffer_out, fov, crossfade_buffer_in, fiv, to_write);
 
 	return to_write;
 }
@@ -500,6 +592,7 @@ Crossfade::update ()
 		_fade_in.x_scale (factor);
 
 		_length = newlen;
+		rebuild_fade_tables ();
 	}
 
 	switch (_anchor_point) {
@@ -924,6 +1017,7 @@ Crossfade::set_xfade_length (framecnt_t len)
 	_in_update = false;
 
 	_length = len;
+	rebuild_fade_tables ();
 
 	PropertyChanged (PropertyChange (Properties::length));
 	
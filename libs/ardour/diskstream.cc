@@ -36,7 +36,7 @@
 #include "pbd/basename.h"
 #include <glibmm/thread.h>
 #include "pbd/xml++.h"
-#include "pbd/memento_command.h"
+#include "pbd/delta_memento_command.h"
 
 #include "ardour/ardour.h"
 #include "ardour/audioengine.h"
@@ -458,7 +458,7 @@ Diskstream::playlist_ranges_moved (list< Evoral::RangeMove<framepos_t> > const &
 			boost::shared_ptr<AutomationList> pan_alist = p->streampanner(i).pan_control()->alist();
 			XMLNode & before = pan_alist->get_state ();
 			pan_alist->move_ranges (movements);
-			_session.add_command (new MementoCommand<AutomationList> (
+			_session.add_command (new DeltaMementoCommand<AutomationList> (
 						      *pan_alist.get(), &before, &pan_alist->get_state ()));
 		}
 	}
@@ -488,7 +488,7 @@ Diskstream::move_processor_automation (boost::weak_ptr<Processor> p, list< Evora
 		XMLNode & before = al->get_state ();
 		al->move_ranges (movements);
 		_session.add_command (
-			new MementoCommand<AutomationList> (
+			new DeltaMementoCommand<AutomationList> (
 				*al.get(), &before, &al->get_state ()
 				)
 			);
@@ -0,0 +1,299 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#endif
+
+#include <glibmm/timer.h>
+
+#include "pbd/compose.h"
+#include "pbd/error.h"
+#include "pbd/malign.h"
+#include "pbd/pthread_utils.h"
+
+#include "ardour/ardour.h"
+#include "ardour/dummy_backend.h"
+#include "ardour/noise.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+const char* const DummyBackend::physical_client_name = X_("system");
+
+DummyBackend::Parameters::Parameters ()
+	: sample_rate (48000)
+	, period_size (1024)
+	, n_audio_inputs (2)
+	, n_audio_outputs (2)
+	, n_midi_inputs (1)
+	, n_midi_outputs (1)
+	, realtime (true)
+	, noise_input (false)
+{
+}
+
+DummyBackend::DummyBackend (Parameters const & p, boost::function<void()> thread_init, boost::function<int(nframes_t)> process)
+	: _params (p)
+	, _thread_init (thread_init)
+	, _process (process)
+	, _thread (0)
+	, _running (false)
+	, _cycle_start_frame (0)
+	, _cycle_start_usecs (0)
+	, _dsp_load (0)
+	, _cycles (0)
+	, _overruns (0)
+{
+	if (_params.period_size == 0 || _params.period_size > max_period_size) {
+		_params.period_size = max_period_size;
+	}
+
+	g_atomic_int_set (&_should_stop, 0);
+	g_atomic_int_set (&_freewheeling, 0);
+}
+
+DummyBackend::~DummyBackend ()
+{
+	stop ();
+}
+
+int
+DummyBackend::start ()
+{
+	if (_running) {
+		return 0;
+	}
+
+	g_atomic_int_set (&_should_stop, 0);
+	_dsp_load = 0;
+	_cycles = 0;
+	_overruns = 0;
+
+	if (pthread_create_and_store ("dummy backend", &_thread, _driver_thread, this)) {
+		error << _("DummyBackend: could not create process thread") << endmsg;
+		return -1;
+	}
+
+	_running = true;
+	return 0;
+}
+
+int
+DummyBackend::stop ()
+{
+	if (!_running) {
+		return 0;
+	}
+
+	void* status;
+
+	g_atomic_int_set (&_should_stop, 1);
+	pthread_join (_thread, &status);
+
+	_thread = 0;
+	_running = false;
+	return 0;
+}
+
+/** Change the period size; the backend must not be running */
+int
+DummyBackend::set_period_size (nframes_t nframes)
+{
+	if (_running || nframes == 0 || nframes > max_period_size) {
+		return -1;
+	}
+
+	_params.period_size = nframes;
+	return 0;
+}
+
+/** While freewheeling, cycles are run back-to-back regardless of Parameters::realtime */
+void
+DummyBackend::set_freewheel (bool yn)
+{
+	g_atomic_int_set (&_freewheeling, yn ? 1 : 0);
+}
+
+/** @return microseconds from a monotonic clock; JACK's clock is not used,
+ *  as there may be no JACK at all.
+ */
+microseconds_t
+DummyBackend::microseconds ()
+{
+#ifdef __APPLE__
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0) {
+		mach_timebase_info (&timebase);
+	}
+	return (microseconds_t) ((mach_absolute_time () * timebase.numer / timebase.denom) / 1000);
+#else
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (microseconds_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+microseconds_t
+DummyBackend::period_usecs () const
+{
+	return ((microseconds_t) _params.period_size * 1000000) / _params.sample_rate;
+}
+
+nframes_t
+DummyBackend::frames_since_cycle_start () const
+{
+	if (!_running) {
+		return 0;
+	}
+
+	microseconds_t const elapsed = microseconds () - _cycle_start_usecs;
+	return (nframes_t) ((elapsed * _params.sample_rate) / 1000000);
+}
+
+nframes_t
+DummyBackend::frame_time () const
+{
+	return _cycle_start_frame + frames_since_cycle_start ();
+}
+
+uint32_t
+DummyBackend::n_physical (DataType type, bool input) const
+{
+	if (type == DataType::AUDIO) {
+		return input ? _params.n_audio_inputs : _params.n_audio_outputs;
+	} else if (type == DataType::MIDI) {
+		return input ? _params.n_midi_inputs : _params.n_midi_outputs;
+	}
+
+	return 0;
+}
+
+/** @param input true for a capture port, false for a playback port.
+ *  @return full name of the nth "physical" port, or an empty string.
+ */
+string
+DummyBackend::nth_physical (DataType type, bool input, uint32_t n) const
+{
+	if (n >= n_physical (type, input)) {
+		return string ();
+	}
+
+	if (type == DataType::MIDI) {
+		return string_compose (X_("%1:midi_%2_%3"), physical_client_name, (input ? X_("capture") : X_("playback")), n + 1);
+	}
+
+	return string_compose (X_("%1:%2_%3"), physical_client_name, (input ? X_("capture") : X_("playback")), n + 1);
+}
+
+/** @return a buffer, big enough for max_period_size frames, to stand in for a
+ *  JACK port buffer; 0 for types which do not need one.
+ */
+void*
+DummyBackend::allocate_port_buffer (DataType type, bool input) const
+{
+	if (type != DataType::AUDIO) {
+		return 0;
+	}
+
+	void* buf;
+
+	cache_aligned_malloc (&buf, max_period_size * sizeof (Sample));
+
+	Sample* s = (Sample*) buf;
+
+	if (input && _params.noise_input) {
+		/* about -60dBFS; enough to keep the DSP off any "silent" fast paths */
+		for (nframes_t n = 0; n < max_period_size; ++n) {
+			s[n] = (gdither_noise () - 0.5f) * 0.002f;
+		}
+	} else {
+		memset (s, 0, max_period_size * sizeof (Sample));
+	}
+
+	return buf;
+}
+
+void
+DummyBackend::release_port_buffer (void* buf) const
+{
+	free (buf);
+}
+
+void*
+DummyBackend::_driver_thread (void* arg)
+{
+	pthread_set_name (X_("dummy backend"));
+	static_cast<DummyBackend*> (arg)->driver_thread ();
+	return 0;
+}
+
+void
+DummyBackend::driver_thread ()
+{
+	_thread_init ();
+
+	nframes_t frames = 0;
+	microseconds_t deadline = microseconds ();
+
+	while (!g_atomic_int_get (&_should_stop)) {
+
+		nframes_t const nframes = _params.period_size;
+		microseconds_t const period = period_usecs ();
+
+		if (_params.realtime && !g_atomic_int_get (&_freewheeling)) {
+
+			microseconds_t const now = microseconds ();
+
+			if (now < deadline) {
+				Glib::usleep (deadline - now);
+			} else if (now - deadline > period) {
+				/* more than a period late; don't try to catch up */
+				deadline = now;
+			}
+		}
+
+		_cycle_start_frame = frames;
+		_cycle_start_usecs = microseconds ();
+
+		if (_process (nframes)) {
+			break;
+		}
+
+		microseconds_t const elapsed = microseconds () - _cycle_start_usecs;
+
+		if (elapsed > period) {
+			++_overruns;
+		}
+
+		/* smooth the load a little, much as JACK does */
+		_dsp_load += (((100.0f * elapsed) / period) - _dsp_load) * 0.1f;
+
+		++_cycles;
+		frames += nframes;
+		deadline += period;
+	}
+}
@@ -78,6 +78,7 @@ setup_enum_writer ()
 	SyncSource _SyncSource;
 	ShuttleBehaviour _ShuttleBehaviour;
 	ShuttleUnits _ShuttleUnits;
+	VarispeedInterpolation _VarispeedInterpolation;
 	Session::RecordState _Session_RecordState;
 	SessionEvent::Type _SessionEvent_Type;
 	TimecodeFormat _Session_TimecodeFormat;
@@ -293,6 +294,10 @@ setup_enum_writer ()
 	REGISTER_ENUM (Semitones);
 	REGISTER (_ShuttleUnits);
 
+	REGISTER_ENUM (CubicVarispeed);
+	REGISTER_ENUM (SincVarispeed);
+	REGISTER (_VarispeedInterpolation);
+
 	REGISTER_CLASS_ENUM (Session, Disabled);
 	REGISTER_CLASS_ENUM (Session, Enabled);
 	REGISTER_CLASS_ENUM (Session, Recording);
@@ -730,6 +735,19 @@ std::ostream& operator<<(std::ostream& o, const ShuttleUnits& var)
 	std::string s = enum_2_string (var);
 	return o << s;
 }
+std::istream& operator>>(std::istream& o, VarispeedInterpolation& var) 
+{ 
+	std::string s;
+	o >> s;
+	var = (VarispeedInterpolation) string_2_enum (s, var);
+	return o;
+}
+
+std::ostream& operator<<(std::ostream& o, const VarispeedInterpolation& var) 
+{ 
+	std::string s = enum_2_string (var);
+	return o << s;
+}
 std::istream& operator>>(std::istream& o, TimecodeFormat& var) 
 { 
 	std::string s;
@@ -108,6 +108,15 @@ find_peaks_t            ARDOUR::find_peaks = 0;
 apply_gain_to_buffer_t  ARDOUR::apply_gain_to_buffer = 0;
 mix_buffers_with_gain_t ARDOUR::mix_buffers_with_gain = 0;
 mix_buffers_no_gain_t   ARDOUR::mix_buffers_no_gain = 0;
+compute_meter_t         ARDOUR::compute_meter = 0;
+pan_buffers_t           ARDOUR::pan_buffers = 0;
+pan_equal_power_stereo_t ARDOUR::pan_equal_power_stereo = 0;
+apply_gain_curve_to_buffer_t ARDOUR::apply_gain_curve_to_buffer = 0;
+copy_buffer_with_gain_t ARDOUR::copy_buffer_with_gain = 0;
+interleave_t            ARDOUR::interleave = 0;
+deinterleave_t          ARDOUR::deinterleave = 0;
+scale_and_offset_buffer_t ARDOUR::scale_and_offset_buffer = 0;
+crossfade_buffers_t     ARDOUR::crossfade_buffers = 0;
 
 PBD::Signal1<void,std::string> ARDOUR::BootMessage;
 
@@ -248,9 +257,46 @@ setup_hardware_optimization (bool try_optimization)
 			apply_gain_to_buffer  = x86_sse_apply_gain_to_buffer;
 			mix_buffers_with_gain = x86_sse_mix_buffers_with_gain;
 			mix_buffers_no_gain   = x86_sse_mix_buffers_no_gain;
+			compute_meter         = x86_sse_compute_meter;
+			pan_buffers           = x86_sse_pan_buffers;
+			pan_equal_power_stereo = x86_sse_pan_equal_power_stereo;
+			apply_gain_curve_to_buffer = x86_sse_apply_gain_curve_to_buffer;
+			copy_buffer_with_gain = x86_sse_copy_buffer_with_gain;
+			interleave            = x86_sse_interleave;
+			deinterleave          = x86_sse_deinterleave;
+			scale_and_offset_buffer = x86_sse_scale_and_offset_buffer;
+			crossfade_buffers     = x86_sse_crossfade_buffers;
 
 			generic_mix_functions = false;
 
+			if (fpu.has_avx()) {
+
+				info << "Using AVX optimized routines" << endmsg;
+
+				// AVX SET
+				compute_peak          = x86_sse_avx_compute_peak;
+				find_peaks            = x86_sse_avx_find_peaks;
+				apply_gain_to_buffer  = x86_sse_avx_apply_gain_to_buffer;
+				mix_buffers_with_gain = x86_sse_avx_mix_buffers_with_gain;
+				mix_buffers_no_gain   = x86_sse_avx_mix_buffers_no_gain;
+				compute_meter         = x86_sse_avx_compute_meter;
+				pan_buffers           = x86_sse_avx_pan_buffers;
+				pan_equal_power_stereo = x86_sse_avx_pan_equal_power_stereo;
+				apply_gain_curve_to_buffer = x86_sse_avx_apply_gain_curve_to_buffer;
+				copy_buffer_with_gain = x86_sse_avx_copy_buffer_with_gain;
+				scale_and_offset_buffer = x86_sse_avx_scale_and_offset_buffer;
+				crossfade_buffers     = x86_sse_avx_crossfade_buffers;
+
+				if (fpu.has_fma()) {
+
+					info << "Using FMA optimized routines" << endmsg;
+
+					// FMA SET
+					mix_buffers_with_gain = x86_fma_mix_buffers_with_gain;
+					pan_buffers           = x86_fma_pan_buffers;
+					crossfade_buffers     = x86_fma_crossfade_buffers;
+				}
+			}
 		}
 
 #elif defined (__APPLE__) && defined (BUILD_VECLIB_OPTIMIZATIONS)
@@ -265,6 +311,15 @@ setup_hardware_optimization (bool try_optimization)
 			apply_gain_to_buffer   = veclib_apply_gain_to_buffer;
 			mix_buffers_with_gain  = veclib_mix_buffers_with_gain;
 			mix_buffers_no_gain    = veclib_mix_buffers_no_gain;
+			compute_meter          = veclib_compute_meter;
+			pan_buffers            = veclib_pan_buffers;
+			pan_equal_power_stereo = default_pan_equal_power_stereo;
+			apply_gain_curve_to_buffer = veclib_apply_gain_curve_to_buffer;
+			copy_buffer_with_gain  = veclib_copy_buffer_with_gain;
+			interleave             = veclib_interleave;
+			deinterleave           = veclib_deinterleave;
+			scale_and_offset_buffer = default_scale_and_offset_buffer;
+			crossfade_buffers      = veclib_crossfade_buffers;
 
 			generic_mix_functions = false;
 
@@ -284,6 +339,15 @@ setup_hardware_optimization (bool try_optimization)
 		apply_gain_to_buffer  = default_apply_gain_to_buffer;
 		mix_buffers_with_gain = default_mix_buffers_with_gain;
 		mix_buffers_no_gain   = default_mix_buffers_no_gain;
+		compute_meter         = default_compute_meter;
+		pan_buffers           = default_pan_buffers;
+		pan_equal_power_stereo = default_pan_equal_power_stereo;
+		apply_gain_curve_to_buffer = default_apply_gain_curve_to_buffer;
+		copy_buffer_with_gain = default_copy_buffer_with_gain;
+		interleave            = default_interleave;
+		deinterleave          = default_deinterleave;
+		scale_and_offset_buffer = default_scale_and_offset_buffer;
+		crossfade_buffers     = default_crossfade_buffers;
 
 		info << "No H/W specific optimizations in use" << endmsg;
 	}
@@ -348,7 +348,7 @@ Graph::run_one()
 
 static void get_rt()
 {
-        if (!jack_is_realtime (AudioEngine::instance()->jack())) {
+        if (!AudioEngine::instance()->is_realtime()) {
                 return;
         }
 
@@ -1,8 +1,15 @@
 #include <stdint.h>
 #include <cstdio>
+#include <algorithm>
+#include <pthread.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 #include "ardour/interpolation.h"
 
+using namespace std;
 using namespace ARDOUR;
 
 
@@ -134,3 +141,236 @@ CubicInterpolation::interpolate (int channel, nframes_t nframes, Sample *input,
 
     return i;
 }
+
+/* The sinc filter is tabulated at sinc_phases fractional positions between
+   input frames, and interpolated linearly between them.  There is one table
+   for each band of speeds: at speed s > 1 the output's Nyquist frequency is
+   1/s of the input's, so the filter must cut off there to avoid aliasing.
+   Each table is used for speeds up to its band's speed; the last band is
+   for the transport's maximum speed of 8.
+*/
+
+static const int sinc_taps = SincInterpolation::half_taps * 2;
+static const int sinc_phases = 256;
+static const int sinc_bands = 7;
+static const double sinc_band_speeds[sinc_bands] = { 1.0, 1.5, 2.0, 3.0, 4.0, 6.0, 8.0 };
+static const double sinc_kaiser_beta = 7.0;
+
+static float sinc_table[sinc_bands][sinc_phases + 1][sinc_taps];
+static pthread_once_t sinc_table_once = PTHREAD_ONCE_INIT;
+
+/** zeroth-order modified Bessel function of the first kind, for the Kaiser window */
+static double
+bessel_i0 (double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+
+	for (int k = 1; k < 32; ++k) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+
+	return sum;
+}
+
+static void
+make_sinc_table ()
+{
+	for (int b = 0; b < sinc_bands; ++b) {
+
+		double const cutoff = 1.0 / sinc_band_speeds[b];
+
+		for (int p = 0; p <= sinc_phases; ++p) {
+
+			double const frac = p / (double) sinc_phases;
+			double sum = 0.0;
+
+			/* tap t is for input frame i - (half_taps - 1) + t when the
+			   output is at i + frac.
+			*/
+
+			for (int t = 0; t < sinc_taps; ++t) {
+				double const x = t - (SincInterpolation::half_taps - 1) - frac;
+				double const w = x / SincInterpolation::half_taps;
+				double h;
+
+				if (fabs (w) >= 1.0) {
+					h = 0.0;
+				} else if (x == 0.0) {
+					h = cutoff;
+				} else if (cutoff == 1.0 && x == floor (x)) {
+					/* exactly zero, so that speed 1 passes the input through */
+					h = 0.0;
+				} else {
+					h = sin (M_PI * cutoff * x) / (M_PI * x);
+				}
+
+				h *= bessel_i0 (sinc_kaiser_beta * sqrt (max (0.0, 1.0 - w * w))) / bessel_i0 (sinc_kaiser_beta);
+
+				sinc_table[b][p][t] = h;
+				sum += h;
+			}
+
+			/* unity gain at DC */
+
+			for (int t = 0; t < sinc_taps; ++t) {
+				sinc_table[b][p][t] /= sum;
+			}
+		}
+	}
+}
+
+SincInterpolation::SincInterpolation ()
+{
+	pthread_once (&sinc_table_once, make_sinc_table);
+}
+
+void
+SincInterpolation::add_channel_to (int input_buffer_size, int output_buffer_size)
+{
+	Interpolation::add_channel_to (input_buffer_size, output_buffer_size);
+	_history.push_back (vector<Sample> (half_taps, 0.0f));
+	_edge.push_back (vector<Sample> (half_taps + sinc_taps, 0.0f));
+}
+
+void
+SincInterpolation::remove_channel_from ()
+{
+	Interpolation::remove_channel_from ();
+	_history.pop_back ();
+	_edge.pop_back ();
+}
+
+void
+SincInterpolation::reset ()
+{
+	Interpolation::reset ();
+
+	for (vector<vector<Sample> >::iterator i = _history.begin(); i != _history.end(); ++i) {
+		fill (i->begin(), i->end(), 0.0f);
+	}
+}
+
+nframes_t
+SincInterpolation::interpolate (uint32_t nchannels, nframes_t nframes, Sample* const * inputs, Sample* const * outputs)
+{
+	double const acceleration = _target_speed - _speed;
+	double const step = _speed + acceleration;
+	double distance = phase.empty() ? 0.0 : phase[0];
+
+	nchannels = min (nchannels, (uint32_t) _history.size());
+
+	if (nframes == 0 || nchannels == 0 || !inputs || !outputs) {
+		distance += step * nframes;
+		nframes_t const i = floor (distance);
+		if (!phase.empty()) {
+			phase[0] = distance - i;
+		}
+		return i;
+	}
+
+	int band = 0;
+	while (band < sinc_bands - 1 && fabs (step) > sinc_band_speeds[band]) {
+		++band;
+	}
+
+	/* windows which start before the first input frame read from the edge
+	   buffers: our history followed by as much of the input as they need.
+	*/
+
+	nframes_t const last = floor (distance + step * (nframes - 1));
+	nframes_t const edge_input = min ((nframes_t) sinc_taps, last + half_taps + 1);
+
+	for (uint32_t c = 0; c < nchannels; ++c) {
+		Sample* e = &_edge[c][0];
+		copy (_history[c].begin(), _history[c].end(), e);
+		copy (inputs[c], inputs[c] + edge_input, e + half_taps);
+	}
+
+	for (nframes_t outsample = 0; outsample < nframes; ++outsample) {
+
+		nframes_t const i = floor (distance);
+		double const fp = (distance - i) * sinc_phases;
+		int p = (int) fp;
+		float const frac = fp - p;
+
+		if (p >= sinc_phases) {
+			/* distance - i only reaches 1.0 by rounding */
+			p = sinc_phases - 1;
+		}
+
+		float const * a = sinc_table[band][p];
+		float const * b = sinc_table[band][p + 1];
+
+		/* first frame of the window, relative to the input */
+		int const start = (int) i - (half_taps - 1);
+
+#ifdef __SSE__
+		__m128 const f = _mm_set1_ps (frac);
+		__m128 k[sinc_taps / 4];
+
+		for (int t = 0; t < sinc_taps / 4; ++t) {
+			__m128 const ka = _mm_loadu_ps (a + 4 * t);
+			k[t] = _mm_add_ps (ka, _mm_mul_ps (f, _mm_sub_ps (_mm_loadu_ps (b + 4 * t), ka)));
+		}
+
+		for (uint32_t c = 0; c < nchannels; ++c) {
+			Sample const * in = (start < 0) ? &_edge[c][start + half_taps] : inputs[c] + start;
+			__m128 sum = _mm_mul_ps (k[0], _mm_loadu_ps (in));
+			for (int t = 1; t < sinc_taps / 4; ++t) {
+				sum = _mm_add_ps (sum, _mm_mul_ps (k[t], _mm_loadu_ps (in + 4 * t)));
+			}
+			sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+			sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 1));
+			_mm_store_ss (outputs[c] + outsample, sum);
+		}
+#else
+		float coefficients[sinc_taps];
+
+		for (int t = 0; t < sinc_taps; ++t) {
+			coefficients[t] = a[t] + frac * (b[t] - a[t]);
+		}
+
+		for (uint32_t c = 0; c < nchannels; ++c) {
+			Sample const * in = (start < 0) ? &_edge[c][start + half_taps] : inputs[c] + start;
+			float sum = 0.0f;
+			for (int t = 0; t < sinc_taps; ++t) {
+				sum += coefficients[t] * in[t];
+			}
+			outputs[c][outsample] = sum;
+		}
+#endif
+
+		distance += step;
+	}
+
+	nframes_t const consumed = floor (distance);
+	phase[0] = distance - consumed;
+
+	keep_history (nchannels, consumed, inputs);
+
+	return consumed;
+}
+
+void
+SincInterpolation::pass_through (uint32_t nchannels, nframes_t nframes, Sample* const * inputs)
+{
+	Interpolation::reset ();
+	keep_history (min (nchannels, (uint32_t) _history.size()), nframes, inputs);
+}
+
+/** Keep the half_taps frames before the new read position, some of which
+ *  may still be in the old history if we have moved less than that.
+ */
+void
+SincInterpolation::keep_history (uint32_t nchannels, nframes_t consumed, Sample* const * inputs)
+{
+	for (uint32_t c = 0; c < nchannels; ++c) {
+		vector<Sample>& h (_history[c]);
+		for (int k = 0; k < half_taps; ++k) {
+			int const n = (int) consumed - half_taps + k;
+			h[k] = (n < 0) ? h[n + half_taps] : inputs[c][n];
+		}
+	}
+}
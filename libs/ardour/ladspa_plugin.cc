@@ -563,7 +563,7 @@ LadspaPlugin::automatable () const
 
 int
 LadspaPlugin::connect_and_run (BufferSet& bufs,
-		ChanMapping in_map, ChanMapping out_map,
+		ChanMapping const & in_map, ChanMapping const & out_map,
 		nframes_t nframes, nframes_t offset)
 {
 	cycles_t now;
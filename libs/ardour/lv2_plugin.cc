@@ -486,7 +486,7 @@ LV2Plugin::automatable () const
 
 int
 LV2Plugin::connect_and_run (BufferSet& bufs,
-		ChanMapping in_map, ChanMapping out_map,
+		ChanMapping const & in_map, ChanMapping const & out_map,
 		nframes_t nframes, nframes_t offset)
 {
 	cycles_t then = get_cycles ();
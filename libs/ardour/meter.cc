@@ -33,6 +33,54 @@ using namespace ARDOUR;
 
 PBD::Signal0<void> Metering::Meter;
 
+/* float values shared between the process thread and the meter thread,
+   stored as their bit patterns so that they can be updated atomically
+*/
+
+union FloatBits {
+	gint  i;
+	float f;
+};
+
+/** Raise *p to v, if v is larger */
+static inline void
+atomic_float_max (gint* p, float v)
+{
+	FloatBits cur;
+	FloatBits nv;
+
+	nv.f = v;
+
+	do {
+		cur.i = g_atomic_int_get (p);
+		if (cur.f >= v) {
+			return;
+		}
+	} while (!g_atomic_int_compare_and_exchange (p, cur.i, nv.i));
+}
+
+/** @return *p, which is set to zero */
+static inline float
+atomic_float_take (gint* p)
+{
+	FloatBits cur;
+
+	do {
+		cur.i = g_atomic_int_get (p);
+	} while (!g_atomic_int_compare_and_exchange (p, cur.i, 0)); /* 0 is also the bit pattern of 0.0f */
+
+	return cur.f;
+}
+
+PeakMeter::Level::Level ()
+	: peak (0)
+	, mean_square (0)
+	, visible_peak (minus_infinity())
+	, max_peak (minus_infinity())
+	, rms (minus_infinity())
+{
+}
+
 /** Get peaks from @a bufs
  * Input acceptance is lenient - the first n buffers from @a bufs will
  * be metered, where n was set by the last call to setup(), excess meters will
@@ -45,8 +93,8 @@ PeakMeter::run (BufferSet& bufs, sframes_t /*start_frame*/, sframes_t /*end_fram
 		return;
 	}
 
-	const uint32_t n_audio = min(_configured_input.n_audio(), bufs.count().n_audio());
-	const uint32_t n_midi  = min(_configured_input.n_midi(), bufs.count().n_midi());
+	const uint32_t n_midi  = min (min(_configured_input.n_midi(), bufs.count().n_midi()), (uint32_t) _levels.size());
+	const uint32_t n_audio = min (min(_configured_input.n_audio(), bufs.count().n_audio()), (uint32_t) _levels.size() - n_midi);
 
 	uint32_t n = 0;
 
@@ -67,17 +115,32 @@ PeakMeter::run (BufferSet& bufs, sframes_t /*start_frame*/, sframes_t /*end_fram
 				}
 			}
 		}
-		_peak_power[n] = max (val, _peak_power[n]);
+		atomic_float_max (&_levels[n].peak, val);
 	}
 
-	// Meter audio in to the rest of the peaks
-	for (uint32_t i = 0; i < n_audio; ++i, ++n) {
-		_peak_power[n] = compute_peak (bufs.get_audio(i).data(), nframes, _peak_power[n]);
+	// Meter audio in to the rest of the peaks, all channels in one call
+
+	if (n_audio) {
+
+		for (uint32_t i = 0; i < n_audio; ++i) {
+			_buffers[i] = bufs.get_audio(i).data();
+			_peaks[i] = 0.0f;
+			_powers[i] = 0.0f;
+		}
+
+		compute_meter (&_buffers[0], n_audio, nframes, &_peaks[0], (_rms ? &_powers[0] : 0));
+
+		for (uint32_t i = 0; i < n_audio; ++i, ++n) {
+			atomic_float_max (&_levels[n].peak, _peaks[i]);
+			if (_rms && nframes) {
+				atomic_float_max (&_levels[n].mean_square, _powers[i] / nframes);
+			}
+		}
 	}
 
 	// Zero any excess peaks
-	for (uint32_t i = n; i < _peak_power.size(); ++i) {
-		_peak_power[i] = 0.0f;
+	for (uint32_t i = n; i < _levels.size(); ++i) {
+		g_atomic_int_set (&_levels[i].peak, 0);
 	}
 
 	_active = _pending_active;
@@ -86,16 +149,32 @@ PeakMeter::run (BufferSet& bufs, sframes_t /*start_frame*/, sframes_t /*end_fram
 void
 PeakMeter::reset ()
 {
-	for (size_t i = 0; i < _peak_power.size(); ++i) {
-		_peak_power[i] = 0.0f;
+	for (size_t i = 0; i < _levels.size(); ++i) {
+		g_atomic_int_set (&_levels[i].peak, 0);
+		g_atomic_int_set (&_levels[i].mean_square, 0);
 	}
 }
 
 void
 PeakMeter::reset_max ()
 {
-	for (size_t i = 0; i < _max_peak_power.size(); ++i) {
-		_max_peak_power[i] = -INFINITY;
+	for (size_t i = 0; i < _levels.size(); ++i) {
+		_levels[i].max_peak = -INFINITY;
+	}
+}
+
+void
+PeakMeter::set_rms (bool yn)
+{
+	if (yn == _rms) {
+		return;
+	}
+
+	_rms = yn;
+
+	for (size_t i = 0; i < _levels.size(); ++i) {
+		g_atomic_int_set (&_levels[i].mean_square, 0);
+		_levels[i].rms = minus_infinity();
 	}
 }
 
@@ -131,21 +210,12 @@ PeakMeter::reset_max_channels (const ChanCount& chn)
 {
 	uint32_t limit = chn.n_total();
 
-	while (_peak_power.size() > limit) {
-		_peak_power.pop_back();
-		_visible_peak_power.pop_back();
-		_max_peak_power.pop_back();
-	}
-
-	while (_peak_power.size() < limit) {
-		_peak_power.push_back(0);
-		_visible_peak_power.push_back(minus_infinity());
-		_max_peak_power.push_back(minus_infinity());
-	}
+	_levels.resize (limit);
+	_buffers.resize (limit);
+	_peaks.resize (limit);
+	_powers.resize (limit);
 
-	assert(_peak_power.size() == limit);
-	assert(_visible_peak_power.size() == limit);
-	assert(_max_peak_power.size() == limit);
+	assert(_levels.size() == limit);
 }
 
 /** To be driven by the Meter signal from IO.
@@ -160,16 +230,16 @@ PeakMeter::meter ()
 		return;
 	}
 
-	assert(_visible_peak_power.size() == _peak_power.size());
-
-	const size_t limit = min (_peak_power.size(), (size_t) current_meters.n_total ());
+	const size_t limit = min (_levels.size(), (size_t) current_meters.n_total ());
+	const float falloff = Config->get_meter_falloff();
 
 	for (size_t n = 0; n < limit; ++n) {
 
+		Level& l (_levels[n]);
+
 		/* grab peak since last read */
 
-		float new_peak = _peak_power[n]; /* XXX we should use atomic exchange from here ... */
-		_peak_power[n] = 0;              /* ... to here */
+		float new_peak = atomic_float_take (&l.peak);
 
 		/* compute new visible value using falloff */
 
@@ -181,14 +251,19 @@ PeakMeter::meter ()
 
 		/* update max peak */
 
-		_max_peak_power[n] = std::max (new_peak, _max_peak_power[n]);
+		l.max_peak = std::max (new_peak, l.max_peak);
 
-		if (Config->get_meter_falloff() == 0.0f || new_peak > _visible_peak_power[n]) {
-			_visible_peak_power[n] = new_peak;
+		if (falloff == 0.0f || new_peak > l.visible_peak) {
+			l.visible_peak = new_peak;
 		} else {
 			// do falloff
-			new_peak = _visible_peak_power[n] - (Config->get_meter_falloff() * 0.01f);
-			_visible_peak_power[n] = std::max (new_peak, -INFINITY);
+			new_peak = l.visible_peak - (falloff * 0.01f);
+			l.visible_peak = std::max (new_peak, -INFINITY);
+		}
+
+		if (_rms) {
+			const float ms = atomic_float_take (&l.mean_square);
+			l.rms = (ms > 0.0f) ? fast_coefficient_to_dB (sqrtf (ms)) : minus_infinity();
 		}
 	}
 }
@@ -0,0 +1,208 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <algorithm>
+
+#include "pbd/fastlog.h"
+
+#include "ardour/meter.h"
+#include "ardour/meter_snapshot.h"
+#include "ardour/route.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+MeterSnapshot::MeterSnapshot ()
+	: _layout (new Layout)
+{
+}
+
+/** @return true if the routes, or the number of channels that any of them
+ *  meter, have changed since l was built.
+ */
+bool
+MeterSnapshot::layout_stale (Layout const & l, boost::shared_ptr<RouteList> routes) const
+{
+	if (l.routes.lock() != routes) {
+		return true;
+	}
+
+	vector<uint32_t>::const_iterator c = l.channels.begin();
+
+	for (RouteList::const_iterator i = routes->begin(); i != routes->end(); ++i, ++c) {
+		if ((*i)->peak_meter().input_streams().n_total() != *c) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+MeterSnapshot::rebuild (boost::shared_ptr<RouteList> routes)
+{
+	RCUWriter<Layout> writer (_layout);
+	boost::shared_ptr<Layout> l = writer.get_copy ();
+
+	l->routes = routes;
+	l->order.clear ();
+	l->channels.clear ();
+	l->slots.clear ();
+
+	uint32_t offset = 0;
+
+	for (RouteList::const_iterator i = routes->begin(); i != routes->end(); ++i) {
+		uint32_t const n = (*i)->peak_meter().input_streams().n_total();
+		l->order.push_back (*i);
+		l->channels.push_back (n);
+		l->slots[i->get()] = Slot (offset, n);
+		offset += n;
+	}
+
+	/* these are never resized once published, so readers can use
+	   them without a lock.
+	*/
+
+	for (int b = 0; b < 2; ++b) {
+		l->buffer[b].assign (offset * 2, minus_infinity ());
+	}
+}
+
+/** Copy the current levels of all routes' meters.  Must only be called by
+ *  the metering thread.
+ */
+void
+MeterSnapshot::update (boost::shared_ptr<RouteList> routes)
+{
+	if (layout_stale (*_layout.reader(), routes)) {
+		rebuild (routes);
+	}
+
+	boost::shared_ptr<Layout> l = _layout.reader ();
+
+	if (l->buffer[0].empty()) {
+		return;
+	}
+
+	/* fill the buffer that readers are not using, then publish it */
+
+	gint const g = g_atomic_int_get (&l->generation);
+	float* dst = &l->buffer[(g + 1) & 1][0];
+
+	vector<uint32_t>::const_iterator c = l->channels.begin();
+
+	for (vector<boost::weak_ptr<Route> >::const_iterator i = l->order.begin(); i != l->order.end(); ++i, ++c) {
+
+		boost::shared_ptr<Route> r = i->lock ();
+
+		if (!r) {
+			for (uint32_t n = 0; n < *c; ++n) {
+				*dst++ = minus_infinity ();
+				*dst++ = minus_infinity ();
+			}
+			continue;
+		}
+
+		PeakMeter& meter (r->peak_meter ());
+
+		for (uint32_t n = 0; n < *c; ++n) {
+			*dst++ = meter.peak_power (n);
+			*dst++ = meter.max_peak_power (n);
+		}
+	}
+
+	g_atomic_int_inc (&l->generation);
+}
+
+uint32_t
+MeterSnapshot::read (boost::shared_ptr<Route const> route, float* peaks, float* max_peaks, uint32_t n) const
+{
+	boost::shared_ptr<Layout> l = _layout.reader ();
+	boost::unordered_map<Route const *, Slot>::const_iterator s = l->slots.find (route.get());
+
+	if (s == l->slots.end()) {
+		return 0;
+	}
+
+	if (s->second.channels == 0) {
+		return 0;
+	}
+
+	n = min (n, s->second.channels);
+
+	while (true) {
+
+		gint const g = g_atomic_int_get (&l->generation);
+		float const * src = &l->buffer[g & 1][s->second.offset * 2];
+
+		for (uint32_t c = 0; c < n; ++c) {
+			if (peaks) {
+				peaks[c] = src[c * 2];
+			}
+			if (max_peaks) {
+				max_peaks[c] = src[c * 2 + 1];
+			}
+		}
+
+		/* if update() published while we were copying, it may since
+		   have started to overwrite the buffer we were reading; go again.
+		*/
+
+		if (g_atomic_int_get (&l->generation) == g) {
+			break;
+		}
+	}
+
+	return s->second.channels;
+}
+
+float
+MeterSnapshot::level (boost::shared_ptr<Route const> route, uint32_t chn, uint32_t which) const
+{
+	boost::shared_ptr<Layout> l = _layout.reader ();
+	boost::unordered_map<Route const *, Slot>::const_iterator s = l->slots.find (route.get());
+
+	if (s == l->slots.end() || chn >= s->second.channels) {
+		return minus_infinity ();
+	}
+
+	uint32_t const index = (s->second.offset + chn) * 2 + which;
+
+	/* a single float can't be torn, so there is no need to check the generation */
+
+	return l->buffer[g_atomic_int_get (&l->generation) & 1][index];
+}
+
+float
+MeterSnapshot::peak_power (boost::shared_ptr<Route const> route, uint32_t chn) const
+{
+	return level (route, chn, 0);
+}
+
+float
+MeterSnapshot::max_peak_power (boost::shared_ptr<Route const> route, uint32_t chn) const
+{
+	return level (route, chn, 1);
+}
+
+uint32_t
+MeterSnapshot::generation () const
+{
+	return g_atomic_int_get (&_layout.reader()->generation);
+}
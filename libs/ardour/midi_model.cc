@@ -19,11 +19,15 @@
 */
 
 #define __STDC_LIMIT_MACROS 1
+#include <cstring>
 #include <set>
+#include <vector>
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
 #include <stdint.h>
+#include <glib.h>
+#include <boost/bind.hpp>
 #include "pbd/error.h"
 #include "pbd/enumwriter.h"
 #include "midi++/events.h"
@@ -89,6 +93,7 @@ MidiModel::apply_command_as_subcommand(Session& session, Command* cmd)
 
 #define DIFF_COMMAND_ELEMENT "DiffCommand"
 #define DIFF_NOTES_ELEMENT "ChangedNotes"
+#define PACKED_DIFF_NOTES_ELEMENT "PackedChangedNotes"
 #define ADDED_NOTES_ELEMENT "AddedNotes"
 #define REMOVED_NOTES_ELEMENT "RemovedNotes"
 #define SIDE_EFFECT_REMOVALS_ELEMENT "SideEffectRemovals"
@@ -244,57 +249,16 @@ MidiModel::DiffCommand::operator()()
                         _model->remove_note_unlocked(*i);
                 }
 
-                /* notes we modify in a way that requires remove-then-add to maintain ordering */
+                /* notes we modify in a way that changes their place in the model; the
+                   model moves them all at once, which is much quicker than removing and
+                   adding each one when many notes are quantized or transposed.
+                */
                 set<NotePtr> temporary_removals;
+                find_reordered_notes (temporary_removals);
 
-                for (ChangeList::iterator i = _changes.begin(); i != _changes.end(); ++i) {
-                        Property prop = i->property;
-                        switch (prop) {
-                        case NoteNumber:
-                                if (temporary_removals.find (i->note) == temporary_removals.end()) {
-                                        _model->remove_note_unlocked (i->note);
-                                        temporary_removals.insert (i->note);
-                                }
-                                i->note->set_note (i->new_value);
-                                break;
-
-                        case StartTime:
-                                if (temporary_removals.find (i->note) == temporary_removals.end()) {
-                                        _model->remove_note_unlocked (i->note);
-                                        temporary_removals.insert (i->note);
-
-                                }
-                                i->note->set_time (i->new_time);
-                                break;
-
-                        case Channel:
-                                if (temporary_removals.find (i->note) == temporary_removals.end()) {
-                                        _model->remove_note_unlocked (i->note);
-                                        temporary_removals.insert (i->note);
-                                }
-                                i->note->set_channel (i->new_value);
-                                break;
-
-                                /* no remove-then-add required for these properties, since we do not index them
-                                 */
-
-                        case Velocity:
-                                i->note->set_velocity (i->new_value);
-                                break;
-
-                        case Length:
-                                i->note->set_length (i->new_time);
-                                break;
-
-                        }
-                }
-
-
-                for (set<NotePtr>::iterator i = temporary_removals.begin(); i != temporary_removals.end(); ++i) {
-                        DiffCommand side_effects (model(), "side effects");
-                        _model->add_note_unlocked (*i, &side_effects);
-                        *this += side_effects;
-                }
+                DiffCommand side_effects (model(), "side effects");
+                _model->edit_notes_unlocked (temporary_removals, boost::bind (&DiffCommand::apply_changes, this, false), &side_effects);
+                *this += side_effects;
 
                 if (!side_effect_removals.empty()) {
                         cerr << "SER: \n";
@@ -321,45 +285,11 @@ MidiModel::DiffCommand::undo()
                         _model->add_note_unlocked(*i);
                 }
 
-                /* notes we modify in a way that requires remove-then-add to maintain ordering */
+                /* notes we modify in a way that changes their place in the model */
                 set<NotePtr> temporary_removals;
+                find_reordered_notes (temporary_removals);
 
-                for (ChangeList::iterator i = _changes.begin(); i != _changes.end(); ++i) {
-                        Property prop = i->property;
-                        switch (prop) {
-                        case NoteNumber:
-                                if (temporary_removals.find (i->note) == temporary_removals.end()) {
-                                        _model->remove_note_unlocked (i->note);
-                                        temporary_removals.insert (i->note);
-                                }
-                                i->note->set_note (i->old_value);
-                                break;
-                        case Velocity:
-                                i->note->set_velocity (i->old_value);
-                                break;
-                        case StartTime:
-                                if (temporary_removals.find (i->note) == temporary_removals.end()) {
-                                        _model->remove_note_unlocked (i->note);
-                                        temporary_removals.insert (i->note);
-                                }
-                                i->note->set_time (i->old_time);
-                                break;
-                        case Length:
-                                i->note->set_length (i->old_time);
-                                break;
-                        case Channel:
-                                if (temporary_removals.find (i->note) == temporary_removals.end()) {
-                                        _model->remove_note_unlocked (i->note);
-                                        temporary_removals.insert (i->note);
-                                }
-                                i->note->set_channel (i->old_value);
-                                break;
-                        }
-                }
-
-                for (set<NotePtr>::iterator i = temporary_removals.begin(); i != temporary_removals.end(); ++i) {
-                        _model->add_note_unlocked (*i);
-                }
+                _model->edit_notes_unlocked (temporary_removals, boost::bind (&DiffCommand::apply_changes, this, true));
 
                 /* finally add back notes that were removed by the "do". we don't care
                    about side effects here since the model should be back to its original
@@ -374,13 +304,56 @@ MidiModel::DiffCommand::undo()
         _model->ContentsChanged(); /* EMIT SIGNAL */
 }
 
+/** Find the notes whose changes alter their place in the model, which are
+ *  those whose note number, start time or channel is changed.
+ */
+void
+MidiModel::DiffCommand::find_reordered_notes (set<NotePtr>& notes) const
+{
+        for (ChangeList::const_iterator i = _changes.begin(); i != _changes.end(); ++i) {
+                switch (i->property) {
+                case NoteNumber:
+                case StartTime:
+                case Channel:
+                        notes.insert (i->note);
+                        break;
+                case Velocity:
+                case Length:
+                        break;
+                }
+        }
+}
+
+/** Set each changed property to its new value, or to its old one if \a undo is true */
+void
+MidiModel::DiffCommand::apply_changes (bool undo)
+{
+        for (ChangeList::iterator i = _changes.begin(); i != _changes.end(); ++i) {
+                switch (i->property) {
+                case NoteNumber:
+                        i->note->set_note (undo ? i->old_value : i->new_value);
+                        break;
+                case Velocity:
+                        i->note->set_velocity (undo ? i->old_value : i->new_value);
+                        break;
+                case StartTime:
+                        i->note->set_time (undo ? i->old_time : i->new_time);
+                        break;
+                case Length:
+                        i->note->set_length (undo ? i->old_time : i->new_time);
+                        break;
+                case Channel:
+                        i->note->set_channel (undo ? i->old_value : i->new_value);
+                        break;
+                }
+        }
+}
+
 XMLNode&
 MidiModel::DiffCommand::marshal_note(const NotePtr note)
 {
         XMLNode* xml_note = new XMLNode("note");
 
-        cerr << "Marshalling note: " << *note << endl;
-
         ostringstream note_str(ios::ate);
         note_str << int(note->note());
         xml_note->add_property("note", note_str.str());
@@ -459,203 +432,330 @@ MidiModel::DiffCommand::unmarshal_note(XMLNode *xml_note)
         return note_ptr;
 }
 
-XMLNode&
-MidiModel::DiffCommand::marshal_change(const NoteChange& change)
+/** Read a change in the form that older sessions saved it, as an XML node */
+MidiModel::DiffCommand::SavedChange
+MidiModel::DiffCommand::read_change (const XMLNode& xml_change)
 {
-        XMLNode* xml_change = new XMLNode("change");
-
-        /* first, the change itself */
-
-        xml_change->add_property ("property", enum_2_string (change.property));
+        const XMLProperty* prop;
+        SavedChange change;
+        unsigned int note;
+        unsigned int channel;
+        unsigned int velocity;
 
-        {
-                ostringstream old_value_str (ios::ate);
-                if (change.property == StartTime || change.property == Length) {
-                        old_value_str << change.old_time;
-                } else {
-                        old_value_str << (unsigned int) change.old_value;
-                }
-                xml_change->add_property ("old", old_value_str.str());
+        if ((prop = xml_change.property("property")) != 0) {
+                change.property = (Property) string_2_enum (prop->value(), change.property);
+        } else {
+                fatal << "!!!" << endmsg;
+                /*NOTREACHED*/
         }
 
-        {
-                ostringstream new_value_str (ios::ate);
-                if (change.property == StartTime || change.property == Length) {
-                        new_value_str << change.new_time;
-                } else {
-                        new_value_str << (unsigned int) change.new_value;
-                }
-                xml_change->add_property ("new", new_value_str.str());
+        if ((prop = xml_change.property ("old")) != 0) {
+                istringstream old_str (prop->value());
+                old_str >> change.old_value;
+        } else {
+                fatal << "!!!" << endmsg;
+                /*NOTREACHED*/
         }
 
-        /* now the rest of the note */
+        if ((prop = xml_change.property ("new")) != 0) {
+                istringstream new_str (prop->value());
+                new_str >> change.new_value;
+        } else {
+                fatal << "!!!" << endmsg;
+                /*NOTREACHED*/
+        }
 
-        const SMFSource* smf = dynamic_cast<const SMFSource*> (_model->midi_source());
+        /* the changed property need not be given for the note */
 
-        if (change.property != NoteNumber) {
-                ostringstream note_str;
-                note_str << int(change.note->note());
-                xml_change->add_property("note", note_str.str());
+        if ((prop = xml_change.property("note")) != 0) {
+                istringstream note_str(prop->value());
+                note_str >> note;
+        } else {
+                if (change.property != NoteNumber) {
+                        warning << "note information missing note value" << endmsg;
+                }
+                note = 127;
         }
 
-        if (change.property != Channel) {
-                ostringstream channel_str;
-                channel_str << int(change.note->channel());
-                xml_change->add_property("channel", channel_str.str());
+        if ((prop = xml_change.property("channel")) != 0) {
+                istringstream channel_str(prop->value());
+                channel_str >> channel;
+        } else {
+                if (change.property != Channel) {
+                        warning << "note information missing channel" << endmsg;
+                }
+                channel = 0;
         }
 
-        if (change.property != StartTime) {
-                ostringstream time_str;
-                if (smf) {
-                        time_str << smf->round_to_file_precision (change.note->time());
-                } else {
-                        time_str << change.note->time();
+        if ((prop = xml_change.property("time")) != 0) {
+                istringstream time_str(prop->value());
+                time_str >> change.time;
+        } else {
+                if (change.property != StartTime) {
+                        warning << "note information missing time" << endmsg;
                 }
-                xml_change->add_property("time", time_str.str());
+                change.time = 0;
         }
 
-        if (change.property != Length) {
-                ostringstream length_str;
-                if (smf) {
-                        length_str << smf->round_to_file_precision (change.note->length());
-                } else {
-                        length_str << change.note->length();
+        if ((prop = xml_change.property("length")) != 0) {
+                istringstream length_str(prop->value());
+                length_str >> change.length;
+        } else {
+                if (change.property != Length) {
+                        warning << "note information missing length" << endmsg;
                 }
-                xml_change->add_property ("length", length_str.str());
+                change.length = 1;
         }
 
-        if (change.property != Velocity) {
-                ostringstream velocity_str;
-                velocity_str << int (change.note->velocity());
-                xml_change->add_property("velocity", velocity_str.str());
+        if ((prop = xml_change.property("velocity")) != 0) {
+                istringstream velocity_str(prop->value());
+                velocity_str >> velocity;
+        } else {
+                if (change.property != Velocity) {
+                        warning << "note information missing velocity" << endmsg;
+                }
+                velocity = 127;
         }
 
-        /* and now notes that were remove as a side-effect */
+        change.note = note;
+        change.channel = channel;
+        change.velocity = velocity;
 
-        return *xml_change;
+        return change;
 }
 
 MidiModel::DiffCommand::NoteChange
 MidiModel::DiffCommand::unmarshal_change(XMLNode *xml_change)
 {
-        XMLProperty* prop;
+        return make_change (read_change (*xml_change));
+}
+
+/** Turn a saved change back into one of ours, finding the note that it changes in the model */
+MidiModel::DiffCommand::NoteChange
+MidiModel::DiffCommand::make_change (const SavedChange& saved)
+{
         NoteChange change;
-        unsigned int note;
-        unsigned int channel;
-        unsigned int velocity;
-        Evoral::MusicalTime time;
-        Evoral::MusicalTime length;
+        change.property = saved.property;
 
-        if ((prop = xml_change->property("property")) != 0) {
-                change.property = (Property) string_2_enum (prop->value(), change.property);
-        } else {
-                fatal << "!!!" << endmsg;
-                /*NOTREACHED*/
+        uint8_t channel = saved.channel & 0xf;
+        uint8_t note = saved.note;
+        uint8_t velocity = saved.velocity;
+        TimeType time = saved.time;
+        TimeType length = saved.length;
+
+        switch (change.property) {
+        case StartTime:
+                change.old_time = saved.old_value;
+                change.new_time = time = saved.new_value;
+                break;
+        case Length:
+                change.old_time = saved.old_value;
+                change.new_time = length = saved.new_value;
+                break;
+        case NoteNumber:
+                change.old_value = (uint8_t) saved.old_value;
+                change.new_value = note = (uint8_t) saved.new_value;
+                break;
+        case Velocity:
+                change.old_value = (uint8_t) saved.old_value;
+                change.new_value = velocity = (uint8_t) saved.new_value;
+                break;
+        case Channel:
+                change.old_value = (uint8_t) saved.old_value;
+                change.new_value = channel = (uint8_t) saved.new_value & 0xf;
+                break;
         }
 
-        if ((prop = xml_change->property ("old")) != 0) {
-                istringstream old_str (prop->value());
-                if (change.property == StartTime || change.property == Length) {
-                        old_str >> change.old_time;
-                } else {
-                        int integer_value_so_that_istream_does_the_right_thing;
-                        old_str >> integer_value_so_that_istream_does_the_right_thing;
-                        change.old_value = integer_value_so_that_istream_does_the_right_thing;
-                }
-        } else {
-                fatal << "!!!" << endmsg;
-                /*NOTREACHED*/
+        change.note = find_model_note (NotePtr (new Evoral::Note<TimeType> (channel, time, length, note, velocity)));
+
+        return change;
+}
+
+/* Changes are saved as one block of base64-encoded data, rather than as
+   an XML node each, so that large edits can be saved and loaded quickly.
+   Each change is a record of
+
+     uint8_t   property
+     uint8_t   channel, note number and velocity of the note
+     double    start time and length of the note
+     double    old and new values of the property
+
+   with everything little-endian.  As with the XML form, the value of the
+   changed property of the note is the new value.
+*/
+
+static size_t const packed_change_size = 36;
+
+static void
+pack_double (guchar* p, double d)
+{
+        uint64_t u;
+        memcpy (&u, &d, sizeof (u));
+        for (int i = 0; i < 8; ++i) {
+                p[i] = u & 0xff;
+                u >>= 8;
         }
+}
 
-        if ((prop = xml_change->property ("new")) != 0) {
-                istringstream new_str (prop->value());
-                if (change.property == StartTime || change.property == Length) {
-                        new_str >> change.new_time;
-                } else {
-                        int integer_value_so_that_istream_does_the_right_thing;
-                        new_str >> integer_value_so_that_istream_does_the_right_thing;
-                        change.new_value = integer_value_so_that_istream_does_the_right_thing;
-                }
-        } else {
-                fatal << "!!!" << endmsg;
-                /*NOTREACHED*/
+static double
+unpack_double (guchar const * p)
+{
+        uint64_t u = 0;
+        for (int i = 7; i >= 0; --i) {
+                u = (u << 8) | p[i];
         }
+        double d;
+        memcpy (&d, &u, sizeof (d));
+        return d;
+}
 
-        if (change.property != NoteNumber) {
-                if ((prop = xml_change->property("note")) != 0) {
-                        istringstream note_str(prop->value());
-                        note_str >> note;
-                } else {
-                        warning << "note information missing note value" << endmsg;
-                        note = 127;
-                }
-        } else {
-                note = change.new_value;
+/** @return changes packed as described above, in base64 */
+string
+MidiModel::DiffCommand::pack_changes (const SavedChanges& changes)
+{
+        if (changes.empty()) {
+                return string ();
         }
 
-        if (change.property != Channel) {
-                if ((prop = xml_change->property("channel")) != 0) {
-                        istringstream channel_str(prop->value());
-                        channel_str >> channel;
-                } else {
-                        warning << "note information missing channel" << endmsg;
-                        channel = 0;
-                }
-        } else {
-                channel = change.new_value;
+        vector<guchar> data (changes.size() * packed_change_size);
+        guchar* p = &data[0];
+
+        for (SavedChanges::const_iterator i = changes.begin(); i != changes.end(); ++i) {
+                p[0] = i->property;
+                p[1] = i->channel;
+                p[2] = i->note;
+                p[3] = i->velocity;
+                pack_double (p + 4, i->time);
+                pack_double (p + 12, i->length);
+                pack_double (p + 20, i->old_value);
+                pack_double (p + 28, i->new_value);
+                p += packed_change_size;
         }
 
-        if (change.property != StartTime) {
-                if ((prop = xml_change->property("time")) != 0) {
-                        istringstream time_str(prop->value());
-                        time_str >> time;
-                } else {
-                        warning << "note information missing time" << endmsg;
-                        time = 0;
-                }
-        } else {
-                time = change.new_time;
+        gchar* encoded = g_base64_encode (&data[0], data.size());
+        string const s (encoded);
+        g_free (encoded);
+
+        return s;
+}
+
+/** @return changes from base64 data written by pack_changes().  Records of
+ *  properties that we do not know about, and any incomplete record at the
+ *  end, are skipped.
+ */
+MidiModel::DiffCommand::SavedChanges
+MidiModel::DiffCommand::unpack_changes (const string& packed)
+{
+        SavedChanges changes;
+
+        if (packed.empty()) {
+                return changes;
         }
 
-        if (change.property != Length) {
-                if ((prop = xml_change->property("length")) != 0) {
-                        istringstream length_str(prop->value());
-                        length_str >> length;
-                } else {
-                        warning << "note information missing length" << endmsg;
-                        length = 1;
+        gsize size = 0;
+        guchar* data = g_base64_decode (packed.c_str(), &size);
+
+        for (guchar const * p = data; p + packed_change_size <= data + size; p += packed_change_size) {
+
+                if (p[0] > Channel) {
+                        warning << "MIDI note change with unknown property ignored" << endmsg;
+                        continue;
                 }
-        } else {
-                length = change.new_time;
+
+                SavedChange change;
+                change.property = (Property) p[0];
+                change.channel = p[1];
+                change.note = p[2];
+                change.velocity = p[3];
+                change.time = unpack_double (p + 4);
+                change.length = unpack_double (p + 12);
+                change.old_value = unpack_double (p + 20);
+                change.new_value = unpack_double (p + 28);
+
+                changes.push_back (change);
+        }
+
+        g_free (data);
+
+        return changes;
+}
+
+XMLNode&
+MidiModel::DiffCommand::marshal_changes ()
+{
+        XMLNode* xml_changes = new XMLNode (PACKED_DIFF_NOTES_ELEMENT);
+
+        if (_changes.empty()) {
+                return *xml_changes;
         }
 
-        if (change.property != Velocity) {
-                if ((prop = xml_change->property("velocity")) != 0) {
-                        istringstream velocity_str(prop->value());
-                        velocity_str >> velocity;
+        const SMFSource* smf = dynamic_cast<const SMFSource*> (_model->midi_source());
+
+        SavedChanges saved;
+
+        for (ChangeList::const_iterator i = _changes.begin(); i != _changes.end(); ++i) {
+
+                SavedChange s;
+
+                s.property = i->property;
+                s.channel = i->note->channel();
+                s.note = i->note->note();
+                s.velocity = i->note->velocity();
+                s.time = i->note->time();
+                s.length = i->note->length();
+
+                if (smf) {
+                        s.time = smf->round_to_file_precision (s.time);
+                        s.length = smf->round_to_file_precision (s.length);
+                }
+
+                if (i->property == StartTime || i->property == Length) {
+                        s.old_value = i->old_time;
+                        s.new_value = i->new_time;
                 } else {
-                        warning << "note information missing velocity" << endmsg;
-                        velocity = 127;
+                        s.old_value = i->old_value;
+                        s.new_value = i->new_value;
                 }
-        } else {
-                velocity = change.new_value;
+
+                saved.push_back (s);
         }
 
-        /* we must point at the instance of the note that is actually in the model.
-           so go look for it ...
-        */
+        xml_changes->add_content (pack_changes (saved));
 
-        NotePtr new_note (new Evoral::Note<TimeType> (channel, time, length, note, velocity));
+        return *xml_changes;
+}
 
-        change.note = _model->find_note (new_note);
+void
+MidiModel::DiffCommand::unmarshal_changes (const XMLNode& xml_changes)
+{
+        if (xml_changes.children().empty()) {
+                return;
+        }
 
-        if (!change.note) {
-                warning << "MIDI note " << *new_note << " not found in model - programmers should investigate this" << endmsg;
+        SavedChanges const saved = unpack_changes (xml_changes.children().front()->content());
+
+        for (SavedChanges::const_iterator i = saved.begin(); i != saved.end(); ++i) {
+                _changes.push_back (make_change (*i));
+        }
+}
+
+/** We must point at the instance of a note that is actually in the model,
+ *  so go and look for it.
+ *  @param note Note with the contents to look for.
+ *  @return Note in the model, or \a note if there is none.
+ */
+Evoral::Sequence<MidiModel::TimeType>::NotePtr
+MidiModel::DiffCommand::find_model_note (NotePtr note)
+{
+        NotePtr n = _model->find_note (note);
+
+        if (!n) {
+                warning << "MIDI note " << *note << " not found in model - programmers should investigate this" << endmsg;
                 /* use the actual new note */
-                change.note = new_note;
+                return note;
         }
 
-        return change;
+        return n;
 }
 
 int
@@ -692,8 +792,11 @@ MidiModel::DiffCommand::set_state(const XMLNode& diff_command, int /*version*/)
         _changes.clear();
 
         XMLNode* changed_notes = diff_command.child(DIFF_NOTES_ELEMENT);
+        XMLNode* packed_changed_notes = diff_command.child(PACKED_DIFF_NOTES_ELEMENT);
 
-        if (changed_notes) {
+        if (packed_changed_notes) {
+                unmarshal_changes (*packed_changed_notes);
+        } else if (changed_notes) {
                 XMLNodeList notes = changed_notes->children();
                 transform (notes.begin(), notes.end(), back_inserter(_changes),
                            boost::bind (&DiffCommand::unmarshal_change, this, _1));
@@ -722,11 +825,7 @@ MidiModel::DiffCommand::get_state ()
         XMLNode* diff_command = new XMLNode(DIFF_COMMAND_ELEMENT);
         diff_command->add_property("midi-source", _model->midi_source()->id().to_s());
 
-        XMLNode* changes = diff_command->add_child(DIFF_NOTES_ELEMENT);
-        for_each(_changes.begin(), _changes.end(), 
-                 boost::bind (
-                         boost::bind (&XMLNode::add_child_nocopy, changes, _1),
-                         boost::bind (&DiffCommand::marshal_change, this, _1)));
+        diff_command->add_child_nocopy (marshal_changes ());
 
         XMLNode* added_notes = diff_command->add_child(ADDED_NOTES_ELEMENT);
         for_each(_added_notes.begin(), _added_notes.end(), 
@@ -906,7 +1005,7 @@ MidiModel::find_note (NotePtr other)
         Notes::iterator l = notes().lower_bound(other);
 
         if (l != notes().end()) {
-                for (; (*l)->time() == other->time(); ++l) {
+                for (; l != notes().end() && (*l)->time() == other->time(); ++l) {
                         /* NB: compare note contents, not note pointers.
                            If "other" was a ptr to a note already in
                            the model, we wouldn't be looking for it,
@@ -967,6 +1066,11 @@ MidiModel::resolve_overlaps_unlocked (const NotePtr note, void* arg)
         for (Pitches::const_iterator i = p.lower_bound (search_note); 
              i != p.end() && (*i)->note() == note->note(); ++i) {
 
+                if (*i == note) {
+                        /* the note is being moved, and is still in the model */
+                        continue;
+                }
+
                 TimeType sb = (*i)->time();
                 TimeType eb = (*i)->end_time();
                 OverlapType overlap = OverlapNone;
@@ -21,6 +21,7 @@
 
 #include "ardour/midi_port.h"
 #include "ardour/data_type.h"
+#include "ardour/dummy_backend.h"
 
 using namespace ARDOUR;
 using namespace std;
@@ -44,7 +45,7 @@ MidiPort::cycle_start (nframes_t nframes)
 	_buffer->clear ();
 	assert (_buffer->size () == 0);
 
-	if (sends_output ()) {
+	if (sends_output () && _jack_port) {
 		jack_midi_clear_buffer (jack_port_get_buffer (_jack_port, nframes));
 	}
 }
@@ -56,7 +57,7 @@ MidiPort::get_midi_buffer (nframes_t nframes, nframes_t offset)
 		return *_buffer;
 	}
 
-	if (receives_input ()) {
+	if (receives_input () && _jack_port) {
 
 		void* jack_buffer = jack_port_get_buffer (_jack_port, nframes);
 		const nframes_t event_count = jack_midi_get_event_count(jack_buffer);
@@ -117,7 +118,7 @@ MidiPort::cycle_split ()
 void
 MidiPort::flush_buffers (nframes_t nframes, nframes64_t time, nframes_t offset)
 {
-	if (sends_output ()) {
+	if (sends_output () && _jack_port) {
 
 		void* jack_buffer = jack_port_get_buffer (_jack_port, nframes);
 
@@ -164,6 +165,12 @@ MidiPort::transport_stopped ()
 size_t
 MidiPort::raw_buffer_size (nframes_t nframes) const
 {
+	if (!_jack_port) {
+		/* same estimate that AudioEngine uses before it has any MIDI ports */
+		nframes_t const n = nframes ? nframes : DummyBackend::max_period_size;
+		return n * 4 - (n/2);
+	}
+
 	return jack_midi_max_event_size(jack_port_get_buffer(_jack_port, nframes));
 }
 
@@ -134,6 +134,132 @@ default_mix_buffers_no_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, n
 	}
 }
 
+void
+default_compute_meter (const ARDOUR::Sample * const * bufs, uint32_t nchannels, nframes_t nframes, float *peaks, float *powers)
+{
+	for (uint32_t c = 0; c < nchannels; ++c) {
+
+		const ARDOUR::Sample * const buf = bufs[c];
+		float peak = peaks[c];
+
+		if (powers) {
+			float power = 0.0f;
+			for (nframes_t i = 0; i < nframes; ++i) {
+				peak = f_max (peak, fabsf (buf[i]));
+				power += buf[i] * buf[i];
+			}
+			powers[c] += power;
+		} else {
+			for (nframes_t i = 0; i < nframes; ++i) {
+				peak = f_max (peak, fabsf (buf[i]));
+			}
+		}
+
+		peaks[c] = peak;
+	}
+}
+
+void
+default_pan_buffers (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, nframes_t nframes)
+{
+	uint32_t o = 0;
+
+	/* outputs are done in pairs, so that each source sample is read once per pair */
+
+	for (; o + 1 < nouts; o += 2) {
+		ARDOUR::Sample * const a = dsts[o];
+		ARDOUR::Sample * const b = dsts[o+1];
+		const float ga = gains[o];
+		const float gb = gains[o+1];
+
+		for (nframes_t i = 0; i < nframes; ++i) {
+			a[i] += src[i] * ga;
+			b[i] += src[i] * gb;
+		}
+	}
+
+	if (o < nouts) {
+		default_mix_buffers_with_gain (dsts[o], src, nframes, gains[o]);
+	}
+}
+
+void
+default_pan_equal_power_stereo (ARDOUR::Sample * left, ARDOUR::Sample * right, const ARDOUR::Sample * src, const ARDOUR::pan_t * positions,
+				nframes_t nframes, float scale, float gain)
+{
+	for (nframes_t i = 0; i < nframes; ++i) {
+		const float panR = positions[i];
+		const float panL = 1.0f - panR;
+
+		left[i] += src[i] * (panL * (scale * panL + 1.0f - scale) * gain);
+		right[i] += src[i] * (panR * (scale * panR + 1.0f - scale) * gain);
+	}
+}
+
+void
+default_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, nframes_t nframes, const ARDOUR::gain_t * gains)
+{
+	for (nframes_t i = 0; i < nframes; ++i) {
+		buf[i] *= gains[i];
+	}
+}
+
+void
+default_copy_buffer_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, nframes_t nframes, float gain)
+{
+	for (nframes_t i = 0; i < nframes; ++i) {
+		dst[i] = src[i] * gain;
+	}
+}
+
+void
+default_interleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, nframes_t nframes)
+{
+	dst += channel;
+
+	for (nframes_t i = 0; i < nframes; ++i) {
+		*dst = src[i];
+		dst += nchannels;
+	}
+}
+
+void
+default_deinterleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, nframes_t nframes)
+{
+	src += channel;
+
+	for (nframes_t i = 0; i < nframes; ++i) {
+		dst[i] = *src;
+		src += nchannels;
+	}
+}
+
+void
+default_scale_and_offset_buffer (ARDOUR::Sample * buf, nframes_t nframes, const ARDOUR::gain_t * ramp, nframes_t ramp_frames,
+				 float gain, float scale, float offset)
+{
+	nframes_t i = 0;
+
+	for (; i < ramp_frames; ++i) {
+		buf[i] = buf[i] * (ramp[i] * scale) + offset;
+	}
+
+	const float g = gain * scale;
+
+	for (; i < nframes; ++i) {
+		buf[i] = buf[i] * g + offset;
+	}
+}
+
+void
+default_crossfade_buffers (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains,
+			   const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, nframes_t nframes)
+{
+	for (nframes_t i = 0; i < nframes; ++i) {
+		dst[i] = out[i] * out_gains[i] + in[i] * in_gains[i];
+	}
+}
+
 #if defined (__APPLE__) && defined (BUILD_VECLIB_OPTIMIZATIONS)
 #include <Accelerate/Accelerate.h>
 
@@ -172,6 +298,63 @@ veclib_mix_buffers_no_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, nf
 	vDSP_vsma(src, 1, &gain, dst, 1, dst, 1, nframes);
 }
 
+void
+veclib_compute_meter (const ARDOUR::Sample * const * bufs, uint32_t nchannels, nframes_t nframes, float *peaks, float *powers)
+{
+	for (uint32_t c = 0; c < nchannels; ++c) {
+		float tmp = 0.0f;
+		vDSP_maxmgv (bufs[c], 1, &tmp, nframes);
+		peaks[c] = f_max (peaks[c], tmp);
+		if (powers) {
+			vDSP_svesq (const_cast<ARDOUR::Sample*>(bufs[c]), 1, &tmp, nframes);
+			powers[c] += tmp;
+		}
+	}
+}
+
+void
+veclib_pan_buffers (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, nframes_t nframes)
+{
+	for (uint32_t o = 0; o < nouts; ++o) {
+		float gain = gains[o];
+		vDSP_vsma (src, 1, &gain, dsts[o], 1, dsts[o], 1, nframes);
+	}
+}
+
+void
+veclib_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, nframes_t nframes, const ARDOUR::gain_t * gains)
+{
+	vDSP_vmul (buf, 1, gains, 1, buf, 1, nframes);
+}
+
+void
+veclib_copy_buffer_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, nframes_t nframes, float gain)
+{
+	vDSP_vsmul (src, 1, &gain, dst, 1, nframes);
+}
+
+void
+veclib_interleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, nframes_t nframes)
+{
+	/* a strided copy is a multiply by one */
+	float one = 1.0f;
+	vDSP_vsmul (src, 1, &one, dst + channel, nchannels, nframes);
+}
+
+void
+veclib_deinterleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, nframes_t nframes)
+{
+	float one = 1.0f;
+	vDSP_vsmul (src + channel, nchannels, &one, dst, 1, nframes);
+}
+
+void
+veclib_crossfade_buffers (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains,
+			  const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, nframes_t nframes)
+{
+	vDSP_vmma (out, 1, out_gains, 1, in, 1, in_gains, 1, dst, 1, nframes);
+}
+
 #endif
 
 
@@ -274,131 +274,92 @@ BaseStereoPanner::load (istream& in, string path, uint32_t& linecnt)
 	return 0;
 }
 
-void
-BaseStereoPanner::do_distribute (AudioBuffer& srcbuf, BufferSet& obufs, gain_t gain_coeff, nframes_t nframes)
+/** Mix src into nouts outputs with the given gains in one pass, leaving
+ *  out any output whose gain is zero.  dsts and gains are modified.
+ */
+static void
+pan_to_outputs (Sample** dsts, float* gains, uint32_t nouts, const Sample* src, nframes_t nframes)
 {
-	assert(obufs.count().n_audio() == 2);
-
-	pan_t delta;
-	Sample* dst;
-	pan_t pan;
-
-	if (_muted) {
-		return;
-	}
-
-	Sample* const src = srcbuf.data();
-
-	/* LEFT */
-
-	dst = obufs.get_audio(0).data();
-
-	if (fabsf ((delta = (left - desired_left))) > 0.002) { // about 1 degree of arc
-
-		/* we've moving the pan by an appreciable amount, so we must
-		   interpolate over 64 frames or nframes, whichever is smaller */
-
-		nframes_t const limit = min ((nframes_t)64, nframes);
-		nframes_t n;
-
-		delta = -(delta / (float) (limit));
-
-		for (n = 0; n < limit; n++) {
-			left_interp = left_interp + delta;
-			left = left_interp + 0.9 * (left - left_interp);
-			dst[n] += src[n] * left * gain_coeff;
-		}
-
-		/* then pan the rest of the buffer; no need for interpolation for this bit */
-
-		pan = left * gain_coeff;
-
-		mix_buffers_with_gain (dst+n,src+n,nframes-n,pan);
-
-	} else {
-
-		left = desired_left;
-		left_interp = left;
+	uint32_t n = 0;
 
-		if ((pan = (left * gain_coeff)) != 1.0f) {
-
-			if (pan != 0.0f) {
-
-				/* pan is 1 but also not 0, so we must do it "properly" */
-
-				mix_buffers_with_gain(dst,src,nframes,pan);
-
-				/* mark that we wrote into the buffer */
-
-				// obufs[0] = 0;
-
-			}
-
-		} else {
-
-			/* pan is 1 so we can just copy the input samples straight in */
-
-			mix_buffers_no_gain(dst,src,nframes);
-
-			/* mark that we wrote into the buffer */
-
-			// obufs[0] = 0;
+	for (uint32_t i = 0; i < nouts; ++i) {
+		if (gains[i] != 0.0f) {
+			dsts[n] = dsts[i];
+			gains[n] = gains[i];
+			++n;
 		}
 	}
 
-	/* RIGHT */
-
-	dst = obufs.get_audio(1).data();
-
-	if (fabsf ((delta = (right - desired_right))) > 0.002) { // about 1 degree of arc
+	if (n && nframes) {
+		pan_buffers (dsts, gains, n, src, nframes);
+	}
+}
 
-		/* we're moving the pan by an appreciable amount, so we must
-		   interpolate over 64 frames or nframes, whichever is smaller */
+/** If pan is an appreciable distance from desired, move it there over 64
+ *  frames or nframes, whichever is smaller, mixing those frames into dst.
+ *  @return number of frames mixed.
+ */
+static nframes_t
+interpolate_pan (pan_t& pan, pan_t& interp, pan_t desired, Sample* dst, const Sample* src, gain_t gain_coeff, nframes_t nframes)
+{
+	pan_t delta;
 
-		nframes_t const limit = min ((nframes_t)64, nframes);
-		nframes_t n;
+	if (fabsf ((delta = (pan - desired))) <= 0.002) { // about 1 degree of arc
+		pan = desired;
+		interp = pan;
+		return 0;
+	}
 
-		delta = -(delta / (float) (limit));
+	nframes_t const limit = min ((nframes_t)64, nframes);
 
-		for (n = 0; n < limit; n++) {
-			right_interp = right_interp + delta;
-			right = right_interp + 0.9 * (right - right_interp);
-			dst[n] += src[n] * right * gain_coeff;
-		}
+	delta = -(delta / (float) (limit));
 
-		/* then pan the rest of the buffer, no need for interpolation for this bit */
+	for (nframes_t n = 0; n < limit; n++) {
+		interp = interp + delta;
+		pan = interp + 0.9 * (pan - interp);
+		dst[n] += src[n] * pan * gain_coeff;
+	}
 
-		pan = right * gain_coeff;
+	return limit;
+}
 
-		mix_buffers_with_gain(dst+n,src+n,nframes-n,pan);
+void
+BaseStereoPanner::do_distribute (AudioBuffer& srcbuf, BufferSet& obufs, gain_t gain_coeff, nframes_t nframes)
+{
+	assert(obufs.count().n_audio() == 2);
 
-		/* XXX it would be nice to mark the buffer as written to */
+	if (_muted) {
+		return;
+	}
 
-	} else {
+	Sample* const src = srcbuf.data();
+	Sample* const dst_left = obufs.get_audio(0).data();
+	Sample* const dst_right = obufs.get_audio(1).data();
 
-		right = desired_right;
-		right_interp = right;
+	/* interpolate either side whose pan has moved */
 
-		if ((pan = (right * gain_coeff)) != 1.0f) {
+	nframes_t const l = interpolate_pan (left, left_interp, desired_left, dst_left, src, gain_coeff, nframes);
+	nframes_t const r = interpolate_pan (right, right_interp, desired_right, dst_right, src, gain_coeff, nframes);
 
-			if (pan != 0.0f) {
+	/* bring the other side up to the same point */
 
-				/* pan is not 1 but also not 0, so we must do it "properly" */
-				
-				mix_buffers_with_gain(dst,src,nframes,pan);
+	if (l < r) {
+		mix_buffers_with_gain (dst_left + l, src + l, r - l, left * gain_coeff);
+	} else if (r < l) {
+		mix_buffers_with_gain (dst_right + r, src + r, l - r, right * gain_coeff);
+	}
 
-				/* XXX it would be nice to mark the buffer as written to */
-			}
+	/* then pan the rest of the buffer to both sides at once; no need for
+	   interpolation for this bit.
+	*/
 
-		} else {
+	nframes_t const done = max (l, r);
+	Sample* dsts[2] = { dst_left + done, dst_right + done };
+	float gains[2] = { left * gain_coeff, right * gain_coeff };
 
-			/* pan is 1 so we can just copy the input samples straight in */
-			
-			mix_buffers_no_gain(dst,src,nframes);
+	pan_to_outputs (dsts, gains, 2, src + done, nframes - done);
 
-			/* XXX it would be nice to mark the buffer as written to */
-		}
-	}
+	/* XXX it would be nice to mark the buffers as written to */
 }
 
 /*---------------------------------------------------------------------- */
@@ -453,8 +414,6 @@ EqualPowerStereoPanner::do_distribute_automated (AudioBuffer& srcbuf, BufferSet&
 {
 	assert (obufs.count().n_audio() == 2);
 
-	Sample* dst;
-	pan_t* pbuf;
 	Sample* const src = srcbuf.data();
 
 	/* fetch positional data */
@@ -478,42 +437,15 @@ EqualPowerStereoPanner::do_distribute_automated (AudioBuffer& srcbuf, BufferSet&
 	}
 
 	/* apply pan law to convert positional data into pan coefficients for
-	   each buffer (output)
+	   each output, and mix into both outputs, in one pass
 	*/
 
 	const float pan_law_attenuation = -3.0f;
 	const float scale = 2.0f - 4.0f * powf (10.0f,pan_law_attenuation/20.0f);
 
-	for (nframes_t n = 0; n < nframes; ++n) {
-
-		float const panR = buffers[0][n];
-		float const panL = 1 - panR;
-
-		buffers[0][n] = panL * (scale * panL + 1.0f - scale);
-		buffers[1][n] = panR * (scale * panR + 1.0f - scale);
-	}
-
-	/* LEFT */
-
-	dst = obufs.get_audio(0).data();
-	pbuf = buffers[0];
-
-	for (nframes_t n = 0; n < nframes; ++n) {
-		dst[n] += src[n] * pbuf[n];
-	}
-
-	/* XXX it would be nice to mark the buffer as written to */
-
-	/* RIGHT */
-
-	dst = obufs.get_audio(1).data();
-	pbuf = buffers[1];
-
-	for (nframes_t n = 0; n < nframes; ++n) {
-		dst[n] += src[n] * pbuf[n];
-	}
+	pan_equal_power_stereo (obufs.get_audio(0).data(), obufs.get_audio(1).data(), src, buffers[0], nframes, scale, 1.0f);
 
-	/* XXX it would be nice to mark the buffer as written to */
+	/* XXX it would be nice to mark the buffers as written to */
 }
 
 StreamPanner*
@@ -585,6 +517,8 @@ EqualPowerStereoPanner::set_state (const XMLNode& node, int version)
 
 Multi2dPanner::Multi2dPanner (Panner& p, Evoral::Parameter param)
 	: StreamPanner (p, param)
+	, _dsts (p.nouts ())
+	, _gains (p.nouts ())
 {
 	update ();
 }
@@ -628,61 +562,19 @@ Multi2dPanner::update ()
 void
 Multi2dPanner::do_distribute (AudioBuffer& srcbuf, BufferSet& obufs, gain_t gain_coeff, nframes_t nframes)
 {
-	Sample* dst;
-	pan_t pan;
-
 	if (_muted) {
 		return;
 	}
 
-	Sample* const src = srcbuf.data();
-
 	uint32_t const N = parent.nouts ();
-	for (uint32_t n = 0; n < N; ++n) {
-		Panner::Output& o = parent.output (n);
-
-		dst = obufs.get_audio(n).data();
-
-#ifdef CAN_INTERP
-		if (fabsf ((delta = (left_interp - desired_left))) > 0.002) { // about 1 degree of arc
-
-			/* interpolate over 64 frames or nframes, whichever is smaller */
+	assert (_dsts.size() == N && N > 0);
 
-			nframes_t limit = min ((nframes_t)64, nframes);
-			nframes_t n;
-
-			delta = -(delta / (float) (limit));
-
-			for (n = 0; n < limit; n++) {
-				left_interp = left_interp + delta;
-				left = left_interp + 0.9 * (left - left_interp);
-				dst[n] += src[n] * left * gain_coeff;
-			}
-
-			pan = left * gain_coeff;
-			mix_buffers_with_gain(dst+n,src+n,nframes-n,pan);
-
-		} else {
-
-#else
-			pan = o.desired_pan;
-
-			if ((pan *= gain_coeff) != 1.0f) {
-
-				if (pan != 0.0f) {
-					mix_buffers_with_gain(dst,src,nframes,pan);
-				}
-				
-			} else {
-					mix_buffers_no_gain(dst,src,nframes);
-			}
-#endif
-#ifdef CAN_INTERP
-		}
-#endif
+	for (uint32_t n = 0; n < N; ++n) {
+		_dsts[n] = obufs.get_audio(n).data();
+		_gains[n] = parent.output(n).desired_pan * gain_coeff;
 	}
 
-	return;
+	pan_to_outputs (&_dsts[0], &_gains[0], N, srcbuf.data(), nframes);
 }
 
 void
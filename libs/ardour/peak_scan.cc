@@ -0,0 +1,240 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <functional>
+
+#include "ardour/peak_scan.h"
+#include "ardour/runtime_functions.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+namespace {
+
+enum PeakLevel {
+	UnknownPeak,
+	SilentPeak,
+	LoudPeak
+};
+
+/** @return true if the frames of peak i must be read to find silence */
+bool
+must_read (vector<char> const & level, size_t i, bool skip_loud)
+{
+	if (level[i] == SilentPeak) {
+		return false;
+	}
+
+	if (level[i] == UnknownPeak || !skip_loud) {
+		return true;
+	}
+
+	/* a loud peak must be read if a period of silence might run into it */
+
+	return (i > 0 && level[i - 1] != LoudPeak) || (i < level.size() - 1 && level[i + 1] != LoudPeak);
+}
+
+}
+
+/** Find the periods of at least min_length frames in which the channel is
+ *  silent.  Where the peaks show that the source is silent, or too loud for
+ *  long enough for it not to matter exactly where, the source is not read.
+ *  @param itt Checked for cancellation.
+ *  @param report_progress true to set itt's progress.
+ */
+PeakScan::Periods
+PeakScan::find_silence (Sample threshold, framecnt_t min_length, InterThreadInfo& itt, bool report_progress) const
+{
+	framecnt_t const fpp = _frames_per_peak;
+	framecnt_t const block_size = 64 * 1024;
+	framepos_t const first_peak = _start / fpp;
+	Periods silence;
+
+	vector<char> level (_peaks.size());
+	for (size_t i = 0; i < _peaks.size(); ++i) {
+		level[i] = _peaks[i] < 0 ? UnknownPeak : (_peaks[i] < threshold ? SilentPeak : LoudPeak);
+	}
+
+	/* any min_length + 1 frames include all of some peak when min_length is at
+	   least 2 peaks long.  A long enough period of silence then has one of its
+	   peaks not loud, so it can only touch a loud peak that is next to one which
+	   is not.  Other loud peaks can be taken to be loud throughout.
+	*/
+
+	bool const skip_loud = min_length >= 2 * fpp;
+
+	vector<Sample> buf (block_size);
+	frameoffset_t silence_start = -1;
+	size_t i = 0;
+
+	while (i < _peaks.size() && !itt.cancel) {
+
+		frameoffset_t const from = max ((first_peak + (framepos_t) i) * fpp - _start, (frameoffset_t) 0);
+		size_t next = i + 1;
+
+		if (level[i] == SilentPeak) {
+
+			if (silence_start < 0) {
+				silence_start = from;
+			}
+
+		} else if (!must_read (level, i, skip_loud)) {
+
+			if (silence_start >= 0) {
+				if (from - 1 - silence_start >= min_length) {
+					silence.push_back (make_pair (silence_start, from - 1));
+				}
+				silence_start = -1;
+			}
+
+		} else {
+
+			/* read as many consecutive peaks' frames as need it, up to a block */
+
+			while (next < _peaks.size() && (framecnt_t) (next - i) * fpp < block_size && must_read (level, next, skip_loud)) {
+				++next;
+			}
+
+			frameoffset_t const to = min ((first_peak + (framepos_t) next) * fpp - _start, _length);
+
+			if (_read (&buf[0], _start + from, to - from) != to - from) {
+				/* treat what we could not read as loud */
+				fill (buf.begin(), buf.begin() + (to - from), threshold);
+			}
+
+			for (frameoffset_t j = 0; j < to - from; ++j) {
+				if (fabsf (buf[j]) < threshold) {
+					if (silence_start < 0) {
+						silence_start = from + j;
+					}
+				} else if (silence_start >= 0) {
+					if (from + j - 1 - silence_start >= min_length) {
+						silence.push_back (make_pair (silence_start, from + j - 1));
+					}
+					silence_start = -1;
+				}
+			}
+		}
+
+		i = next;
+
+		if (report_progress) {
+			itt.progress = i / (double) _peaks.size();
+		}
+	}
+
+	if (silence_start >= 0 && _length - 1 - silence_start >= min_length) {
+		/* the region ends in silence, so finish off the last period */
+		silence.push_back (make_pair (silence_start, _length - 1));
+	}
+
+	return silence;
+}
+
+/** Find the largest absolute sample value in the channel.  Blocks of the
+ *  source are read in order of their peaks, so that once the largest value
+ *  has been found the rest need not be read.
+ *  @return largest value, or -1 if the source cannot be read.
+ */
+double
+PeakScan::maximum_amplitude () const
+{
+	framecnt_t const fpp = _frames_per_peak;
+	framecnt_t const block_size = 64 * 1024;
+	framecnt_t const peaks_per_block = block_size / fpp;
+	framepos_t const first_peak = _start / fpp;
+
+	/* the largest value that each block might contain, and the index of its first peak */
+
+	vector<pair<Sample, size_t> > blocks;
+
+	for (size_t i = 0; i < _peaks.size(); i += peaks_per_block) {
+		Sample bound = 0;
+		for (size_t j = i; j < min (i + peaks_per_block, _peaks.size()); ++j) {
+			bound = _peaks[j] < 0 ? FLT_MAX : max (bound, _peaks[j]);
+		}
+		blocks.push_back (make_pair (bound, i));
+	}
+
+	sort (blocks.begin(), blocks.end(), greater<pair<Sample, size_t> > ());
+
+	vector<Sample> buf (block_size);
+	double m = 0;
+
+	for (vector<pair<Sample, size_t> >::const_iterator b = blocks.begin(); b != blocks.end() && b->first > m; ++b) {
+
+		frameoffset_t const from = max ((first_peak + (framepos_t) b->second) * fpp - _start, (frameoffset_t) 0);
+		frameoffset_t const to = min ((first_peak + (framepos_t) (b->second + peaks_per_block)) * fpp - _start, _length);
+
+		if (_read (&buf[0], _start + from, to - from) != to - from) {
+			return -1;
+		}
+
+		m = compute_peak (&buf[0], to - from, m);
+	}
+
+	return m;
+}
+
+/** Find where all of some channels are silent, given where each of them is.
+ *  A channel's periods only include those which are long enough, but none of
+ *  the periods that we are after can be longer than those that they fall
+ *  within.
+ *  @param channels Silent periods of each channel, in order.
+ *  @return Periods of at least min_length frames which are silent in every channel.
+ */
+PeakScan::Periods
+PeakScan::intersect (vector<Periods> const & channels, framecnt_t min_length)
+{
+	if (channels.empty ()) {
+		return Periods ();
+	}
+
+	Periods silent_periods (channels.front ());
+
+	for (size_t n = 1; n < channels.size() && !silent_periods.empty(); ++n) {
+
+		Periods both;
+		Periods::const_iterator a = silent_periods.begin ();
+		Periods::const_iterator b = channels[n].begin ();
+
+		while (a != silent_periods.end() && b != channels[n].end()) {
+
+			frameoffset_t const first = max (a->first, b->first);
+			frameoffset_t const last = min (a->second, b->second);
+
+			if (last - first >= min_length) {
+				both.push_back (make_pair (first, last));
+			}
+
+			if (a->second < b->second) {
+				++a;
+			} else {
+				++b;
+			}
+		}
+
+		silent_periods.swap (both);
+	}
+
+	return silent_periods;
+}
@@ -484,6 +484,8 @@ Playlist::release_notifications ()
 void
 Playlist::notify_contents_changed ()
 {
+	state_changed ();
+
 	if (holding_state ()) {
 		pending_contents_change = true;
 	} else {
@@ -495,6 +497,8 @@ Playlist::notify_contents_changed ()
 void
 Playlist::notify_layering_changed ()
 {
+	state_changed ();
+
 	if (holding_state ()) {
 		pending_layering = true;
 	} else {
@@ -506,6 +510,8 @@ Playlist::notify_layering_changed ()
 void
 Playlist::notify_region_removed (boost::shared_ptr<Region> r)
 {
+	state_changed ();
+
 	if (holding_state ()) {
 		pending_removes.insert (r);
 		pending_contents_change = true;
@@ -525,6 +531,8 @@ Playlist::notify_region_removed (boost::shared_ptr<Region> r)
 void
 Playlist::notify_region_moved (boost::shared_ptr<Region> r)
 {
+	state_changed ();
+
 	Evoral::RangeMove<framepos_t> const move (r->last_position (), r->length (), r->position ());
 
 	if (holding_state ()) {
@@ -543,6 +551,8 @@ Playlist::notify_region_moved (boost::shared_ptr<Region> r)
 void
 Playlist::notify_region_added (boost::shared_ptr<Region> r)
 {
+	state_changed ();
+
 	/* the length change might not be true, but we have to act
 	   as though it could be.
 	*/
@@ -564,6 +574,8 @@ Playlist::notify_region_added (boost::shared_ptr<Region> r)
 void
 Playlist::notify_length_changed ()
 {
+	state_changed ();
+
 	if (holding_state ()) {
 		pending_length = true;
 	} else {
@@ -2294,6 +2306,27 @@ Playlist::get_template()
 	return state (false);
 }
 
+/** @return state generation which changes whenever the state returned by
+ *  get_state() does; that includes the state of our regions.
+ */
+uint32_t
+Playlist::full_state_generation () const
+{
+	/* generations are handed out in increasing order, and any change to
+	   our list of regions changes our own, so the newest of them all
+	   will do.
+	*/
+
+	RegionLock rlock (const_cast<Playlist *> (this), false);
+	uint32_t g = state_generation ();
+
+	for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+		g = max (g, (*i)->state_generation ());
+	}
+
+	return g;
+}
+
 /** @param full_state true to include regions in the returned state, otherwise false.
  */
 XMLNode&
@@ -2777,6 +2810,7 @@ void
 Playlist::set_frozen (bool yn)
 {
 	_frozen = yn;
+	state_changed ();
 }
 
 void
@@ -30,6 +30,7 @@
 #include "ardour/audio_buffer.h"
 #include "ardour/automation_list.h"
 #include "ardour/buffer_set.h"
+#include "ardour/configuration.h"
 #include "ardour/event_type_map.h"
 #include "ardour/ladspa_plugin.h"
 #include "ardour/plugin.h"
@@ -65,7 +66,10 @@ PluginInsert::PluginInsert (Session& s, boost::shared_ptr<Plugin> plug)
 	: Processor (s, (plug ? plug->name() : string ("toBeRenamed")))
 	, _signal_analysis_collected_nframes(0)
 	, _signal_analysis_collect_nframes_max(0)
+	, _automated_controls (new AutomatedControls)
 {
+	AutomationStateChanged.connect_same_thread (*this, boost::bind (&PluginInsert::update_automated_controls, this));
+
 	/* the first is the master */
 
         if (plug) {
@@ -201,6 +205,31 @@ PluginInsert::set_automatable ()
 			add_control (boost::shared_ptr<AutomationControl>(new PluginControl(this, param, list)));
 		}
 	}
+
+	update_automated_controls ();
+}
+
+/** Called when any of our controls' automation state changes.  The caller
+ *  may hold control_lock(), so we don't take it.
+ */
+void
+PluginInsert::update_automated_controls ()
+{
+	RCUWriter<AutomatedControls> writer (_automated_controls);
+	boost::shared_ptr<AutomatedControls> ac = writer.get_copy ();
+
+	ac->clear ();
+
+	for (Controls::iterator li = controls().begin(); li != controls().end(); ++li) {
+
+		boost::shared_ptr<AutomationControl> c = boost::dynamic_pointer_cast<AutomationControl> (li->second);
+
+		if (c && c->parameter().type() == PluginAutomation && c->automation_state() != Off) {
+			ac->push_back (c);
+		}
+	}
+
+	/* writer goes out of scope and publishes the new list */
 }
 
 void
@@ -259,31 +288,26 @@ PluginInsert::connect_and_run (BufferSet& bufs, nframes_t nframes, nframes_t off
 		collect_signal_nframes = nframes;
 	}
 
-	ChanMapping in_map(input_streams());
-	ChanMapping out_map(output_streams());
-
 	/* Note that we've already required that plugins
 	   be able to handle in-place processing.
 	*/
 
 	if (with_auto) {
 
-		uint32_t n = 0;
+		boost::shared_ptr<AutomatedControls> ac = _automated_controls.reader ();
 
-		for (Controls::iterator li = controls().begin(); li != controls().end(); ++li, ++n) {
+		for (AutomatedControls::iterator i = ac->begin(); i != ac->end(); ++i) {
 
-			boost::shared_ptr<AutomationControl> c
-				= boost::dynamic_pointer_cast<AutomationControl>(li->second);
+			AutomationControl& c (**i);
 
-			if (c->parameter().type() == PluginAutomation && c->automation_playback()) {
+			if (c.automation_playback()) {
 				bool valid;
 
-				const float val = c->list()->rt_safe_eval (now, valid);
+				const float val = c.list()->rt_safe_eval (now, valid);
 
 				if (valid) {
-					c->set_value(val);
+					c.set_value(val);
 				}
-
 			}
 		}
 	}
@@ -305,12 +329,10 @@ PluginInsert::connect_and_run (BufferSet& bufs, nframes_t nframes, nframes_t off
 
 	}
 
-	for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
-		(*i)->connect_and_run(bufs, in_map, out_map, nframes, offset);
-		for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
-			in_map.offset_to(*t, natural_input_streams().get(*t));
-			out_map.offset_to(*t, natural_output_streams().get(*t));
-		}
+	assert (_in_maps.size() == _plugins.size());
+
+	for (uint32_t n = 0; n < _plugins.size(); ++n) {
+		_plugins[n]->connect_and_run (bufs, _in_maps[n], _out_maps[n], nframes, offset);
 	}
 
 	if (collect_signal_nframes > 0) {
@@ -344,12 +366,14 @@ PluginInsert::connect_and_run (BufferSet& bufs, nframes_t nframes, nframes_t off
 void
 PluginInsert::silence (nframes_t nframes)
 {
-	ChanMapping in_map(input_streams());
-	ChanMapping out_map(output_streams());
+	if (active() && !_in_maps.empty()) {
+
+		/* every instance is fed the same silent buffers, so each gets the
+		   mappings of the first instance.
+		*/
 
-	if (active()) {
 		for (Plugins::iterator i = _plugins.begin(); i != _plugins.end(); ++i) {
-			(*i)->connect_and_run (_session.get_silent_buffers ((*i)->get_info()->n_inputs), in_map, out_map, nframes, 0);
+			(*i)->connect_and_run (_session.get_silent_buffers ((*i)->get_info()->n_inputs), _in_maps.front(), _out_maps.front(), nframes, 0);
 		}
 	}
 }
@@ -421,13 +445,56 @@ PluginInsert::get_parameter (Evoral::Parameter param)
 	}
 }
 
+/** Find the time of the first automation event after now and before end
+ *  in any of the controls in ac.
+ */
+bool
+PluginInsert::find_next_automation_event (AutomatedControls const & ac, nframes_t now, nframes_t end, nframes_t& next) const
+{
+	double next_when = end;
+	Evoral::ControlEvent cp (now, 0.0f);
+
+	for (AutomatedControls::const_iterator c = ac.begin(); c != ac.end(); ++c) {
+
+		if (!(*c)->automation_playback()) {
+			continue;
+		}
+
+		boost::shared_ptr<const Evoral::ControlList> alist ((*c)->list());
+		Evoral::ControlList::const_iterator i;
+
+		for (i = lower_bound (alist->begin(), alist->end(), &cp, Evoral::ControlList::time_comparator);
+		     i != alist->end() && (*i)->when < next_when; ++i) {
+			if ((*i)->when > now) {
+				next_when = (*i)->when;
+				break;
+			}
+		}
+	}
+
+	if (next_when < end) {
+		next = (nframes_t) ceil (next_when);
+		return true;
+	}
+
+	return false;
+}
+
+/** Run our plugins with automation applied.  The cycle is split at
+ *  automation events so that each control takes its automated value at the
+ *  start of each fragment, but (unless plugin-automation-min-slice is 0)
+ *  no fragment is shorter than plugin-automation-min-slice frames: events
+ *  closer together than that are taken together, so dense automation
+ *  follows its curve in steps rather than running the plugins dozens of
+ *  times per cycle.
+ */
 void
 PluginInsert::automation_run (BufferSet& bufs, nframes_t nframes)
 {
-	Evoral::ControlEvent next_event (0, 0.0f);
 	nframes_t now = _session.transport_frame ();
 	nframes_t end = now + nframes;
 	nframes_t offset = 0;
+	nframes_t next;
 
 	Glib::Mutex::Lock lm (control_lock(), Glib::TRY_LOCK);
 
@@ -436,7 +503,14 @@ PluginInsert::automation_run (BufferSet& bufs, nframes_t nframes)
 		return;
 	}
 
-	if (!find_next_event (now, end, next_event)) {
+	boost::shared_ptr<AutomatedControls> ac = _automated_controls.reader ();
+
+	if (ac->empty()) {
+		connect_and_run (bufs, nframes, offset, false);
+		return;
+	}
+
+	if (!find_next_automation_event (*ac, now, end, next)) {
 
 		/* no events have a time within the relevant range */
 
@@ -444,9 +518,20 @@ PluginInsert::automation_run (BufferSet& bufs, nframes_t nframes)
 		return;
 	}
 
+	const nframes_t min_slice = Config->get_plugin_automation_min_slice ();
+
 	while (nframes) {
 
-		nframes_t cnt = min (((nframes_t) ceil (next_event.when) - now), nframes);
+		nframes_t cnt = min (next - now, nframes);
+
+		if (cnt < min_slice) {
+			cnt = min (min_slice, nframes);
+		}
+
+		if (nframes - cnt < min_slice) {
+			/* don't leave a sliver at the end of the cycle */
+			cnt = nframes;
+		}
 
 		connect_and_run (bufs, cnt, offset, true, now);
 
@@ -454,7 +539,7 @@ PluginInsert::automation_run (BufferSet& bufs, nframes_t nframes)
 		offset += cnt;
 		now += cnt;
 
-		if (!find_next_event (now, end, next_event)) {
+		if (!nframes || !find_next_automation_event (*ac, now, end, next)) {
 			break;
 		}
 	}
@@ -536,6 +621,8 @@ PluginInsert::configure_io (ChanCount in, ChanCount out)
 		return false;
 	}
 
+	setup_channel_maps ();
+
 	// we don't know the analysis window size, so we must work with the
 	// current buffer size here. each request for data fills in these
 	// buffers and the analyser makes sure it gets enough data for the
@@ -551,6 +638,31 @@ PluginInsert::configure_io (ChanCount in, ChanCount out)
 	return Processor::configure_io (in, out);
 }
 
+/** Build the buffer mappings for each plugin instance: each instance
+ *  takes its inputs and outputs from the channels after those of the
+ *  instance before it.
+ */
+void
+PluginInsert::setup_channel_maps ()
+{
+	ChanMapping in_map (input_streams ());
+	ChanMapping out_map (output_streams ());
+
+	_in_maps.clear ();
+	_out_maps.clear ();
+
+	for (uint32_t n = 0; n < _plugins.size(); ++n) {
+
+		_in_maps.push_back (in_map);
+		_out_maps.push_back (out_map);
+
+		for (DataType::iterator t = DataType::begin(); t != DataType::end(); ++t) {
+			in_map.offset_to (*t, natural_input_streams().get(*t));
+			out_map.offset_to (*t, natural_output_streams().get(*t));
+		}
+	}
+}
+
 bool
 PluginInsert::can_support_io_configuration (const ChanCount& in, ChanCount& out) const
 {
@@ -810,6 +922,11 @@ PluginInsert::set_state(const XMLNode& node, int version)
 		set_parameter_state (node, version);
 	}
 
+	/* the lists may have been replaced or given a new automation state
+	   without AutomationStateChanged being emitted, so catch up here.
+	*/
+	update_automated_controls ();
+
 	// The name of the PluginInsert comes from the plugin, nothing else
 	_name = plugin->get_info()->name;
 
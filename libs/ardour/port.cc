@@ -23,6 +23,7 @@
 
 #include "ardour/port.h"
 #include "ardour/audioengine.h"
+#include "ardour/dummy_backend.h"
 #include "pbd/failed_constructor.h"
 #include "pbd/error.h"
 #include "pbd/compose.h"
@@ -40,7 +41,9 @@ bool Port::_connecting_blocked = false;
 
 /** @param n Port short name */
 Port::Port (std::string const & n, DataType t, Flags f)
-	: _last_monitor (false)
+	: _jack_port (0)
+	, _dummy_buffer (0)
+	, _last_monitor (false)
 	, _name (n)
 	, _flags (f)
 {
@@ -52,6 +55,12 @@ Port::Port (std::string const & n, DataType t, Flags f)
 
 	assert (_name.find_first_of (':') == std::string::npos);
 
+	if (_engine->dummy_backend ()) {
+		/* no JACK port; connections are just kept in _connections */
+		_dummy_buffer = _engine->dummy_backend()->allocate_port_buffer (t, _flags & IsInput);
+		return;
+	}
+
 	if ((_jack_port = jack_port_register (_engine->jack (), _name.c_str (), t.to_jack_type (), _flags, 0)) == 0) {
 		throw failed_constructor ();
 	}
@@ -60,20 +69,30 @@ Port::Port (std::string const & n, DataType t, Flags f)
 /** Port destructor */
 Port::~Port ()
 {
-	jack_port_unregister (_engine->jack (), _jack_port);
+	if (_jack_port) {
+		jack_port_unregister (_engine->jack (), _jack_port);
+	} else if (_dummy_buffer) {
+		_engine->dummy_backend()->release_port_buffer (_dummy_buffer);
+	}
 }
 
 /** @return true if this port is connected to anything */
 bool
 Port::connected () const
 {
+	if (!_jack_port) {
+		return !_connections.empty ();
+	}
+
 	return (jack_port_connected (_jack_port) != 0);
 }
 
 int
 Port::disconnect_all ()
 {
-	jack_port_disconnect (_engine->jack(), _jack_port);
+	if (_jack_port) {
+		jack_port_disconnect (_engine->jack(), _jack_port);
+	}
 	_connections.clear ();
 
 	return 0;
@@ -85,6 +104,10 @@ Port::disconnect_all ()
 bool
 Port::connected_to (std::string const & o) const
 {
+	if (!_jack_port) {
+		return _connections.find (o) != _connections.end ();
+	}
+
 	return jack_port_connected_to (_jack_port, _engine->make_port_name_non_relative(o).c_str ());
 }
 
@@ -94,6 +117,14 @@ Port::get_connections (std::vector<std::string> & c) const
 {
 	int n = 0;
 
+	if (!_jack_port) {
+		for (std::set<string>::const_iterator i = _connections.begin(); i != _connections.end(); ++i) {
+			c.push_back (_engine->make_port_name_non_relative (*i));
+			++n;
+		}
+		return n;
+	}
+
 	const char** jc = jack_port_get_connections (_jack_port);
 	if (jc) {
 		for (int i = 0; jc[i]; ++i) {
@@ -121,7 +152,9 @@ Port::connect (std::string const & other)
 		return r;
 	}
 
-	if (sends_output ()) {
+	if (!_jack_port) {
+		/* dummy backend: nothing to tell */
+	} else if (sends_output ()) {
 		r = jack_connect (_engine->jack (), this_shrt.c_str (), other_shrt.c_str ());
 	} else {
 		r = jack_connect (_engine->jack (), other_shrt.c_str (), this_shrt.c_str());
@@ -144,7 +177,9 @@ Port::disconnect (std::string const & other)
 
 	int r = 0;
 
-	if (sends_output ()) {
+	if (!_jack_port) {
+		/* dummy backend: nothing to tell */
+	} else if (sends_output ()) {
 		r = jack_disconnect (_engine->jack (), this_shrt.c_str (), other_shrt.c_str ());
 	} else {
 		r = jack_disconnect (_engine->jack (), other_shrt.c_str (), this_shrt.c_str ());
@@ -185,13 +220,15 @@ Port::set_engine (AudioEngine* e)
 void
 Port::ensure_monitor_input (bool yn)
 {
-	jack_port_ensure_monitor (_jack_port, yn);
+	if (_jack_port) {
+		jack_port_ensure_monitor (_jack_port, yn);
+	}
 }
 
 bool
 Port::monitoring_input () const
 {
-	return jack_port_monitoring_input (_jack_port);
+	return _jack_port && jack_port_monitoring_input (_jack_port);
 }
 
 void
@@ -210,7 +247,7 @@ Port::recompute_total_latency () const
 #ifdef HAVE_JACK_RECOMPUTE_LATENCY
 	jack_client_t* jack = _engine->jack();
 
-	if (!jack) {
+	if (!jack || !_jack_port) {
 		return;
 	}
 
@@ -223,7 +260,7 @@ Port::total_latency () const
 {
 	jack_client_t* jack = _engine->jack();
 
-	if (!jack) {
+	if (!jack || !_jack_port) {
 		return 0;
 	}
 
@@ -275,7 +312,7 @@ Port::set_name (std::string const & n)
 		return 0;
 	}
 
-	int const r = jack_port_set_name (_jack_port, n.c_str());
+	int const r = _jack_port ? jack_port_set_name (_jack_port, n.c_str()) : 0;
 
 	if (r == 0) {
 		_name = n;
@@ -287,18 +324,26 @@ Port::set_name (std::string const & n)
 void
 Port::request_monitor_input (bool yn)
 {
-	jack_port_request_monitor (_jack_port, yn);
+	if (_jack_port) {
+		jack_port_request_monitor (_jack_port, yn);
+	}
 }
 
 void
 Port::set_latency (nframes_t n)
 {
-	jack_port_set_latency (_jack_port, n);
+	if (_jack_port) {
+		jack_port_set_latency (_jack_port, n);
+	}
 }
 
 bool
 Port::physically_connected () const
 {
+	if (!_jack_port) {
+		return false;
+	}
+
 	const char** jc = jack_port_get_connections (_jack_port);
 
 	if (jc) {
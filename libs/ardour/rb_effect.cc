@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <cmath>
 
+#include <boost/bind.hpp>
+
 #include "pbd/error.h"
 
 #undef TRUE
@@ -53,7 +55,10 @@ RBStretch::RBStretch (Session& s, TimeFXRequest& req)
 RBEffect::RBEffect (Session& s, TimeFXRequest& req)
 	: Filter (s)
 	, tsr (req)
-
+	, _read_start (0)
+	, _read_duration (0)
+	, _stretch (1)
+	, _shift (1)
 {
 	tsr.progress = 0.0f;
 }
@@ -65,33 +70,37 @@ RBEffect::~RBEffect ()
 int
 RBEffect::run (boost::shared_ptr<Region> r)
 {
-	boost::shared_ptr<AudioRegion> region = boost::dynamic_pointer_cast<AudioRegion> (r);
+	Buffers buffers;
+	int ret = prepare (r);
+
+	if (ret == 0) {
+		ret = process (buffers);
+	}
+
+	return complete (ret);
+}
+
+/** Work out what to do and make the new sources */
+int
+RBEffect::prepare (boost::shared_ptr<Region> r)
+{
+	tsr.progress = 0.0f;
+	tsr.done = false;
 
-	if (!region) {
+	_region = boost::dynamic_pointer_cast<AudioRegion> (r);
+
+	if (!_region) {
 		error << "RBEffect::run() passed a non-audio region! WTF?" << endmsg;
 		return -1;
 	}
 
-	SourceList nsrcs;
-	nframes_t done;
-	int ret = -1;
-	const nframes_t bufsize = 256;
-	gain_t* gain_buffer = 0;
-	Sample** buffers = 0;
-	char suffix[32];
-	string new_name;
-	string::size_type at;
-	nframes_t pos = 0;
-	int avail = 0;
-	boost::shared_ptr<AudioRegion> result;
-	
-	cerr << "RBEffect: source region: position = " << region->position()
-	     << ", start = " << region->start()
-	     << ", length = " << region->length()
-	     << ", ancestral_start = " << region->ancestral_start()
-	     << ", ancestral_length = " << region->ancestral_length()
-	     << ", stretch " << region->stretch()
-	     << ", shift " << region->shift() << endl;
+	cerr << "RBEffect: source region: position = " << _region->position()
+	     << ", start = " << _region->start()
+	     << ", length = " << _region->length()
+	     << ", ancestral_start = " << _region->ancestral_start()
+	     << ", ancestral_length = " << _region->ancestral_length()
+	     << ", stretch " << _region->stretch()
+	     << ", shift " << _region->shift() << endl;
 
 	/*
 	   We have two cases to consider:
@@ -148,241 +157,211 @@ RBEffect::run (boost::shared_ptr<Region> r)
 	   I hope this is clear.
 	*/
 
-	double stretch = region->stretch() * tsr.time_fraction;
-	double shift = region->shift() * tsr.pitch_fraction;
-
-	nframes_t read_start = region->ancestral_start() +
-		nframes_t(region->start() / (double)region->stretch());
-
-	nframes_t read_duration =
-		nframes_t(region->length() / (double)region->stretch());
+	_stretch = _region->stretch() * tsr.time_fraction;
+	_shift = _region->shift() * tsr.pitch_fraction;
 
-	uint32_t channels = region->n_channels();
-
-	RubberBandStretcher stretcher
-		(session.frame_rate(), channels,
-		 (RubberBandStretcher::Options) tsr.opts, stretch, shift);
-
-	tsr.progress = 0.0f;
-	tsr.done = false;
+	_read_start = _region->ancestral_start() +
+		nframes_t(_region->start() / (double)_region->stretch());
 
-	stretcher.setExpectedInputDuration(read_duration);
-	stretcher.setDebugLevel(1);
+	_read_duration =
+		nframes_t(_region->length() / (double)_region->stretch());
 
 	/* the name doesn't need to be super-precise, but allow for 2 fractional
 	   digits just to disambiguate close but not identical FX
 	*/
 
-	if (stretch == 1.0) {
-		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (shift * 100.0f));
-	} else if (shift == 1.0) {
-		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (stretch * 100.0f));
+	char suffix[32];
+
+	if (_stretch == 1.0) {
+		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (_shift * 100.0f));
+	} else if (_shift == 1.0) {
+		snprintf (suffix, sizeof (suffix), "@%d", (int) floor (_stretch * 100.0f));
 	} else {
 		snprintf (suffix, sizeof (suffix), "@%d-%d",
-			  (int) floor (stretch * 100.0f),
-			  (int) floor (shift * 100.0f));
+			  (int) floor (_stretch * 100.0f),
+			  (int) floor (_shift * 100.0f));
 	}
 
-	/* create new sources */
+	_suffix = suffix;
 
-	if (make_new_sources (region, nsrcs, suffix)) {
-		goto out;
-	}
-
-	gain_buffer = new gain_t[bufsize];
-	buffers = new float *[channels];
+	/* create new sources */
 
-	for (uint32_t i = 0; i < channels; ++i) {
-		buffers[i] = new float[bufsize];
-	}
+	return make_new_sources (_region, _new_sources, _suffix);
+}
 
-	/* we read from the master (original) sources for the region,
-	   not the ones currently in use, in case it's already been
-	   subject to timefx.  */
+/** Read a block of each channel of the master sources into buffers */
+static int
+read_master (boost::shared_ptr<AudioRegion> region, Filter::Buffers& buffers, nframes_t read_start, nframes_t pos, nframes_t cnt)
+{
+	nframes_t const position = read_start + pos - region->start() + region->position();
 
-	/* study first, process afterwards. */
+	framecnt_t const this_read = buffers.read
+		(boost::bind (&AudioRegion::master_read_at, region, _1, _1, _2, _3, _4, _5), position, cnt, 0, region->n_channels());
 
-	pos = 0;
-	avail = 0;
-	done = 0;
+	if (this_read != cnt) {
+		error << string_compose
+			(_("tempoize: error reading data from %1 at %2 (wanted %3, got %4)"),
+			 region->name(), position, cnt, this_read) << endmsg;
+		return -1;
+	}
 
-	try {
-		while (pos < read_duration && !tsr.cancel) {
+	return 0;
+}
 
-			nframes_t this_read = 0;
+/** Write what the stretcher has ready to our new sources.
+ *  @param all true to wait for the stretcher to finish.
+ */
+static int
+write_available (RubberBandStretcher& stretcher, SourceList& sources, Filter::Buffers& buffers, nframes_t bufsize, bool all)
+{
+	int avail;
 
-			for (uint32_t i = 0; i < channels; ++i) {
+	while ((avail = stretcher.available()) > 0 || (all && avail == 0)) {
 
-				this_read = 0;
+		nframes_t const this_read = min (bufsize, nframes_t (avail));
 
-				nframes_t this_time;
-				this_time = min(bufsize, read_duration - pos);
+		stretcher.retrieve (&buffers.pointers[0], this_read);
 
-				nframes_t this_position;
-				this_position = read_start + pos -
-					region->start() + region->position();
+		for (uint32_t i = 0; i < sources.size(); ++i) {
 
-				this_read = region->master_read_at
-					(buffers[i],
-					 buffers[i],
-					 gain_buffer,
-					 this_position,
-					 this_time,
-					 i);
+			boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(sources[i]);
+			if (!asrc) {
+				continue;
+			}
 
-				if (this_read != this_time) {
-					error << string_compose
-						(_("tempoize: error reading data from %1 at %2 (wanted %3, got %4)"),
-						 region->name(), this_position, this_time, this_read) << endmsg;
-					goto out;
-				}
+			if (asrc->write (buffers.pointers[i], this_read) != this_read) {
+				error << string_compose (_("error writing tempo-adjusted data to %1"), sources[i]->name()) << endmsg;
+				return -1;
 			}
+		}
+	}
 
-			pos += this_read;
-			done += this_read;
+	return 0;
+}
 
-			tsr.progress = ((float) done / read_duration) * 0.25;
+/** Stretch the region's master sources into our new sources.  This may be
+ *  called while other filters are running.
+ */
+int
+RBEffect::process (Buffers& buffers)
+{
+	const nframes_t bufsize = 8192;
+	uint32_t const channels = _region->n_channels();
 
-			stretcher.study(buffers, this_read, pos == read_duration);
-		}
+	RubberBandStretcher stretcher
+		(session.frame_rate(), channels,
+		 (RubberBandStretcher::Options) tsr.opts, _stretch, _shift);
 
-		done = 0;
-		pos = 0;
+	stretcher.setExpectedInputDuration(_read_duration);
+	stretcher.setDebugLevel(1);
 
-		while (pos < read_duration && !tsr.cancel) {
+	buffers.ensure (channels, bufsize);
 
-			nframes_t this_read = 0;
+	/* we read from the master (original) sources for the region,
+	   not the ones currently in use, in case it's already been
+	   subject to timefx.  */
 
-			for (uint32_t i = 0; i < channels; ++i) {
+	/* study first, process afterwards. */
 
-				this_read = 0;
-				nframes_t this_time;
-				this_time = min(bufsize, read_duration - pos);
+	nframes_t pos = 0;
 
-				nframes_t this_position;
-				this_position = read_start + pos -
-					region->start() + region->position();
+	try {
+		while (pos < _read_duration && !tsr.cancel) {
 
-				this_read = region->master_read_at
-					(buffers[i],
-					 buffers[i],
-					 gain_buffer,
-					 this_position,
-					 this_time,
-					 i);
+			nframes_t const this_read = min (bufsize, _read_duration - pos);
 
-				if (this_read != this_time) {
-					error << string_compose
-						(_("tempoize: error reading data from %1 at %2 (wanted %3, got %4)"),
-						 region->name(), pos + region->position(), this_time, this_read) << endmsg;
-					goto out;
-				}
+			if (read_master (_region, buffers, _read_start, pos, this_read)) {
+				return -1;
 			}
 
 			pos += this_read;
-			done += this_read;
-
-			tsr.progress = 0.25 + ((float) done / read_duration) * 0.75;
-
-			stretcher.process(buffers, this_read, pos == read_duration);
 
-			int avail = 0;
+			tsr.progress = ((float) pos / _read_duration) * 0.25;
 
-			while ((avail = stretcher.available()) > 0) {
-
-				this_read = min(bufsize, uint32_t(avail));
+			stretcher.study (&buffers.pointers[0], this_read, pos == _read_duration);
+		}
 
-				stretcher.retrieve(buffers, this_read);
+		pos = 0;
 
-				for (uint32_t i = 0; i < nsrcs.size(); ++i) {
+		while (pos < _read_duration && !tsr.cancel) {
 
-					boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(nsrcs[i]);
-					if (!asrc) {
-						continue;
-					}
+			nframes_t const this_read = min (bufsize, _read_duration - pos);
 
-					if (asrc->write(buffers[i], this_read) != this_read) {
-						error << string_compose (_("error writing tempo-adjusted data to %1"), nsrcs[i]->name()) << endmsg;
-						goto out;
-					}
-				}
+			if (read_master (_region, buffers, _read_start, pos, this_read)) {
+				return -1;
 			}
-		}
-
-		while ((avail = stretcher.available()) >= 0) {
 
-			uint32_t this_read = min(bufsize, uint32_t(avail));
-
-			stretcher.retrieve(buffers, this_read);
+			pos += this_read;
 
-			for (uint32_t i = 0; i < nsrcs.size(); ++i) {
+			tsr.progress = 0.25 + ((float) pos / _read_duration) * 0.75;
 
-				boost::shared_ptr<AudioSource> asrc = boost::dynamic_pointer_cast<AudioSource>(nsrcs[i]);
-				if (!asrc) {
-					continue;
-				}
+			stretcher.process (&buffers.pointers[0], this_read, pos == _read_duration);
 
-				if (asrc->write(buffers[i], this_read) !=
-				    this_read) {
-					error << string_compose (_("error writing tempo-adjusted data to %1"), nsrcs[i]->name()) << endmsg;
-					goto out;
-				}
+			if (write_available (stretcher, _new_sources, buffers, bufsize, false)) {
+				return -1;
 			}
 		}
 
+		if (!tsr.cancel && write_available (stretcher, _new_sources, buffers, bufsize, true)) {
+			return -1;
+		}
+
 	} catch (runtime_error& err) {
 		error << _("timefx code failure. please notify ardour-developers.") << endmsg;
 		error << err.what() << endmsg;
-		goto out;
+		return -1;
 	}
 
-	new_name = region->name();
-	at = new_name.find ('@');
+	return 0;
+}
 
-	// remove any existing stretch indicator
+/** Make the new region, or clean up if something went wrong.
+ *  @param status 0 if prepare() and process() succeeded.
+ */
+int
+RBEffect::complete (int status)
+{
+	int ret = (tsr.cancel ? -1 : status);
 
-	if (at != string::npos && at > 2) {
-		new_name = new_name.substr (0, at - 1);
-	}
+	if (ret == 0) {
 
-	new_name += suffix;
+		string new_name = _region->name();
+		string::size_type at = new_name.find ('@');
 
-	ret = finish (region, nsrcs, new_name);
+		// remove any existing stretch indicator
 
-	/* now reset ancestral data for each new region */
+		if (at != string::npos && at > 2) {
+			new_name = new_name.substr (0, at - 1);
+		}
 
-	for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
+		new_name += _suffix;
 
-		(*x)->set_ancestral_data (read_start,
-					  read_duration,
-					  stretch,
-					  shift);
-		(*x)->set_master_sources (region->master_sources());
-		(*x)->set_length( (*x)->length() * stretch, this);
-	}
+		ret = finish (_region, _new_sources, new_name);
 
-	/* stretch region gain envelope */
-	/* XXX: assuming we've only processed one input region into one result here */
+		/* now reset ancestral data for each new region */
 
-	if (tsr.time_fraction != 1) {
-		result = boost::dynamic_pointer_cast<AudioRegion> (results.front());
-		assert (result);
-		result->envelope()->x_scale (tsr.time_fraction);
-	}
+		for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
 
-  out:
+			(*x)->set_ancestral_data (_read_start,
+						  _read_duration,
+						  _stretch,
+						  _shift);
+			(*x)->set_master_sources (_region->master_sources());
+			(*x)->set_length( (*x)->length() * _stretch, this);
+		}
 
-	delete [] gain_buffer;
+		/* stretch region gain envelope */
+		/* XXX: assuming we've only processed one input region into one result here */
 
-	if (buffers) {
-		for (uint32_t i = 0; i < channels; ++i) {
-			delete buffers[i];
+		if (tsr.time_fraction != 1) {
+			boost::shared_ptr<AudioRegion> result = boost::dynamic_pointer_cast<AudioRegion> (results.front());
+			assert (result);
+			result->envelope()->x_scale (tsr.time_fraction);
 		}
-		delete [] buffers;
 	}
 
-	if (ret || tsr.cancel) {
-		for (SourceList::iterator si = nsrcs.begin(); si != nsrcs.end(); ++si) {
+	if (ret) {
+		for (SourceList::iterator si = _new_sources.begin(); si != _new_sources.end(); ++si) {
 			(*si)->mark_for_remove ();
 		}
 	}
@@ -391,8 +370,3 @@ RBEffect::run (boost::shared_ptr<Region> r)
 
 	return ret;
 }
-
-
-
-
-
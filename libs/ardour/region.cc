@@ -371,6 +371,7 @@ Region::Region (boost::shared_ptr<const Region> other, const SourceList& srcs)
 	_position_locked = false;
 
 	other->_first_edit = EditChangesName;
+	other->state_changed ();
 
 	if (other->_extra_xml) {
 		_extra_xml = new XMLNode (*other->_extra_xml);
@@ -401,6 +402,7 @@ Region::Region (boost::shared_ptr<const Region> other)
 	_position_locked = false;
 
 	other->_first_edit = EditChangesName;
+	other->state_changed ();
 
 	if (other->_extra_xml) {
 		_extra_xml = new XMLNode (*other->_extra_xml);
@@ -649,6 +651,7 @@ Region::recompute_position_from_lock_style ()
 {
 	if (_position_lock_style == MusicTime) {
 		_session.tempo_map().bbt_time (_position, _bbt_time);
+		state_changed ();
 	}
 }
 
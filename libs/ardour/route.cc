@@ -24,9 +24,10 @@
 
 #include "pbd/xml++.h"
 #include "pbd/enumwriter.h"
-#include "pbd/memento_command.h"
+#include "pbd/delta_memento_command.h"
 #include "pbd/stacktrace.h"
 #include "pbd/convert.h"
+#include "pbd/rt_alloc_check.h"
 
 #include "evoral/Curve.hpp"
 
@@ -54,6 +55,7 @@
 #include "ardour/profile.h"
 #include "ardour/route.h"
 #include "ardour/route_group.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/send.h"
 #include "ardour/session.h"
 #include "ardour/timestamps.h"
@@ -383,66 +385,34 @@ Route::process_output_buffers (BufferSet& bufs,
 
 
 	/* -------------------------------------------------------------------------------------------
-	   GLOBAL DECLICK (for transport changes etc.)
+	   GLOBAL DECLICK (for transport changes etc.), PHASE INVERT and DENORMAL CONTROL,
+	   applied in a single pass over each buffer
 	   ----------------------------------------------------------------------------------------- */
 
+	gain_t declick_ramp[Amp::declick_frames];
+	nframes_t ramp_frames = 0;
+	gain_t gain = 1.0;
+
 	if (declick > 0) {
-		Amp::apply_gain (bufs, nframes, 0.0, 1.0);
+		ramp_frames = Amp::declick_ramp (declick_ramp, nframes, 0.0, 1.0);
+		Amp::apply_gain_to_midi (bufs, nframes, 0.0, 1.0);
 	} else if (declick < 0) {
-		Amp::apply_gain (bufs, nframes, 1.0, 0.0);
+		ramp_frames = Amp::declick_ramp (declick_ramp, nframes, 1.0, 0.0);
+		Amp::apply_gain_to_midi (bufs, nframes, 1.0, 0.0);
+		gain = 0.0;
 	}
 
 	_pending_declick = 0;
 
-	/* -------------------------------------------------------------------------------------------
-	   DENORMAL CONTROL/PHASE INVERT
-	   ----------------------------------------------------------------------------------------- */
-
-	if (_phase_invert) {
-
-		int chn = 0;
-
-		if (_denormal_protection || Config->get_denormal_protection()) {
-
-			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i, ++chn) {
-				Sample* const sp = i->data();
+	float const offset = (_denormal_protection || Config->get_denormal_protection()) ? 1.0e-27f : 0.0f;
 
-				if (_phase_invert & chn) {
-					for (nframes_t nx = 0; nx < nframes; ++nx) {
-						sp[nx]  = -sp[nx];
-						sp[nx] += 1.0e-27f;
-					}
-				} else {
-					for (nframes_t nx = 0; nx < nframes; ++nx) {
-						sp[nx] += 1.0e-27f;
-					}
-				}
-			}
-
-		} else {
+	if (ramp_frames || _phase_invert || offset != 0.0f) {
 
-			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i, ++chn) {
-				Sample* const sp = i->data();
-
-				if (_phase_invert & (1<<chn)) {
-					for (nframes_t nx = 0; nx < nframes; ++nx) {
-						sp[nx] = -sp[nx];
-					}
-				}
-			}
-		}
-
-	} else {
-
-		if (_denormal_protection || Config->get_denormal_protection()) {
-
-			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-				Sample* const sp = i->data();
-				for (nframes_t nx = 0; nx < nframes; ++nx) {
-					sp[nx] += 1.0e-27f;
-				}
-			}
+		uint32_t chn = 0;
 
+		for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i, ++chn) {
+			float const scale = (chn < 32 && (_phase_invert & (1<<chn))) ? -1.0f : 1.0f;
+			scale_and_offset_buffer (i->data(), nframes, declick_ramp, ramp_frames, gain, scale, offset);
 		}
 	}
 
@@ -450,6 +420,10 @@ Route::process_output_buffers (BufferSet& bufs,
 	   and go ....
 	   ----------------------------------------------------------------------------------------- */
 
+	/* no processor may allocate; checked if libpbd was built with --rt-alloc-check */
+
+	PBD::RTAllocCheck rt_alloc_check;
+
 	for (ProcessorList::iterator i = _processors.begin(); i != _processors.end(); ++i) {
 
 		if (bufs.count() != (*i)->input_streams()) {
@@ -3099,7 +3073,7 @@ Route::shift (nframes64_t /*pos*/, nframes64_t /*frames*/)
 	XMLNode &before = _gain_control->get_state ();
 	_gain_control->shift (pos, frames);
 	XMLNode &after = _gain_control->get_state ();
-	_session.add_command (new MementoCommand<AutomationList> (_gain_automation_curve, &before, &after));
+	_session.add_command (new DeltaMementoCommand<AutomationList> (_gain_automation_curve, &before, &after));
 
 	/* pan automation */
 	for (std::vector<StreamPanner*>::iterator i = _panner->begin (); i != _panner->end (); ++i) {
@@ -3107,7 +3081,7 @@ Route::shift (nframes64_t /*pos*/, nframes64_t /*frames*/)
 		XMLNode &before = c.get_state ();
 		c.shift (pos, frames);
 		XMLNode &after = c.get_state ();
-		_session.add_command (new MementoCommand<AutomationList> (c, &before, &after));
+		_session.add_command (new DeltaMementoCommand<AutomationList> (c, &before, &after));
 	}
 
 	/* redirect automation */
@@ -3123,7 +3097,7 @@ Route::shift (nframes64_t /*pos*/, nframes64_t /*frames*/)
 				XMLNode &before = al.get_state ();
 				al.shift (pos, frames);
 				XMLNode &after = al.get_state ();
-				_session.add_command (new MementoCommand<AutomationList> (al, &before, &after));
+				_session.add_command (new DeltaMementoCommand<AutomationList> (al, &before, &after));
 			}
 		}
 	}
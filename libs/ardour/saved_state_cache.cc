@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include "pbd/stateful.h"
+#include "pbd/xml++.h"
+
+#include "ardour/saved_state_cache.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+SavedStateCache::~SavedStateCache ()
+{
+	clear ();
+}
+
+/** @param generation Generation of obj's state; this need not be obj's own
+ *  state_generation() if its state includes that of other objects.
+ *  @return obj's state, as from get_state(); the caller owns it.  If obj's
+ *  generation has not changed since its state was last asked for, this
+ *  is a copy of that state, which is much cheaper to make.
+ */
+XMLNode&
+SavedStateCache::get_state (PBD::Stateful& obj, uint32_t generation)
+{
+	Glib::Mutex::Lock lm (_lock);
+
+	Entries::iterator i = _entries.find (obj.id ());
+
+	if (i != _entries.end()) {
+
+		i->second.used = true;
+
+		if (i->second.generation == generation) {
+			return *(new XMLNode (*i->second.state));
+		}
+
+		delete i->second.state;
+
+	} else {
+		i = _entries.insert (make_pair (obj.id (), Entry ())).first;
+		i->second.used = true;
+	}
+
+	XMLNode& node (obj.get_state ());
+
+	i->second.generation = generation;
+	i->second.state = new XMLNode (node);
+
+	return node;
+}
+
+/** Forget the state of objects which have not been asked for since the
+ *  last call, as they are presumably no longer part of the session.
+ */
+void
+SavedStateCache::sweep ()
+{
+	Glib::Mutex::Lock lm (_lock);
+
+	for (Entries::iterator i = _entries.begin(); i != _entries.end(); ) {
+
+		Entries::iterator tmp = i;
+		++tmp;
+
+		if (!i->second.used) {
+			delete i->second.state;
+			_entries.erase (i);
+		} else {
+			i->second.used = false;
+		}
+
+		i = tmp;
+	}
+}
+
+void
+SavedStateCache::clear ()
+{
+	Glib::Mutex::Lock lm (_lock);
+
+	for (Entries::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		delete i->second.state;
+	}
+
+	_entries.clear ();
+}
@@ -72,6 +72,7 @@
 #include "ardour/midi_playlist.h"
 #include "ardour/midi_region.h"
 #include "ardour/midi_track.h"
+#include "ardour/meter_snapshot.h"
 #include "ardour/midi_ui.h"
 #include "ardour/named_selection.h"
 #include "ardour/process_thread.h"
@@ -84,6 +85,7 @@
 #include "ardour/region_factory.h"
 #include "ardour/return.h"
 #include "ardour/route_group.h"
+#include "ardour/saved_state_cache.h"
 #include "ardour/send.h"
 #include "ardour/session.h"
 #include "ardour/session_directory.h"
@@ -147,6 +149,11 @@ Session::Session (AudioEngine &eng,
 	  _send_timecode_update (false),
 	  route_graph (new Graph(*this)),
 	  routes (new RouteList),
+	  route_index (new RouteIndex),
+	  _meter_snapshot (new MeterSnapshot),
+	  _state_writer (new SessionStateWriter (boost::bind (&Session::state_write_failed, this))),
+	  _saved_state_cache (new SavedStateCache),
+	  _state_write_failed (0),
 	  _total_free_4k_blocks (0),
 	  _bundles (new BundleList),
 	  _bundle_xml_node (0),
@@ -219,8 +226,21 @@ Session::destroy ()
 
 	_state_of_the_state = StateOfTheState (CannotSave|Deletion);
 
+	/* finish any saves that are still being written */
+
+	delete _state_writer;
+	_state_writer = 0;
+
+	delete _saved_state_cache;
+	_saved_state_cache = 0;
+
 	_engine.remove_session ();
 
+	/* the metering thread has stopped, so nobody will update this again */
+
+	delete _meter_snapshot;
+	_meter_snapshot = 0;
+
 	/* clear history so that no references to objects are held any more */
 
 	_history.clear ();
@@ -286,6 +306,8 @@ Session::destroy ()
 		/* writer goes out of scope and updates master */
 	}
 	routes.flush ();
+	rebuild_route_index ();
+	route_index.flush ();
 
 	boost::shared_ptr<RouteList> r = routes.reader ();
 
@@ -1318,6 +1340,8 @@ Session::resort_routes ()
 		/* writer goes out of scope and forces update */
 	}
 
+	rebuild_route_index ();
+
 	//route_graph->dump(1);
 
 #ifndef NDEBUG
@@ -1505,7 +1529,7 @@ Session::new_midi_track (TrackMode mode, RouteGroup* route_group, uint32_t how_m
   failed:
 	if (!new_routes.empty()) {
 		add_routes (new_routes, false);
-		save_state (_current_snapshot_name);
+		save_state (_current_snapshot_name, false, false, true);
 	}
 
 	return ret;
@@ -1891,6 +1915,8 @@ Session::add_routes (RouteList& new_routes, bool save)
 		}
 	}
 
+	rebuild_route_index ();
+
 	for (RouteList::iterator x = new_routes.begin(); x != new_routes.end(); ++x) {
 
 		boost::weak_ptr<Route> wpr (*x);
@@ -1902,6 +1928,8 @@ Session::add_routes (RouteList& new_routes, bool save)
 		r->mute_changed.connect_same_thread (*this, boost::bind (&Session::route_mute_changed, this, _1));
 		r->output()->changed.connect_same_thread (*this, boost::bind (&Session::set_worst_io_latencies_x, this, _1, _2));
 		r->processors_changed.connect_same_thread (*this, boost::bind (&Session::route_processors_changed, this, _1));
+		r->RemoteControlIDChanged.connect_same_thread (*this, boost::bind (&Session::rebuild_route_index, this));
+		r->PropertyChanged.connect_same_thread (*this, boost::bind (&Session::route_property_changed, this, _1));
 
 		if (r->is_master()) {
 			_master_out = r;
@@ -1939,7 +1967,7 @@ Session::add_routes (RouteList& new_routes, bool save)
 	set_dirty();
 
 	if (save) {
-		save_state (_current_snapshot_name);
+		save_state (_current_snapshot_name, false, false, true);
 	}
 
 	RouteAdded (new_routes); /* EMIT SIGNAL */
@@ -2073,6 +2101,8 @@ Session::remove_route (shared_ptr<Route> route)
 		/* writer goes out of scope, forces route list update */
 	}
 
+	rebuild_route_index ();
+
         update_route_solo_state ();
 	update_session_range_location_marker ();
 
@@ -2354,15 +2384,14 @@ Session::io_name_is_legal (const std::string& name)
 shared_ptr<Route>
 Session::route_by_name (string name)
 {
-	shared_ptr<RouteList> r = routes.reader ();
+	shared_ptr<RouteIndex> ri = route_index.reader ();
+	boost::unordered_map<string, boost::weak_ptr<Route> >::const_iterator i = ri->by_name.find (name);
 
-	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
-		if ((*i)->name() == name) {
-			return *i;
-		}
+	if (i == ri->by_name.end()) {
+		return shared_ptr<Route> ((Route*) 0);
 	}
 
-	return shared_ptr<Route> ((Route*) 0);
+	return i->second.lock ();
 }
 
 shared_ptr<Route>
@@ -2381,16 +2410,50 @@ Session::route_by_id (PBD::ID id)
 
 shared_ptr<Route>
 Session::route_by_remote_id (uint32_t id)
+{
+	shared_ptr<RouteIndex> ri = route_index.reader ();
+	boost::unordered_map<uint32_t, boost::weak_ptr<Route> >::const_iterator i = ri->by_remote_id.find (id);
+
+	if (i == ri->by_remote_id.end()) {
+		return shared_ptr<Route> ((Route*) 0);
+	}
+
+	return i->second.lock ();
+}
+
+void
+Session::rebuild_route_index ()
 {
 	shared_ptr<RouteList> r = routes.reader ();
 
+	RCUWriter<RouteIndex> writer (route_index);
+	shared_ptr<RouteIndex> ri = writer.get_copy ();
+
+	ri->by_remote_id.clear ();
+	ri->by_name.clear ();
+
 	for (RouteList::iterator i = r->begin(); i != r->end(); ++i) {
-		if ((*i)->remote_control_id() == id) {
-			return *i;
-		}
+		/* insert() leaves existing entries alone, so the first route with a given key wins */
+		ri->by_remote_id.insert (make_pair ((*i)->remote_control_id(), boost::weak_ptr<Route> (*i)));
+		ri->by_name.insert (make_pair ((*i)->name(), boost::weak_ptr<Route> (*i)));
 	}
 
-	return shared_ptr<Route> ((Route*) 0);
+	/* writer goes out of scope and publishes the new index */
+}
+
+void
+Session::route_property_changed (const PropertyChange& what_changed)
+{
+	if (what_changed.contains (Properties::name)) {
+		rebuild_route_index ();
+	}
+}
+
+/** Called from the metering thread, after all meters have been updated */
+void
+Session::update_meter_snapshot ()
+{
+	_meter_snapshot->update (routes.reader ());
 }
 
 /** If either end of the session range location marker lies inside the current
@@ -2583,6 +2646,9 @@ Session::add_source (boost::shared_ptr<Source> source)
                         if (Config->get_auto_analyse_audio()) {
                                 Analyser::queue_source_for_analysis (source, false);
                         }
+
+                        /* stop analysing the source if it is removed */
+                        source->DropReferences.connect_same_thread (*this, boost::bind (&Analyser::cancel, source->id()));
                 }
         }
 }
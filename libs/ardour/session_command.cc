@@ -20,6 +20,7 @@
 #include "ardour/session.h"
 #include "ardour/route.h"
 #include "pbd/memento_command.h"
+#include "pbd/delta_memento_command.h"
 #include "ardour/diskstream.h"
 #include "ardour/playlist.h"
 #include "ardour/audioplaylist.h"
@@ -165,3 +166,40 @@ Session::stateful_diff_command_factory (XMLNode* n)
 	
 	return 0;
 }
+
+Command *
+Session::delta_memento_command_factory (XMLNode* n)
+{
+	PBD::ID const id (n->property ("obj-id")->value ());
+
+	string const obj_T = n->property ("type-name")->value ();
+
+	if (obj_T == "ARDOUR::Location") {
+		if (Location* loc = _locations.get_location_by_id (id)) {
+			return new DeltaMementoCommand<Location> (*loc, *n);
+		}
+
+	} else if (obj_T == "ARDOUR::Locations") {
+		return new DeltaMementoCommand<Locations> (_locations, *n);
+
+	} else if (obj_T == "ARDOUR::TempoMap") {
+		return new DeltaMementoCommand<TempoMap> (*_tempo_map, *n);
+
+	} else if (obj_T == "Evoral::Curve" || obj_T == "ARDOUR::AutomationList") {
+		std::map<PBD::ID, AutomationList*>::iterator i = automation_lists.find (id);
+		if (i != automation_lists.end()) {
+			return new DeltaMementoCommand<AutomationList> (*i->second, *n);
+		}
+
+	} else if (registry.count (id)) {
+		return new DeltaMementoCommand<PBD::StatefulDestructible> (*registry[id], *n);
+	}
+
+	/* we failed */
+
+	error << string_compose (
+		_("could not reconstitute DeltaMementoCommand from XMLNode. object type = %1 id = %2"), obj_T, id.to_s())
+	      << endmsg;
+
+	return 0;
+}
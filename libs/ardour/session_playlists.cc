@@ -24,6 +24,7 @@
 #include "ardour/session_playlists.h"
 #include "ardour/playlist.h"
 #include "ardour/region.h"
+#include "ardour/saved_state_cache.h"
 #include "ardour/playlist_factory.h"
 #include "ardour/session.h"
 #include "i18n.h"
@@ -271,13 +272,16 @@ SessionPlaylists::update_after_tempo_map_change ()
 	}
 }
 
+/** @param cache if non-0, cache of the state of playlists as they were last saved */
 void
-SessionPlaylists::add_state (XMLNode* node, bool full_state)
+SessionPlaylists::add_state (XMLNode* node, bool full_state, SavedStateCache* cache)
 {
 	XMLNode* child = node->add_child ("Playlists");
 	for (List::iterator i = playlists.begin(); i != playlists.end(); ++i) {
 		if (!(*i)->hidden()) {
-                        if (full_state) {
+                        if (full_state && cache) {
+                                child->add_child_nocopy (cache->get_state (**i, (*i)->full_state_generation ()));
+                        } else if (full_state) {
                                 child->add_child_nocopy ((*i)->get_state());
                         } else {
                                 child->add_child_nocopy ((*i)->get_template());
@@ -289,7 +293,9 @@ SessionPlaylists::add_state (XMLNode* node, bool full_state)
 	for (List::iterator i = unused_playlists.begin(); i != unused_playlists.end(); ++i) {
 		if (!(*i)->hidden()) {
 			if (!(*i)->empty()) {
-				if (full_state) {
+				if (full_state && cache) {
+					child->add_child_nocopy (cache->get_state (**i, (*i)->full_state_generation ()));
+				} else if (full_state) {
 					child->add_child_nocopy ((*i)->get_state());
 				} else {
 					child->add_child_nocopy ((*i)->get_template());
@@ -58,6 +58,7 @@
 
 #include "pbd/boost_debug.h"
 #include "pbd/controllable_descriptor.h"
+#include "pbd/cpus.h"
 #include "pbd/enumwriter.h"
 #include "pbd/error.h"
 #include "pbd/pathscanner.h"
@@ -65,6 +66,7 @@
 #include "pbd/search_path.h"
 #include "pbd/stacktrace.h"
 #include "pbd/convert.h"
+#include "pbd/xml_cache.h"
 
 #include "ardour/amp.h"
 #include "ardour/audio_diskstream.h"
@@ -95,11 +97,13 @@
 #include "ardour/port.h"
 #include "ardour/region_factory.h"
 #include "ardour/route_group.h"
+#include "ardour/saved_state_cache.h"
 #include "ardour/send.h"
 #include "ardour/session.h"
 #include "ardour/session_directory.h"
 #include "ardour/session_metadata.h"
 #include "ardour/session_state_utils.h"
+#include "ardour/session_state_writer.h"
 #include "ardour/session_playlists.h"
 #include "ardour/session_utils.h"
 #include "ardour/silentfilesource.h"
@@ -160,6 +164,7 @@ Session::first_stage_init (string fullpath, string snapshot_name)
 	_name = _current_snapshot_name = snapshot_name;
 
 	set_history_depth (Config->get_history_depth());
+	set_history_memory_budget (Config->get_history_memory_budget());
 
 	_current_frame_rate = _engine.frame_rate ();
 	_nominal_frame_rate = _current_frame_rate;
@@ -609,7 +614,7 @@ void
 Session::maybe_write_autosave()
 {
         if (dirty() && record_status() != Recording) {
-                save_state("", true);
+                save_state("", true, false, true);
         }
 }
 
@@ -620,6 +625,12 @@ Session::remove_pending_capture_state ()
 
 	pending_state_file_path /= legalize_for_path (_current_snapshot_name) + pending_suffix;
 
+	/* a queued pending save must not put the file back after we have removed it */
+
+	if (_state_writer) {
+		_state_writer->wait ();
+	}
+
 	try
 	{
 		sys::remove (pending_state_file_path);
@@ -656,7 +667,11 @@ Session::rename_state (string old_name, string new_name)
 	{
 		error << string_compose(_("could not rename snapshot %1 to %2 (%3)"),
 				old_name, new_name, err.what()) << endmsg;
+		return;
 	}
+
+	/* the cache is still valid for the renamed file, if there is one */
+	::rename ((old_xml_path.to_string() + statecache_suffix).c_str(), (new_xml_path.to_string() + statecache_suffix).c_str());
 }
 
 /** Remove a state file.
@@ -680,8 +695,9 @@ Session::remove_state (string snapshot_name)
 		return;
 	}
 
-	// and delete it
+	// and delete it, along with any cache of it
 	sys::remove (xml_path);
+	::remove ((xml_path.to_string() + statecache_suffix).c_str());
 }
 
 #ifdef HAVE_JACK_SESSION
@@ -737,10 +753,14 @@ Session::jack_session_event (jack_session_event_t * event)
 }
 #endif
 
+/** Save the session's state.
+ *  @param background true to write the state from the state writer's thread, if the
+ *  configuration allows it.  The state itself is always collected before this method
+ *  returns, but a return value of 0 then only means that it was queued for writing.
+ */
 int
-Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot)
+Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot, bool background)
 {
-	XMLTree tree;
 	sys::path xml_path(_session_dir->root_path());
 
 	if (!_writable || (_state_of_the_state & CannotSave)) {
@@ -760,7 +780,10 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 		i->second->session_saved();
         }
 
-	tree.set_root (&get_state());
+	SessionStateWriter::Job* job = new SessionStateWriter::Job;
+
+	job->state = new XMLTree;
+	job->state->set_root (&get_state());
 
 	if (snapshot_name.empty()) {
 		snapshot_name = _current_snapshot_name;
@@ -770,16 +793,14 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 
 	if (!pending) {
 
-		/* proper save: use statefile_suffix (.ardour in English) */
+		/* proper save: use statefile_suffix (.ardour in English), backing up
+		   the old file before it is replaced.
+		*/
 
 		xml_path /= legalize_for_path (snapshot_name) + statefile_suffix;
+		job->backup = true;
 
-		/* make a backup copy of the old file */
-
-		if (sys::exists(xml_path) && !create_backup_file (xml_path)) {
-			// create_backup_file will log the error
-			return -1;
-		}
+		prepare_history (*job, snapshot_name);
 
 	} else {
 
@@ -791,30 +812,55 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 
 	tmp_path /= legalize_for_path (snapshot_name) + temp_suffix;
 
-	// cerr << "actually writing state to " << xml_path.to_string() << endl;
+	job->path = xml_path.to_string ();
+	job->tmp_path = tmp_path.to_string ();
 
-	if (!tree.write (tmp_path.to_string())) {
-		error << string_compose (_("state could not be saved to %1"), tmp_path.to_string()) << endmsg;
-		sys::remove (tmp_path);
-		return -1;
+	if (!pending && Config->get_session_state_cache()) {
+		job->cache_path = job->path + statecache_suffix;
+	}
+
+	if (background && Config->get_background_session_save()) {
+
+		_state_writer->queue (job);
 
 	} else {
 
-		if (rename (tmp_path.to_string().c_str(), xml_path.to_string().c_str()) != 0) {
-			error << string_compose (_("could not rename temporary session file %1 to %2"),
-					tmp_path.to_string(), xml_path.to_string()) << endmsg;
-			sys::remove (tmp_path);
+		/* don't let an earlier, queued save overwrite this one */
+		_state_writer->wait ();
+
+		/* the cache means parsing the file again, so leave it to the
+		   writer's thread rather than keep our caller waiting for it.
+		*/
+
+		SessionStateWriter::Job* cache = 0;
+
+		if (!job->cache_path.empty()) {
+			cache = new SessionStateWriter::Job;
+			cache->path = job->path;
+			cache->cache_path = job->cache_path;
+			job->cache_path.clear ();
+		}
+
+		int const r = SessionStateWriter::write (*job);
+		delete job;
+
+		if (r) {
+			delete cache;
 			return -1;
 		}
+
+		if (cache) {
+			_state_writer->queue (cache);
+		}
 	}
 
 	if (!pending) {
 
-		save_history (snapshot_name);
-
 		bool was_dirty = dirty();
 
 		_state_of_the_state = StateOfTheState (_state_of_the_state & ~Dirty);
+		/* this save supersedes any queued one that failed */
+		g_atomic_int_set (&_state_write_failed, 0);
 
 		if (was_dirty) {
 			DirtyChanged (); /* EMIT SIGNAL */
@@ -826,6 +872,16 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 	return 0;
 }
 
+/** Called from the state writer's thread when a queued save could not be written.
+ *  DirtyChanged must not be emitted from there, so just leave a flag which dirty()
+ *  reports and which set_dirty() folds into our state on its own thread.
+ */
+void
+Session::state_write_failed ()
+{
+	g_atomic_int_set (&_state_write_failed, 1);
+}
+
 int
 Session::restore_state (string snapshot_name)
 {
@@ -886,7 +942,18 @@ Session::load_state (string snapshot_name)
 		_writable = false;
 	}
 
-	if (!state_tree->read (xmlpath.to_string())) {
+	/* use the binary cache of the state file if it is up to date, as it is much quicker to read */
+
+	XMLNode* cached = 0;
+
+	if (!state_was_pending && Config->get_session_state_cache()) {
+		cached = xml_read_cache (xmlpath.to_string(), xmlpath.to_string() + statecache_suffix);
+	}
+
+	if (cached) {
+		state_tree->set_filename (xmlpath.to_string());
+		state_tree->set_root (cached);
+	} else if (!state_tree->read (xmlpath.to_string())) {
 		error << string_compose(_("Could not understand ardour file %1"), xmlpath.to_string()) << endmsg;
 		delete state_tree;
 		state_tree = 0;
@@ -1067,7 +1134,7 @@ Session::state(bool full_state)
                         boost::shared_ptr<Region> r = i->second;
                         /* only store regions not attached to playlists */
                         if (r->playlist() == 0) {
-                                child->add_child_nocopy (r->state (true));
+                                child->add_child_nocopy (_saved_state_cache->get_state (*r, r->state_generation ()));
                         }
                 }
 	}
@@ -1120,7 +1187,7 @@ Session::state(bool full_state)
 		}
 	}
 
-	playlists->add_state (node, full_state);
+	playlists->add_state (node, full_state, full_state ? _saved_state_cache : 0);
 
 	child = node->add_child ("RouteGroups");
 	for (list<RouteGroup *>::iterator i = _route_groups.begin(); i != _route_groups.end(); ++i) {
@@ -1149,6 +1216,11 @@ Session::state(bool full_state)
 		node->add_child_copy (*_extra_xml);
 	}
 
+	if (full_state) {
+		/* forget about anything that was not saved this time round */
+		_saved_state_cache->sweep ();
+	}
+
 	return *node;
 }
 
@@ -1849,25 +1921,160 @@ Session::path_from_region_name (DataType type, string name, string identifier)
 }
 
 
+/** Sources being created by load_sources(), and the state of each */
+struct SourceLoad {
+	enum Result {
+		Created,
+		Failed,   ///< the factory did not produce a source
+		Unusable, ///< the file exists but cannot be used
+		Missing,
+		Deferred  ///< something unexpected was thrown; to be tried again by the loading thread
+	};
+
+	SourceLoad (Session& s, XMLNodeList const & nodes)
+		: session (s)
+		, next (0)
+	{
+		for (XMLNodeConstIterator i = nodes.begin(); i != nodes.end(); ++i) {
+			node.push_back (*i);
+		}
+
+		source.resize (node.size ());
+		result.resize (node.size (), Failed);
+		messages.resize (node.size ());
+	}
+
+	Session& session;
+	std::vector<XMLNode const *> node;
+	std::vector<boost::shared_ptr<Source> > source;
+	std::vector<Result> result;
+	std::vector<TransmitterMessages> messages; ///< anything said while creating each source
+	gint next; ///< index of the next node to be picked up by a thread
+};
+
+/** Create the source for one of a SourceLoad's nodes, noting the failures
+ *  that we expect.  Anything else that is thrown is passed on.
+ */
+static void
+create_source (SourceLoad* load, uint32_t i)
+{
+	try {
+		/* note: do peak building in another thread when loading session state */
+		load->source[i] = SourceFactory::create (load->session, *load->node[i], true, false);
+		load->result[i] = load->source[i] ? SourceLoad::Created : SourceLoad::Failed;
+	}
+
+	catch (MissingSource& err) {
+		load->result[i] = SourceLoad::Missing;
+	}
+
+	catch (failed_constructor& err) {
+		load->result[i] = SourceLoad::Unusable;
+	}
+}
+
+/** Create sources for a SourceLoad's nodes until there are none left.  This is
+ *  run by several threads at once, so that the time spent opening files and
+ *  checking their peaks overlaps.  Nothing is announced to the session here,
+ *  and any messages are held back for load_sources() to deliver.
+ */
+static void
+load_sources_work (SourceLoad* load)
+{
+	while (true) {
+
+		uint32_t const i = g_atomic_int_exchange_and_add (&load->next, 1);
+
+		if (i >= load->node.size()) {
+			break;
+		}
+
+		if (load->node[i]->name() != "Source") {
+			continue;
+		}
+
+		Transmitter::hold_messages (&load->messages[i]);
+
+		try {
+			create_source (load, i);
+		}
+
+		catch (...) {
+			/* we cannot throw this on from here, so forget about it and
+			   leave the source for load_sources() to create again; then
+			   whatever is thrown will reach its caller.
+			*/
+			load->result[i] = SourceLoad::Deferred;
+			load->messages[i] = TransmitterMessages ();
+		}
+
+		Transmitter::hold_messages (0);
+	}
+}
+
 int
 Session::load_sources (const XMLNode& node)
 {
-	XMLNodeList nlist;
-	XMLNodeConstIterator niter;
-	boost::shared_ptr<Source> source;
-
-	nlist = node.children();
+	SourceLoad load (*this, node.children ());
 
 	set_dirty();
 
-	for (niter = nlist.begin(); niter != nlist.end(); ++niter) {
+	/* most of the work of loading a source is waiting for its files, so use
+	   a few threads even on a machine with few processors.  This thread
+	   does its share too.
+	*/
+
+	uint32_t threads = min (max (hardware_concurrency (), (uint32_t) 4), (uint32_t) 16);
+	threads = min (threads, (uint32_t) (load.node.size() / 16) + 1);
+
+	vector<Glib::Thread*> workers;
+
+	for (uint32_t i = 1; i < threads; ++i) {
 		try {
-			if ((source = XMLSourceFactory (**niter)) == 0) {
-				error << _("Session: cannot create Source from XML description.") << endmsg;
-			}
-		} catch (MissingSource& err) {
+			workers.push_back (Glib::Thread::create (boost::bind (load_sources_work, &load), true));
+		} catch (Glib::ThreadError& err) {
+			break;
+		}
+	}
+
+	load_sources_work (&load);
+
+	for (vector<Glib::Thread*>::iterator i = workers.begin(); i != workers.end(); ++i) {
+		(*i)->join ();
+	}
+
+	/* now tell everyone about the new sources, in the order in which they
+	   appear in the session file, and report any problems.
+	*/
+
+	for (size_t i = 0; i < load.node.size(); ++i) {
+
+		load.messages[i].deliver ();
+
+		if (load.result[i] == SourceLoad::Deferred) {
+			create_source (&load, i);
+		}
+
+		switch (load.result[i]) {
+		case SourceLoad::Created:
+			SourceFactory::SourceCreated (load.source[i]);
+			break;
+
+		case SourceLoad::Unusable:
+			error << string_compose (_("Found a sound file that cannot be used by %1. Talk to the progammers."), PROGRAM_NAME) << endmsg;
+			/* fallthrough */
+		case SourceLoad::Failed:
+			error << _("Session: cannot create Source from XML description.") << endmsg;
+			break;
+
+		case SourceLoad::Missing:
 			warning << _("A sound file is missing. It will be replaced by silence.") << endmsg;
-			source = SourceFactory::createSilent (*this, **niter, max_frames, _current_frame_rate);
+			SourceFactory::createSilent (*this, *load.node[i], max_frames, _current_frame_rate);
+			break;
+
+		case SourceLoad::Deferred:
+			/* not after create_source() above */
+			break;
 		}
 	}
 
@@ -2193,7 +2400,7 @@ Session::load_route_groups (const XMLNode& node, int version)
 void
 Session::auto_save()
 {
-	save_state (_current_snapshot_name);
+	save_state (_current_snapshot_name, false, false, true);
 }
 
 static bool
@@ -2770,9 +2977,10 @@ Session::cleanup_trash_sources (CleanupReport& rep)
 void
 Session::set_dirty ()
 {
-	bool was_dirty = dirty();
+	bool was_dirty = _state_of_the_state & Dirty;
 
 	_state_of_the_state = StateOfTheState (_state_of_the_state | Dirty);
+	g_atomic_int_set (&_state_write_failed, 0);
 
 
 	if (!was_dirty) {
@@ -2787,6 +2995,7 @@ Session::set_clean ()
 	bool was_dirty = dirty();
 
 	_state_of_the_state = Clean;
+	g_atomic_int_set (&_state_write_failed, 0);
 
 
 	if (was_dirty) {
@@ -2987,8 +3196,6 @@ Session::instant_xml (const string& node_name)
 int
 Session::save_history (string snapshot_name)
 {
-	XMLTree tree;
-
 	if (!_writable) {
 	        return 0;
 	}
@@ -2997,48 +3204,30 @@ Session::save_history (string snapshot_name)
 		snapshot_name = _current_snapshot_name;
 	}
 
-	const string history_filename = legalize_for_path (snapshot_name) + history_suffix;
-	const string backup_filename = history_filename + backup_suffix;
-	const sys::path xml_path = _session_dir->root_path() / history_filename;
-	const sys::path backup_path = _session_dir->root_path() / backup_filename;
+	SessionStateWriter::Job job;
+	prepare_history (job, snapshot_name);
 
-	if (sys::exists (xml_path)) {
-		try
-		{
-			sys::rename (xml_path, backup_path);
-		}
-		catch (const sys::filesystem_error& err)
-		{
-			error << _("could not backup old history file, current history not saved") << endmsg;
-			return -1;
-		}
-	}
+	_state_writer->wait ();
 
-	if (!Config->get_save_history() || Config->get_saved_history_depth() < 0) {
-		return 0;
-	}
-
-	tree.set_root (&_history.get_state (Config->get_saved_history_depth()));
+	return SessionStateWriter::write_history (job);
+}
 
-	if (!tree.write (xml_path.to_string()))
-	{
-		error << string_compose (_("history could not be saved to %1"), xml_path.to_string()) << endmsg;
+/** Set up a state writer job to save our history alongside a snapshot */
+void
+Session::prepare_history (SessionStateWriter::Job& job, string const & snapshot_name)
+{
+	const string history_filename = legalize_for_path (snapshot_name) + history_suffix;
+	const string backup_filename = history_filename + backup_suffix;
 
-		try
-		{
-			sys::remove (xml_path);
-			sys::rename (backup_path, xml_path);
-		}
-		catch (const sys::filesystem_error& err)
-		{
-			error << string_compose (_("could not restore history file from backup %1 (%2)"),
-					backup_path.to_string(), err.what()) << endmsg;
-		}
+	job.history_path = (_session_dir->root_path() / history_filename).to_string ();
+	job.history_backup_path = (_session_dir->root_path() / backup_filename).to_string ();
 
-		return -1;
+	if (!Config->get_save_history() || Config->get_saved_history_depth() < 0) {
+		return;
 	}
 
-	return 0;
+	job.history = new XMLTree;
+	job.history->set_root (&_history.get_state (Config->get_saved_history_depth()));
 }
 
 int
@@ -3111,6 +3300,10 @@ Session::restore_history (string snapshot_name)
 				if ((c = stateful_diff_command_factory (n))) {
 					ut->add_command (c);
 				}
+			} else if (n->name() == "DeltaMementoCommand") {
+				if ((c = delta_memento_command_factory (n))) {
+					ut->add_command (c);
+				}
 			} else {
 				error << string_compose(_("Couldn't figure out how to make a Command out of a %1 XMLNode."), n->name()) << endmsg;
 			}
@@ -3307,6 +3500,8 @@ Session::config_changed (std::string p, bool ours)
 		setup_fpu ();
 	} else if (p == "history-depth") {
 		set_history_depth (Config->get_history_depth());
+	} else if (p == "history-memory-budget") {
+		set_history_memory_budget (Config->get_history_memory_budget());
 	} else if (p == "sync-all-route-ordering") {
 		sync_order_keys ("session");
 	} else if (p == "initial-program-change") {
@@ -3346,6 +3541,13 @@ Session::set_history_depth (uint32_t d)
 	_history.set_depth (d);
 }
 
+/** @param mb Memory budget for the undo history, in megabytes, or 0 for no limit */
+void
+Session::set_history_memory_budget (uint32_t mb)
+{
+	_history.set_memory_budget ((size_t) mb * 1048576);
+}
+
 int
 Session::load_diskstreams_2X (XMLNode const & node, int)
 {
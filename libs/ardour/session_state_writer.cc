@@ -0,0 +1,256 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cstdio>
+
+#include "pbd/compose.h"
+#include "pbd/error.h"
+#include "pbd/filesystem.h"
+#include "pbd/pthread_utils.h"
+#include "pbd/xml++.h"
+#include "pbd/xml_cache.h"
+
+#include "ardour/session_state_utils.h"
+#include "ardour/session_state_writer.h"
+
+#include "i18n.h"
+
+using namespace std;
+using namespace ARDOUR;
+using namespace PBD;
+
+SessionStateWriter::Job::Job ()
+	: state (0)
+	, backup (false)
+	, history (0)
+{
+}
+
+SessionStateWriter::Job::~Job ()
+{
+	delete state;
+	delete history;
+}
+
+SessionStateWriter::SessionStateWriter (boost::function<void()> failed)
+	: _failed (failed)
+	, _thread (0)
+	, _running (false)
+	, _quit (false)
+	, _busy (false)
+{
+}
+
+/** Finishes any queued writes before returning */
+SessionStateWriter::~SessionStateWriter ()
+{
+	{
+		Glib::Mutex::Lock lm (_lock);
+
+		if (!_running) {
+			return;
+		}
+
+		_quit = true;
+		_work.signal ();
+	}
+
+	void* status;
+	pthread_join (_thread, &status);
+}
+
+/** Queue a job to be written by our thread.  If the job has state, any
+ *  queued job for the same file which has not yet been started is dropped,
+ *  as this one supersedes it.
+ *  @param job Job; we take ownership of it.
+ */
+void
+SessionStateWriter::queue (Job* job)
+{
+	Glib::Mutex::Lock lm (_lock);
+
+	if (!_running) {
+		if (pthread_create_and_store (X_("state writer"), &_thread, _thread_work, this)) {
+			error << _("SessionStateWriter: could not create thread; writing state now") << endmsg;
+			lm.release ();
+			if (write (*job)) {
+				_failed ();
+			}
+			delete job;
+			return;
+		}
+		_running = true;
+	}
+
+	for (list<Job*>::iterator i = _jobs.begin(); i != _jobs.end(); ) {
+		list<Job*>::iterator tmp = i;
+		++tmp;
+		if (job->state && (*i)->path == job->path) {
+			delete *i;
+			_jobs.erase (i);
+		}
+		i = tmp;
+	}
+
+	_jobs.push_back (job);
+	_work.signal ();
+}
+
+/** Wait until all queued jobs have been written */
+void
+SessionStateWriter::wait ()
+{
+	Glib::Mutex::Lock lm (_lock);
+
+	while (!_jobs.empty() || _busy) {
+		_done.wait (_lock);
+	}
+}
+
+void*
+SessionStateWriter::_thread_work (void* arg)
+{
+	pthread_set_name (X_("state writer"));
+	static_cast<SessionStateWriter*> (arg)->thread_work ();
+	return 0;
+}
+
+void
+SessionStateWriter::thread_work ()
+{
+	Glib::Mutex::Lock lm (_lock);
+
+	while (true) {
+
+		while (_jobs.empty() && !_quit) {
+			_work.wait (_lock);
+		}
+
+		if (_jobs.empty()) {
+			break;
+		}
+
+		Job* job = _jobs.front ();
+		_jobs.pop_front ();
+		_busy = true;
+
+		lm.release ();
+
+		if (write (*job)) {
+			_failed ();
+		}
+
+		delete job;
+
+		lm.acquire ();
+
+		_busy = false;
+		_done.broadcast ();
+	}
+}
+
+/** Write a job's session state, its cache and then its history.
+ *  @return 0 on success, -1 if the session state could not be written.
+ */
+int
+SessionStateWriter::write (Job& job)
+{
+	if (job.state) {
+
+		sys::path const xml_path (job.path);
+		sys::path const tmp_path (job.tmp_path);
+
+		/* make a backup copy of the old file */
+
+		if (job.backup && sys::exists (xml_path) && !create_backup_file (xml_path)) {
+			// create_backup_file will log the error
+			return -1;
+		}
+
+		if (!job.state->write (tmp_path.to_string())) {
+			error << string_compose (_("state could not be saved to %1"), tmp_path.to_string()) << endmsg;
+			sys::remove (tmp_path);
+			return -1;
+		}
+
+		if (rename (tmp_path.to_string().c_str(), xml_path.to_string().c_str()) != 0) {
+			error << string_compose (_("could not rename temporary session file %1 to %2"),
+						 tmp_path.to_string(), xml_path.to_string()) << endmsg;
+			sys::remove (tmp_path);
+			return -1;
+		}
+	}
+
+	if (!job.cache_path.empty() && !xml_write_cache (job.path, job.cache_path)) {
+		/* not fatal; the session will just be loaded from its XML next time */
+		warning << string_compose (_("could not write session state cache %1"), job.cache_path) << endmsg;
+	}
+
+	write_history (job);
+
+	return 0;
+}
+
+/** Move the old history file aside and write a job's history, if it has any */
+int
+SessionStateWriter::write_history (Job& job)
+{
+	if (job.history_path.empty()) {
+		return 0;
+	}
+
+	sys::path const xml_path (job.history_path);
+	sys::path const backup_path (job.history_backup_path);
+
+	if (sys::exists (xml_path)) {
+		try
+		{
+			sys::rename (xml_path, backup_path);
+		}
+		catch (const sys::filesystem_error& err)
+		{
+			error << _("could not backup old history file, current history not saved") << endmsg;
+			return -1;
+		}
+	}
+
+	if (!job.history) {
+		return 0;
+	}
+
+	if (!job.history->write (xml_path.to_string()))
+	{
+		error << string_compose (_("history could not be saved to %1"), xml_path.to_string()) << endmsg;
+
+		try
+		{
+			sys::remove (xml_path);
+			sys::rename (backup_path, xml_path);
+		}
+		catch (const sys::filesystem_error& err)
+		{
+			error << string_compose (_("could not restore history file from backup %1 (%2)"),
+					backup_path.to_string(), err.what()) << endmsg;
+		}
+
+		return -1;
+	}
+
+	return 0;
+}
@@ -577,7 +577,7 @@ Session::non_realtime_stop (bool abort, int on_entry, bool& finished)
 	/* save the current state of things if appropriate */
 
 	if (did_record && !saved) {
-		save_state (_current_snapshot_name);
+		save_state (_current_snapshot_name, false, false, true);
 	}
 
 	if (ptw & PostTransportStop) {
@@ -37,6 +37,7 @@
 #include "ardour/utils.h"
 #include "ardour/version.h"
 #include "ardour/rc_configuration.h"
+#include "ardour/runtime_functions.h"
 #include "ardour/session.h"
 
 #include "i18n.h"
@@ -273,7 +274,6 @@ framecnt_t
 SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) const
 {
 	int32_t nread;
-	float *ptr;
 	uint32_t real_cnt;
 	framepos_t file_cnt;
 
@@ -335,15 +335,9 @@ SndFileSource::read_unlocked (Sample *dst, framepos_t start, framecnt_t cnt) con
 	Sample* interleave_buf = get_interleave_buffer (real_cnt);
 
 	nread = sf_read_float (sf, interleave_buf, real_cnt);
-	ptr = interleave_buf + _channel;
 	nread /= _info.channels;
 
-	/* stride through the interleaved data */
-
-	for (int32_t n = 0; n < nread; ++n) {
-		dst[n] = *ptr;
-		ptr += _info.channels;
-	}
+	deinterleave (dst, interleave_buf, _info.channels, _channel, nread);
 
 	_read_data_count = cnt * sizeof(float);
 
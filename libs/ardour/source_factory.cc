@@ -132,7 +132,7 @@ SourceFactory::createSilent (Session& s, const XMLNode& node, nframes_t nframes,
 }
 
 boost::shared_ptr<Source>
-SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
+SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks, bool announce)
 {
 	DataType type = DataType::AUDIO;
 	const XMLProperty* prop = node.property("type");
@@ -152,7 +152,9 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 				return boost::shared_ptr<Source>();
 			}
 			ret->check_for_analysis_data_on_disk ();
-			SourceCreated (ret);
+			if (announce) {
+				SourceCreated (ret);
+			}
 			return ret;
 		}
 
@@ -171,7 +173,9 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 			}
 
 			ret->check_for_analysis_data_on_disk ();
-			SourceCreated (ret);
+			if (announce) {
+				SourceCreated (ret);
+			}
 			return ret;
 #else
 			throw; // rethrow
@@ -183,7 +187,9 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 		// boost_debug_shared_ptr_mark_interesting (src, "Source");
 		boost::shared_ptr<Source> ret (src);
 		ret->check_for_analysis_data_on_disk ();
-		SourceCreated (ret);
+		if (announce) {
+			SourceCreated (ret);
+		}
 		return ret;
 	}
 
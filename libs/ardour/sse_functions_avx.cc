@@ -0,0 +1,368 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* This file is compiled with -mavx; nothing in it may be called unless
+   PBD::FPU::has_avx() is true.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include <immintrin.h>
+#include "ardour/types.h"
+
+/* fold eight lanes into one */
+
+static inline float
+horizontal_max (__m256 v)
+{
+	__m128 p = _mm_max_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	p = _mm_max_ps (p, _mm_movehl_ps (p, p));
+	p = _mm_max_ss (p, _mm_shuffle_ps (p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32 (p);
+}
+
+static inline float
+horizontal_min (__m256 v)
+{
+	__m128 p = _mm_min_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+	p = _mm_min_ps (p, _mm_movehl_ps (p, p));
+	p = _mm_min_ss (p, _mm_shuffle_ps (p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32 (p);
+}
+
+float
+x86_sse_avx_compute_peak (const ARDOUR::Sample * buf, ARDOUR::nframes_t nsamples, float current)
+{
+	const __m256 abs_mask = _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+	__m256 peak = _mm256_set1_ps (current);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 16 <= nsamples; i += 16) {
+		peak = _mm256_max_ps (peak, _mm256_and_ps (_mm256_loadu_ps (buf + i), abs_mask));
+		peak = _mm256_max_ps (peak, _mm256_and_ps (_mm256_loadu_ps (buf + i + 8), abs_mask));
+	}
+
+	current = horizontal_max (peak);
+
+	for (; i < nsamples; ++i) {
+		current = std::max (current, fabsf (buf[i]));
+	}
+
+	_mm256_zeroupper ();
+	return current;
+}
+
+void
+x86_sse_avx_find_peaks (const ARDOUR::Sample * buf, ARDOUR::nframes_t nsamples, float *min, float *max)
+{
+	__m256 vmin = _mm256_set1_ps (*min);
+	__m256 vmax = _mm256_set1_ps (*max);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nsamples; i += 8) {
+		const __m256 work = _mm256_loadu_ps (buf + i);
+		vmin = _mm256_min_ps (vmin, work);
+		vmax = _mm256_max_ps (vmax, work);
+	}
+
+	float a = horizontal_max (vmax);
+	float b = horizontal_min (vmin);
+
+	for (; i < nsamples; ++i) {
+		a = std::max (a, buf[i]);
+		b = std::min (b, buf[i]);
+	}
+
+	*max = a;
+	*min = b;
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_apply_gain_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, float gain)
+{
+	const __m256 g = _mm256_set1_ps (gain);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm256_storeu_ps (buf + i, _mm256_mul_ps (_mm256_loadu_ps (buf + i), g));
+		_mm256_storeu_ps (buf + i + 8, _mm256_mul_ps (_mm256_loadu_ps (buf + i + 8), g));
+	}
+
+	for (; i < nframes; ++i) {
+		buf[i] *= gain;
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_mix_buffers_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain)
+{
+	const __m256 g = _mm256_set1_ps (gain);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm256_storeu_ps (dst + i, _mm256_add_ps (_mm256_loadu_ps (dst + i), _mm256_mul_ps (_mm256_loadu_ps (src + i), g)));
+		_mm256_storeu_ps (dst + i + 8, _mm256_add_ps (_mm256_loadu_ps (dst + i + 8), _mm256_mul_ps (_mm256_loadu_ps (src + i + 8), g)));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] += src[i] * gain;
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_mix_buffers_no_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes)
+{
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm256_storeu_ps (dst + i, _mm256_add_ps (_mm256_loadu_ps (dst + i), _mm256_loadu_ps (src + i)));
+		_mm256_storeu_ps (dst + i + 8, _mm256_add_ps (_mm256_loadu_ps (dst + i + 8), _mm256_loadu_ps (src + i + 8)));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] += src[i];
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * gains)
+{
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm256_storeu_ps (buf + i, _mm256_mul_ps (_mm256_loadu_ps (buf + i), _mm256_loadu_ps (gains + i)));
+	}
+
+	for (; i < nframes; ++i) {
+		buf[i] *= gains[i];
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_copy_buffer_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain)
+{
+	const __m256 g = _mm256_set1_ps (gain);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm256_storeu_ps (dst + i, _mm256_mul_ps (_mm256_loadu_ps (src + i), g));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] = src[i] * gain;
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_compute_meter (const ARDOUR::Sample * const * bufs, uint32_t nchannels, ARDOUR::nframes_t nframes, float *peaks, float *powers)
+{
+	const __m256 abs_mask = _mm256_castsi256_ps (_mm256_set1_epi32 (0x7fffffff));
+
+	for (uint32_t c = 0; c < nchannels; ++c) {
+
+		const ARDOUR::Sample* buf = bufs[c];
+		ARDOUR::nframes_t n = nframes;
+
+		__m256 peak = _mm256_set1_ps (peaks[c]);
+		__m256 power = _mm256_setzero_ps ();
+		__m256 work;
+
+		float tail_peak = peaks[c];
+		float tail_power = 0.0f;
+
+		/* JACK and our own buffers are at least 16 byte aligned, so go
+		   scalar only until 32 byte alignment.
+		*/
+
+		while (((uintptr_t) buf) % 32 != 0 && n > 0) {
+			tail_peak = std::max (tail_peak, fabsf (*buf));
+			tail_power += *buf * *buf;
+			++buf;
+			--n;
+		}
+
+		if (powers) {
+			while (n >= 8) {
+				work = _mm256_load_ps (buf);
+				peak = _mm256_max_ps (peak, _mm256_and_ps (work, abs_mask));
+				power = _mm256_add_ps (power, _mm256_mul_ps (work, work));
+				buf += 8;
+				n -= 8;
+			}
+		} else {
+			while (n >= 16) {
+				peak = _mm256_max_ps (peak, _mm256_and_ps (_mm256_load_ps (buf), abs_mask));
+				peak = _mm256_max_ps (peak, _mm256_and_ps (_mm256_load_ps (buf + 8), abs_mask));
+				buf += 16;
+				n -= 16;
+			}
+		}
+
+		while (n > 0) {
+			tail_peak = std::max (tail_peak, fabsf (*buf));
+			tail_power += *buf * *buf;
+			++buf;
+			--n;
+		}
+
+		peaks[c] = std::max (horizontal_max (peak), tail_peak);
+
+		if (powers) {
+			__m128 s = _mm_add_ps (_mm256_castps256_ps128 (power), _mm256_extractf128_ps (power, 1));
+			s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+			s = _mm_add_ss (s, _mm_shuffle_ps (s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+			powers[c] += _mm_cvtss_f32 (s) + tail_power;
+		}
+	}
+
+	/* avoid the SSE/AVX transition penalty in whatever runs next */
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_pan_buffers (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes)
+{
+	/* as x86_sse_pan_buffers, eight frames at a time */
+
+	for (uint32_t o = 0; o < nouts; o += 2) {
+
+		const bool pair = (o + 1 < nouts);
+		ARDOUR::Sample * const a = dsts[o];
+		ARDOUR::Sample * const b = pair ? dsts[o+1] : 0;
+		const __m256 ga = _mm256_set1_ps (gains[o]);
+		const __m256 gb = _mm256_set1_ps (pair ? gains[o+1] : 0.0f);
+		ARDOUR::nframes_t i = 0;
+
+		if (pair) {
+			for (; i + 8 <= nframes; i += 8) {
+				const __m256 s = _mm256_loadu_ps (src + i);
+				_mm256_storeu_ps (a + i, _mm256_add_ps (_mm256_loadu_ps (a + i), _mm256_mul_ps (s, ga)));
+				_mm256_storeu_ps (b + i, _mm256_add_ps (_mm256_loadu_ps (b + i), _mm256_mul_ps (s, gb)));
+			}
+			for (; i < nframes; ++i) {
+				a[i] += src[i] * gains[o];
+				b[i] += src[i] * gains[o+1];
+			}
+		} else {
+			for (; i + 8 <= nframes; i += 8) {
+				_mm256_storeu_ps (a + i, _mm256_add_ps (_mm256_loadu_ps (a + i), _mm256_mul_ps (_mm256_loadu_ps (src + i), ga)));
+			}
+			for (; i < nframes; ++i) {
+				a[i] += src[i] * gains[o];
+			}
+		}
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_pan_equal_power_stereo (ARDOUR::Sample * left, ARDOUR::Sample * right, const ARDOUR::Sample * src, const ARDOUR::pan_t * positions,
+				    ARDOUR::nframes_t nframes, float scale, float gain)
+{
+	const __m256 one = _mm256_set1_ps (1.0f);
+	const __m256 s = _mm256_set1_ps (scale);
+	const __m256 offset = _mm256_set1_ps (1.0f - scale);
+	const __m256 g = _mm256_set1_ps (gain);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		const __m256 panR = _mm256_loadu_ps (positions + i);
+		const __m256 panL = _mm256_sub_ps (one, panR);
+		const __m256 in = _mm256_mul_ps (_mm256_loadu_ps (src + i), g);
+
+		const __m256 cl = _mm256_mul_ps (panL, _mm256_add_ps (_mm256_mul_ps (s, panL), offset));
+		const __m256 cr = _mm256_mul_ps (panR, _mm256_add_ps (_mm256_mul_ps (s, panR), offset));
+
+		_mm256_storeu_ps (left + i, _mm256_add_ps (_mm256_loadu_ps (left + i), _mm256_mul_ps (in, cl)));
+		_mm256_storeu_ps (right + i, _mm256_add_ps (_mm256_loadu_ps (right + i), _mm256_mul_ps (in, cr)));
+	}
+
+	for (; i < nframes; ++i) {
+		const float panR = positions[i];
+		const float panL = 1.0f - panR;
+
+		left[i] += src[i] * gain * (panL * (scale * panL + 1.0f - scale));
+		right[i] += src[i] * gain * (panR * (scale * panR + 1.0f - scale));
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_scale_and_offset_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * ramp, ARDOUR::nframes_t ramp_frames,
+				     float gain, float scale, float offset)
+{
+	const __m256 s = _mm256_set1_ps (scale);
+	const __m256 o = _mm256_set1_ps (offset);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= ramp_frames; i += 8) {
+		_mm256_storeu_ps (buf + i, _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (buf + i), _mm256_mul_ps (_mm256_loadu_ps (ramp + i), s)), o));
+	}
+
+	for (; i < ramp_frames; ++i) {
+		buf[i] = buf[i] * (ramp[i] * scale) + offset;
+	}
+
+	const float g = gain * scale;
+	const __m256 gs = _mm256_set1_ps (g);
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm256_storeu_ps (buf + i, _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (buf + i), gs), o));
+		_mm256_storeu_ps (buf + i + 8, _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (buf + i + 8), gs), o));
+	}
+
+	for (; i < nframes; ++i) {
+		buf[i] = buf[i] * g + offset;
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_sse_avx_crossfade_buffers (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains,
+			       const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes)
+{
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm256_storeu_ps (dst + i, _mm256_add_ps (_mm256_mul_ps (_mm256_loadu_ps (out + i), _mm256_loadu_ps (out_gains + i)),
+							  _mm256_mul_ps (_mm256_loadu_ps (in + i), _mm256_loadu_ps (in_gains + i))));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] = out[i] * out_gains[i] + in[i] * in_gains[i];
+	}
+
+	_mm256_zeroupper ();
+}
@@ -0,0 +1,100 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+/* This file is compiled with -mavx -mfma; nothing in it may be called
+   unless PBD::FPU::has_fma() is true.  Only the multiply-accumulate
+   kernels are here; everything else is as fast with plain AVX.
+*/
+
+#include <stdint.h>
+#include <immintrin.h>
+#include "ardour/types.h"
+
+void
+x86_fma_mix_buffers_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain)
+{
+	const __m256 g = _mm256_set1_ps (gain);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 16 <= nframes; i += 16) {
+		_mm256_storeu_ps (dst + i, _mm256_fmadd_ps (_mm256_loadu_ps (src + i), g, _mm256_loadu_ps (dst + i)));
+		_mm256_storeu_ps (dst + i + 8, _mm256_fmadd_ps (_mm256_loadu_ps (src + i + 8), g, _mm256_loadu_ps (dst + i + 8)));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] += src[i] * gain;
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_fma_pan_buffers (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes)
+{
+	/* as x86_sse_pan_buffers: outputs in pairs, eight frames at a time */
+
+	for (uint32_t o = 0; o < nouts; o += 2) {
+
+		const bool pair = (o + 1 < nouts);
+		ARDOUR::Sample * const a = dsts[o];
+		ARDOUR::Sample * const b = pair ? dsts[o+1] : 0;
+		const __m256 ga = _mm256_set1_ps (gains[o]);
+		const __m256 gb = _mm256_set1_ps (pair ? gains[o+1] : 0.0f);
+		ARDOUR::nframes_t i = 0;
+
+		if (pair) {
+			for (; i + 8 <= nframes; i += 8) {
+				const __m256 s = _mm256_loadu_ps (src + i);
+				_mm256_storeu_ps (a + i, _mm256_fmadd_ps (s, ga, _mm256_loadu_ps (a + i)));
+				_mm256_storeu_ps (b + i, _mm256_fmadd_ps (s, gb, _mm256_loadu_ps (b + i)));
+			}
+			for (; i < nframes; ++i) {
+				a[i] += src[i] * gains[o];
+				b[i] += src[i] * gains[o+1];
+			}
+		} else {
+			for (; i + 8 <= nframes; i += 8) {
+				_mm256_storeu_ps (a + i, _mm256_fmadd_ps (_mm256_loadu_ps (src + i), ga, _mm256_loadu_ps (a + i)));
+			}
+			for (; i < nframes; ++i) {
+				a[i] += src[i] * gains[o];
+			}
+		}
+	}
+
+	_mm256_zeroupper ();
+}
+
+void
+x86_fma_crossfade_buffers (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains,
+			   const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes)
+{
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		const __m256 o = _mm256_mul_ps (_mm256_loadu_ps (out + i), _mm256_loadu_ps (out_gains + i));
+		_mm256_storeu_ps (dst + i, _mm256_fmadd_ps (_mm256_loadu_ps (in + i), _mm256_loadu_ps (in_gains + i), o));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] = out[i] * out_gains[i] + in[i] * in_gains[i];
+	}
+
+	_mm256_zeroupper ();
+}
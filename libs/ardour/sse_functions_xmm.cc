@@ -18,6 +18,7 @@
 
 */
 
+#include <stdint.h>
 #include <xmmintrin.h>
 #include "ardour/types.h"
 
@@ -114,3 +115,312 @@ x86_sse_find_peaks(const ARDOUR::Sample* buf, ARDOUR::nframes_t nframes, float *
 
 
 
+/* peak, and optionally sum of squares, of each of several buffers.  Both
+   are accumulated in all four lanes of an XMM register and only combined
+   at the end of each buffer.
+*/
+
+void
+x86_sse_compute_meter (const ARDOUR::Sample * const * bufs, uint32_t nchannels, ARDOUR::nframes_t nframes, float *peaks, float *powers)
+{
+	/* clearing the sign bit gives the absolute value; built this way
+	   because the integer intrinsics need SSE2.
+	*/
+	static const union { uint32_t i[4]; __m128 v; } abs_bits = { { 0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff } };
+	const __m128 abs_mask = abs_bits.v;
+
+	for (uint32_t c = 0; c < nchannels; ++c) {
+
+		const ARDOUR::Sample* buf = bufs[c];
+		ARDOUR::nframes_t n = nframes;
+
+		__m128 peak = _mm_set1_ps (peaks[c]);
+		__m128 power = _mm_setzero_ps ();
+		__m128 work;
+
+		// Work input until "buf" reaches 16 byte alignment
+		while (((unsigned long) buf) % 16 != 0 && n > 0) {
+			work = _mm_load_ss (buf);
+			peak = _mm_max_ss (peak, _mm_and_ps (work, abs_mask));
+			power = _mm_add_ss (power, _mm_mul_ss (work, work));
+			++buf;
+			--n;
+		}
+
+		if (powers) {
+			while (n >= 4) {
+				work = _mm_load_ps (buf);
+				peak = _mm_max_ps (peak, _mm_and_ps (work, abs_mask));
+				power = _mm_add_ps (power, _mm_mul_ps (work, work));
+				buf += 4;
+				n -= 4;
+			}
+		} else {
+			while (n >= 8) {
+				__builtin_prefetch (buf + 64, 0, 0);
+				peak = _mm_max_ps (peak, _mm_and_ps (_mm_load_ps (buf), abs_mask));
+				peak = _mm_max_ps (peak, _mm_and_ps (_mm_load_ps (buf + 4), abs_mask));
+				buf += 8;
+				n -= 8;
+			}
+		}
+
+		// work through the rest < 4 (or 8) samples
+		while (n > 0) {
+			work = _mm_load_ss (buf);
+			peak = _mm_max_ss (peak, _mm_and_ps (work, abs_mask));
+			power = _mm_add_ss (power, _mm_mul_ss (work, work));
+			++buf;
+			--n;
+		}
+
+		// Horizontal max & sum through shuffle tricks
+
+		peak = _mm_max_ps (peak, _mm_shuffle_ps (peak, peak, _MM_SHUFFLE(2, 3, 0, 1)));
+		peak = _mm_max_ps (peak, _mm_shuffle_ps (peak, peak, _MM_SHUFFLE(1, 0, 3, 2)));
+		_mm_store_ss (&peaks[c], peak);
+
+		if (powers) {
+			power = _mm_add_ps (power, _mm_shuffle_ps (power, power, _MM_SHUFFLE(2, 3, 0, 1)));
+			power = _mm_add_ps (power, _mm_shuffle_ps (power, power, _MM_SHUFFLE(1, 0, 3, 2)));
+			float p;
+			_mm_store_ss (&p, power);
+			powers[c] += p;
+		}
+	}
+}
+
+
+void
+x86_sse_pan_buffers (ARDOUR::Sample * const * dsts, const float *gains, uint32_t nouts, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes)
+{
+	/* outputs are done in pairs, so that each source sample is loaded
+	   once per pair; a stereo panner makes a single pass.  Offsets into
+	   port buffers are not necessarily aligned, so use unaligned access.
+	*/
+
+	uint32_t o = 0;
+
+	for (; o < nouts; o += 2) {
+
+		const bool pair = (o + 1 < nouts);
+		ARDOUR::Sample * const a = dsts[o];
+		ARDOUR::Sample * const b = pair ? dsts[o+1] : 0;
+		const __m128 ga = _mm_set1_ps (gains[o]);
+		const __m128 gb = _mm_set1_ps (pair ? gains[o+1] : 0.0f);
+		ARDOUR::nframes_t i = 0;
+
+		if (pair) {
+			for (; i + 4 <= nframes; i += 4) {
+				const __m128 s = _mm_loadu_ps (src + i);
+				_mm_storeu_ps (a + i, _mm_add_ps (_mm_loadu_ps (a + i), _mm_mul_ps (s, ga)));
+				_mm_storeu_ps (b + i, _mm_add_ps (_mm_loadu_ps (b + i), _mm_mul_ps (s, gb)));
+			}
+			for (; i < nframes; ++i) {
+				a[i] += src[i] * gains[o];
+				b[i] += src[i] * gains[o+1];
+			}
+		} else {
+			for (; i + 4 <= nframes; i += 4) {
+				_mm_storeu_ps (a + i, _mm_add_ps (_mm_loadu_ps (a + i), _mm_mul_ps (_mm_loadu_ps (src + i), ga)));
+			}
+			for (; i < nframes; ++i) {
+				a[i] += src[i] * gains[o];
+			}
+		}
+	}
+}
+
+void
+x86_sse_pan_equal_power_stereo (ARDOUR::Sample * left, ARDOUR::Sample * right, const ARDOUR::Sample * src, const ARDOUR::pan_t * positions,
+				ARDOUR::nframes_t nframes, float scale, float gain)
+{
+	const __m128 one = _mm_set1_ps (1.0f);
+	const __m128 s = _mm_set1_ps (scale);
+	const __m128 offset = _mm_set1_ps (1.0f - scale);
+	const __m128 g = _mm_set1_ps (gain);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 4 <= nframes; i += 4) {
+		const __m128 panR = _mm_loadu_ps (positions + i);
+		const __m128 panL = _mm_sub_ps (one, panR);
+		const __m128 in = _mm_mul_ps (_mm_loadu_ps (src + i), g);
+
+		const __m128 cl = _mm_mul_ps (panL, _mm_add_ps (_mm_mul_ps (s, panL), offset));
+		const __m128 cr = _mm_mul_ps (panR, _mm_add_ps (_mm_mul_ps (s, panR), offset));
+
+		_mm_storeu_ps (left + i, _mm_add_ps (_mm_loadu_ps (left + i), _mm_mul_ps (in, cl)));
+		_mm_storeu_ps (right + i, _mm_add_ps (_mm_loadu_ps (right + i), _mm_mul_ps (in, cr)));
+	}
+
+	for (; i < nframes; ++i) {
+		const float panR = positions[i];
+		const float panL = 1.0f - panR;
+
+		left[i] += src[i] * gain * (panL * (scale * panL + 1.0f - scale));
+		right[i] += src[i] * gain * (panR * (scale * panR + 1.0f - scale));
+	}
+}
+
+void
+x86_sse_apply_gain_curve_to_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * gains)
+{
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm_storeu_ps (buf + i, _mm_mul_ps (_mm_loadu_ps (buf + i), _mm_loadu_ps (gains + i)));
+		_mm_storeu_ps (buf + i + 4, _mm_mul_ps (_mm_loadu_ps (buf + i + 4), _mm_loadu_ps (gains + i + 4)));
+	}
+
+	for (; i < nframes; ++i) {
+		buf[i] *= gains[i];
+	}
+}
+
+void
+x86_sse_copy_buffer_with_gain (ARDOUR::Sample * dst, const ARDOUR::Sample * src, ARDOUR::nframes_t nframes, float gain)
+{
+	const __m128 g = _mm_set1_ps (gain);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm_storeu_ps (dst + i, _mm_mul_ps (_mm_loadu_ps (src + i), g));
+		_mm_storeu_ps (dst + i + 4, _mm_mul_ps (_mm_loadu_ps (src + i + 4), g));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] = src[i] * gain;
+	}
+}
+
+/* Stereo and 4 channel data are shuffled four frames at a time; anything
+   else is strided through one sample at a time.
+*/
+
+void
+x86_sse_interleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes)
+{
+	ARDOUR::nframes_t i = 0;
+
+	if (nchannels == 2) {
+
+		if (channel == 0) {
+			for (; i + 4 <= nframes; i += 4) {
+				float* d = dst + 2 * i;
+				const __m128 s = _mm_loadu_ps (src + i);
+				const __m128 other = _mm_shuffle_ps (_mm_loadu_ps (d), _mm_loadu_ps (d + 4), _MM_SHUFFLE(3, 1, 3, 1));
+				_mm_storeu_ps (d, _mm_unpacklo_ps (s, other));
+				_mm_storeu_ps (d + 4, _mm_unpackhi_ps (s, other));
+			}
+		} else {
+			for (; i + 4 <= nframes; i += 4) {
+				float* d = dst + 2 * i;
+				const __m128 s = _mm_loadu_ps (src + i);
+				const __m128 other = _mm_shuffle_ps (_mm_loadu_ps (d), _mm_loadu_ps (d + 4), _MM_SHUFFLE(2, 0, 2, 0));
+				_mm_storeu_ps (d, _mm_unpacklo_ps (other, s));
+				_mm_storeu_ps (d + 4, _mm_unpackhi_ps (other, s));
+			}
+		}
+
+	} else if (nchannels == 4) {
+
+		for (; i + 4 <= nframes; i += 4) {
+			float* d = dst + 4 * i;
+			__m128 r[4] = { _mm_loadu_ps (d), _mm_loadu_ps (d + 4), _mm_loadu_ps (d + 8), _mm_loadu_ps (d + 12) };
+			_MM_TRANSPOSE4_PS (r[0], r[1], r[2], r[3]);
+			r[channel] = _mm_loadu_ps (src + i);
+			_MM_TRANSPOSE4_PS (r[0], r[1], r[2], r[3]);
+			_mm_storeu_ps (d, r[0]);
+			_mm_storeu_ps (d + 4, r[1]);
+			_mm_storeu_ps (d + 8, r[2]);
+			_mm_storeu_ps (d + 12, r[3]);
+		}
+	}
+
+	for (float* d = dst + i * nchannels + channel; i < nframes; ++i) {
+		*d = src[i];
+		d += nchannels;
+	}
+}
+
+void
+x86_sse_deinterleave (ARDOUR::Sample * dst, const ARDOUR::Sample * src, uint32_t nchannels, uint32_t channel, ARDOUR::nframes_t nframes)
+{
+	ARDOUR::nframes_t i = 0;
+
+	if (nchannels == 2) {
+
+		if (channel == 0) {
+			for (; i + 4 <= nframes; i += 4) {
+				const float* s = src + 2 * i;
+				_mm_storeu_ps (dst + i, _mm_shuffle_ps (_mm_loadu_ps (s), _mm_loadu_ps (s + 4), _MM_SHUFFLE(2, 0, 2, 0)));
+			}
+		} else {
+			for (; i + 4 <= nframes; i += 4) {
+				const float* s = src + 2 * i;
+				_mm_storeu_ps (dst + i, _mm_shuffle_ps (_mm_loadu_ps (s), _mm_loadu_ps (s + 4), _MM_SHUFFLE(3, 1, 3, 1)));
+			}
+		}
+
+	} else if (nchannels == 4) {
+
+		for (; i + 4 <= nframes; i += 4) {
+			const float* s = src + 4 * i;
+			__m128 r[4] = { _mm_loadu_ps (s), _mm_loadu_ps (s + 4), _mm_loadu_ps (s + 8), _mm_loadu_ps (s + 12) };
+			_MM_TRANSPOSE4_PS (r[0], r[1], r[2], r[3]);
+			_mm_storeu_ps (dst + i, r[channel]);
+		}
+	}
+
+	for (const float* s = src + i * nchannels + channel; i < nframes; ++i) {
+		dst[i] = *s;
+		s += nchannels;
+	}
+}
+
+void
+x86_sse_scale_and_offset_buffer (ARDOUR::Sample * buf, ARDOUR::nframes_t nframes, const ARDOUR::gain_t * ramp, ARDOUR::nframes_t ramp_frames,
+				 float gain, float scale, float offset)
+{
+	const __m128 s = _mm_set1_ps (scale);
+	const __m128 o = _mm_set1_ps (offset);
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 4 <= ramp_frames; i += 4) {
+		_mm_storeu_ps (buf + i, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (buf + i), _mm_mul_ps (_mm_loadu_ps (ramp + i), s)), o));
+	}
+
+	for (; i < ramp_frames; ++i) {
+		buf[i] = buf[i] * (ramp[i] * scale) + offset;
+	}
+
+	const float g = gain * scale;
+	const __m128 gs = _mm_set1_ps (g);
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm_storeu_ps (buf + i, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (buf + i), gs), o));
+		_mm_storeu_ps (buf + i + 4, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (buf + i + 4), gs), o));
+	}
+
+	for (; i < nframes; ++i) {
+		buf[i] = buf[i] * g + offset;
+	}
+}
+
+void
+x86_sse_crossfade_buffers (ARDOUR::Sample * dst, const ARDOUR::Sample * out, const ARDOUR::gain_t * out_gains,
+			   const ARDOUR::Sample * in, const ARDOUR::gain_t * in_gains, ARDOUR::nframes_t nframes)
+{
+	ARDOUR::nframes_t i = 0;
+
+	for (; i + 8 <= nframes; i += 8) {
+		_mm_storeu_ps (dst + i, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (out + i), _mm_loadu_ps (out_gains + i)),
+						    _mm_mul_ps (_mm_loadu_ps (in + i), _mm_loadu_ps (in_gains + i))));
+		_mm_storeu_ps (dst + i + 4, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (out + i + 4), _mm_loadu_ps (out_gains + i + 4)),
+							_mm_mul_ps (_mm_loadu_ps (in + i + 4), _mm_loadu_ps (in_gains + i + 4))));
+	}
+
+	for (; i < nframes; ++i) {
+		dst[i] = out[i] * out_gains[i] + in[i] * in_gains[i];
+	}
+}
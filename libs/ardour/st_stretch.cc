@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <cmath>
 
+#include <boost/bind.hpp>
+
 #include "pbd/error.h"
 
 #include "ardour/types.h"
@@ -64,68 +66,85 @@ STStretch::~STStretch ()
 }
 
 int
-STStretch::run (boost::shared_ptr<Region> a_region)
+STStretch::run (boost::shared_ptr<Region> r)
 {
-	SourceList nsrcs;
-	nframes_t total_frames;
-	nframes_t done;
-	int ret = -1;
-	const nframes_t bufsize = 16384;
-	gain_t *gain_buffer = 0;
-	Sample *buffer = 0;
-	char suffix[32];
-	string new_name;
-	string::size_type at;
+	Buffers buffers;
+	int ret = prepare (r);
+
+	if (ret == 0) {
+		ret = process (buffers);
+	}
+
+	return complete (ret);
+}
 
+/** Make the new sources */
+int
+STStretch::prepare (boost::shared_ptr<Region> a_region)
+{
 	tsr.progress = 0.0f;
 	tsr.done = false;
 
-	boost::shared_ptr<AudioRegion> region = boost::dynamic_pointer_cast<AudioRegion>(a_region);
+	_region = boost::dynamic_pointer_cast<AudioRegion>(a_region);
 
-	total_frames = region->length() * region->n_channels();
-	done = 0;
+	if (!_region) {
+		return -1;
+	}
 
 	/* the name doesn't need to be super-precise, but allow for 2 fractional
 	   digits just to disambiguate close but not identical stretches.
 	*/
 
+	char suffix[32];
 	snprintf (suffix, sizeof (suffix), "@%d", (int) floor (tsr.time_fraction * 100.0f));
+	_suffix = suffix;
 
 	/* create new sources */
 
-	if (make_new_sources (region, nsrcs, suffix)) {
-		goto out;
-	}
+	return make_new_sources (_region, _new_sources, _suffix);
+}
+
+/** Stretch each channel of the region into our new sources.  This may be
+ *  called while other filters are running.
+ */
+int
+STStretch::process (Buffers& buffers)
+{
+	const nframes_t bufsize = 16384;
+	nframes_t const total_frames = _region->length() * _region->n_channels();
+	nframes_t done = 0;
+
+	buffers.ensure (1, bufsize);
+	Sample* buffer = buffers.pointers[0];
+
+	/* read from the master (original) sources for the region,
+	   not the ones currently in use, in case it's already been
+	   subject to timefx.
+	*/
 
-	gain_buffer = new gain_t[bufsize];
-	buffer = new Sample[bufsize];
+	Buffers::ChannelReader const read_master = boost::bind (&AudioRegion::master_read_at, _region, _1, _1, _2, _3, _4, _5);
 
 	// soundtouch throws runtime_error on error
 
 	try {
-		for (uint32_t i = 0; i < nsrcs.size(); ++i) {
+		for (uint32_t i = 0; i < _new_sources.size(); ++i) {
 
 			boost::shared_ptr<AudioSource> asrc
-				= boost::dynamic_pointer_cast<AudioSource>(nsrcs[i]);
+				= boost::dynamic_pointer_cast<AudioSource>(_new_sources[i]);
 
 			nframes_t pos = 0;
 			nframes_t this_read = 0;
 
 			st.clear();
 
-			while (!tsr.cancel && pos < region->length()) {
+			while (!tsr.cancel && pos < _region->length()) {
 				nframes_t this_time;
 
-				this_time = min (bufsize, region->length() - pos);
-
-				/* read from the master (original) sources for the region,
-				   not the ones currently in use, in case it's already been
-				   subject to timefx.
-				*/
+				this_time = min (bufsize, _region->length() - pos);
 
-				if ((this_read = region->master_read_at (buffer, buffer, gain_buffer, pos + region->position(), this_time)) != this_time) {
+				if ((this_read = buffers.read (read_master, pos + _region->position(), this_time, i, 1)) != this_time) {
 					error << string_compose (_("tempoize: error reading data from %1"), asrc->name()) << endmsg;
-					goto out;
+					return -1;
 				}
 
 				pos += this_read;
@@ -138,7 +157,7 @@ STStretch::run (boost::shared_ptr<Region> a_region)
 				while ((this_read = st.receiveSamples (buffer, bufsize)) > 0 && !tsr.cancel) {
 					if (asrc->write (buffer, this_read) != this_read) {
 						error << string_compose (_("error writing tempo-adjusted data to %1"), asrc->name()) << endmsg;
-						goto out;
+						return -1;
 					}
 				}
 			}
@@ -150,7 +169,7 @@ STStretch::run (boost::shared_ptr<Region> a_region)
 			while (!tsr.cancel && (this_read = st.receiveSamples (buffer, bufsize)) > 0) {
 				if (asrc->write (buffer, this_read) != this_read) {
 					error << string_compose (_("error writing tempo-adjusted data to %1"), asrc->name()) << endmsg;
-					goto out;
+					return -1;
 				}
 			}
 		}
@@ -158,48 +177,57 @@ STStretch::run (boost::shared_ptr<Region> a_region)
 	} catch (runtime_error& err) {
 		error << _("timefx code failure. please notify ardour-developers.") << endmsg;
 		error << err.what() << endmsg;
-		goto out;
+		return -1;
 	}
 
-	new_name = region->name();
-	at = new_name.find ('@');
+	return 0;
+}
 
-	// remove any existing stretch indicator
+/** Make the new region, or clean up if something went wrong.
+ *  @param status 0 if prepare() and process() succeeded.
+ */
+int
+STStretch::complete (int status)
+{
+	int ret = (tsr.cancel ? -1 : status);
 
-	if (at != string::npos && at > 2) {
-		new_name = new_name.substr (0, at - 1);
-	}
+	if (ret == 0) {
 
-	new_name += suffix;
+		string new_name = _region->name();
+		string::size_type at = new_name.find ('@');
 
-	ret = finish (region, nsrcs, new_name);
+		// remove any existing stretch indicator
 
-	/* now reset ancestral data for each new region */
+		if (at != string::npos && at > 2) {
+			new_name = new_name.substr (0, at - 1);
+		}
 
-	for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
-		nframes64_t astart = (*x)->ancestral_start();
-		nframes64_t alength = (*x)->ancestral_length();
-		nframes_t start;
-		nframes_t length;
+		new_name += _suffix;
 
-		// note: tsr.fraction is a percentage of original length. 100 = no change,
-		// 50 is half as long, 200 is twice as long, etc.
+		ret = finish (_region, _new_sources, new_name);
 
-		float stretch = (*x)->stretch() * (tsr.time_fraction/100.0);
+		/* now reset ancestral data for each new region */
 
-		start = (nframes_t) floor (astart + ((astart - (*x)->start()) / stretch));
-		length = (nframes_t) floor (alength / stretch);
+		for (vector<boost::shared_ptr<Region> >::iterator x = results.begin(); x != results.end(); ++x) {
+			nframes64_t astart = (*x)->ancestral_start();
+			nframes64_t alength = (*x)->ancestral_length();
+			nframes_t start;
+			nframes_t length;
 
-		(*x)->set_ancestral_data (start, length, stretch, (*x)->shift());
-	}
+			// note: tsr.fraction is a percentage of original length. 100 = no change,
+			// 50 is half as long, 200 is twice as long, etc.
 
-  out:
+			float stretch = (*x)->stretch() * (tsr.time_fraction/100.0);
 
-	delete [] gain_buffer;
-	delete [] buffer;
+			start = (nframes_t) floor (astart + ((astart - (*x)->start()) / stretch));
+			length = (nframes_t) floor (alength / stretch);
+
+			(*x)->set_ancestral_data (start, length, stretch, (*x)->shift());
+		}
+	}
 
-	if (ret || tsr.cancel) {
-		for (SourceList::iterator si = nsrcs.begin(); si != nsrcs.end(); ++si) {
+	if (ret) {
+		for (SourceList::iterator si = _new_sources.begin(); si != _new_sources.end(); ++si) {
 			(*si)->mark_for_remove ();
 		}
 	}
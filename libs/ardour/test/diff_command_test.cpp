@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <vector>
+#include <glib.h>
+
+#include "pbd/xml++.h"
+#include "ardour/midi_model.h"
+#include "diff_command_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (DiffCommandTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+typedef MidiModel::DiffCommand DiffCommand;
+
+namespace {
+
+DiffCommand::SavedChange
+saved_change (DiffCommand::Property property, double time, double old_value, double new_value)
+{
+	DiffCommand::SavedChange c;
+	c.property = property;
+	c.channel = 9;
+	c.note = 60;
+	c.velocity = 100;
+	c.time = time;
+	c.length = 0.25;
+	c.old_value = old_value;
+	c.new_value = new_value;
+	return c;
+}
+
+bool
+same (DiffCommand::SavedChange const & a, DiffCommand::SavedChange const & b)
+{
+	return a.property == b.property && a.channel == b.channel && a.note == b.note && a.velocity == b.velocity
+		&& a.time == b.time && a.length == b.length && a.old_value == b.old_value && a.new_value == b.new_value;
+}
+
+}
+
+void
+DiffCommandTest::packTest ()
+{
+	DiffCommand::SavedChanges changes;
+
+	/* values which would not survive being written out as decimal text */
+	changes.push_back (saved_change (DiffCommand::StartTime, 1.0 / 3, 0.1, 1e-300));
+	changes.push_back (saved_change (DiffCommand::Length, 123456789.123, -2.5, 7.0 / 11));
+	changes.push_back (saved_change (DiffCommand::NoteNumber, 4, 60, 67));
+	changes.push_back (saved_change (DiffCommand::Velocity, 0, 100, 127));
+	changes.push_back (saved_change (DiffCommand::Channel, 1.0, 9, 15));
+
+	string const packed = DiffCommand::pack_changes (changes);
+	DiffCommand::SavedChanges const unpacked = DiffCommand::unpack_changes (packed);
+
+	CPPUNIT_ASSERT_EQUAL (changes.size(), unpacked.size());
+	DiffCommand::SavedChanges::const_iterator j = unpacked.begin ();
+	for (DiffCommand::SavedChanges::const_iterator i = changes.begin(); i != changes.end(); ++i, ++j) {
+		CPPUNIT_ASSERT (same (*i, *j));
+	}
+
+	/* the records are little-endian whatever machine wrote them */
+
+	gsize size = 0;
+	guchar* data = g_base64_decode (packed.c_str(), &size);
+	CPPUNIT_ASSERT_EQUAL (gsize (5 * 36), size);
+
+	/* the time of the last change, 1.0 */
+	guchar const one[] = { 0, 0, 0, 0, 0, 0, 0xf0, 0x3f };
+	CPPUNIT_ASSERT (equal (one, one + 8, data + 4 * 36 + 4));
+	CPPUNIT_ASSERT_EQUAL (guchar (DiffCommand::Channel), data[4 * 36]);
+	CPPUNIT_ASSERT_EQUAL (guchar (9), data[4 * 36 + 1]);
+
+	g_free (data);
+
+	CPPUNIT_ASSERT (DiffCommand::pack_changes (DiffCommand::SavedChanges ()).empty ());
+	CPPUNIT_ASSERT (DiffCommand::unpack_changes ("").empty ());
+}
+
+void
+DiffCommandTest::unknownPropertyTest ()
+{
+	DiffCommand::SavedChanges changes;
+	changes.push_back (saved_change (DiffCommand::StartTime, 1, 1, 2));
+	changes.push_back (saved_change (DiffCommand::Velocity, 2, 3, 4));
+	changes.push_back (saved_change (DiffCommand::Length, 3, 5, 6));
+
+	string const packed = DiffCommand::pack_changes (changes);
+
+	gsize size = 0;
+	guchar* data = g_base64_decode (packed.c_str(), &size);
+
+	/* a property from some later version, and the start of another record */
+	data[36] = DiffCommand::Channel + 1;
+	vector<guchar> longer (data, data + size);
+	longer.insert (longer.end(), 20, 0);
+	g_free (data);
+
+	gchar* encoded = g_base64_encode (&longer[0], longer.size());
+	DiffCommand::SavedChanges const unpacked = DiffCommand::unpack_changes (encoded);
+	g_free (encoded);
+
+	CPPUNIT_ASSERT_EQUAL (size_t (2), unpacked.size());
+	CPPUNIT_ASSERT (same (unpacked.front(), changes.front()));
+	CPPUNIT_ASSERT (same (unpacked.back(), changes.back()));
+}
+
+void
+DiffCommandTest::oldFormatTest ()
+{
+	/* a change as older sessions saved it, without the changed property of the note */
+
+	XMLNode time_change ("change");
+	time_change.add_property ("property", "StartTime");
+	time_change.add_property ("old", "1.5");
+	time_change.add_property ("new", "2.25");
+	time_change.add_property ("note", "64");
+	time_change.add_property ("channel", "3");
+	time_change.add_property ("length", "0.5");
+	time_change.add_property ("velocity", "90");
+
+	DiffCommand::SavedChange c = DiffCommand::read_change (time_change);
+
+	CPPUNIT_ASSERT_EQUAL (DiffCommand::StartTime, c.property);
+	CPPUNIT_ASSERT_EQUAL (1.5, c.old_value);
+	CPPUNIT_ASSERT_EQUAL (2.25, c.new_value);
+	CPPUNIT_ASSERT_EQUAL (uint8_t (64), c.note);
+	CPPUNIT_ASSERT_EQUAL (uint8_t (3), c.channel);
+	CPPUNIT_ASSERT_EQUAL (0.5, c.length);
+	CPPUNIT_ASSERT_EQUAL (uint8_t (90), c.velocity);
+
+	XMLNode note_change ("change");
+	note_change.add_property ("property", "NoteNumber");
+	note_change.add_property ("old", "60");
+	note_change.add_property ("new", "72");
+	note_change.add_property ("channel", "0");
+	note_change.add_property ("time", "4");
+	note_change.add_property ("length", "1");
+	note_change.add_property ("velocity", "127");
+
+	c = DiffCommand::read_change (note_change);
+
+	CPPUNIT_ASSERT_EQUAL (DiffCommand::NoteNumber, c.property);
+	CPPUNIT_ASSERT_EQUAL (60.0, c.old_value);
+	CPPUNIT_ASSERT_EQUAL (72.0, c.new_value);
+	CPPUNIT_ASSERT_EQUAL (4.0, c.time);
+	CPPUNIT_ASSERT_EQUAL (uint8_t (127), c.velocity);
+
+	/* and it survives being packed */
+
+	DiffCommand::SavedChanges changes (1, c);
+	CPPUNIT_ASSERT (same (DiffCommand::unpack_changes (DiffCommand::pack_changes (changes)).front(), c));
+}
@@ -0,0 +1,17 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+/** Checks the forms in which MidiModel::DiffCommand saves its note changes */
+class DiffCommandTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (DiffCommandTest);
+	CPPUNIT_TEST (packTest);
+	CPPUNIT_TEST (unknownPropertyTest);
+	CPPUNIT_TEST (oldFormatTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void packTest ();
+	void unknownPropertyTest ();
+	void oldFormatTest ();
+};
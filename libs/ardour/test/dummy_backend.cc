@@ -0,0 +1,74 @@
+#include <glibmm/timer.h>
+
+#include "ardour/audioengine.h"
+#include "ardour/dummy_backend.h"
+#include "ardour/port.h"
+#include "dummy_backend.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (DummyBackendTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+void
+DummyBackendTest::cycleTest ()
+{
+	DummyBackend::Parameters p;
+	p.sample_rate = 44100;
+	p.period_size = 256;
+	p.realtime = false;
+
+	AudioEngine engine ("dummytest", p);
+
+	CPPUNIT_ASSERT (engine.connected ());
+	CPPUNIT_ASSERT_EQUAL ((nframes_t) 44100, engine.frame_rate ());
+	CPPUNIT_ASSERT_EQUAL ((nframes_t) 256, engine.frames_per_cycle ());
+
+	CPPUNIT_ASSERT_EQUAL (0, engine.start ());
+	Glib::usleep (100000);
+	CPPUNIT_ASSERT_EQUAL (0, engine.stop ());
+
+	/* free-running, so we should have run many more cycles than
+	   100ms worth of real time would allow
+	*/
+	CPPUNIT_ASSERT (engine.dummy_backend()->cycles () > 17);
+
+	/* a different period size must be picked up by the engine */
+	CPPUNIT_ASSERT_EQUAL (0, engine.request_buffer_size (512));
+	CPPUNIT_ASSERT_EQUAL ((nframes_t) 512, engine.frames_per_cycle ());
+}
+
+void
+DummyBackendTest::portTest ()
+{
+	DummyBackend::Parameters p;
+	p.n_audio_inputs = 4;
+	p.n_audio_outputs = 8;
+	p.realtime = false;
+
+	AudioEngine engine ("dummytest", p);
+
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 4, engine.n_physical_inputs (DataType::AUDIO));
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) 8, engine.n_physical_outputs (DataType::AUDIO));
+
+	vector<string> outs;
+	engine.get_physical_outputs (DataType::AUDIO, outs);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 8, outs.size ());
+	CPPUNIT_ASSERT_EQUAL (string ("system:playback_1"), outs[0]);
+
+	CPPUNIT_ASSERT_EQUAL (0, engine.start ());
+
+	Port* port = engine.register_output_port (DataType::AUDIO, "out");
+	CPPUNIT_ASSERT (port);
+	CPPUNIT_ASSERT (!port->connected ());
+
+	CPPUNIT_ASSERT_EQUAL (0, port->connect (outs[0]));
+	CPPUNIT_ASSERT (port->connected ());
+	CPPUNIT_ASSERT (port->connected_to (outs[0]));
+
+	CPPUNIT_ASSERT_EQUAL (0, port->disconnect (outs[0]));
+	CPPUNIT_ASSERT (!port->connected ());
+
+	engine.unregister_port (*port);
+	engine.stop ();
+}
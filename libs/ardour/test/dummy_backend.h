@@ -0,0 +1,14 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class DummyBackendTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (DummyBackendTest);
+	CPPUNIT_TEST (cycleTest);
+	CPPUNIT_TEST (portTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void cycleTest ();
+	void portTest ();
+};
@@ -0,0 +1,65 @@
+#include "ardour/filter.h"
+#include "filter_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (FilterTest);
+
+using namespace ARDOUR;
+
+namespace {
+
+/** Fills a buffer with values which say which channel and frame they came
+ *  from, and reads short from one channel if asked.
+ */
+struct Reader {
+	Reader () : short_channel (0), short_count (-1) {}
+	Reader (uint32_t s, framecnt_t g) : short_channel (s), short_count (g) {}
+
+	framecnt_t operator() (Sample* buf, gain_t*, framepos_t position, framecnt_t cnt, uint32_t channel) const {
+		if (channel == short_channel && short_count >= 0) {
+			cnt = short_count;
+		}
+		for (framecnt_t i = 0; i < cnt; ++i) {
+			buf[i] = channel * 100000 + position + i;
+		}
+		return cnt;
+	}
+
+	uint32_t short_channel;
+	framecnt_t short_count;
+};
+
+}
+
+void
+FilterTest::readTest ()
+{
+	Filter::Buffers buffers;
+	buffers.ensure (1, 256);
+
+	/* all the channels at once, as RBEffect does; the buffers must grow to fit */
+
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 1024, buffers.read (Reader (), 5000, 1024, 0, 3));
+	CPPUNIT_ASSERT_EQUAL ((size_t) 3, buffers.pointers.size ());
+
+	for (uint32_t c = 0; c < 3; ++c) {
+		CPPUNIT_ASSERT (buffers.channels[c].size () >= 1024);
+		for (framecnt_t i = 0; i < 1024; ++i) {
+			CPPUNIT_ASSERT_EQUAL ((Sample) (c * 100000 + 5000 + i), buffers.pointers[c][i]);
+		}
+	}
+
+	/* one channel at a time, as STStretch does; each must come from its own channel */
+
+	for (uint32_t c = 0; c < 3; ++c) {
+		CPPUNIT_ASSERT_EQUAL ((framecnt_t) 512, buffers.read (Reader (), 7000, 512, c, 1));
+		for (framecnt_t i = 0; i < 512; ++i) {
+			CPPUNIT_ASSERT_EQUAL ((Sample) (c * 100000 + 7000 + i), buffers.pointers[0][i]);
+		}
+	}
+
+	/* a channel which cannot be read in full makes the read short */
+
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 100, buffers.read (Reader (1, 100), 0, 1024, 0, 3));
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 100, buffers.read (Reader (1, 100), 0, 1024, 1, 1));
+	CPPUNIT_ASSERT_EQUAL ((framecnt_t) 1024, buffers.read (Reader (1, 100), 0, 1024, 2, 1));
+}
@@ -0,0 +1,13 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+/** Checks that filters read each channel of a region into its own buffer */
+class FilterTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (FilterTest);
+	CPPUNIT_TEST (readTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void readTest ();
+};
@@ -1,4 +1,7 @@
+#include <iomanip>
+#include <vector>
 #include <sigc++/sigc++.h>
+#include "ardour/ardour.h"
 #include "interpolation_test.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION(InterpolationTest);
@@ -166,3 +169,177 @@ InterpolationTest::cubicInterpolationTest ()
 		CPPUNIT_ASSERT_EQUAL (1.0f, output[i]);
 	}
 }
+
+void
+InterpolationTest::sincInterpolationTest ()
+{
+	nframes_t result = 0;
+	cout << "\nSinc Interpolation Test\n";
+
+	/* the sinc filter reads lookahead() frames past those that it consumes */
+	nframes_t const available = NUM_SAMPLES - SincInterpolation::lookahead ();
+
+	Sample* in[1] = { input };
+	Sample* out[1] = { output };
+
+	cout << "\nSpeed: 1/3";
+	for (int i = 0; 3*i < (int) available - 1024;) {
+		sinc.set_speed (double(1.0)/double(3.0));
+		sinc.set_target_speed (double(1.0)/double(3.0));
+		Sample* in_i[1] = { input + i };
+		Sample* out_i[1] = { output + i*3 };
+		result = sinc.interpolate (1, 1024, in_i, out_i);
+		i += result;
+	}
+
+	cout << "\nSpeed: 1.0";
+	sinc.reset();
+	sinc.set_speed (1.0);
+	sinc.set_target_speed (sinc.speed());
+	result = sinc.interpolate (1, available, in, out);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) available, result);
+	for (nframes_t i = 0; i < available; ++i) {
+		CPPUNIT_ASSERT_EQUAL (input[i], output[i]);
+	}
+
+	/* at half speed every other output frame falls exactly on an input frame,
+	   where the filter should give back the input
+	*/
+
+	cout << "\nSpeed: 0.5";
+	sinc.reset();
+	sinc.set_speed (0.5);
+	sinc.set_target_speed (sinc.speed());
+	result = sinc.interpolate (1, NUM_SAMPLES, in, out);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t)(NUM_SAMPLES * sinc.speed()), result);
+	for (int i = 0; i < NUM_SAMPLES; i += (INTERVAL / sinc.speed() +0.5)) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (1.0f, output[i], 1e-6);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (0.0f, output[i + 2], 1e-6);
+	}
+
+	cout << "\nSpeed: 0.2";
+	sinc.reset();
+	sinc.set_speed (0.2);
+	sinc.set_target_speed (sinc.speed());
+	result = sinc.interpolate (1, NUM_SAMPLES, in, out);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t)(NUM_SAMPLES * sinc.speed()), result);
+
+	cout << "\nSpeed: 2.0";
+	sinc.reset();
+	sinc.set_speed (2.0);
+	sinc.set_target_speed (sinc.speed());
+	result = sinc.interpolate (1, available / 2, in, out);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t)(available / 2 * sinc.speed()), result);
+
+	/* above normal speed the input is low-pass filtered, so an impulse is
+	   spread out; its energy should still come through
+	*/
+	for (int i = INTERVAL; i < (int) available / 2 - INTERVAL; i += (INTERVAL / sinc.speed() +0.5)) {
+		float sum = 0;
+		for (int j = -INTERVAL / 4; j < INTERVAL / 4; ++j) {
+			sum += output[i + j];
+		}
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (1.0f / sinc.speed(), sum, 1e-2);
+	}
+
+	cout << "\nSpeed: 10.0";
+	sinc.set_speed (10.0);
+	sinc.set_target_speed (sinc.speed());
+	result = sinc.interpolate (1, available / 10, in, out);
+	CPPUNIT_ASSERT_EQUAL ((uint32_t)(available / 10 * sinc.speed()), result);
+
+	/* starting to varispeed after frames have been passed through should give
+	   the same as having interpolated them at speed 1
+	*/
+
+	cout << "\nPass through";
+	for (int i = 0; i < NUM_SAMPLES; ++i) {
+		input[i] = sin (i * 0.3);
+	}
+
+	SincInterpolation passed;
+	SincInterpolation interpolated;
+	passed.add_channel_to (NUM_SAMPLES, NUM_SAMPLES);
+	interpolated.add_channel_to (NUM_SAMPLES, NUM_SAMPLES);
+
+	nframes_t const played = 1000;
+	Sample* rest[1] = { input + played };
+	Sample* passed_out[1] = { output };
+	Sample* interpolated_out[1] = { output + NUM_SAMPLES / 2 };
+
+	passed.pass_through (1, played, in);
+	interpolated.interpolate (1, played, in, interpolated_out);
+
+	passed.set_speed (0.7);
+	interpolated.set_speed (0.7);
+	passed.interpolate (1, 256, rest, passed_out);
+	interpolated.interpolate (1, 256, rest, interpolated_out);
+
+	for (int i = 0; i < 256; ++i) {
+		CPPUNIT_ASSERT_EQUAL (interpolated_out[0][i], passed_out[0][i]);
+	}
+}
+
+/** Print the cost of each interpolator, in ns per output frame per channel */
+void
+InterpolationTest::benchmark ()
+{
+	nframes_t const n = 1024;
+	int const iterations = 2000;
+	uint32_t const channels = 8;
+	double const speeds[] = { 0.5, 0.97, 1.37, 2.0 };
+	int const num_speeds = sizeof (speeds) / sizeof (speeds[0]);
+
+	/* enough input for the fastest speed, plus the sinc filter's lookahead */
+	nframes_t const input_length = n * 2 + 1 + SincInterpolation::lookahead ();
+
+	vector<vector<Sample> > in (channels, vector<Sample> (input_length));
+	vector<vector<Sample> > out (channels, vector<Sample> (n));
+	Sample* ins[channels];
+	Sample* outs[channels];
+
+	for (uint32_t c = 0; c < channels; ++c) {
+		for (nframes_t i = 0; i < input_length; ++i) {
+			in[c][i] = sin (i * 0.01 * (c + 1));
+		}
+		ins[c] = &in[c][0];
+		outs[c] = &out[c][0];
+	}
+
+	LinearInterpolation bench_linear;
+	CubicInterpolation bench_cubic;
+	SincInterpolation bench_sinc;
+
+	for (uint32_t c = 0; c < channels; ++c) {
+		bench_linear.add_channel_to (input_length, n);
+		bench_cubic.add_channel_to (input_length, n);
+		bench_sinc.add_channel_to (input_length, n);
+	}
+
+	cout << endl << setw (28) << left << "ns/frame/channel";
+	for (int s = 0; s < num_speeds; ++s) {
+		cout << setw (10) << right << speeds[s];
+	}
+	cout << endl;
+
+#define INTERPOLATION_BENCHMARK(name, interpolator, call) \
+	cout << setw (28) << left << name; \
+	for (int s = 0; s < num_speeds; ++s) { \
+		interpolator.reset (); \
+		interpolator.set_speed (speeds[s]); \
+		interpolator.set_target_speed (speeds[s]); \
+		microseconds_t const start = get_microseconds (); \
+		for (int i = 0; i < iterations; ++i) { \
+			call; \
+		} \
+		microseconds_t const elapsed = get_microseconds () - start; \
+		cout << setw (10) << right << fixed << setprecision (3) << (elapsed * 1000.0 / ((double) iterations * n * channels)); \
+	} \
+	cout << endl;
+
+	INTERPOLATION_BENCHMARK ("linear", bench_linear, for (uint32_t c = 0; c < channels; ++c) { bench_linear.interpolate (c, n, ins[c], outs[c]); });
+	INTERPOLATION_BENCHMARK ("cubic", bench_cubic, for (uint32_t c = 0; c < channels; ++c) { bench_cubic.interpolate (c, n, ins[c], outs[c]); });
+	INTERPOLATION_BENCHMARK ("sinc", bench_sinc, bench_sinc.interpolate (channels, n, ins, outs));
+
+#undef INTERPOLATION_BENCHMARK
+}
@@ -27,6 +27,8 @@ class InterpolationTest : public CppUnit::TestFixture
 	CPPUNIT_TEST_SUITE(InterpolationTest);
 	CPPUNIT_TEST(cubicInterpolationTest);
 	CPPUNIT_TEST(linearInterpolationTest);
+	CPPUNIT_TEST(sincInterpolationTest);
+	CPPUNIT_TEST(benchmark);
 	CPPUNIT_TEST_SUITE_END();
 
 #define NUM_SAMPLES 1000000
@@ -37,6 +39,7 @@ class InterpolationTest : public CppUnit::TestFixture
 
 	ARDOUR::LinearInterpolation linear;
 	ARDOUR::CubicInterpolation  cubic;
+	ARDOUR::SincInterpolation   sinc;
 
 	public:
 
@@ -51,6 +54,7 @@ class InterpolationTest : public CppUnit::TestFixture
 		}
 		linear.add_channel_to (NUM_SAMPLES, NUM_SAMPLES);
 		cubic.add_channel_to (NUM_SAMPLES, NUM_SAMPLES);
+		sinc.add_channel_to (NUM_SAMPLES, NUM_SAMPLES);
 	}
 
 	void tearDown() {
@@ -58,4 +62,6 @@ class InterpolationTest : public CppUnit::TestFixture
 
 	void linearInterpolationTest();
 	void cubicInterpolationTest();
+	void sincInterpolationTest();
+	void benchmark();
 };
@@ -0,0 +1,367 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+#include "pbd/fpu.h"
+#include "pbd/malign.h"
+
+#include "ardour/ardour.h"
+#include "ardour/mix.h"
+#include "mix_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MixTest);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION (MixBenchmark, "Benchmarks");
+
+using namespace std;
+using namespace ARDOUR;
+
+void
+MixTest::setUp ()
+{
+	Functions f;
+
+	f.name                       = "generic";
+	f.compute_peak               = default_compute_peak;
+	f.find_peaks                 = default_find_peaks;
+	f.compute_meter              = default_compute_meter;
+	f.apply_gain_to_buffer       = default_apply_gain_to_buffer;
+	f.mix_buffers_with_gain      = default_mix_buffers_with_gain;
+	f.mix_buffers_no_gain        = default_mix_buffers_no_gain;
+	f.pan_buffers                = default_pan_buffers;
+	f.pan_equal_power_stereo     = default_pan_equal_power_stereo;
+	f.apply_gain_curve_to_buffer = default_apply_gain_curve_to_buffer;
+	f.copy_buffer_with_gain      = default_copy_buffer_with_gain;
+	f.interleave                 = default_interleave;
+	f.deinterleave               = default_deinterleave;
+	f.scale_and_offset_buffer    = default_scale_and_offset_buffer;
+	f.crossfade_buffers          = default_crossfade_buffers;
+
+	_functions.push_back (f);
+
+	PBD::FPU fpu;
+
+#if defined (ARCH_X86) && defined (BUILD_SSE_OPTIMIZATIONS)
+	if (fpu.has_sse()) {
+		f.name                       = "sse";
+		f.compute_peak               = x86_sse_compute_peak;
+		f.find_peaks                 = x86_sse_find_peaks;
+		f.compute_meter              = x86_sse_compute_meter;
+		f.apply_gain_to_buffer       = x86_sse_apply_gain_to_buffer;
+		f.mix_buffers_with_gain      = x86_sse_mix_buffers_with_gain;
+		f.mix_buffers_no_gain        = x86_sse_mix_buffers_no_gain;
+		f.pan_buffers                = x86_sse_pan_buffers;
+		f.pan_equal_power_stereo     = x86_sse_pan_equal_power_stereo;
+		f.apply_gain_curve_to_buffer = x86_sse_apply_gain_curve_to_buffer;
+		f.copy_buffer_with_gain      = x86_sse_copy_buffer_with_gain;
+		f.interleave                 = x86_sse_interleave;
+		f.deinterleave               = x86_sse_deinterleave;
+		f.scale_and_offset_buffer    = x86_sse_scale_and_offset_buffer;
+		f.crossfade_buffers          = x86_sse_crossfade_buffers;
+		_functions.push_back (f);
+	}
+
+	if (fpu.has_avx()) {
+		f.name                       = "avx";
+		f.compute_peak               = x86_sse_avx_compute_peak;
+		f.find_peaks                 = x86_sse_avx_find_peaks;
+		f.compute_meter              = x86_sse_avx_compute_meter;
+		f.apply_gain_to_buffer       = x86_sse_avx_apply_gain_to_buffer;
+		f.mix_buffers_with_gain      = x86_sse_avx_mix_buffers_with_gain;
+		f.mix_buffers_no_gain        = x86_sse_avx_mix_buffers_no_gain;
+		f.pan_buffers                = x86_sse_avx_pan_buffers;
+		f.pan_equal_power_stereo     = x86_sse_avx_pan_equal_power_stereo;
+		f.apply_gain_curve_to_buffer = x86_sse_avx_apply_gain_curve_to_buffer;
+		f.copy_buffer_with_gain      = x86_sse_avx_copy_buffer_with_gain;
+		f.scale_and_offset_buffer    = x86_sse_avx_scale_and_offset_buffer;
+		f.crossfade_buffers          = x86_sse_avx_crossfade_buffers;
+		_functions.push_back (f);
+	}
+
+	if (fpu.has_fma()) {
+		f.name                       = "fma";
+		f.mix_buffers_with_gain      = x86_fma_mix_buffers_with_gain;
+		f.pan_buffers                = x86_fma_pan_buffers;
+		f.crossfade_buffers          = x86_fma_crossfade_buffers;
+		_functions.push_back (f);
+	}
+#endif
+
+#if defined (__APPLE__) && defined (BUILD_VECLIB_OPTIMIZATIONS)
+	f.name                       = "veclib";
+	f.compute_peak               = veclib_compute_peak;
+	f.find_peaks                 = veclib_find_peaks;
+	f.compute_meter              = veclib_compute_meter;
+	f.apply_gain_to_buffer       = veclib_apply_gain_to_buffer;
+	f.mix_buffers_with_gain      = veclib_mix_buffers_with_gain;
+	f.mix_buffers_no_gain        = veclib_mix_buffers_no_gain;
+	f.pan_buffers                = veclib_pan_buffers;
+	f.pan_equal_power_stereo     = default_pan_equal_power_stereo;
+	f.apply_gain_curve_to_buffer = veclib_apply_gain_curve_to_buffer;
+	f.copy_buffer_with_gain      = veclib_copy_buffer_with_gain;
+	f.interleave                 = veclib_interleave;
+	f.deinterleave               = veclib_deinterleave;
+	f.scale_and_offset_buffer    = default_scale_and_offset_buffer;
+	f.crossfade_buffers          = veclib_crossfade_buffers;
+	_functions.push_back (f);
+#endif
+
+	/* room for 4 interleaved channels */
+	cache_aligned_malloc ((void**) &_src, size * 4 * sizeof (Sample));
+	cache_aligned_malloc ((void**) &_ref, size * 4 * sizeof (Sample));
+	cache_aligned_malloc ((void**) &_out, size * 4 * sizeof (Sample));
+	cache_aligned_malloc ((void**) &_gains, size * sizeof (Sample));
+
+	srandom (42);
+	reset (_src, size * 4);
+
+	for (nframes_t i = 0; i < size; ++i) {
+		_gains[i] = (float) i / size;
+	}
+}
+
+void
+MixTest::tearDown ()
+{
+	free (_src);
+	free (_ref);
+	free (_out);
+	free (_gains);
+	_functions.clear ();
+}
+
+void
+MixTest::reset (Sample* buf, nframes_t n)
+{
+	for (nframes_t i = 0; i < n; ++i) {
+		buf[i] = (random() / (float) RAND_MAX) * 2.0f - 1.0f;
+	}
+}
+
+void
+MixTest::check_equal (string const & what, nframes_t n, float tolerance)
+{
+	for (nframes_t i = 0; i < n; ++i) {
+		if (fabsf (_out[i] - _ref[i]) > tolerance) {
+			cerr << what << " differs at " << i << ": " << _out[i] << " != " << _ref[i] << endl;
+			CPPUNIT_FAIL (what);
+		}
+	}
+}
+
+/* odd lengths, so that the scalar tails are exercised too */
+static const nframes_t lengths[] = { 1, 7, 64, 1023, 4099 };
+static const int n_lengths = sizeof (lengths) / sizeof (lengths[0]);
+
+void
+MixTest::gainTest ()
+{
+	for (vector<Functions>::iterator f = _functions.begin(); f != _functions.end(); ++f) {
+		for (int l = 0; l < n_lengths; ++l) {
+			nframes_t const n = lengths[l];
+
+			memcpy (_ref, _src, n * sizeof (Sample));
+			default_apply_gain_to_buffer (_ref, n, 0.3f);
+			memcpy (_out, _src, n * sizeof (Sample));
+			f->apply_gain_to_buffer (_out, n, 0.3f);
+			check_equal (f->name + " apply_gain_to_buffer", n);
+
+			memcpy (_ref, _src, n * sizeof (Sample));
+			default_apply_gain_curve_to_buffer (_ref, n, _gains);
+			memcpy (_out, _src, n * sizeof (Sample));
+			f->apply_gain_curve_to_buffer (_out, n, _gains);
+			check_equal (f->name + " apply_gain_curve_to_buffer", n);
+
+			default_copy_buffer_with_gain (_ref, _src, n, 0.7f);
+			f->copy_buffer_with_gain (_out, _src, n, 0.7f);
+			check_equal (f->name + " copy_buffer_with_gain", n);
+
+			/* a declick out of at most 128 frames, inverted and offset */
+			nframes_t const ramp = min (n, (nframes_t) 128);
+			memcpy (_ref, _src, n * sizeof (Sample));
+			default_scale_and_offset_buffer (_ref, n, _gains, ramp, 0.0f, -1.0f, 1.0e-27f);
+			memcpy (_out, _src, n * sizeof (Sample));
+			f->scale_and_offset_buffer (_out, n, _gains, ramp, 0.0f, -1.0f, 1.0e-27f);
+			check_equal (f->name + " scale_and_offset_buffer", n);
+		}
+	}
+}
+
+void
+MixTest::mixTest ()
+{
+	for (vector<Functions>::iterator f = _functions.begin(); f != _functions.end(); ++f) {
+		for (int l = 0; l < n_lengths; ++l) {
+			nframes_t const n = lengths[l];
+
+			memcpy (_ref, _src + size, n * sizeof (Sample));
+			default_mix_buffers_with_gain (_ref, _src, n, 0.5f);
+			memcpy (_out, _src + size, n * sizeof (Sample));
+			f->mix_buffers_with_gain (_out, _src, n, 0.5f);
+			check_equal (f->name + " mix_buffers_with_gain", n);
+
+			memcpy (_ref, _src + size, n * sizeof (Sample));
+			default_mix_buffers_no_gain (_ref, _src, n);
+			memcpy (_out, _src + size, n * sizeof (Sample));
+			f->mix_buffers_no_gain (_out, _src, n);
+			check_equal (f->name + " mix_buffers_no_gain", n);
+
+			/* a fade out of one buffer under a fade in of another */
+			default_crossfade_buffers (_ref, _src, _gains + size - n, _src + size, _gains, n);
+			f->crossfade_buffers (_out, _src, _gains + size - n, _src + size, _gains, n);
+			check_equal (f->name + " crossfade_buffers", n);
+
+			/* three outputs: one pair and one on its own */
+			float const gains[3] = { 0.2f, 0.9f, 0.5f };
+			Sample* ref[3] = { _ref, _ref + size, _ref + 2 * size };
+			Sample* out[3] = { _out, _out + size, _out + 2 * size };
+			memcpy (_ref, _src + size, 3 * size * sizeof (Sample));
+			memcpy (_out, _src + size, 3 * size * sizeof (Sample));
+			default_pan_buffers (ref, gains, 3, _src, n);
+			f->pan_buffers (out, gains, 3, _src, n);
+			check_equal (f->name + " pan_buffers", 3 * size);
+
+			/* a stereo pan moving from left to right, with an unaligned source,
+			   unaligned positions and the -3dB pan law of the stereo panner
+			*/
+			float const scale = -0.831783f;
+			memcpy (_ref, _src + size, 2 * size * sizeof (Sample));
+			memcpy (_out, _src + size, 2 * size * sizeof (Sample));
+			default_pan_equal_power_stereo (_ref, _ref + size, _src + 1, _gains + 3, n, scale, 0.8f);
+			f->pan_equal_power_stereo (_out, _out + size, _src + 1, _gains + 3, n, scale, 0.8f);
+			check_equal (f->name + " pan_equal_power_stereo", 2 * size, 1e-5);
+		}
+	}
+}
+
+void
+MixTest::peakTest ()
+{
+	for (vector<Functions>::iterator f = _functions.begin(); f != _functions.end(); ++f) {
+		for (int l = 0; l < n_lengths; ++l) {
+			nframes_t const n = lengths[l];
+
+			CPPUNIT_ASSERT_EQUAL (default_compute_peak (_src, n, 0.0f), f->compute_peak (_src, n, 0.0f));
+			CPPUNIT_ASSERT_EQUAL (2.0f, f->compute_peak (_src, n, 2.0f));
+
+			float ref_min = 0.0f, ref_max = 0.0f;
+			float min = 0.0f, max = 0.0f;
+			default_find_peaks (_src, n, &ref_min, &ref_max);
+			f->find_peaks (_src, n, &min, &max);
+			CPPUNIT_ASSERT_EQUAL (ref_min, min);
+			CPPUNIT_ASSERT_EQUAL (ref_max, max);
+		}
+	}
+}
+
+void
+MixTest::meterTest ()
+{
+	/* three channels, the last two not aligned */
+	Sample const * bufs[3] = { _src, _src + size + 1, _src + 2 * size + 3 };
+
+	for (vector<Functions>::iterator f = _functions.begin(); f != _functions.end(); ++f) {
+		for (int l = 0; l < n_lengths; ++l) {
+			nframes_t const n = lengths[l];
+
+			/* peaks carry on from earlier cycles, so start them off somewhere */
+			float ref_peaks[3] = { 0.0f, 0.5f, 2.0f };
+			float peaks[3] = { 0.0f, 0.5f, 2.0f };
+			float ref_powers[3] = { 0.0f, 1.0f, 0.0f };
+			float powers[3] = { 0.0f, 1.0f, 0.0f };
+
+			default_compute_meter (bufs, 3, n, ref_peaks, ref_powers);
+			f->compute_meter (bufs, 3, n, peaks, powers);
+
+			for (int c = 0; c < 3; ++c) {
+				CPPUNIT_ASSERT_EQUAL (ref_peaks[c], peaks[c]);
+				/* the sums may be added up in a different order */
+				CPPUNIT_ASSERT_DOUBLES_EQUAL (ref_powers[c], powers[c], 1e-5 * ref_powers[c]);
+			}
+
+			CPPUNIT_ASSERT_EQUAL (2.0f, peaks[2]);
+
+			/* without RMS */
+			float peaks_only[3] = { 0.0f, 0.5f, 2.0f };
+			f->compute_meter (bufs, 3, n, peaks_only, 0);
+
+			for (int c = 0; c < 3; ++c) {
+				CPPUNIT_ASSERT_EQUAL (ref_peaks[c], peaks_only[c]);
+			}
+		}
+	}
+}
+
+void
+MixTest::interleaveTest ()
+{
+	uint32_t const channels[] = { 1, 2, 3, 4, 6 };
+
+	for (vector<Functions>::iterator f = _functions.begin(); f != _functions.end(); ++f) {
+		for (int c = 0; c < 5; ++c) {
+			uint32_t const nchannels = channels[c];
+			nframes_t const n = 1023;
+
+			for (uint32_t chn = 0; chn < nchannels; ++chn) {
+				/* the other channels must be left alone */
+				memcpy (_ref, _src + size, n * nchannels * sizeof (Sample));
+				memcpy (_out, _src + size, n * nchannels * sizeof (Sample));
+				default_interleave (_ref, _src, nchannels, chn, n);
+				f->interleave (_out, _src, nchannels, chn, n);
+				check_equal (f->name + " interleave", n * nchannels, 0);
+
+				default_deinterleave (_ref, _src, nchannels, chn, n);
+				f->deinterleave (_out, _src, nchannels, chn, n);
+				check_equal (f->name + " deinterleave", n, 0);
+			}
+		}
+	}
+}
+
+/** Run each implementation over a period's worth of frames many times
+ *  and print the time per frame, so that they can be compared on this CPU.
+ */
+void
+MixBenchmark::benchmark ()
+{
+	nframes_t const n = 1024;
+	int const iterations = 20000;
+
+	cout << endl << setw (28) << left << "ns/frame";
+	for (vector<Functions>::iterator f = _functions.begin(); f != _functions.end(); ++f) {
+		cout << setw (10) << right << f->name;
+	}
+	cout << endl;
+
+#define MIX_BENCHMARK(name, call) \
+	cout << setw (28) << left << name; \
+	for (vector<Functions>::iterator f = _functions.begin(); f != _functions.end(); ++f) { \
+		microseconds_t const start = get_microseconds (); \
+		for (int i = 0; i < iterations; ++i) { \
+			call; \
+		} \
+		microseconds_t const elapsed = get_microseconds () - start; \
+		cout << setw (10) << right << fixed << setprecision (3) << (elapsed * 1000.0 / ((double) iterations * n)); \
+	} \
+	cout << endl;
+
+	float min, max;
+	Sample* outs[2] = { _out, _out + size };
+	float const gains[2] = { 0.3f, 0.7f };
+
+	MIX_BENCHMARK ("compute_peak", f->compute_peak (_src, n, 0.0f));
+	MIX_BENCHMARK ("find_peaks", f->find_peaks (_src, n, &min, &max));
+	MIX_BENCHMARK ("apply_gain_to_buffer", f->apply_gain_to_buffer (_out, n, 0.999f));
+	MIX_BENCHMARK ("apply_gain_curve_to_buffer", f->apply_gain_curve_to_buffer (_out, n, _gains));
+	MIX_BENCHMARK ("mix_buffers_with_gain", f->mix_buffers_with_gain (_out, _src, n, 1e-6f));
+	MIX_BENCHMARK ("mix_buffers_no_gain", f->mix_buffers_no_gain (_out, _src, n));
+	MIX_BENCHMARK ("copy_buffer_with_gain", f->copy_buffer_with_gain (_out, _src, n, 0.5f));
+	MIX_BENCHMARK ("scale_and_offset_buffer", f->scale_and_offset_buffer (_out, n, _gains, 0, 1.0f, -1.0f, 1.0e-27f));
+	MIX_BENCHMARK ("crossfade_buffers", f->crossfade_buffers (_out, _src, _gains, _src + size, _gains + size - n, n));
+	MIX_BENCHMARK ("pan_buffers (stereo)", f->pan_buffers (outs, gains, 2, _src, n));
+	MIX_BENCHMARK ("interleave (stereo)", f->interleave (_out, _src, 2, 1, n));
+	MIX_BENCHMARK ("deinterleave (stereo)", f->deinterleave (_out, _src, 2, 1, n));
+
+#undef MIX_BENCHMARK
+}
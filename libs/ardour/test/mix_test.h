@@ -0,0 +1,75 @@
+#include <string>
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ardour/runtime_functions.h"
+
+/** Checks every implementation of the mixing primitives that the running
+ *  CPU supports against the generic ones.
+ */
+class MixTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (MixTest);
+	CPPUNIT_TEST (gainTest);
+	CPPUNIT_TEST (mixTest);
+	CPPUNIT_TEST (peakTest);
+	CPPUNIT_TEST (meterTest);
+	CPPUNIT_TEST (interleaveTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void setUp ();
+	void tearDown ();
+
+	void gainTest ();
+	void mixTest ();
+	void peakTest ();
+	void meterTest ();
+	void interleaveTest ();
+
+protected:
+	/** one set of implementations, as setup_hardware_optimization() would choose them */
+	struct Functions {
+		std::string                          name;
+		ARDOUR::compute_peak_t               compute_peak;
+		ARDOUR::find_peaks_t                 find_peaks;
+		ARDOUR::compute_meter_t              compute_meter;
+		ARDOUR::apply_gain_to_buffer_t       apply_gain_to_buffer;
+		ARDOUR::mix_buffers_with_gain_t      mix_buffers_with_gain;
+		ARDOUR::mix_buffers_no_gain_t        mix_buffers_no_gain;
+		ARDOUR::pan_buffers_t                pan_buffers;
+		ARDOUR::pan_equal_power_stereo_t     pan_equal_power_stereo;
+		ARDOUR::apply_gain_curve_to_buffer_t apply_gain_curve_to_buffer;
+		ARDOUR::copy_buffer_with_gain_t      copy_buffer_with_gain;
+		ARDOUR::interleave_t                 interleave;
+		ARDOUR::deinterleave_t               deinterleave;
+		ARDOUR::scale_and_offset_buffer_t    scale_and_offset_buffer;
+		ARDOUR::crossfade_buffers_t          crossfade_buffers;
+	};
+
+	std::vector<Functions> _functions;
+
+	static const ARDOUR::nframes_t size = 8192;
+
+	ARDOUR::Sample* _src;
+	ARDOUR::Sample* _ref;
+	ARDOUR::Sample* _out;
+	ARDOUR::Sample* _gains;
+
+	void reset (ARDOUR::Sample *, ARDOUR::nframes_t);
+	void check_equal (std::string const &, ARDOUR::nframes_t, float tolerance = 1e-6);
+};
+
+/** Times every implementation of the mixing primitives that the running
+ *  CPU supports.  Not part of the default run; use "run-tests Benchmarks".
+ */
+class MixBenchmark : public MixTest
+{
+	CPPUNIT_TEST_SUITE (MixBenchmark);
+	CPPUNIT_TEST (benchmark);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void benchmark ();
+};
@@ -0,0 +1,200 @@
+#include <cmath>
+#include <algorithm>
+
+#include "peak_scan_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (PeakScanTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+namespace {
+
+/** Reads from a vector, counting the frames that it reads */
+struct Reader {
+	Reader (vector<Sample> const & d, framecnt_t& c) : data (d), count (c) {}
+
+	framecnt_t operator() (Sample* buf, framepos_t pos, framecnt_t cnt) const {
+		cnt = min (cnt, (framecnt_t) data.size() - pos);
+		copy (data.begin() + pos, data.begin() + pos + cnt, buf);
+		count += cnt;
+		return cnt;
+	}
+
+	vector<Sample> const & data;
+	framecnt_t& count;
+};
+
+framecnt_t
+failing_reader (Sample*, framepos_t, framecnt_t)
+{
+	return 0;
+}
+
+/** @return peaks of data as AudioRegion::file_peaks() would give them for a
+ *  region from start to start + length: -1 for those which are partly outside it.
+ */
+vector<Sample>
+peaks (vector<Sample> const & data, framecnt_t fpp, framepos_t start, framecnt_t length)
+{
+	framepos_t const first = start / fpp;
+	framepos_t const last = (start + length - 1) / fpp;
+	vector<Sample> p (last - first + 1, -1);
+
+	for (framepos_t i = (start + fpp - 1) / fpp; i < (start + length) / fpp; ++i) {
+		p[i - first] = 0;
+		for (framepos_t j = i * fpp; j < (i + 1) * fpp; ++j) {
+			p[i - first] = max (p[i - first], fabsf (data[j]));
+		}
+	}
+
+	return p;
+}
+
+void
+make_loud (vector<Sample>& data, framepos_t from, framepos_t to, Sample level)
+{
+	for (framepos_t i = from; i < to; ++i) {
+		data[i] = (i % 2) ? level : -level;
+	}
+}
+
+}
+
+void
+PeakScanTest::silenceTest ()
+{
+	framecnt_t const fpp = 256;
+	framepos_t const start = 1000;
+	framecnt_t const length = 190000;
+	Sample const threshold = 0.01;
+
+	/* silent from 10000 to 30000, 50000 to 60000, briefly at 70000 and from
+	   185000 to beyond the end of the region
+	*/
+
+	vector<Sample> data (200000, 0);
+	make_loud (data, 0, 10000, 0.5);
+	make_loud (data, 30000, 50000, 0.5);
+	make_loud (data, 60000, 70000, 0.5);
+	make_loud (data, 71000, 185000, 0.5);
+
+	vector<Sample> const known = peaks (data, fpp, start, length);
+	vector<Sample> const unknown (known.size(), -1);
+
+	PeakScan::Periods expected;
+	expected.push_back (make_pair (9000, 28999));
+	expected.push_back (make_pair (49000, 58999));
+	expected.push_back (make_pair (184000, length - 1));
+
+	InterThreadInfo itt;
+	framecnt_t with_peaks = 0;
+	framecnt_t without_peaks = 0;
+
+	PeakScan::Periods const a = PeakScan (known, fpp, start, length, Reader (data, with_peaks)).find_silence (threshold, 3000, itt, true);
+	PeakScan::Periods const b = PeakScan (unknown, fpp, start, length, Reader (data, without_peaks)).find_silence (threshold, 3000, itt, false);
+
+	CPPUNIT_ASSERT (a == expected);
+	CPPUNIT_ASSERT (b == expected);
+	CPPUNIT_ASSERT_EQUAL (length, without_peaks);
+	CPPUNIT_ASSERT (with_peaks < length / 4);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (1.0, itt.progress, 1e-6);
+
+	/* shorter than 2 peaks, so that loud peaks must be read too */
+
+	PeakScan::Periods::iterator i = expected.begin ();
+	advance (i, 2);
+	expected.insert (i, make_pair (69000, 69999));
+
+	with_peaks = 0;
+	PeakScan::Periods const c = PeakScan (known, fpp, start, length, Reader (data, with_peaks)).find_silence (threshold, 500, itt, false);
+	PeakScan::Periods const d = PeakScan (unknown, fpp, start, length, Reader (data, without_peaks)).find_silence (threshold, 500, itt, false);
+
+	CPPUNIT_ASSERT (c == expected);
+	CPPUNIT_ASSERT (d == expected);
+	CPPUNIT_ASSERT (with_peaks < length);
+
+	/* what cannot be read is taken to be loud */
+
+	CPPUNIT_ASSERT (PeakScan (unknown, fpp, start, length, failing_reader).find_silence (threshold, 500, itt, false).empty ());
+}
+
+void
+PeakScanTest::intersectTest ()
+{
+	vector<PeakScan::Periods> channels (3);
+
+	channels[0].push_back (make_pair (0, 99));
+	channels[0].push_back (make_pair (200, 399));
+	channels[0].push_back (make_pair (600, 999));
+
+	channels[1].push_back (make_pair (50, 299));
+	channels[1].push_back (make_pair (350, 700));
+
+	channels[2].push_back (make_pair (0, 1000));
+
+	PeakScan::Periods expected;
+	expected.push_back (make_pair (50, 99));
+	expected.push_back (make_pair (200, 299));
+	expected.push_back (make_pair (350, 399));
+	expected.push_back (make_pair (600, 700));
+
+	CPPUNIT_ASSERT (PeakScan::intersect (channels, 40) == expected);
+
+	/* periods which are long enough in each channel may not be where they overlap */
+
+	expected.clear ();
+	expected.push_back (make_pair (200, 299));
+	expected.push_back (make_pair (600, 700));
+
+	CPPUNIT_ASSERT (PeakScan::intersect (channels, 60) == expected);
+
+	/* a channel which is never silent means that the region never is */
+
+	channels.push_back (PeakScan::Periods ());
+	CPPUNIT_ASSERT (PeakScan::intersect (channels, 0).empty ());
+
+	CPPUNIT_ASSERT (PeakScan::intersect (vector<PeakScan::Periods> (1, expected), 0) == expected);
+	CPPUNIT_ASSERT (PeakScan::intersect (vector<PeakScan::Periods> (), 0).empty ());
+}
+
+void
+PeakScanTest::maximumTest ()
+{
+	framecnt_t const fpp = 256;
+	framepos_t const start = 1000;
+	framecnt_t const length = 900000;
+
+	vector<Sample> data (1000000);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = 0.1 * sin (i * 0.01);
+	}
+
+	data[400000] = -0.95;
+	data[700000] = 0.9;
+
+	/* outside the region, but in the same peak as its first frame */
+	data[900] = 1.0;
+
+	vector<Sample> known = peaks (data, fpp, start, length);
+	vector<Sample> const unknown (known.size(), -1);
+
+	framecnt_t with_peaks = 0;
+	framecnt_t without_peaks = 0;
+
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (0.95, PeakScan (known, fpp, start, length, Reader (data, with_peaks)).maximum_amplitude (), 1e-6);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (0.95, PeakScan (unknown, fpp, start, length, Reader (data, without_peaks)).maximum_amplitude (), 1e-6);
+	CPPUNIT_ASSERT_EQUAL (length, without_peaks);
+
+	/* the block holding 0.95 and the blocks at each end of the region, whose
+	   end peaks are not known, are all that need be read
+	*/
+	CPPUNIT_ASSERT (with_peaks <= 3 * 64 * 1024);
+
+	/* the largest value may be in a peak which is only partly in the region */
+
+	data[start + 3] = -0.99;
+	CPPUNIT_ASSERT_DOUBLES_EQUAL (0.99, PeakScan (known, fpp, start, length, Reader (data, with_peaks)).maximum_amplitude (), 1e-6);
+
+	CPPUNIT_ASSERT_EQUAL (-1.0, PeakScan (known, fpp, start, length, failing_reader).maximum_amplitude ());
+}
@@ -0,0 +1,23 @@
+#include <vector>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ardour/peak_scan.h"
+
+/** Checks that the scans used by AudioRegion::find_silence() and
+ *  AudioRegion::normalize_to() give the same answers whether or not they
+ *  have peaks to work from, and that the peaks save reading.
+ */
+class PeakScanTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (PeakScanTest);
+	CPPUNIT_TEST (silenceTest);
+	CPPUNIT_TEST (intersectTest);
+	CPPUNIT_TEST (maximumTest);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void silenceTest ();
+	void intersectTest ();
+	void maximumTest ();
+};
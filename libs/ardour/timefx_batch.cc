@@ -0,0 +1,153 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <glibmm/thread.h>
+#include <glibmm/timer.h>
+#include <boost/bind.hpp>
+
+#include "pbd/cpus.h"
+
+#include "ardour/filter.h"
+#include "ardour/timefx_batch.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+/** @param request Settings for every region; also used for overall progress and to cancel.
+ *  @param factory Used to make a filter for each region.
+ *  @param regions Regions to process.
+ */
+TimeFXBatch::TimeFXBatch (TimeFXRequest& request, FilterFactory factory, vector<boost::shared_ptr<Region> > const & regions)
+	: _request (request)
+	, _regions (regions)
+	, _requests (regions.size(), request)
+	, _status (regions.size(), -1)
+	, _messages (regions.size())
+	, _next (0)
+{
+	for (size_t i = 0; i < _regions.size(); ++i) {
+		_filters.push_back (factory (_requests[i]));
+	}
+}
+
+TimeFXBatch::~TimeFXBatch ()
+{
+	for (vector<Filter*>::iterator i = _filters.begin(); i != _filters.end(); ++i) {
+		delete *i;
+	}
+}
+
+/** Process all the regions and fill in results.  New sources are made and
+ *  results are created on the calling thread, one region after another, but
+ *  the processing is spread over a pool of threads.  Anything that the
+ *  processing says is passed on from this thread, before the region's results
+ *  are made.
+ *  @return 0 if every region was processed successfully, otherwise -1.
+ */
+int
+TimeFXBatch::run ()
+{
+	_request.progress = 0;
+	_request.done = false;
+
+	for (size_t i = 0; i < _regions.size(); ++i) {
+		_status[i] = _filters[i]->prepare (_regions[i]);
+	}
+
+	uint32_t const threads = min ((uint32_t) _regions.size(), hardware_concurrency ());
+	vector<Glib::Thread*> workers;
+
+	for (uint32_t i = 0; i < threads; ++i) {
+		try {
+			workers.push_back (Glib::Thread::create (boost::bind (&TimeFXBatch::work, this), true));
+		} catch (Glib::ThreadError& err) {
+			break;
+		}
+	}
+
+	if (workers.empty ()) {
+		work ();
+	}
+
+	/* while the workers run, pass on any request to cancel and add up
+	   the regions' progress
+	*/
+
+	while (g_atomic_int_get (&_next) < (gint) _regions.size() + (gint) workers.size()) {
+
+		float progress = 0;
+
+		for (size_t i = 0; i < _requests.size(); ++i) {
+			_requests[i].cancel = _request.cancel;
+			progress += _requests[i].progress;
+		}
+
+		_request.progress = progress / _requests.size();
+
+		Glib::usleep (50000);
+	}
+
+	for (vector<Glib::Thread*>::iterator i = workers.begin(); i != workers.end(); ++i) {
+		(*i)->join ();
+	}
+
+	int ret = 0;
+
+	results.clear ();
+
+	for (size_t i = 0; i < _regions.size(); ++i) {
+		_messages[i].deliver ();
+		_requests[i].cancel = _request.cancel;
+		if (_filters[i]->complete (_status[i]) == 0) {
+			results.push_back (_filters[i]->results);
+		} else {
+			results.push_back (vector<boost::shared_ptr<Region> > ());
+			ret = -1;
+		}
+	}
+
+	_request.progress = 1;
+	_request.done = true;
+
+	return ret;
+}
+
+/** Process regions until there are none left; run by each of our threads.
+ *  Each thread has one set of buffers which it uses for all of its regions.
+ */
+void
+TimeFXBatch::work ()
+{
+	Filter::Buffers buffers;
+
+	while (true) {
+
+		size_t const n = g_atomic_int_exchange_and_add (&_next, 1);
+
+		if (n >= _regions.size()) {
+			break;
+		}
+
+		if (_status[n] == 0) {
+			Transmitter::hold_messages (&_messages[n]);
+			_status[n] = _filters[n]->process (buffers);
+			Transmitter::hold_messages (0);
+		}
+	}
+}
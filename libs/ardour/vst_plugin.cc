@@ -383,7 +383,7 @@ VSTPlugin::automatable () const
 
 int
 VSTPlugin::connect_and_run (BufferSet& bufs,
-		ChanMapping in_map, ChanMapping out_map,
+		ChanMapping const & in_map, ChanMapping const & out_map,
 		nframes_t nframes, nframes_t offset)
 {
 	float *ins[_plugin->numInputs];
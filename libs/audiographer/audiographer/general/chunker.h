@@ -35,9 +35,24 @@ class Chunker
 	
 	/** Outputs data in \a context in chunks with the size specified in the constructor.
 	  * Note that some calls might not produce any output, while others may produce several.
+	  * Whole chunks in \a context are passed on without being copied.
 	  * \n RT safe
 	  */
 	void process (ProcessContext<T> const & context)
+	{
+		do_process (context, false);
+	}
+	
+	/// As the const version, but whole chunks are passed on non-const \n RT safe
+	void process (ProcessContext<T> & context)
+	{
+		do_process (context, true);
+	}
+	
+	bool modifies_data () const { return ListedSource<T>::outputs_modify_data (); }
+	
+  private:
+	void do_process (ProcessContext<T> const & context, bool writable)
 	{
 		check_flags (*this, context);
 		
@@ -45,6 +60,23 @@ class Chunker
 		nframes_t input_position = 0;
 		
 		while (position + frames_left >= chunk_size) {
+			
+			if (position == 0) {
+				// A whole chunk is in the context, so output it from there
+				T * data = const_cast<T *> (&context.data()[input_position]);
+				if (writable) {
+					ProcessContext<T> c_out (context, data, chunk_size);
+					ListedSource<T>::output (c_out);
+				} else {
+					ConstProcessContext<T> c_out (context, data, chunk_size);
+					ListedSource<T>::output (c_out);
+				}
+				
+				input_position += chunk_size;
+				frames_left -= chunk_size;
+				continue;
+			}
+			
 			// Copy from context to buffer
 			nframes_t const frames_to_copy = chunk_size - position;
 			TypeUtils<T>::copy (&context.data()[input_position], &buffer[position], frames_to_copy);
@@ -70,9 +102,7 @@ class Chunker
 			ListedSource<T>::output (c_out);
 		}
 	}
-	using Sink<T>::process;
 	
-  private:
 	nframes_t chunk_size;
 	nframes_t position;
 	T * buffer;
@@ -64,12 +64,12 @@ class DeInterleaver
 		
 		nframes_t const  frames_per_channel = frames / channels;
 		
-		if (throw_level (ThrowProcess) && c.channels() != channels) {
-			throw Exception (*this, "wrong amount of channels given to process()");
-		}
+		check_input (c);
 		
-		if (throw_level (ThrowProcess) && frames_per_channel > max_frames) {
-			throw Exception (*this, "too many frames given to process()");
+		if (channels == 1) {
+			// Nothing to deinterleave, so pass the data straight on
+			if (outputs[0]) { outputs[0]->process (c); }
+			return;
 		}
 		
 		unsigned int channel = 0;
@@ -85,10 +85,33 @@ class DeInterleaver
 		}
 	}
 	
-	using Sink<T>::process;
+	/// As the const version, but single channel data is passed on non-const \n RT safe
+	void process (ProcessContext<T> & c)
+	{
+		if (channels != 1) {
+			process (static_cast<ProcessContext<T> const &> (c));
+			return;
+		}
+		
+		check_input (c);
+		if (outputs[0]) { outputs[0]->process (c); }
+	}
+	
+	bool modifies_data () const { return channels == 1 && outputs[0] && outputs[0]->modifies_data (); }
 	
   private:
 
+	void check_input (ProcessContext<T> const & c)
+	{
+		if (throw_level (ThrowProcess) && c.channels() != channels) {
+			throw Exception (*this, "wrong amount of channels given to process()");
+		}
+		
+		if (throw_level (ThrowProcess) && c.frames() / channels > max_frames) {
+			throw Exception (*this, "too many frames given to process()");
+		}
+	}
+
 	void reset ()
 	{
 		outputs.clear();
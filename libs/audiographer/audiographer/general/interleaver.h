@@ -64,7 +64,16 @@ class Interleaver
 		Input (Interleaver & parent, unsigned int channel)
 		  : frames_written (0), parent (parent), channel (channel) {}
 		
-		void process (ProcessContext<T> const & c)
+		void process (ProcessContext<T> const & c) { do_process (c, false); }
+		void process (ProcessContext<T> & c) { do_process (c, true); }
+		
+		bool modifies_data () const { return parent.channels == 1 && parent.outputs_modify_data (); }
+		
+		nframes_t frames() { return frames_written; }
+		void reset() { frames_written = 0; }
+		
+	  private:
+		void do_process (ProcessContext<T> const & c, bool writable)
 		{
 			if (parent.throw_level (ThrowProcess) && c.channels() > 1) {
 				throw Exception (*this, "Data input has more than on channel");
@@ -73,15 +82,9 @@ class Interleaver
 				throw Exception (*this, "Input channels out of sync");
 			}
 			frames_written = c.frames();
-			parent.write_channel (c, channel);
+			parent.write_channel (c, channel, writable);
 		}
 		
-		using Sink<T>::process;
-		
-		nframes_t frames() { return frames_written; }
-		void reset() { frames_written = 0; }
-		
-	  private:
 		nframes_t frames_written;
 		Interleaver & parent;
 		unsigned int channel;
@@ -104,13 +107,25 @@ class Interleaver
 
 	}
 	
-	void write_channel (ProcessContext<T> const & c, unsigned int channel)
+	void write_channel (ProcessContext<T> const & c, unsigned int channel, bool writable)
 	{
 		if (throw_level (ThrowProcess) && c.frames() > max_frames) {
 			reset_channels();
 			throw Exception (*this, "Too many frames given to an input");
 		}
 		
+		if (channels == 1) {
+			// Nothing to interleave, so pass the data straight on
+			reset_channels ();
+			if (writable) {
+				ProcessContext<T> c_out (c, const_cast<T *> (c.data()));
+				ListedSource<T>::output (c_out);
+			} else {
+				ListedSource<T>::output (c);
+			}
+			return;
+		}
+		
 		for (unsigned int i = 0; i < c.frames(); ++i) {
 			buffer[channel + (channels * i)] = c.data()[i];
 		}
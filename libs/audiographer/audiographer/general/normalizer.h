@@ -80,6 +80,8 @@ class Normalizer
 		ListedSource<float>::output(c);
 	}
 	
+	bool modifies_data () const { return enabled || outputs_modify_data (); }
+	
   private:
 	bool      enabled;
 	float     target;
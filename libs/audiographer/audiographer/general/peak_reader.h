@@ -28,7 +28,14 @@ class PeakReader : public ListedSource<float>, public Sink<float>
 		ListedSource<float>::output(c);
 	}
 	
-	using Sink<float>::process;
+	/// Finds peaks from the data, and passes it on non-const \n RT safe
+	void process (ProcessContext<float> & c)
+	{
+		peak = Routines::compute_peak (c.data(), c.frames(), peak);
+		ListedSource<float>::output(c);
+	}
+	
+	bool modifies_data () const { return outputs_modify_data (); }
 	
   private:
 	float peak;
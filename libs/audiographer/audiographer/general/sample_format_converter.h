@@ -51,6 +51,9 @@ class SampleFormatConverter
 	/// This version is only different in the case when \a TOut = float, and float clipping is on.
 	void process (ProcessContext<float> & c_in);
 
+	/// Only true when \a TOut = float, and float clipping is on or an output modifies data.
+	bool modifies_data () const;
+
   private:
 	void reset();
 	void init_common(nframes_t max_frames); // not-template-specialized part of init
@@ -118,6 +118,21 @@ class SilenceTrimmer
 	  * \n RT safe
 	  */
 	void process (ProcessContext<T> const & c)
+	{
+		do_process (c, false);
+	}
+
+	/// As the const version, but data from \a c is passed on non-const \n RT safe
+	void process (ProcessContext<T> & c)
+	{
+		do_process (c, true);
+	}
+
+	bool modifies_data () const { return ListedSource<T>::outputs_modify_data (); }
+
+  private:
+
+	void do_process (ProcessContext<T> const & c, bool writable)
 	{
 		if (debug_level (DebugVerbose)) {
 			debug_stream () << DebugUtils::demangled_name (*this) <<
@@ -170,8 +185,7 @@ class SilenceTrimmer
 				}
 				
 				in_beginning = false;
-				ConstProcessContext<T> c_out (c, &c.data()[frame_index], c.frames() - frame_index);
-				ListedSource<T>::output (c_out);
+				output_data (c, frame_index, writable);
 			}
 			
 		} else if (trim_end) { // Only check zero samples if trimming end
@@ -185,7 +199,7 @@ class SilenceTrimmer
 				
 				// context contains non-zero data
 				output_silence_frames (c, silence_frames); // flush intermediate silence
-				ListedSource<T>::output (c); // output rest of data
+				output_data (c, 0, writable); // output rest of data
 			} else { // whole context is zero
 				
 				if (debug_level (DebugVerbose)) {
@@ -203,7 +217,7 @@ class SilenceTrimmer
 					" outputting whole frame in middle" << std::endl;
 			}
 			
-			ListedSource<T>::output (c);
+			output_data (c, 0, writable);
 		}
 		
 		// Finally, if in end, add silence to end
@@ -219,9 +233,18 @@ class SilenceTrimmer
 		}
 	}
 
-	using Sink<T>::process;
-
-  private:
+	/// Outputs the data in \a c from \a frame_index on, non-const if \a writable
+	void output_data (ProcessContext<T> const & c, nframes_t frame_index, bool writable)
+	{
+		T * data = const_cast<T *> (&c.data()[frame_index]);
+		if (writable) {
+			ProcessContext<T> c_out (c, data, c.frames() - frame_index);
+			ListedSource<T>::output (c_out);
+		} else {
+			ConstProcessContext<T> c_out (c, data, c.frames() - frame_index);
+			ListedSource<T>::output (c_out);
+		}
+	}
 
 	bool find_first_non_zero_sample (ProcessContext<T> const & c, nframes_t & result_frame)
 	{
@@ -37,7 +37,11 @@ class SampleRateConverter
 	  * \TODO Check RT safety from libsamplerate
 	  */
 	void process (ProcessContext<float> const & c);
-	using Sink<float>::process;
+	
+	/// As the const version, but if no conversion is needed \a c is passed on non-const \n RT safe
+	void process (ProcessContext<float> & c);
+	
+	bool modifies_data () const { return !active && outputs_modify_data (); }
 
   private:
 
@@ -37,6 +37,14 @@ class Sink  {
 	{
 		this->process (static_cast<ProcessContext<T> const &> (context));
 	}
+
+	/** Tells whether data given to the non-const process() may be modified,
+	  * either by this sink or by one that it passes the data on to.
+	  * A source with several outputs uses this to pick the one which
+	  * is given a non-const context, so that it does not have to copy the data.
+	  * Sinks which override the non-const process() should override this too.
+	  */
+	virtual bool modifies_data () const { return false; }
 };
 
 } // namespace
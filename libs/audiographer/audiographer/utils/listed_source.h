@@ -35,9 +35,36 @@ class ListedSource : public Source<T>
 		if (output_size_is_one()) {
 			// only one output, so we can keep this non-const
 			outputs.front()->process (c);
-		} else {
-			output (const_cast<ProcessContext<T> const &> (c));
+			return;
 		}
+
+		/* Give the data to the outputs which only read it first, and then to the
+		 * first one which wants to modify it, which can do so in place.  Any other
+		 * outputs which modify data get it const, and make their own copy.
+		 */
+		typename Source<T>::SinkPtr in_place;
+		for (typename SinkList::iterator i = outputs.begin(); i != outputs.end(); ++i) {
+			if (!in_place && (*i)->modifies_data ()) {
+				in_place = *i;
+			} else {
+				(*i)->process (const_cast<ProcessContext<T> const &> (c));
+			}
+		}
+
+		if (in_place) {
+			in_place->process (c);
+		}
+	}
+
+	/// Helper for derived classes which pass on non-const data, \see Sink::modifies_data()
+	bool outputs_modify_data () const
+	{
+		for (typename SinkList::const_iterator i = outputs.begin(); i != outputs.end(); ++i) {
+			if ((*i)->modifies_data ()) {
+				return true;
+			}
+		}
+		return false;
 	}
 
 	inline bool output_size_is_one () { return (!outputs.empty() && ++outputs.begin() == outputs.end()); }
@@ -44,6 +44,11 @@
 #endif
 
 #include <sys/types.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /* Lipshitz's minimally audible FIR, only really works for 46kHz-ish signals */
 static const float shaped_bs[] = { 2.033f, -2.165f, 1.959f, -1.590f, 0.6149f };
@@ -151,6 +156,17 @@ GDither gdither_new(GDitherType type, uint32_t channels,
 	break;
     }
 
+    if (type != GDitherNone) {
+	/* noise for gdither_run_interleaved(); a few frames of history,
+	 * then room for a block, rounded up to a multiple of 4 */
+	s->noise = (float *) calloc((GDITHER_HISTORY + GDITHER_BLOCK) * channels
+				    + 3, sizeof(float));
+	s->rng[0] = 23232323;
+	s->rng[1] = 362436069;
+	s->rng[2] = 521288629;
+	s->rng[3] = 88675123;
+    }
+
     return s;
 }
 
@@ -159,6 +175,7 @@ void gdither_free(GDither s)
     if (s) {
 	free(s->tri_state);
 	free(s->shaped_state);
+	free(s->noise);
 	free(s);
     }
 }
@@ -471,4 +488,244 @@ void gdither_runf(GDither s, uint32_t channel, uint32_t length,
     }
 }
 
+/* Fill n floats, rounded up to a multiple of 4, with white noise between
+ * 0.0f and 1.0f. The noise comes from four xorshift generators run side by
+ * side, which is much cheaper than GDITHER_NOISE when vectorised and gives
+ * the same numbers either way. */
+static void gdither_fill_noise(uint32_t *rng, float *w, uint32_t n)
+{
+    uint32_t i;
+
+#ifdef __SSE2__
+    __m128i r = _mm_loadu_si128((__m128i const *) rng);
+    const __m128 k = _mm_set1_ps(1.0f / 16777216.0f);
+
+    for (i = 0; i < n; i += 4) {
+	r = _mm_xor_si128(r, _mm_slli_epi32(r, 13));
+	r = _mm_xor_si128(r, _mm_srli_epi32(r, 17));
+	r = _mm_xor_si128(r, _mm_slli_epi32(r, 5));
+	_mm_storeu_ps(w + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(r, 8)), k));
+    }
+
+    _mm_storeu_si128((__m128i *) rng, r);
+#else
+    uint32_t j, t;
+
+    for (i = 0; i < n; i += 4) {
+	for (j = 0; j < 4; j++) {
+	    t = rng[j];
+	    t ^= t << 13;
+	    t ^= t >> 17;
+	    t ^= t << 5;
+	    rng[j] = t;
+	    w[i + j] = (float) (int32_t) (t >> 8) * (1.0f / 16777216.0f);
+	}
+    }
+#endif
+}
+
+/* The shaped dither filter, with the 0.5 applied to the noise folded in */
+static const float shaped_half_bs[] = { 1.0165f, -1.0825f, 0.9795f, -0.795f, 0.30745f };
+
+/* Dither for the sample whose noise is at w; the noise for the previous
+ * samples of the same channel is at w - stride, w - 2 * stride ... Without
+ * the error feedback, which gdither_innner_loop() overwrites before using,
+ * shaped dither is just filtered noise, so it can be worked out ahead.
+ */
+inline static float gdither_dither(const GDitherType dt, float const *w,
+				   const uint32_t stride)
+{
+    switch (dt) {
+    case GDitherRect:
+	return -w[0];
+    case GDitherTri:
+	return w[-(int) stride] - w[0];
+    case GDitherShaped:
+	return w[0] * shaped_half_bs[0]
+	       + w[-(int) stride] * shaped_half_bs[1]
+	       + w[-2 * (int) stride] * shaped_half_bs[2]
+	       + w[-3 * (int) stride] * shaped_half_bs[3]
+	       + w[-4 * (int) stride] * shaped_half_bs[4];
+    default:
+	return 0.0f;
+    }
+}
+
+#ifdef __SSE2__
+/* gdither_dither() for 4 samples at once; the sums are done in the same
+ * order, so the results are the same */
+inline static __m128 gdither_dither_sse(const GDitherType dt, float const *w,
+					const uint32_t stride)
+{
+    __m128 d;
+
+    switch (dt) {
+    case GDitherRect:
+	return _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(w));
+    case GDitherTri:
+	return _mm_sub_ps(_mm_loadu_ps(w - stride), _mm_loadu_ps(w));
+    case GDitherShaped:
+	d = _mm_mul_ps(_mm_loadu_ps(w), _mm_set1_ps(shaped_half_bs[0]));
+	d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(w - stride),
+				     _mm_set1_ps(shaped_half_bs[1])));
+	d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(w - 2 * stride),
+				     _mm_set1_ps(shaped_half_bs[2])));
+	d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(w - 3 * stride),
+				     _mm_set1_ps(shaped_half_bs[3])));
+	d = _mm_add_ps(d, _mm_mul_ps(_mm_loadu_ps(w - 4 * stride),
+				     _mm_set1_ps(shaped_half_bs[4])));
+	return d;
+    default:
+	return _mm_setzero_ps();
+    }
+}
+#endif
+
+/* Convert n interleaved samples to 16 bit, or to 24 bits in the upper bits
+ * of a 32 bit word. Samples are clamped before they are rounded, which
+ * gives the same result as gdither_innner_loop()'s rounding and then
+ * clamping, and lets the rounding be done 4 at a time. */
+inline static void gdither_interleaved_loop(const GDitherType dt,
+    const int bit_depth, const uint32_t stride, const float scale,
+
+    const int clamp_u, const int clamp_l, const uint32_t n, float const *w,
+
+    float const *x, void *y)
+{
+    int16_t *o16 = (int16_t*) y;
+    int32_t *o32 = (int32_t*) y;
+    const float lo = (float) clamp_l;
+    const float hi = (float) clamp_u;
+    uint32_t i = 0;
+    float tmp;
+    long clamped;
+
+#ifdef __SSE2__
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 vlo = _mm_set1_ps(lo);
+    const __m128 vhi = _mm_set1_ps(hi);
+    __m128 t;
+    __m128i v;
+
+    for (; i + 4 <= n; i += 4) {
+	t = _mm_mul_ps(_mm_loadu_ps(x + i), vscale);
+	if (dt != GDitherNone) {
+	    t = _mm_add_ps(t, gdither_dither_sse(dt, w + i, stride));
+	}
+	/* NaN becomes lo, as it does below */
+	t = _mm_min_ps(_mm_max_ps(t, vlo), vhi);
+	v = _mm_cvtps_epi32(t);
+
+	if (bit_depth == GDither16bit) {
+	    _mm_storel_epi64((__m128i *) (o16 + i), _mm_packs_epi32(v, v));
+	} else {
+	    _mm_storeu_si128((__m128i *) (o32 + i), _mm_slli_epi32(v, 8));
+	}
+    }
+#endif
+
+    for (; i < n; i++) {
+	tmp = x[i] * scale;
+	if (dt != GDitherNone) {
+	    tmp += gdither_dither(dt, w + i, stride);
+	}
+	if (!(tmp >= lo)) {
+	    tmp = lo;
+	} else if (tmp > hi) {
+	    tmp = hi;
+	}
+	clamped = lrintf(tmp);
+
+	if (bit_depth == GDither16bit) {
+	    o16[i] = (int16_t) clamped;
+	} else {
+	    o32[i] = (int32_t) (clamped * 256);
+	}
+    }
+}
+
+void gdither_run_interleaved(GDither s, uint32_t frames, float const *x,
+			     void *y)
+{
+    uint32_t c, f, n, history;
+    int bytes;
+    float *w;
+
+    if (!s) {
+	return;
+    }
+
+    if (!(s->bit_depth == 16 && s->dither_depth == 16)
+	&& !(s->bit_depth == 32 && s->dither_depth == 24)) {
+	for (c = 0; c < s->channels; c++) {
+	    gdither_runf(s, c, frames, x, y);
+	}
+	return;
+    }
+
+    bytes = s->bit_depth / 8;
+    history = GDITHER_HISTORY * s->channels;
+    w = s->noise ? s->noise + history : NULL;
+
+    while (frames > 0) {
+	f = frames < GDITHER_BLOCK ? frames : GDITHER_BLOCK;
+	n = f * s->channels;
+
+	if (w) {
+	    gdither_fill_noise(s->rng, w, n);
+	}
+
+	/* as in gdither_runf, constant arguments let the compiler drop
+	 * the branches in the inner loop */
+	if (s->bit_depth == 16) {
+	    switch (s->type) {
+	    case GDitherNone:
+		gdither_interleaved_loop(GDitherNone, 16, s->channels, SCALE_S16,
+					 MAX_S16, MIN_S16, n, w, x, y);
+		break;
+	    case GDitherRect:
+		gdither_interleaved_loop(GDitherRect, 16, s->channels, SCALE_S16,
+					 MAX_S16, MIN_S16, n, w, x, y);
+		break;
+	    case GDitherTri:
+		gdither_interleaved_loop(GDitherTri, 16, s->channels, SCALE_S16,
+					 MAX_S16, MIN_S16, n, w, x, y);
+		break;
+	    case GDitherShaped:
+		gdither_interleaved_loop(GDitherShaped, 16, s->channels, SCALE_S16,
+					 MAX_S16, MIN_S16, n, w, x, y);
+		break;
+	    }
+	} else {
+	    switch (s->type) {
+	    case GDitherNone:
+		gdither_interleaved_loop(GDitherNone, 32, s->channels, SCALE_S24,
+					 MAX_S24, MIN_S24, n, w, x, y);
+		break;
+	    case GDitherRect:
+		gdither_interleaved_loop(GDitherRect, 32, s->channels, SCALE_S24,
+					 MAX_S24, MIN_S24, n, w, x, y);
+		break;
+	    case GDitherTri:
+		gdither_interleaved_loop(GDitherTri, 32, s->channels, SCALE_S24,
+					 MAX_S24, MIN_S24, n, w, x, y);
+		break;
+	    case GDitherShaped:
+		gdither_interleaved_loop(GDitherShaped, 32, s->channels, SCALE_S24,
+					 MAX_S24, MIN_S24, n, w, x, y);
+		break;
+	    }
+	}
+
+	if (w) {
+	    /* keep the end of this block's noise for the next */
+	    memmove(s->noise, s->noise + n, history * sizeof(float));
+	}
+
+	x += n;
+	y = (char *) y + n * bytes;
+	frames -= f;
+    }
+}
+
 /* vi:set ts=8 sts=4 sw=4: */
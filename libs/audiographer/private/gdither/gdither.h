@@ -81,6 +81,18 @@ void gdither_free(GDither s);
 void gdither_runf(GDither s, uint32_t channel, uint32_t length,
 		   float const *x, void *y);
 
+/* Applies dithering to all channels of an interleaved signal at once.
+ *
+ * frames is the number of frames (samples per channel) in x. 16 bit and
+ * 24-in-32 bit output are converted several samples at a time, with a
+ * quicker noise source than gdither_runf(); other formats are passed on to
+ * gdither_runf(), one channel at a time. Without dither the output is the
+ * same as gdither_runf()'s. Use one or the other with a given GDither, as
+ * they do not share their dither state.
+ */
+void gdither_run_interleaved(GDither s, uint32_t frames, float const *x,
+			     void *y);
+
 /* see gdither_runf, vut input argument is double format */
 void gdither_run(GDither s, uint32_t channel, uint32_t length,
 		   double const *x, void *y);
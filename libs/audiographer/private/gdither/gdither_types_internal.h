@@ -29,6 +29,11 @@ extern "C" {
 #define GDITHER_SH_BUF_SIZE 8
 #define GDITHER_SH_BUF_MASK 7
 
+/* frames of noise kept from one block to the next by gdither_run_interleaved() */
+#define GDITHER_HISTORY 4
+/* frames handled at a time by gdither_run_interleaved() */
+#define GDITHER_BLOCK 256
+
 /* this must agree with whats in gdither_types.h */
 typedef enum {
     GDitherNone = 0,
@@ -65,6 +70,10 @@ typedef struct GDither_s {
     int   clamp_l;
     float *tri_state;
     GDitherShapedState *shaped_state;
+
+    /* state for gdither_run_interleaved() */
+    uint32_t rng[4];
+    float *noise;
 } *GDither;
 
 #ifdef __cplusplus
@@ -6,6 +6,10 @@
 
 #include <boost/format.hpp>
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
 namespace AudioGrapher
 {
 
@@ -118,9 +122,7 @@ SampleFormatConverter<TOut>::process (ProcessContext<float> const & c_in)
 
 	/* Do conversion */
 
-	for (uint32_t chn = 0; chn < c_in.channels(); ++chn) {
-		gdither_runf (dither, chn, c_in.frames_per_channel (), data, data_out);
-	}
+	gdither_run_interleaved (dither, c_in.frames_per_channel (), data, data_out);
 
 	/* Write forward */
 
@@ -145,7 +147,19 @@ SampleFormatConverter<float>::process (ProcessContext<float> & c_in)
 	float * data = c_in.data();
 	
 	if (clip_floats) {
-		for (nframes_t x = 0; x < frames; ++x) {
+		nframes_t x = 0;
+
+#ifdef __SSE__
+		__m128 const lo = _mm_set1_ps (-1.0f);
+		__m128 const hi = _mm_set1_ps (1.0f);
+
+		/* with the limits first, NaN is passed through as it is below */
+		for (; x + 4 <= frames; x += 4) {
+			_mm_storeu_ps (data + x, _mm_min_ps (hi, _mm_max_ps (lo, _mm_loadu_ps (data + x))));
+		}
+#endif
+
+		for (; x < frames; ++x) {
 			if (data[x] > 1.0f) {
 				data[x] = 1.0f;
 			} else if (data[x] < -1.0f) {
@@ -170,6 +184,20 @@ SampleFormatConverter<float>::process (ProcessContext<float> const & c_in)
 	process (c);
 }
 
+template<typename TOut>
+bool
+SampleFormatConverter<TOut>::modifies_data () const
+{
+	return false;
+}
+
+template<>
+bool
+SampleFormatConverter<float>::modifies_data () const
+{
+	return clip_floats || outputs_modify_data ();
+}
+
 template<typename TOut>
 void
 SampleFormatConverter<TOut>::check_frame_and_channel_count(nframes_t frames, ChannelCount channels_)
@@ -182,6 +182,18 @@ SampleRateConverter::process (ProcessContext<float> const & c)
 	}
 }
 
+void
+SampleRateConverter::process (ProcessContext<float> & c)
+{
+	if (!active) {
+		check_flags (*this, c);
+		output (c);
+		return;
+	}
+	
+	process (static_cast<ProcessContext<float> const &> (c));
+}
+
 void SampleRateConverter::set_end_of_input (ProcessContext<float> const & c)
 {
 	src_data.end_of_input = true;
@@ -0,0 +1,226 @@
+#include "tests/utils.h"
+
+#include "audiographer/general/chunker.h"
+#include "audiographer/general/interleaver.h"
+#include "audiographer/general/deinterleaver.h"
+#include "audiographer/general/peak_reader.h"
+#include "audiographer/general/sample_format_converter.h"
+#include "audiographer/general/silence_trimmer.h"
+#include "audiographer/utils/identity_vertex.h"
+
+using namespace AudioGrapher;
+
+/// Passes data on, noting where each context's data was and whether it could be modified
+class Tap
+  : public ListedSource<float>
+  , public Sink<float>
+{
+  public:
+	void process (ProcessContext<float> const & c) { note (c, false); output (c); }
+	void process (ProcessContext<float> & c) { note (c, true); output (c); }
+	bool modifies_data () const { return outputs_modify_data (); }
+
+	/// Returns how many of the contexts seen here had data at a different place to \a before's
+	unsigned int copies_since (Tap const & before) const
+	{
+		unsigned int copies = 0;
+		for (unsigned int i = 0; i < data.size(); ++i) {
+			if (i >= before.data.size() || data[i] != before.data[i]) {
+				++copies;
+			}
+		}
+		return copies;
+	}
+
+	std::vector<float const *> data;
+	std::vector<bool> writable;
+	std::vector<float> first_sample;
+
+  private:
+	void note (ProcessContext<float> const & c, bool w)
+	{
+		data.push_back (c.data());
+		writable.push_back (w);
+		first_sample.push_back (c.frames() ? c.data()[0] : 0.0f);
+	}
+};
+
+typedef boost::shared_ptr<Tap> TapPtr;
+
+class CopyCountTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE (CopyCountTest);
+  CPPUNIT_TEST (testMonoChain);
+  CPPUNIT_TEST (testStereoChain);
+  CPPUNIT_TEST (testConstInput);
+  CPPUNIT_TEST (testSeveralOutputs);
+  CPPUNIT_TEST (testDeInterleaver);
+  CPPUNIT_TEST_SUITE_END ();
+
+  public:
+	void setUp()
+	{
+		frames = 1024;
+		chunk = 256;
+		random_data = TestUtils::init_random_data (2 * frames, 1.0);
+		random_data[0] = 1.5f;
+	}
+
+	void tearDown()
+	{
+		delete [] random_data;
+	}
+
+	/** Builds interleaver -> tap -> chunker -> tap -> trimmer -> tap -> float converter -> tap,
+	  * which is what an export to a float file goes through.
+	  */
+	void build_chain (unsigned int channels)
+	{
+		interleaver.reset (new Interleaver<float>());
+		chunker.reset (new Chunker<float> (chunk * channels));
+		trimmer.reset (new SilenceTrimmer<float>());
+		converter.reset (new SampleFormatConverter<float> (channels));
+
+		for (int i = 0; i < 4; ++i) {
+			taps[i].reset (new Tap);
+		}
+
+		interleaver->init (channels, frames);
+		converter->init (chunk * channels, D_None, 32);
+		converter->set_clip_floats (true);
+
+		interleaver->add_output (taps[0]);
+		taps[0]->add_output (chunker);
+		chunker->add_output (taps[1]);
+		taps[1]->add_output (trimmer);
+		trimmer->add_output (taps[2]);
+		taps[2]->add_output (converter);
+		converter->add_output (taps[3]);
+	}
+
+	/// One channel, from a buffer which may be modified: nothing should be copied
+	void testMonoChain()
+	{
+		build_chain (1);
+
+		ProcessContext<float> c (random_data, frames, 1);
+		interleaver->input (0)->process (c);
+
+		CPPUNIT_ASSERT_EQUAL ((size_t) 1, taps[0]->data.size());
+		CPPUNIT_ASSERT (taps[0]->data[0] == random_data);
+		CPPUNIT_ASSERT_EQUAL ((size_t) (frames / chunk), taps[3]->data.size());
+
+		for (unsigned int i = 0; i < frames / chunk; ++i) {
+			CPPUNIT_ASSERT (taps[1]->data[i] == random_data + i * chunk);
+			CPPUNIT_ASSERT (taps[3]->writable[i]);
+		}
+
+		CPPUNIT_ASSERT_EQUAL (0U, taps[2]->copies_since (*taps[1]));
+		CPPUNIT_ASSERT_EQUAL (0U, taps[3]->copies_since (*taps[2]));
+
+		// clipped in place
+		CPPUNIT_ASSERT_EQUAL (1.0f, random_data[0]);
+	}
+
+	/// Two channels: the data is copied once, when it is interleaved
+	void testStereoChain()
+	{
+		build_chain (2);
+
+		ProcessContext<float> left (random_data, frames, 1);
+		ProcessContext<float> right (random_data + frames, frames, 1);
+		interleaver->input (0)->process (left);
+		interleaver->input (1)->process (right);
+
+		CPPUNIT_ASSERT_EQUAL ((size_t) 1, taps[0]->data.size());
+		CPPUNIT_ASSERT_EQUAL ((size_t) (frames / chunk), taps[1]->data.size());
+
+		for (unsigned int i = 0; i < frames / chunk; ++i) {
+			CPPUNIT_ASSERT (taps[1]->data[i] == taps[0]->data[0] + i * chunk * 2);
+			CPPUNIT_ASSERT (taps[3]->writable[i]);
+		}
+
+		CPPUNIT_ASSERT_EQUAL (0U, taps[2]->copies_since (*taps[1]));
+		CPPUNIT_ASSERT_EQUAL (0U, taps[3]->copies_since (*taps[2]));
+		CPPUNIT_ASSERT_EQUAL (1.0f, taps[3]->first_sample[0]);
+
+		// the source data is not touched
+		CPPUNIT_ASSERT_EQUAL (1.5f, random_data[0]);
+	}
+
+	/// Data which may not be modified is only copied by the stage which modifies it
+	void testConstInput()
+	{
+		build_chain (1);
+
+		ProcessContext<float> const c (random_data, frames, 1);
+		interleaver->input (0)->process (c);
+
+		for (unsigned int i = 0; i < frames / chunk; ++i) {
+			CPPUNIT_ASSERT (taps[1]->data[i] == random_data + i * chunk);
+			CPPUNIT_ASSERT (!taps[2]->writable[i]);
+		}
+
+		CPPUNIT_ASSERT_EQUAL (0U, taps[2]->copies_since (*taps[1]));
+		CPPUNIT_ASSERT_EQUAL ((unsigned int) (frames / chunk), taps[3]->copies_since (*taps[2]));
+		CPPUNIT_ASSERT_EQUAL (1.5f, random_data[0]);
+		CPPUNIT_ASSERT_EQUAL (1.0f, taps[3]->first_sample[0]);
+	}
+
+	/// The one output which modifies data gets it last, and without a copy
+	void testSeveralOutputs()
+	{
+		boost::shared_ptr<IdentityVertex<float> > vertex (new IdentityVertex<float>());
+		boost::shared_ptr<SampleFormatConverter<float> > clipper (new SampleFormatConverter<float> (1));
+		boost::shared_ptr<PeakReader> peak_reader (new PeakReader());
+		TapPtr clipped (new Tap);
+		TapPtr read (new Tap);
+
+		clipper->init (frames, D_None, 32);
+		clipper->set_clip_floats (true);
+		clipper->add_output (clipped);
+		peak_reader->add_output (read);
+
+		vertex->add_output (clipper);
+		vertex->add_output (peak_reader);
+
+		ProcessContext<float> c (random_data, frames, 1);
+		vertex->process (c);
+
+		CPPUNIT_ASSERT (clipped->data[0] == random_data);
+		CPPUNIT_ASSERT (clipped->writable[0]);
+		CPPUNIT_ASSERT (!read->writable[0]);
+		CPPUNIT_ASSERT_EQUAL (1.5f, read->first_sample[0]);
+		CPPUNIT_ASSERT_EQUAL (1.5f, peak_reader->get_peak());
+		CPPUNIT_ASSERT_EQUAL (1.0f, random_data[0]);
+	}
+
+	/// A single channel has nothing to deinterleave
+	void testDeInterleaver()
+	{
+		DeInterleaver<float> deinterleaver;
+		TapPtr tap (new Tap);
+		deinterleaver.init (1, frames);
+		deinterleaver.output (0)->add_output (tap);
+
+		ProcessContext<float> c (random_data, frames, 1);
+		deinterleaver.process (c);
+
+		CPPUNIT_ASSERT (tap->data[0] == random_data);
+		CPPUNIT_ASSERT (tap->writable[0]);
+	}
+
+  private:
+	float * random_data;
+	nframes_t frames;
+	nframes_t chunk;
+
+	boost::shared_ptr<Interleaver<float> > interleaver;
+	boost::shared_ptr<Chunker<float> > chunker;
+	boost::shared_ptr<SilenceTrimmer<float> > trimmer;
+	boost::shared_ptr<SampleFormatConverter<float> > converter;
+	TapPtr taps[4];
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION (CopyCountTest);
+
@@ -1,6 +1,13 @@
 #include "tests/utils.h"
 
 #include "audiographer/general/sample_format_converter.h"
+#include "private/gdither/gdither.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include <glibmm/timer.h>
 
 using namespace AudioGrapher;
 
@@ -15,6 +22,10 @@ class SampleFormatConverterTest : public CppUnit::TestFixture
   CPPUNIT_TEST (testInt16);
   CPPUNIT_TEST (testUint8);
   CPPUNIT_TEST (testChannelCount);
+  CPPUNIT_TEST (testNoDitherIsExact);
+  CPPUNIT_TEST (testDither);
+  CPPUNIT_TEST (testClipFloats);
+  CPPUNIT_TEST (benchmark);
   CPPUNIT_TEST_SUITE_END ();
 
   public:
@@ -200,8 +211,178 @@ class SampleFormatConverterTest : public CppUnit::TestFixture
 		CPPUNIT_ASSERT (TestUtils::array_filled(sink->get_array(), pc.frames()));
 	}
 
+	/// Without dither, the output must be that of plain rounding and clamping
+	void testNoDitherIsExact()
+	{
+		ChannelCount const channels = 3;
+		nframes_t const n = 1001 * channels;
+		std::vector<float> data (n);
+		for (nframes_t i = 0; i < n; ++i) {
+			data[i] = random_data[i % frames] * 1.5f;
+		}
+		data[1] = 1.0f;
+		data[2] = -1.0f;
+		data[4] = 1e10f;
+		data[5] = -1e10f;
+		data[7] = 0.5f / 32768.0f;
+		data[8] = 1.5f / 32768.0f;
+		data[9] = -2.5f / 32768.0f;
+		data[11] = NAN;
+
+		boost::shared_ptr<SampleFormatConverter<int16_t> > c16 (new SampleFormatConverter<int16_t>(channels));
+		boost::shared_ptr<VectorSink<int16_t> > s16 (new VectorSink<int16_t>());
+		c16->init (n, D_None, 16);
+		c16->add_output (s16);
+		c16->process (ProcessContext<float> (&data[0], n, channels));
+
+		boost::shared_ptr<SampleFormatConverter<int32_t> > c24 (new SampleFormatConverter<int32_t>(channels));
+		boost::shared_ptr<VectorSink<int32_t> > s24 (new VectorSink<int32_t>());
+		c24->init (n, D_None, 24);
+		c24->add_output (s24);
+		c24->process (ProcessContext<float> (&data[0], n, channels));
+
+		CPPUNIT_ASSERT_EQUAL (n, (nframes_t) s16->get_data().size());
+		CPPUNIT_ASSERT_EQUAL (n, (nframes_t) s24->get_data().size());
+
+		for (nframes_t i = 0; i < n; ++i) {
+			CPPUNIT_ASSERT_EQUAL ((int16_t) clamped_round (data[i] * 32768.0f, -32768, 32767), s16->get_data()[i]);
+			CPPUNIT_ASSERT_EQUAL ((int32_t) (clamped_round (data[i] * 8388608.0f, -8388608, 8388607) * 256), s24->get_data()[i]);
+		}
+	}
+
+	/// Dithered output must stay within a few steps of the signal and average out to it
+	void testDither()
+	{
+		ChannelCount const channels = 2;
+		nframes_t const n = 10000 * channels;
+		float const level = 100.3f / 32768.0f;
+		std::vector<float> data (n, level);
+
+		for (int type = D_Rect; type <= D_Shaped; ++type) {
+			boost::shared_ptr<SampleFormatConverter<int16_t> > converter (new SampleFormatConverter<int16_t>(channels));
+			boost::shared_ptr<VectorSink<int16_t> > sink (new VectorSink<int16_t>());
+			converter->init (n, type, 16);
+			converter->add_output (sink);
+			converter->process (ProcessContext<float> (&data[0], n, channels));
+
+			double sum = 0;
+			bool varies = false;
+			for (nframes_t i = 0; i < n; ++i) {
+				int16_t const s = sink->get_data()[i];
+				CPPUNIT_ASSERT (s >= 96 && s <= 104);
+				varies = varies || s != sink->get_data()[0];
+				sum += s;
+			}
+
+			CPPUNIT_ASSERT (varies);
+			/* rectangular and shaped dither are biased, as they always have been */
+			double expected = 100.3;
+			if (type == D_Rect) {
+				expected -= 0.5;
+			} else if (type == D_Shaped) {
+				expected += 0.213;
+			}
+			CPPUNIT_ASSERT (std::fabs (sum / n - expected) < 0.05);
+		}
+	}
+
+	void testClipFloats()
+	{
+		boost::shared_ptr<SampleFormatConverter<float> > converter (new SampleFormatConverter<float>(1));
+		boost::shared_ptr<VectorSink<float> > sink (new VectorSink<float>());
+		converter->init (frames, D_None, 32);
+		converter->add_output (sink);
+		converter->set_clip_floats (true);
+
+		random_data[0] = 2.0f;
+		random_data[5] = -3.0f;
+		random_data[6] = NAN;
+		random_data[frames - 1] = 1.5f;
+
+		ProcessContext<float> const pc (random_data, frames, 1);
+		converter->process (pc);
+
+		for (nframes_t i = 0; i < frames; ++i) {
+			float const out = sink->get_data()[i];
+			if (i == 6) {
+				CPPUNIT_ASSERT (out != out);
+			} else {
+				float const in = random_data[i];
+				CPPUNIT_ASSERT_EQUAL (in > 1.0f ? 1.0f : (in < -1.0f ? -1.0f : in), out);
+			}
+		}
+	}
+
+	/// Prints the time taken per sample, as nanoseconds, by gdither_runf() on each channel and by the converter
+	void benchmark()
+	{
+		ChannelCount const channels = 2;
+		nframes_t const n = 8192 * channels;
+		int const iterations = 100;
+		std::vector<float> data (n);
+		std::vector<int32_t> out (n);
+		for (nframes_t i = 0; i < n; ++i) {
+			data[i] = random_data[i % frames];
+		}
+
+		char const * names[] = { "none", "rectangular", "triangular", "shaped" };
+
+		std::cout << std::endl << std::setw (26) << std::left << "ns per sample" << std::setw (10) << std::right << "per chan" << std::setw (10) << "converter" << std::endl;
+
+		for (int width = 16; width <= 24; width += 8) {
+			for (int type = D_None; type <= D_Shaped; ++type) {
+
+				GDither dither = gdither_new ((GDitherType) type, channels, width == 16 ? GDither16bit : GDither32bit, width);
+				Glib::Timer timer;
+				for (int i = 0; i < iterations; ++i) {
+					for (ChannelCount c = 0; c < channels; ++c) {
+						gdither_runf (dither, c, n / channels, &data[0], &out[0]);
+					}
+				}
+				double const scalar = timer.elapsed ();
+				gdither_free (dither);
+
+				double vector;
+				if (width == 16) {
+					vector = time_converter<int16_t> (data, channels, type, width, iterations);
+				} else {
+					vector = time_converter<int32_t> (data, channels, type, width, iterations);
+				}
+
+				std::cout << std::setw (4) << std::left << width << std::setw (22) << names[type]
+					  << std::setw (10) << std::right << std::fixed << std::setprecision (3) << (scalar * 1e9 / (iterations * n))
+					  << std::setw (10) << (vector * 1e9 / (iterations * n)) << std::endl;
+			}
+		}
+	}
+
   private:
 
+	static long clamped_round (float x, long lower, long upper)
+	{
+		if (!(x >= lower)) {
+			return lower;
+		} else if (x > upper) {
+			return upper;
+		}
+		return lrintf (x);
+	}
+
+	/// @return seconds taken to convert data iterations times
+	template<typename TOut>
+	double time_converter (std::vector<float> & data, ChannelCount channels, int type, int width, int iterations)
+	{
+		boost::shared_ptr<SampleFormatConverter<TOut> > converter (new SampleFormatConverter<TOut>(channels));
+		converter->init (data.size(), type, width);
+		ProcessContext<float> const pc (&data[0], data.size(), channels);
+
+		Glib::Timer timer;
+		for (int i = 0; i < iterations; ++i) {
+			converter->process (pc);
+		}
+		return timer.elapsed ();
+	}
+
 	float * random_data;
 	nframes_t frames;
 };
@@ -24,9 +24,15 @@
 
 namespace Evoral {
 
+/** Identifier of a note, which stays the same however the note is edited */
+typedef int32_t NoteID;
+
+NoteID next_note_id ();
+
 /** An abstract (protocol agnostic) note.
  *
  * Currently a note is defined as (on event, length, off event).
+ * Each new note is given its own id; copies keep the id of the original.
  */
 template<typename Time>
 class Note {
@@ -52,6 +58,7 @@ public:
 	inline uint8_t     velocity() const { return _on_event.velocity(); }
 	inline uint8_t     off_velocity() const { return _off_event.velocity(); }
 	inline Time        length()   const { return _off_event.time() - _on_event.time(); }
+	inline NoteID      id()       const { return _id; }
 	inline uint8_t     channel()  const {
 		assert(_on_event.channel() == _off_event.channel());
 	    return _on_event.channel();
@@ -63,6 +70,7 @@ public:
         inline void set_off_velocity(uint8_t n) { _off_event.buffer()[2] = n; }
 	inline void set_length(Time l)      { _off_event.time() = _on_event.time() + l; }
 	inline void set_channel(uint8_t c)  { _on_event.set_channel(c);  _off_event.set_channel(c); }
+	inline void set_id(NoteID i)        { _id = i; }
 
 	inline       Event<Time>& on_event()        { return _on_event; }
 	inline const Event<Time>& on_event()  const { return _on_event; }
@@ -73,6 +81,7 @@ private:
 	// Event buffers are self-contained
 	MIDIEvent<Time> _on_event;
 	MIDIEvent<Time> _off_event;
+	NoteID          _id;
 };
 
 } // namespace Evoral
@@ -24,7 +24,9 @@
 #include <set>
 #include <list>
 #include <utility>
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 #include <glibmm/thread.h>
 #include "evoral/types.hpp"
 #include "evoral/Note.hpp"
@@ -107,11 +109,18 @@ public:
 		return a->time() < b->time();
 	}
 
+	/* The NotePtr overloads of these comparators are used by the sets of
+	   notes, and save converting to pointers to const notes.
+	*/
+
 	struct NoteNumberComparator {
 		inline bool operator()(const boost::shared_ptr< const Note<Time> > a,
 		                       const boost::shared_ptr< const Note<Time> > b) const {
 			return a->note() < b->note();
 		}
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
+			return a->note() < b->note();
+		}
 	};
 
 	struct EarlierNoteComparator {
@@ -119,6 +128,9 @@ public:
 		                       const boost::shared_ptr< const Note<Time> > b) const {
 			return a->time() < b->time();
 		}
+		inline bool operator()(const NotePtr& a, const NotePtr& b) const {
+			return a->time() < b->time();
+		}
 	};
 
 	struct LaterNoteComparator {
@@ -241,6 +253,10 @@ public:
         bool add_note_unlocked (const NotePtr note, void* arg = 0);
 	void remove_note_unlocked(const constNotePtr note);
 
+	NotePtr find_note (NoteID id) const;
+
+	void edit_notes_unlocked (const std::set<NotePtr>& notes, boost::function<void()> edit, void* arg = 0);
+
 	uint8_t lowest_note()  const { return _lowest_note; }
 	uint8_t highest_note() const { return _highest_note; }
 
@@ -252,6 +268,11 @@ protected:
 	mutable Glib::RWLock   _lock;
 	bool                   _writing;
 
+        /** Deal with any notes which overlap a note that is about to be added.
+         *  The note may already be in the sequence, in which case it should
+         *  be ignored.
+         *  @return 0 if the note may be added, otherwise non-zero.
+         */
         virtual int resolve_overlaps_unlocked (const NotePtr, void* arg = 0) {
                 return 0;
         }
@@ -274,10 +295,26 @@ private:
         void get_notes_by_pitch (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
         void get_notes_by_velocity (Notes&, NoteOperator, uint8_t val, int chan_mask = 0) const;
 
+	/** Where a note is in _notes and _pitches, so that it can be found and removed without a search */
+	struct NoteIndexEntry {
+		typename Notes::iterator   by_time;
+		typename Pitches::iterator by_pitch;
+		uint8_t                    channel;
+	};
+
+	typedef boost::unordered_map<NoteID, NoteIndexEntry> NoteIndex;
+
+	void insert_note_unlocked (const NotePtr note);
+	bool erase_unindexed_note_unlocked (const constNotePtr note);
+	void reorder_by_time_unlocked ();
+	void reorder_by_pitch_unlocked (uint8_t channel);
+	void update_note_range_unlocked ();
+
 	const TypeMap& _type_map;
 
-        Notes   _notes;       // notes indexed by time
-        Pitches _pitches[16]; // notes indexed by channel+pitch
+        Notes     _notes;       // notes indexed by time
+        Pitches   _pitches[16]; // notes indexed by channel+pitch
+        NoteIndex _note_index;  // notes indexed by id
 	SysExes _sysexes;
 
 	typedef std::multiset<NotePtr, EarlierNoteComparator> WriteNotes;
@@ -18,15 +18,26 @@
 
 #include <iostream>
 #include <limits>
+#include <glib.h>
 #include "evoral/Note.hpp"
 
 namespace Evoral {
 
+static volatile gint _note_id_counter = 0;
+
+/** @return an id which no other note in this process has been given */
+NoteID
+next_note_id ()
+{
+	return g_atomic_int_exchange_and_add (&_note_id_counter, 1);
+}
+
 template<typename Time>
 Note<Time>::Note(uint8_t chan, Time t, Time l, uint8_t n, uint8_t v)
 	// FIXME: types?
 	: _on_event(0xDE, t, 3, NULL, true)
 	, _off_event(0xAD, t + l, 3, NULL, true)
+	, _id(next_note_id())
 {
 	assert(chan < 16);
 
@@ -51,6 +62,7 @@ template<typename Time>
 Note<Time>::Note(const Note<Time>& copy)
 	: _on_event(copy._on_event, true)
 	, _off_event(copy._off_event, true)
+	, _id(copy._id)
 {
 	assert(_on_event.buffer());
 	assert(_off_event.buffer());
@@ -84,6 +96,7 @@ Note<Time>::operator=(const Note<Time>& other)
 {
 	_on_event = other._on_event;
 	_off_event = other._off_event;
+	_id = other._id;
 
 	assert(time() == other.time());
 	assert(end_time() == other.end_time());
@@ -416,7 +416,7 @@ Sequence<Time>::Sequence(const Sequence<Time>& other)
 {
         for (typename Notes::const_iterator i = other._notes.begin(); i != other._notes.end(); ++i) {
                 NotePtr n (new Note<Time> (**i));
-                _notes.insert (n);
+                insert_note_unlocked (n);
         }
 
         for (typename SysExes::const_iterator i = other._sysexes.begin(); i != other._sysexes.end(); ++i) {
@@ -513,6 +513,10 @@ Sequence<Time>::clear()
 {
 	WriteLock lock(write_lock());
 	_notes.clear();
+	for (int i = 0; i < 16; ++i) {
+		_pitches[i].clear();
+	}
+	_note_index.clear();
 	for (Controls::iterator li = _controls.begin(); li != _controls.end(); ++li)
 		li->second->list()->clear();
 }
@@ -561,7 +565,7 @@ Sequence<Time>::end_write (bool delete_stuck)
                         ++next;
                         if ((*n)->length() == 0) {
                                 cerr << "WARNING: Stuck note lost: " << (*n)->note() << endl;
-                                _notes.erase(n);
+                                remove_note_unlocked (*n);
                         }
                         
                         n = next;
@@ -604,62 +608,362 @@ Sequence<Time>::add_note_unlocked(const NotePtr note, void* arg)
 	if (note->note() > _highest_note)
 		_highest_note = note->note();
 
-	_notes.insert (note);
-        _pitches[note->channel()].insert (note);
+	insert_note_unlocked (note);
 
         return true;
 }
 
+/** Put a note into _notes, _pitches and _note_index.  A note whose id is
+ *  already used by a different note in this sequence (a copy, say) is
+ *  given a new one.
+ */
 template<typename Time>
 void
-Sequence<Time>::remove_note_unlocked(const constNotePtr note)
+Sequence<Time>::insert_note_unlocked (const NotePtr note)
 {
-        bool erased = false;
+	typename NoteIndex::iterator i = _note_index.find (note->id());
 
+	if (i != _note_index.end() && *i->second.by_time != note) {
+		note->set_id (next_note_id ());
+	}
+
+	NoteIndexEntry e;
+	e.by_time = _notes.insert (note);
+	e.by_pitch = _pitches[note->channel()].insert (note);
+	e.channel = note->channel();
+
+	_note_index[note->id()] = e;
+}
+
+template<typename Time>
+void
+Sequence<Time>::remove_note_unlocked(const constNotePtr note)
+{
 	_edited = true;
 
 	DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1 remove note %2 @ %3\n", this, (int)note->note(), note->time()));
 
-	for (typename Sequence<Time>::Notes::iterator i = note_lower_bound(note->time()); 
+	typename NoteIndex::iterator i = _note_index.find (note->id());
+
+	if (i != _note_index.end() && *i->second.by_time == note) {
+		_notes.erase (i->second.by_time);
+		_pitches[i->second.channel].erase (i->second.by_pitch);
+		_note_index.erase (i);
+	} else if (!erase_unindexed_note_unlocked (note)) {
+                cerr << "Unable to find note to erase" << endl;
+		return;
+	}
+
+	if (note->note() == _lowest_note || note->note() == _highest_note) {
+		update_note_range_unlocked ();
+	}
+}
+
+/** Set _lowest_note and _highest_note from the notes in _pitches */
+template<typename Time>
+void
+Sequence<Time>::update_note_range_unlocked ()
+{
+	_lowest_note = 127;
+	_highest_note = 0;
+
+	for (int c = 0; c < 16; ++c) {
+		if (!_pitches[c].empty()) {
+			_lowest_note = min (_lowest_note, (*_pitches[c].begin())->note());
+			_highest_note = max (_highest_note, (*_pitches[c].rbegin())->note());
+		}
+	}
+}
+
+/** A note's place in a set and the key which the set orders it by */
+template<typename Key>
+struct NoteOrder {
+	Key    key;
+	size_t place;
+
+	bool operator< (const NoteOrder& other) const {
+		return key < other.key || (!(other.key < key) && place < other.place);
+	}
+};
+
+template<typename Time>
+static Time
+note_time (const boost::shared_ptr< Note<Time> >& note)
+{
+	return note->time();
+}
+
+template<typename Time>
+static uint8_t
+note_number (const boost::shared_ptr< Note<Time> >& note)
+{
+	return note->note();
+}
+
+/** Put a set of notes, some of which have been changed, back in order.  Rather
+ *  than emptying the set and filling it again, the notes are moved between the
+ *  places that the set already has.  The keys are read once, as sorting by
+ *  reading them through the notes is several times slower.
+ *
+ *  @param key Function to read the key which \a set is ordered by; it must
+ *  agree with the set's comparator, so that notes with equal keys are
+ *  equivalent to the set.
+ */
+template<typename Set, typename Key>
+static void
+reorder_notes (Set& set, Key (*key) (const typename Set::value_type&))
+{
+	typedef typename Set::value_type NotePtr;
+
+	std::vector<NotePtr> notes (set.size());
+	std::vector< NoteOrder<Key> > order (set.size());
+
+	size_t k = 0;
+	for (typename Set::iterator i = set.begin(); i != set.end(); ++i, ++k) {
+		/* swapping the pointers in and out saves reference counting */
+		const_cast<NotePtr&> (*i).swap (notes[k]);
+		order[k].key = key (notes[k]);
+		order[k].place = k;
+	}
+
+	std::sort (order.begin(), order.end());
+
+	/* changing the elements of a set in place is only valid because we leave
+	   them exactly in the order that the set's comparator would put them in;
+	   if key and the comparator disagree the set is corrupted.
+	*/
+
+	k = 0;
+	for (typename Set::iterator i = set.begin(); i != set.end(); ++i, ++k) {
+		const_cast<NotePtr&> (*i).swap (notes[order[k].place]);
+	}
+
+#ifndef NDEBUG
+	typename Set::const_iterator prev = set.begin();
+	for (typename Set::const_iterator i = set.begin(); i != set.end(); prev = i++) {
+		assert (!set.value_comp() (*i, *prev));
+	}
+#endif
+}
+
+/** Put _notes back in order after the times of notes in it have been
+ *  changed, and update _note_index to match.  The by_pitch iterators in
+ *  _note_index must still point to their notes.
+ */
+template<typename Time>
+void
+Sequence<Time>::reorder_by_time_unlocked ()
+{
+	reorder_notes (_notes, &note_time<Time>);
+
+	for (typename Notes::iterator i = _notes.begin(); i != _notes.end(); ++i) {
+		typename NoteIndex::iterator e = _note_index.find ((*i)->id());
+		/* by_pitch still points to the note, so notes which are not indexed can be told apart */
+		if (e != _note_index.end() && *e->second.by_pitch == *i) {
+			e->second.by_time = i;
+		}
+	}
+}
+
+/** Put the pitches of one channel back in order after note numbers in it
+ *  have been changed, and update _note_index to match.  The by_time iterators
+ *  in _note_index must still point to their notes.
+ */
+template<typename Time>
+void
+Sequence<Time>::reorder_by_pitch_unlocked (uint8_t channel)
+{
+	Pitches& p (_pitches[channel]);
+
+	reorder_notes (p, &note_number<Time>);
+
+	for (typename Pitches::iterator i = p.begin(); i != p.end(); ++i) {
+		typename NoteIndex::iterator e = _note_index.find ((*i)->id());
+		if (e != _note_index.end() && *e->second.by_time == *i) {
+			e->second.by_pitch = i;
+		}
+	}
+}
+
+/** A note passed to edit_notes_unlocked(), with the parts of it which
+ *  decide its place in the sequence as they were before the edit.
+ */
+template<typename Time>
+struct EditedNote {
+	boost::shared_ptr< Note<Time> > note;
+	Time                            time;
+	uint8_t                         number;
+};
+
+/** Change some notes in ways which may alter their order in the sequence,
+ *  such as their start time, note number or channel.
+ *
+ *  A few notes are taken out of the sequence, changed by \a edit and then
+ *  added back as add_note_unlocked() would.  When many notes are to be
+ *  changed it is quicker to change them where they are and then put the
+ *  sequence back in order once, so that is done instead.  Either way,
+ *  \a edit must not use the order of the notes in the sequence, nor change
+ *  their ids.
+ *
+ *  Overlaps are resolved for each of \a notes in turn, in the set's order.
+ *  When they are added back one by one each note is only checked against
+ *  those added before it, but when they are changed in place it is checked
+ *  against all the others, so a policy such as InsertMergeReject or
+ *  InsertMergeReplace may keep a different one of two notes which overlap.
+ *
+ *  @param notes Notes which \a edit may change; any which are not in the
+ *  sequence are added to it afterwards.
+ *  @param edit Function to change the notes; it may also change the length
+ *  or velocity of any note.
+ *  @param arg Passed to resolve_overlaps_unlocked() for each of \a notes.
+ */
+template<typename Time>
+void
+Sequence<Time>::edit_notes_unlocked (const std::set<NotePtr>& notes, boost::function<void()> edit, void* arg)
+{
+	typedef typename std::set<NotePtr>::const_iterator NoteIterator;
+	typedef typename std::vector< EditedNote<Time> >::const_iterator EditedIterator;
+
+	/* putting the sequence back in order costs about as much as moving
+	   one note in eight of it.
+	*/
+
+	if (notes.size() * 8 < _notes.size()) {
+
+		for (NoteIterator i = notes.begin(); i != notes.end(); ++i) {
+			remove_note_unlocked (*i);
+		}
+
+		edit ();
+
+		for (NoteIterator i = notes.begin(); i != notes.end(); ++i) {
+			add_note_unlocked (*i, arg);
+		}
+
+		return;
+	}
+
+	_edited = true;
+
+	std::vector< EditedNote<Time> > edited;
+	std::vector<NotePtr> added;
+
+	for (NoteIterator i = notes.begin(); i != notes.end(); ++i) {
+		if (find_note ((*i)->id()) == *i) {
+			EditedNote<Time> e = { *i, (*i)->time(), (*i)->note() };
+			edited.push_back (e);
+		} else {
+			/* it may have been put into notes() directly, so take it
+			   out before it is changed, as remove_note_unlocked() would.
+			*/
+			erase_unindexed_note_unlocked (*i);
+			added.push_back (*i);
+		}
+	}
+
+	edit ();
+
+	/* find out which parts of the sequence are now out of order; notes
+	   which have changed channel are simply moved.
+	*/
+
+	bool by_time = false;
+	bool by_pitch[16] = { false };
+	std::vector<NotePtr> changed_channel;
+
+	for (EditedIterator i = edited.begin(); i != edited.end(); ++i) {
+
+		NotePtr const& n = i->note;
+		typename NoteIndex::iterator e = _note_index.find (n->id());
+
+		if (n->channel() != e->second.channel) {
+			_notes.erase (e->second.by_time);
+			_pitches[e->second.channel].erase (e->second.by_pitch);
+			_note_index.erase (e);
+			changed_channel.push_back (n);
+			continue;
+		}
+
+		if (n->time() != i->time) {
+			by_time = true;
+		}
+
+		if (n->note() != i->number) {
+			by_pitch[n->channel()] = true;
+		}
+	}
+
+	if (by_time) {
+		reorder_by_time_unlocked ();
+	}
+
+	for (uint8_t c = 0; c < 16; ++c) {
+		if (by_pitch[c]) {
+			reorder_by_pitch_unlocked (c);
+		}
+	}
+
+	for (typename std::vector<NotePtr>::const_iterator i = changed_channel.begin(); i != changed_channel.end(); ++i) {
+		insert_note_unlocked (*i);
+	}
+
+	update_note_range_unlocked ();
+
+	for (NoteIterator i = notes.begin(); i != notes.end(); ++i) {
+
+		NotePtr const n = *i;
+
+		if (find_note (n->id()) != n) {
+			/* added below, or removed while resolving the overlaps of an earlier note */
+			continue;
+		}
+
+		Time const time = n->time();
+
+		if (resolve_overlaps_unlocked (n, arg)) {
+			remove_note_unlocked (n);
+		} else if (n->time() != time) {
+			remove_note_unlocked (n);
+			insert_note_unlocked (n);
+		}
+	}
+
+	for (typename std::vector<NotePtr>::const_iterator i = added.begin(); i != added.end(); ++i) {
+		add_note_unlocked (*i, arg);
+	}
+}
+
+template<typename Time>
+bool
+Sequence<Time>::erase_unindexed_note_unlocked (const constNotePtr note)
+{
+        bool erased = false;
+
+	for (typename Sequence<Time>::Notes::iterator i = note_lower_bound(note->time());
              i != _notes.end() && (*i)->time() == note->time(); ++i) {
 
 		if (*i == note) {
-                        
                         DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\terasing note %2 @ %3\n", this, (int)(*i)->note(), (*i)->time()));
 			_notes.erase (i);
-
-                        if ((*i)->note() == _lowest_note || (*i)->note() == _highest_note) {
-
-                                _lowest_note = 127;
-                                _highest_note = 0;
-
-                                for (typename Sequence<Time>::Notes::iterator ii = _notes.begin(); ii != _notes.end(); ++ii) {
-                                        if ((*ii)->note() < _lowest_note)
-                                                _lowest_note = (*ii)->note();
-                                        if ((*ii)->note() > _highest_note)
-                                                _highest_note = (*ii)->note();
-                                }
-                        }
-                        
                         erased = true;
+                        break;
                 }
 	}
 
         Pitches& p (pitches (note->channel()));
-        
+
         NotePtr search_note(new Note<Time>(0, 0, 0, note->note(), 0));
 
-        for (typename Pitches::iterator i = p.lower_bound (search_note); 
+        for (typename Pitches::iterator i = p.lower_bound (search_note);
              i != p.end() && (*i)->note() == note->note(); ++i) {
                 if (*i == note) {
                         DEBUG_TRACE (DEBUG::Sequence, string_compose ("%1\terasing pitch %2 @ %3\n", this, (int)(*i)->note(), (*i)->time()));
                         p.erase (i);
+                        break;
                 }
         }
-        
-        if (!erased) {
-                cerr << "Unable to find note to erase" << endl;
-        }
+
+        return erased;
 }
 
 /** Append \a ev to model.  NOT realtime safe.
@@ -890,7 +1194,31 @@ template<typename Time>
  void
  Sequence<Time>::set_notes (const Sequence<Time>::Notes& n)
  {
-         _notes = n;
+         _notes.clear ();
+         for (int i = 0; i < 16; ++i) {
+                 _pitches[i].clear ();
+         }
+         _note_index.clear ();
+
+         for (typename Notes::const_iterator i = n.begin(); i != n.end(); ++i) {
+                 insert_note_unlocked (*i);
+         }
+ }
+
+ /** @return the note in this sequence with a given id, or a null pointer.
+  *  The caller must hold the read or write lock.
+  */
+ template<typename Time>
+ typename Sequence<Time>::NotePtr
+ Sequence<Time>::find_note (NoteID id) const
+ {
+         typename NoteIndex::const_iterator i = _note_index.find (id);
+
+         if (i == _note_index.end()) {
+                 return NotePtr ();
+         }
+
+         return *i->second.by_time;
  }
 
  /** Return the earliest note with time >= t */
@@ -1,8 +1,16 @@
 #include "SequenceTest.hpp"
 #include "evoral/MIDIParameters.hpp"
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <boost/bind.hpp>
+#include <glibmm/timer.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SequenceTest);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION(SequenceBenchmark, "Benchmarks");
 
 using namespace std;
 
@@ -154,3 +162,232 @@ SequenceTest::controlInterpolationTest ()
 		last_value = i->second;
 	}
 }
+
+void
+SequenceTest::noteIDTest ()
+{
+	seq->clear();
+
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		seq->add_note_unlocked(*i);
+	}
+
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		CPPUNIT_ASSERT(seq->find_note((*i)->id()) == *i);
+	}
+
+	// A note keeps its id when it is moved
+	boost::shared_ptr< Note<Time> > moved = test_notes[3];
+	NoteID const id = moved->id();
+	seq->remove_note_unlocked(moved);
+	CPPUNIT_ASSERT(!seq->find_note(id));
+	moved->set_time(1250);
+	moved->set_note(30);
+	seq->add_note_unlocked(moved);
+	CPPUNIT_ASSERT_EQUAL(id, moved->id());
+	CPPUNIT_ASSERT(seq->find_note(id) == moved);
+	CPPUNIT_ASSERT_EQUAL(size_t(12), seq->notes().size());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(30), seq->lowest_note());
+
+	// A copy added to the same sequence is given an id of its own
+	boost::shared_ptr< Note<Time> > copy(new Note<Time>(*test_notes[5]));
+	CPPUNIT_ASSERT_EQUAL(test_notes[5]->id(), copy->id());
+	seq->add_note_unlocked(copy);
+	CPPUNIT_ASSERT(copy->id() != test_notes[5]->id());
+	CPPUNIT_ASSERT(seq->find_note(copy->id()) == copy);
+	CPPUNIT_ASSERT(seq->find_note(test_notes[5]->id()) == test_notes[5]);
+
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		seq->remove_note_unlocked(*i);
+		CPPUNIT_ASSERT(!seq->find_note((*i)->id()));
+	}
+
+	CPPUNIT_ASSERT_EQUAL(size_t(1), seq->notes().size());
+	CPPUNIT_ASSERT(*seq->notes().begin() == copy);
+}
+
+void
+SequenceTest::quantize (std::set< boost::shared_ptr< Note<Time> > > const & notes, Time grid)
+{
+	for (std::set< boost::shared_ptr< Note<Time> > >::const_iterator i = notes.begin(); i != notes.end(); ++i) {
+		(*i)->set_time(floor((*i)->time() / grid + 0.5) * grid);
+	}
+}
+
+/** Transpose notes, and move those on channel 1 to channel 2 */
+void
+SequenceTest::transpose (std::set< boost::shared_ptr< Note<Time> > > const & notes, int semitones)
+{
+	for (std::set< boost::shared_ptr< Note<Time> > >::const_iterator i = notes.begin(); i != notes.end(); ++i) {
+		(*i)->set_note((*i)->note() + semitones);
+		if ((*i)->channel() == 1) {
+			(*i)->set_channel(2);
+		}
+	}
+}
+
+/** Check that notes are in time and pitch order, and that each can be found by its id */
+void
+SequenceTest::check_indexes ()
+{
+	Time last = 0;
+	size_t pitches = 0;
+
+	for (Sequence<Time>::Notes::const_iterator i = seq->notes().begin(); i != seq->notes().end(); ++i) {
+		CPPUNIT_ASSERT((*i)->time() >= last);
+		CPPUNIT_ASSERT(seq->find_note((*i)->id()) == *i);
+		last = (*i)->time();
+	}
+
+	for (uint8_t c = 0; c < 16; ++c) {
+		uint8_t last_note = 0;
+		for (MySequence<Time>::Pitches::const_iterator i = seq->pitches(c).begin(); i != seq->pitches(c).end(); ++i) {
+			CPPUNIT_ASSERT((*i)->note() >= last_note);
+			CPPUNIT_ASSERT_EQUAL(c, (*i)->channel());
+			last_note = (*i)->note();
+			++pitches;
+		}
+	}
+
+	CPPUNIT_ASSERT_EQUAL(seq->notes().size(), pitches);
+}
+
+void
+SequenceTest::bulkEditTest ()
+{
+	seq->clear();
+
+	for (int i = 0; i < 100; ++i) {
+		seq->add_note_unlocked(boost::shared_ptr< Note<Time> >(new Note<Time>(i % 2, 1000 - i * 10 + 3, 5, 40 + i % 8, 64)));
+	}
+
+	// A few notes are moved one at a time
+	std::set< boost::shared_ptr< Note<Time> > > few;
+	few.insert(*seq->notes().begin());
+	few.insert(*seq->notes().rbegin());
+	seq->edit_notes_unlocked(few, boost::bind(&SequenceTest::quantize, this, boost::cref(few), 100));
+	check_indexes();
+
+	// All of them are moved at once
+	std::set< boost::shared_ptr< Note<Time> > > all(seq->notes().begin(), seq->notes().end());
+	seq->edit_notes_unlocked(all, boost::bind(&SequenceTest::quantize, this, boost::cref(all), 64));
+	check_indexes();
+
+	CPPUNIT_ASSERT_EQUAL(size_t(100), seq->notes().size());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(40), seq->lowest_note());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(47), seq->highest_note());
+
+	// Changing note numbers and channels puts them in other places
+	seq->edit_notes_unlocked(all, boost::bind(&SequenceTest::transpose, this, boost::cref(all), -3));
+	check_indexes();
+
+	CPPUNIT_ASSERT_EQUAL(uint8_t(37), seq->lowest_note());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(44), seq->highest_note());
+	CPPUNIT_ASSERT(seq->pitches(1).empty());
+	CPPUNIT_ASSERT_EQUAL(size_t(50), seq->pitches(2).size());
+
+	for (Sequence<Time>::Notes::const_iterator i = seq->notes().begin(); i != seq->notes().end(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(0.0, fmod((*i)->time(), 64));
+	}
+
+	// A note which was put into the sequence without being indexed is moved, not copied
+	boost::shared_ptr< Note<Time> > unindexed(new Note<Time>(2, 2000, 5, 50, 64));
+	seq->notes().insert(unindexed);
+	seq->pitches(2).insert(unindexed);
+	all.insert(unindexed);
+	seq->edit_notes_unlocked(all, boost::bind(&SequenceTest::quantize, this, boost::cref(all), 64));
+	check_indexes();
+
+	CPPUNIT_ASSERT_EQUAL(size_t(101), seq->notes().size());
+	CPPUNIT_ASSERT_EQUAL(1984.0, unindexed->time());
+
+	for (std::set< boost::shared_ptr< Note<Time> > >::const_iterator i = all.begin(); i != all.end(); ++i) {
+		seq->remove_note_unlocked(*i);
+	}
+
+	CPPUNIT_ASSERT(seq->notes().empty());
+	CPPUNIT_ASSERT_EQUAL(uint8_t(127), seq->lowest_note());
+}
+
+/** Fill seq with a drum performance of n notes, slightly off the beat */
+void
+SequenceTest::make_performance (int n)
+{
+	uint8_t const drums[] = { 36, 38, 42, 42, 46, 42, 38, 42 };
+
+	seq->clear();
+	srand(1);
+
+	for (int i = 0; i < n; ++i) {
+		Time const jitter = (rand() % 100 - 50) / 1000.0;
+		seq->add_note_unlocked(boost::shared_ptr< Note<Time> >(new Note<Time>(9, i * 0.25 + jitter, 0.1, drums[i % 8], 100)));
+	}
+}
+
+/** Quantize every note in seq, either by moving each note or with a bulk edit */
+void
+SequenceTest::quantize_performance (bool bulk)
+{
+	std::set< boost::shared_ptr< Note<Time> > > all(seq->notes().begin(), seq->notes().end());
+
+	if (bulk) {
+		seq->edit_notes_unlocked(all, boost::bind(&SequenceTest::quantize, this, boost::cref(all), 0.25));
+	} else {
+		for (std::set< boost::shared_ptr< Note<Time> > >::const_iterator i = all.begin(); i != all.end(); ++i) {
+			seq->remove_note_unlocked(*i);
+			(*i)->set_time(floor((*i)->time() / 0.25 + 0.5) * 0.25);
+			seq->add_note_unlocked(*i);
+		}
+	}
+}
+
+/** Quantizes a drum performance of 100000 notes, both by moving each note
+ *  and with a bulk edit, and checks that the two give the same sequence.
+ */
+void
+SequenceTest::quantizeTest ()
+{
+	int const n = 100000;
+	std::vector< std::pair<Time, uint8_t> > results[2];
+
+	for (int bulk = 0; bulk < 2; ++bulk) {
+
+		make_performance (n);
+		quantize_performance (bulk);
+
+		check_indexes();
+		CPPUNIT_ASSERT_EQUAL(size_t(n), seq->notes().size());
+		CPPUNIT_ASSERT_EQUAL(0.25 * (n - 1), (*seq->notes().rbegin())->time());
+
+		for (Sequence<Time>::Notes::const_iterator i = seq->notes().begin(); i != seq->notes().end(); ++i) {
+			results[bulk].push_back(std::make_pair((*i)->time(), (*i)->note()));
+		}
+	}
+
+	/* notes at the same time may be in either order */
+
+	std::sort(results[0].begin(), results[0].end());
+	std::sort(results[1].begin(), results[1].end());
+	CPPUNIT_ASSERT(results[0] == results[1]);
+}
+
+/** Prints the time taken to quantize a drum performance of 100000 notes,
+ *  both by moving each note and with a bulk edit.
+ */
+void
+SequenceBenchmark::quantizeBenchmark ()
+{
+	int const n = 100000;
+	double times[2];
+
+	for (int bulk = 0; bulk < 2; ++bulk) {
+		make_performance (n);
+		Glib::Timer timer;
+		quantize_performance (bulk);
+		times[bulk] = timer.elapsed();
+		CPPUNIT_ASSERT_EQUAL(size_t(n), seq->notes().size());
+	}
+
+	std::cout << std::endl << "quantizing " << n << " notes: " << times[0] * 1000 << "ms note by note, "
+	          << times[1] * 1000 << "ms in bulk" << std::endl;
+}
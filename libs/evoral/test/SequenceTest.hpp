@@ -55,6 +55,9 @@ class MySequence : public Sequence<Time> {
 public:
 	MySequence(DummyTypeMap&map) : Sequence<Time>(map) {}
 
+	typedef typename Sequence<Time>::Pitches Pitches;
+	using Sequence<Time>::pitches;
+
 	boost::shared_ptr<Control> control_factory(const Parameter& param) {
 
 		return boost::shared_ptr<Control>(
@@ -116,6 +119,9 @@ class SequenceTest : public CppUnit::TestFixture
 	CPPUNIT_TEST (preserveEventOrderingTest);
 	CPPUNIT_TEST (iteratorSeekTest);
 	CPPUNIT_TEST (controlInterpolationTest);
+	CPPUNIT_TEST (noteIDTest);
+	CPPUNIT_TEST (bulkEditTest);
+	CPPUNIT_TEST (quantizeTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -144,10 +150,32 @@ public:
 	void preserveEventOrderingTest ();
 	void iteratorSeekTest ();
 	void controlInterpolationTest ();
+	void noteIDTest ();
+	void bulkEditTest ();
+	void quantizeTest ();
+
+protected:
+	void make_performance (int n);
+	void quantize_performance (bool bulk);
+	void quantize (std::set< boost::shared_ptr< Note<Time> > > const & notes, Time grid);
+	void transpose (std::set< boost::shared_ptr< Note<Time> > > const & notes, int semitones);
+	void check_indexes ();
 
-private:
 	DummyTypeMap*       type_map;
 	MySequence<Time>*   seq;
 
 	Notes test_notes;
 };
+
+/** Times quantizing a large sequence.  Not part of the default run;
+ *  use "run-tests Benchmarks".
+ */
+class SequenceBenchmark : public SequenceTest
+{
+	CPPUNIT_TEST_SUITE (SequenceBenchmark);
+	CPPUNIT_TEST (quantizeBenchmark);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void quantizeBenchmark ();
+};
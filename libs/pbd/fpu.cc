@@ -14,6 +14,7 @@ using namespace std;
 FPU::FPU ()
 {
 	unsigned long cpuflags = 0;
+	unsigned long cpuflags_ecx = 0;
 
 	_flags = Flags (0);
 
@@ -28,8 +29,9 @@ FPU::FPU ()
 		"pushl %%ebx\n"
 		"cpuid\n"
 		"movl %%edx, %0\n"
+		"movl %%ecx, %1\n"
 		"popl %%ebx\n"
-		: "=r" (cpuflags)
+		: "=r" (cpuflags), "=r" (cpuflags_ecx)
 		: 
 		: "%eax", "%ecx", "%edx"
 		);
@@ -47,8 +49,9 @@ FPU::FPU ()
 		"movq $1, %%rax\n"
 		"cpuid\n"
 		"movq %%rdx, %0\n"
+		"movq %%rcx, %1\n"
 		"popq %%rbx\n"
-		: "=r" (cpuflags)
+		: "=r" (cpuflags), "=r" (cpuflags_ecx)
 		: 
 		: "%rax", "%rbx", "%rcx", "%rdx"
 		);
@@ -63,6 +66,33 @@ FPU::FPU ()
 		_flags = Flags (_flags | HasSSE2);
 	}
 
+	/* AVX needs both CPU support and an OS which saves the YMM
+	   registers on context switch (OSXSAVE, then XCR0 bits 1 and 2)
+	*/
+
+	if ((cpuflags_ecx & (1<<28)) && (cpuflags_ecx & (1<<27))) {
+
+		uint32_t xcr0 = 0;
+
+		asm volatile (
+			"xor %%ecx, %%ecx\n"
+			".byte 0x0f, 0x01, 0xd0\n" /* xgetbv */
+			: "=a" (xcr0)
+			:
+			: "%ecx", "%edx"
+			);
+
+		if ((xcr0 & 0x6) == 0x6) {
+			_flags = Flags (_flags | HasAVX);
+
+			/* FMA uses the YMM registers too */
+
+			if (cpuflags_ecx & (1<<12)) {
+				_flags = Flags (_flags | HasFMA);
+			}
+		}
+	}
+
 	if (cpuflags & (1 << 24)) {
 		
 		char* fxbuf = 0;
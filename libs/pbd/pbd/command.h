@@ -40,6 +40,11 @@ public:
 	virtual void undo() = 0;
 	virtual void redo() { (*this)(); }
 	
+	/** @return rough number of bytes of memory used by this command,
+	 *  so that the undo history can be kept within a budget.
+	 */
+	virtual size_t footprint () const { return sizeof (Command); }
+
 	virtual XMLNode &get_state();
 	virtual int set_state(const XMLNode&, int /*version*/) { /* noop */ return 0; }
 
@@ -0,0 +1,156 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __lib_pbd_delta_memento_command_h__
+#define __lib_pbd_delta_memento_command_h__
+
+#include "pbd/command.h"
+#include "pbd/compose.h"
+#include "pbd/demangle.h"
+#include "pbd/error.h"
+#include "pbd/xml++.h"
+#include "pbd/xml_delta.h"
+
+/** A MementoCommand which keeps only the differences between its before
+ *  and after mementos, rather than both of them in full.  This is for
+ *  objects whose state is not held in a PropertyList, and so cannot use
+ *  StatefulDiffCommand.
+ *
+ *  Undo and redo rebuild the required state by applying the appropriate
+ *  delta to the object's current state, so they assume (as the undo
+ *  history does) that the object is in the state this command left it in.
+ */
+template <class obj_T>
+class DeltaMementoCommand : public Command
+{
+public:
+	/** @param a_before State before the change; this command deletes it.
+	 *  @param a_after State after the change; this command deletes it.
+	 */
+	DeltaMementoCommand (obj_T& a_object, XMLNode* a_before, XMLNode* a_after)
+		: obj (a_object)
+		, _undo (PBD::xml_delta (*a_after, *a_before))
+		, _redo (PBD::xml_delta (*a_before, *a_after))
+	{
+		delete a_before;
+		delete a_after;
+		init ();
+	}
+
+	/** Restore a command from its saved state */
+	DeltaMementoCommand (obj_T& a_object, XMLNode const & node)
+		: obj (a_object)
+		, _undo (0)
+		, _redo (0)
+	{
+		XMLNode* u = node.child ("Undo");
+		XMLNode* r = node.child ("Do");
+
+		if (u && !u->children().empty()) {
+			_undo = new XMLNode (*u->children().front());
+		}
+
+		if (r && !r->children().empty()) {
+			_redo = new XMLNode (*r->children().front());
+		}
+
+		init ();
+	}
+
+	~DeltaMementoCommand () {
+		drop_references ();
+		delete _undo;
+		delete _redo;
+	}
+
+	void object_died () {
+		delete this;
+	}
+
+	void operator() () {
+		apply (_redo);
+	}
+
+	void undo () {
+		apply (_undo);
+	}
+
+	size_t footprint () const {
+		return _footprint;
+	}
+
+	XMLNode& get_state () {
+		XMLNode* node = new XMLNode ("DeltaMementoCommand");
+
+		node->add_property ("obj-id", obj.id().to_s());
+		node->add_property ("type-name", demangled_name (obj));
+
+		if (_undo) {
+			node->add_child ("Undo")->add_child_copy (*_undo);
+		}
+
+		if (_redo) {
+			node->add_child ("Do")->add_child_copy (*_redo);
+		}
+
+		return *node;
+	}
+
+private:
+	obj_T&   obj;
+	XMLNode* _undo;
+	XMLNode* _redo;
+	size_t   _footprint;
+	PBD::ScopedConnection obj_death_connection;
+
+	void init () {
+		_footprint = sizeof (*this);
+
+		if (_undo) {
+			_footprint += PBD::xml_size (*_undo);
+		}
+
+		if (_redo) {
+			_footprint += PBD::xml_size (*_redo);
+		}
+
+		/* if the object dies, make sure that we die and that everyone knows about it */
+		obj.Destroyed.connect_same_thread (obj_death_connection, boost::bind (&DeltaMementoCommand::object_died, this));
+	}
+
+	void apply (XMLNode const * delta) {
+		if (!delta) {
+			return;
+		}
+
+		XMLNode& now (obj.get_state ());
+		XMLNode* then = PBD::xml_apply_delta (now, *delta);
+		delete &now;
+
+		if (!then) {
+			PBD::warning << string_compose ("cannot apply undo/redo delta to the current state of %1", demangled_name (obj)) << endmsg;
+			return;
+		}
+
+		obj.set_state (*then, Stateful::current_state_version);
+		delete then;
+	}
+};
+
+#endif /* __lib_pbd_delta_memento_command_h__ */
@@ -10,7 +10,9 @@ class FPU {
 		HasFlushToZero = 0x1,
 		HasDenormalsAreZero = 0x2,
 		HasSSE = 0x4,
-		HasSSE2 = 0x8
+		HasSSE2 = 0x8,
+		HasAVX = 0x10,
+		HasFMA = 0x20
 	};
 
   public:
@@ -21,6 +23,8 @@ class FPU {
 	bool has_denormals_are_zero () const { return _flags & HasDenormalsAreZero; }
 	bool has_sse () const { return _flags & HasSSE; }
 	bool has_sse2 () const { return _flags & HasSSE2; }
+	bool has_avx () const { return _flags & HasAVX; }
+	bool has_fma () const { return _flags & HasFMA; }
 	
   private:
 	Flags _flags;
@@ -27,6 +27,7 @@
 #include "pbd/stacktrace.h"
 #include "pbd/xml++.h"
 #include "pbd/demangle.h"
+#include "pbd/xml_delta.h"
 
 #include <sigc++/slot.h>
 #include <typeinfo>
@@ -68,6 +69,10 @@ public:
 		}
 	}
 
+	size_t footprint () const {
+		return sizeof (*this) + (before ? PBD::xml_size (*before) : 0) + (after ? PBD::xml_size (*after) : 0);
+	}
+
 	virtual XMLNode &get_state() {
 		std::string name;
 		if (before && after) {
@@ -0,0 +1,54 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __pbd_rt_alloc_check_h__
+#define __pbd_rt_alloc_check_h__
+
+#include <stdint.h>
+
+namespace PBD {
+
+/** Marks, for as long as it exists, the current thread as running code
+ *  which must not allocate or free memory (typically, a process thread
+ *  running DSP).
+ *
+ *  If libpbd was configured with --rt-alloc-check, malloc(), calloc(),
+ *  realloc() and free() (and so new and delete) are replaced with versions
+ *  that report every call made from a marked thread, and abort() if
+ *  PBD_RT_ALLOC_ABORT is set in the environment, so that a debugger
+ *  shows the culprit.  Otherwise this costs a thread-local increment and
+ *  decrement, and nothing is checked.
+ */
+class RTAllocCheck
+{
+  public:
+	RTAllocCheck ();
+	~RTAllocCheck ();
+
+	/** @return true if the calling thread is inside an RTAllocCheck */
+	static bool active ();
+	/** @return number of allocations (or frees) made by marked threads so far */
+	static uint32_t violations ();
+	/** @return true if allocations are actually being checked */
+	static bool available ();
+};
+
+}
+
+#endif /* __pbd_rt_alloc_check_h__ */
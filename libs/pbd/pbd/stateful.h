@@ -64,6 +64,13 @@ class Stateful {
 
 	const PBD::ID& id() const { return _id; }
 
+	/** @return the generation of this object's state.  Every change to the
+	 *  state of any Stateful takes a new generation, larger than all those
+	 *  taken before it, so state saved earlier can be reused for as long as
+	 *  the object's generation is unchanged.
+	 */
+	uint32_t state_generation () const { return g_atomic_int_get (&_state_generation); }
+
         /* history management */
 
 	void clear_history ();
@@ -103,6 +110,8 @@ class Stateful {
 	*/
 	virtual void post_set () { };
 
+	void state_changed () const;
+
 	XMLNode *_extra_xml;
 	XMLNode *_instant_xml;
 	PBD::ID  _id;
@@ -120,6 +129,10 @@ class Stateful {
         */
         virtual void mid_thaw (const PropertyChange&) { }
         bool property_changes_suspended() const { return g_atomic_int_get (&_frozen) > 0; }
+
+  private:
+	mutable gint _state_generation;
+	static gint _generation_counter;
 };
 
 } // namespace PBD
@@ -42,6 +42,8 @@ public:
 
 	void operator() ();
 	void undo ();
+
+	size_t footprint () const;
         
 	XMLNode& get_state ();
 
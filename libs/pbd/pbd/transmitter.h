@@ -22,9 +22,13 @@
 
 #include <sstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <sigc++/sigc++.h>
 
+class TransmitterMessages;
+
 class Transmitter : public std::stringstream
 
 {
@@ -45,11 +49,30 @@ class Transmitter : public std::stringstream
 
 	bool does_not_return ();
 
+	static void hold_messages (TransmitterMessages *);
+
   protected:
 	virtual void deliver ();
 	friend std::ostream& endmsg (std::ostream &);
 
   private:
+	/** Keeps the text of the message that each thread is writing apart
+	    from the others, so that threads which write at the same time do
+	    not garble each other's messages.
+	*/
+	class ThreadBuffer : public std::streambuf {
+	  public:
+		ThreadBuffer (Transmitter const * t) : _transmitter (t) {}
+		std::string& text ();
+	  protected:
+		int_type overflow (int_type);
+		std::streamsize xsputn (char const *, std::streamsize);
+	  private:
+		Transmitter const * _transmitter;
+	};
+
+	friend class TransmitterMessages;
+
 	Channel channel;
 	sigc::signal<void, Channel, const char *> *send;
 
@@ -57,6 +80,22 @@ class Transmitter : public std::stringstream
 	sigc::signal<void, Channel, const char *> warning;
 	sigc::signal<void, Channel, const char *> error;
 	sigc::signal<void, Channel, const char *> fatal;
+
+	ThreadBuffer _buffer;
+};
+
+/** Messages which one thread has finished but not sent; see
+ *  Transmitter::hold_messages().
+ */
+class TransmitterMessages
+{
+  public:
+	bool empty () const { return _messages.empty (); }
+	void deliver ();
+
+  private:
+	friend class Transmitter;
+	std::vector<std::pair<Transmitter*, std::string> > _messages;
 };
 
 /* for EGCS 2.91.66, if this function is not compiled within the same
@@ -49,6 +49,8 @@ class UndoTransaction : public Command
 	void undo();
 	void redo();
 
+	size_t footprint () const;
+
 	XMLNode &get_state();
 
 	void set_timestamp (struct timeval &t) {
@@ -63,6 +65,7 @@ class UndoTransaction : public Command
 	std::list<Command*>    actions;
 	struct timeval        _timestamp;
 	bool                  _clearing;
+	size_t                _charged; ///< footprint counted by the UndoHistory that holds us
 
 	friend void command_death (UndoTransaction*, Command *);
 	
@@ -104,6 +107,9 @@ class UndoHistory : public PBD::ScopedConnectionList
         void save_state();
 
 	void set_depth (uint32_t);
+	void set_memory_budget (size_t bytes);
+
+	size_t footprint () const;
 
 	PBD::Signal0<void> Changed;
 	PBD::Signal0<void> BeginUndoRedo;
@@ -112,10 +118,16 @@ class UndoHistory : public PBD::ScopedConnectionList
   private:
 	bool _clearing;
 	uint32_t _depth;
+	size_t _memory_budget; ///< in bytes, or 0 for no limit
+	size_t _footprint; ///< running total of the footprints of UndoList and RedoList
 	std::list<UndoTransaction*> UndoList;
 	std::list<UndoTransaction*> RedoList;
 
 	void remove (UndoTransaction*);
+	void trim_to_budget ();
+	void charge (UndoTransaction*);
+	void discharge (UndoTransaction*);
+	void discharge (std::list<UndoTransaction*> const &);
 };
 
 
@@ -29,7 +29,6 @@ typedef XMLNodeList::const_iterator            XMLNodeConstIterator;
 typedef std::list<XMLProperty*>                XMLPropertyList;
 typedef XMLPropertyList::iterator              XMLPropertyIterator;
 typedef XMLPropertyList::const_iterator        XMLPropertyConstIterator;
-typedef std::map<std::string, XMLProperty*>    XMLPropertyMap;
 
 class XMLTree {
 public:
@@ -75,13 +74,19 @@ public:
 	XMLNode(const XMLNode& other);
 	~XMLNode();
 
-	const std::string& name() const { return _name; }
+	XMLNode& operator= (const XMLNode& other);
+
+	const std::string& name() const { return *_name; }
 
 	bool          is_content() const { return _is_content; }
 	const std::string& content()    const { return _content; }
 	const std::string& set_content(const std::string&);
 	XMLNode*      add_content(const std::string& s = std::string());
 
+	/** @return all children if str is empty, otherwise those called str.  A list
+	 *  of named children stays valid until this node's children are changed and
+	 *  then the same name is asked for again.
+	 */
 	const XMLNodeList& children(const std::string& str = std::string()) const;
 	XMLNode* child(const char*) const;
 	XMLNode* add_child(const char *);
@@ -113,13 +118,21 @@ public:
 	void debug (std::ostream &, std::string p = "");
 
 private:
-	std::string         _name;
+	typedef std::map<std::string, XMLNodeList> ChildIndex;
+
+	const std::string*  _name; ///< interned, so shared with all other nodes of the same name
 	bool                _is_content;
 	std::string         _content;
 	XMLNodeList         _children;
 	XMLPropertyList     _proplist;
-	XMLPropertyMap      _propmap;
-	mutable XMLNodeList _selected_children;
+	mutable ChildIndex* _child_index; ///< children by name, or 0 if they have not been asked for by name
+	mutable bool        _child_index_dirty;
+
+	friend class XMLNodeReader;
+	XMLProperty* add_property(const std::string* interned_name, const std::string& value);
+
+	void clear ();
+	void children_changed () { _child_index_dirty = true; }
 };
 
 class XMLProperty {
@@ -127,13 +140,16 @@ public:
 	XMLProperty(const std::string& n, const std::string& v = std::string());
 	~XMLProperty();
 
-	const std::string& name() const { return _name; }
+	const std::string& name() const { return *_name; }
 	const std::string& value() const { return _value; }
 	const std::string& set_value(const std::string& v) { return _value = v; }
 
 private:
-	std::string _name;
-	std::string _value;
+	friend class XMLNode;
+	XMLProperty(const std::string* n, const std::string& v);
+
+	const std::string* _name; ///< interned, so shared with all other properties of the same name
+	std::string        _value;
 };
 
 class XMLException: public std::exception {
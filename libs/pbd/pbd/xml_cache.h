@@ -0,0 +1,48 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libpbd_xml_cache_h__
+#define __libpbd_xml_cache_h__
+
+#include <string>
+
+class XMLNode;
+
+namespace PBD {
+
+/** Write a compact binary copy of the tree in an XML file.  The tree is taken
+ *  from the file itself rather than from the nodes that it was written from,
+ *  so that reading the cache gives exactly what parsing the file would (an
+ *  empty content node, for example, does not survive the trip through XML).
+ *  The cache records the size, modification time and a hash of the XML file
+ *  so that it will not be used once that file has changed.
+ *  @return true on success.
+ */
+bool xml_write_cache (std::string const & xml_path, std::string const & cache_path);
+
+/** Read a tree from a cache written by xml_write_cache().  This is much
+ *  quicker than parsing the XML.
+ *  @return new tree (owned by the caller), or 0 if there is no cache or it
+ *  is not an up-to-date copy of xml_path.
+ */
+XMLNode* xml_read_cache (std::string const & xml_path, std::string const & cache_path);
+
+} // namespace PBD
+
+#endif /* __libpbd_xml_cache_h__ */
@@ -0,0 +1,53 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __libpbd_xml_delta_h__
+#define __libpbd_xml_delta_h__
+
+#include <cstddef>
+
+class XMLNode;
+
+namespace PBD {
+
+/** @return true if a and b have the same name, properties (in any order),
+ *  content and (recursively) children.
+ */
+bool xml_equal (XMLNode const & a, XMLNode const & b);
+
+/** @return rough number of bytes of memory used by a node and its children */
+size_t xml_size (XMLNode const &);
+
+/** Compute a delta which turns one state tree into another.  Only the
+ *  properties, children and content which differ are stored, so the delta
+ *  of a small edit to a large tree is small.  The delta is itself an
+ *  XMLNode, so it can be saved and reloaded like any other state.
+ *  @return new delta; the caller owns it.
+ */
+XMLNode* xml_delta (XMLNode const & from, XMLNode const & to);
+
+/** Apply a delta made by xml_delta() to a node.
+ *  @return new node (owned by the caller), or 0 if the delta does not fit
+ *  the node it was applied to.
+ */
+XMLNode* xml_apply_delta (XMLNode const & node, XMLNode const & delta);
+
+} // namespace PBD
+
+#endif /* __libpbd_xml_delta_h__ */
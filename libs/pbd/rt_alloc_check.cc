@@ -0,0 +1,155 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifdef WAF_BUILD
+#include "libpbd-config.h"
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "pbd/rt_alloc_check.h"
+
+using namespace PBD;
+
+/** depth of nested RTAllocCheck objects in this thread */
+static __thread int rt_depth = 0;
+
+static gint n_violations = 0;
+
+RTAllocCheck::RTAllocCheck ()
+{
+	++rt_depth;
+}
+
+RTAllocCheck::~RTAllocCheck ()
+{
+	--rt_depth;
+}
+
+bool
+RTAllocCheck::active ()
+{
+	return rt_depth > 0;
+}
+
+uint32_t
+RTAllocCheck::violations ()
+{
+	return g_atomic_int_get (&n_violations);
+}
+
+#ifdef PBD_RT_ALLOC_CHECK
+
+bool
+RTAllocCheck::available ()
+{
+	return true;
+}
+
+/* Replacements for the C library's allocator.  libpbd is linked ahead of
+   libc, so these are the versions that everything (including operator
+   new and delete) ends up calling; they pass straight through to glibc's
+   own implementations.
+*/
+
+extern "C" {
+	extern void* __libc_malloc (size_t);
+	extern void* __libc_calloc (size_t, size_t);
+	extern void* __libc_realloc (void*, size_t);
+	extern void  __libc_free (void*);
+}
+
+/** Called with the allocator's own name.  Must not allocate, so the
+ *  report is made with write(2).
+ */
+static void
+violation (const char* what)
+{
+	g_atomic_int_inc (&n_violations);
+
+	/* don't report allocations made while reporting */
+	int const depth = rt_depth;
+	rt_depth = 0;
+
+	static const char msg[] = " called from a realtime thread\n";
+	ssize_t r;
+	r = write (2, what, strlen (what));
+	r = write (2, msg, sizeof (msg) - 1);
+	(void) r;
+
+	if (getenv ("PBD_RT_ALLOC_ABORT")) {
+		abort ();
+	}
+
+	rt_depth = depth;
+}
+
+extern "C" {
+
+void*
+malloc (size_t size)
+{
+	if (rt_depth > 0) {
+		violation ("malloc()");
+	}
+	return __libc_malloc (size);
+}
+
+void*
+calloc (size_t n, size_t size)
+{
+	if (rt_depth > 0) {
+		violation ("calloc()");
+	}
+	return __libc_calloc (n, size);
+}
+
+void*
+realloc (void* ptr, size_t size)
+{
+	if (rt_depth > 0) {
+		violation ("realloc()");
+	}
+	return __libc_realloc (ptr, size);
+}
+
+void
+free (void* ptr)
+{
+	if (ptr && rt_depth > 0) {
+		violation ("free()");
+	}
+	__libc_free (ptr);
+}
+
+}
+
+#else
+
+bool
+RTAllocCheck::available ()
+{
+	return false;
+}
+
+#endif /* PBD_RT_ALLOC_CHECK */
@@ -37,6 +37,7 @@ namespace PBD {
 
 int Stateful::current_state_version = 0;
 int Stateful::loading_state_version = 0;
+gint Stateful::_generation_counter = 0;
 
 Stateful::Stateful ()
         : _frozen (0)
@@ -45,6 +46,8 @@ Stateful::Stateful ()
 {
 	_extra_xml = 0;
 	_instant_xml = 0;
+
+	state_changed ();
 }
 
 Stateful::~Stateful ()
@@ -66,6 +69,8 @@ Stateful::add_extra_xml (XMLNode& node)
 
 	_extra_xml->remove_nodes (node.name());
 	_extra_xml->add_child_nocopy (node);
+
+	state_changed ();
 }
 
 XMLNode *
@@ -191,6 +196,10 @@ Stateful::set_properties (XMLNode const & owner_state)
 
 	post_set ();
 
+	if (!c.empty()) {
+		state_changed ();
+	}
+
 	return c;
 }
 
@@ -249,6 +258,10 @@ Stateful::send_change (const PropertyChange& what_changed)
 		return;
 	}
 
+	/* the state has changed now, even if nobody is told until later */
+
+	state_changed ();
+
 	{
 		Glib::Mutex::Lock lm (_lock);
 		if (_frozen) {
@@ -260,6 +273,16 @@ Stateful::send_change (const PropertyChange& what_changed)
 	PropertyChanged (what_changed);
 }
 
+/** Note that this object's state has changed.  Derived classes whose state
+ *  includes things other than their properties must call this when those
+ *  things change.
+ */
+void
+Stateful::state_changed () const
+{
+	g_atomic_int_set (&_state_generation, g_atomic_int_exchange_and_add (&_generation_counter, 1) + 1);
+}
+
 void
 Stateful::suspend_property_changes ()
 {
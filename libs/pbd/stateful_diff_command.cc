@@ -95,11 +95,21 @@ StatefulDiffCommand::undo ()
 	boost::shared_ptr<Stateful> s (_object.lock());
 
 	if (s) {
-                std::cerr << "Undoing a stateful diff command\n";
                 s->set_properties (*_undo);
 	}
 }
 
+size_t
+StatefulDiffCommand::footprint () const
+{
+	/* each entry is a map node plus a (usually scalar) property; these
+	   are small, which is the point of this command.
+	*/
+	size_t const per_property = 4 * sizeof (void*) + sizeof (PropertyID) + 64;
+
+	return sizeof (*this) + (_undo->size() + _redo->size()) * per_property;
+}
+
 XMLNode&
 StatefulDiffCommand::get_state ()
 {
@@ -6,8 +6,11 @@
 #include <cppunit/BriefTestProgressListener.h>
 #include "scalar_properties.h"
 
+/** Run the unit tests, or with an argument the tests registered under that
+ *  name instead (such as "Benchmarks", which are not run by default).
+ */
 int
-main ()
+main (int argc, char* argv[])
 {
 	ScalarPropertiesTest::make_property_quarks ();
 	
@@ -20,7 +23,11 @@ main ()
 	testresult.addListener (&progress);
 	
 	CppUnit::TestRunner testrunner;
-	testrunner.addTest (CppUnit::TestFactoryRegistry::getRegistry ().makeTest ());
+	if (argc > 1) {
+		testrunner.addTest (CppUnit::TestFactoryRegistry::getRegistry (argv[1]).makeTest ());
+	} else {
+		testrunner.addTest (CppUnit::TestFactoryRegistry::getRegistry ().makeTest ());
+	}
 	testrunner.run (testresult);
 	
 	CppUnit::CompilerOutputter compileroutputter (&collectedresults, std::cerr);
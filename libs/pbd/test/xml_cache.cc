@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "xml_cache.h"
+#include "pbd/xml++.h"
+#include "pbd/xml_cache.h"
+#include "pbd/xml_delta.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (XMLCacheTest);
+
+using namespace std;
+using namespace PBD;
+
+static string const prefix = "../../libs/pbd/test/";
+static string const xml_path = "xml_cache_test.ardour";
+static string const cache_path = "xml_cache_test.ardour.cache";
+
+/** Check that a session read from the cache is the same as one read from its XML */
+void
+XMLCacheTest::testSession ()
+{
+	XMLTree tree (prefix + "TestSession.ardour");
+	CPPUNIT_ASSERT (tree.root());
+	CPPUNIT_ASSERT (tree.write (xml_path));
+	CPPUNIT_ASSERT (xml_write_cache (xml_path, cache_path));
+
+	XMLNode* cached = xml_read_cache (xml_path, cache_path);
+	CPPUNIT_ASSERT (cached);
+
+	XMLTree reread (xml_path);
+	CPPUNIT_ASSERT (xml_equal (*cached, *reread.root()));
+
+	delete cached;
+	remove (xml_path.c_str());
+	remove (cache_path.c_str());
+}
+
+/** Check that content which does not survive being written as XML is not
+ *  in the cache either.
+ */
+void
+XMLCacheTest::testContent ()
+{
+	XMLTree tree;
+	XMLNode* root = new XMLNode ("Session");
+	root->add_child ("Empty")->add_content ("");
+	root->add_child ("Comment")->add_content ("a comment");
+	tree.set_root (root);
+	CPPUNIT_ASSERT (tree.write (xml_path));
+	CPPUNIT_ASSERT (xml_write_cache (xml_path, cache_path));
+
+	XMLNode* cached = xml_read_cache (xml_path, cache_path);
+	CPPUNIT_ASSERT (cached);
+
+	XMLTree reread (xml_path);
+	CPPUNIT_ASSERT (cached->child ("Empty")->children().empty());
+	CPPUNIT_ASSERT (xml_equal (*cached, *reread.root()));
+
+	delete cached;
+	remove (xml_path.c_str());
+	remove (cache_path.c_str());
+}
+
+/** Check that a cache is not used once its XML file has changed, or if it is damaged */
+void
+XMLCacheTest::testStale ()
+{
+	XMLTree tree (prefix + "TestSession.ardour");
+	CPPUNIT_ASSERT (tree.root());
+	CPPUNIT_ASSERT (tree.write (xml_path));
+	CPPUNIT_ASSERT (xml_write_cache (xml_path, cache_path));
+
+	XMLNode* cached = xml_read_cache (xml_path, cache_path);
+	CPPUNIT_ASSERT (cached);
+	delete cached;
+
+	/* a truncated cache */
+	struct stat st;
+	CPPUNIT_ASSERT (stat (cache_path.c_str(), &st) == 0);
+	CPPUNIT_ASSERT (truncate (cache_path.c_str(), st.st_size - 16) == 0);
+	CPPUNIT_ASSERT (xml_read_cache (xml_path, cache_path) == 0);
+
+	/* a changed XML file */
+	CPPUNIT_ASSERT (xml_write_cache (xml_path, cache_path));
+	tree.root()->add_property ("name", "changed");
+	CPPUNIT_ASSERT (tree.write (xml_path));
+	CPPUNIT_ASSERT (xml_read_cache (xml_path, cache_path) == 0);
+
+	/* no XML file at all */
+	remove (xml_path.c_str());
+	CPPUNIT_ASSERT (xml_read_cache (xml_path, cache_path) == 0);
+
+	remove (cache_path.c_str());
+}
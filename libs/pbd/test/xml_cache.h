@@ -0,0 +1,16 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class XMLCacheTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (XMLCacheTest);
+	CPPUNIT_TEST (testSession);
+	CPPUNIT_TEST (testContent);
+	CPPUNIT_TEST (testStale);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testSession ();
+	void testContent ();
+	void testStale ();
+};
@@ -0,0 +1,107 @@
+#include "xml_delta.h"
+#include "pbd/xml++.h"
+#include "pbd/xml_delta.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (XMLDeltaTest);
+
+using namespace std;
+using namespace PBD;
+
+static string const prefix = "../../libs/pbd/test/";
+
+/** Check that the deltas between a and b turn each into the other */
+static void
+check_deltas (XMLNode const & a, XMLNode const & b)
+{
+	XMLNode* forward = xml_delta (a, b);
+	XMLNode* backward = xml_delta (b, a);
+
+	XMLNode* c = xml_apply_delta (a, *forward);
+	CPPUNIT_ASSERT (c);
+	CPPUNIT_ASSERT (xml_equal (*c, b));
+
+	XMLNode* d = xml_apply_delta (b, *backward);
+	CPPUNIT_ASSERT (d);
+	CPPUNIT_ASSERT (xml_equal (*d, a));
+
+	delete forward;
+	delete backward;
+	delete c;
+	delete d;
+}
+
+void
+XMLDeltaTest::testRoundTrip ()
+{
+	XMLNode a ("AutomationList");
+	a.add_property ("id", "42");
+	a.add_property ("state", "Off");
+	XMLNode* events = a.add_child ("events");
+	events->add_content ("0 1\n100 0.5\n200 0.25\n");
+
+	XMLNode b (a);
+	check_deltas (a, b);
+
+	/* changed and added properties */
+	b.add_property ("state", "Write");
+	b.add_property ("style", "Absolute");
+	check_deltas (a, b);
+
+	/* removed property and edited content */
+	b.remove_property ("id");
+	b.remove_nodes_and_delete ("events");
+	b.add_child ("events")->add_content ("0 1\n150 0.75\n200 0.25\n");
+	check_deltas (a, b);
+
+	/* added and removed children */
+	XMLNode c ("Locations");
+	for (int i = 0; i < 10; ++i) {
+		c.add_child ("Location")->add_property ("start", (long) i);
+	}
+
+	XMLNode d (c);
+	d.add_child ("Location")->add_property ("start", 10L);
+	check_deltas (c, d);
+
+	d.remove_nodes_and_delete ("start", "3");
+	check_deltas (c, d);
+
+	/* renamed root */
+	XMLNode e ("Other");
+	check_deltas (c, e);
+
+	/* a delta does not fit a node of a different shape */
+	XMLNode* delta = xml_delta (c, d);
+	CPPUNIT_ASSERT (xml_apply_delta (e, *delta) == 0);
+	delete delta;
+}
+
+/** Make a small edit deep in a real session file and check that the delta
+ *  is small and restores the original.
+ */
+void
+XMLDeltaTest::testSession ()
+{
+	XMLTree tree (prefix + "TestSession.ardour");
+	CPPUNIT_ASSERT (tree.root());
+
+	XMLNode const & before (*tree.root());
+	XMLNode after (before);
+
+	XMLNode* sources = after.child ("Sources");
+	CPPUNIT_ASSERT (sources && !sources->children().empty());
+	sources->children().front()->add_property ("name", "renamed.wav");
+
+	XMLNode* undo = xml_delta (after, before);
+	size_t const full = xml_size (before);
+	size_t const delta = xml_size (*undo);
+
+	CPPUNIT_ASSERT (delta * 100 < full);
+
+	XMLNode* restored = xml_apply_delta (after, *undo);
+	CPPUNIT_ASSERT (restored);
+	CPPUNIT_ASSERT (xml_equal (*restored, before));
+
+	delete undo;
+	delete restored;
+}
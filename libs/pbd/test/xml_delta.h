@@ -0,0 +1,14 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class XMLDeltaTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (XMLDeltaTest);
+	CPPUNIT_TEST (testRoundTrip);
+	CPPUNIT_TEST (testSession);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testRoundTrip ();
+	void testSession ();
+};
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <sys/time.h>
+
+#include "xml_load.h"
+#include "pbd/xml++.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (XMLLoadTest);
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION (XMLLoadBenchmark, "Benchmarks");
+
+using namespace std;
+
+static string const prefix = "../../libs/pbd/test/";
+
+static double
+now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, 0);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/** Look up properties and children in the way that session loading does */
+static long
+walk (XMLNode const & node)
+{
+	long n = 0;
+
+	if (node.property ("id")) {
+		++n;
+	}
+
+	if (node.property ("name")) {
+		++n;
+	}
+
+	n += node.children ("Processor").size ();
+
+	XMLNodeList const & c (node.children ());
+	for (XMLNodeConstIterator i = c.begin(); i != c.end(); ++i) {
+		n += walk (**i);
+	}
+
+	return n;
+}
+
+void
+XMLLoadTest::testLookups ()
+{
+	XMLNode node ("Route");
+
+	/* property names are normalized when they are added */
+	node.add_property ("default_type", "audio");
+	CPPUNIT_ASSERT (node.property ("default-type"));
+	CPPUNIT_ASSERT (node.property ("default-type")->value() == "audio");
+
+	/* and a replaced property moves to the end */
+	node.add_property ("name", "Audio 1");
+	node.add_property ("default-type", "midi");
+	CPPUNIT_ASSERT (node.properties().size() == 2);
+	CPPUNIT_ASSERT (node.properties().back()->name() == "default-type");
+	CPPUNIT_ASSERT (node.properties().back()->value() == "midi");
+
+	node.remove_property ("name");
+	CPPUNIT_ASSERT (node.property ("name") == 0);
+
+	node.add_child ("Processor")->add_property ("name", "Amp");
+	node.add_child ("IO");
+	node.add_child ("Processor")->add_property ("name", "Meter");
+
+	XMLNodeList const & processors (node.children ("Processor"));
+	CPPUNIT_ASSERT (processors.size() == 2);
+	CPPUNIT_ASSERT (node.children ("IO").size() == 1);
+	CPPUNIT_ASSERT (node.children ("Controllable").empty ());
+
+	/* a list of named children is unaffected by changes until it is asked for again */
+	node.remove_nodes_and_delete ("name", "Meter");
+	CPPUNIT_ASSERT (processors.size() == 2);
+	CPPUNIT_ASSERT (node.children ("Processor").size() == 1);
+
+	XMLNode copy (node);
+	CPPUNIT_ASSERT (copy.children ("Processor").size() == 1);
+	CPPUNIT_ASSERT (copy.property ("default-type")->value() == "midi");
+}
+
+/** Load, copy, search and write a real session file */
+void
+XMLLoadTest::testLoad ()
+{
+	XMLTree tree (prefix + "TestSession.ardour");
+	CPPUNIT_ASSERT (tree.root());
+
+	long const found = walk (*tree.root());
+	CPPUNIT_ASSERT (found > 0);
+
+	XMLNode copy (*tree.root());
+	CPPUNIT_ASSERT (walk (copy) == found);
+
+	XMLTree reread;
+	CPPUNIT_ASSERT (reread.read_buffer (tree.write_buffer ()));
+	CPPUNIT_ASSERT (walk (*reread.root()) == found);
+
+	/* names are interned, so every node with the same name shares it */
+	CPPUNIT_ASSERT (&copy.name() == &tree.root()->name());
+	CPPUNIT_ASSERT (&reread.root()->name() == &tree.root()->name());
+}
+
+/** Load, copy, search and write a real session file repeatedly and print the times taken */
+void
+XMLLoadBenchmark::benchmark ()
+{
+	int const runs = 20;
+
+	double start = now ();
+	for (int i = 0; i < runs; ++i) {
+		XMLTree tree (prefix + "TestSession.ardour");
+		CPPUNIT_ASSERT (tree.root());
+	}
+	double const load = (now () - start) / runs;
+
+	XMLTree tree (prefix + "TestSession.ardour");
+
+	start = now ();
+	for (int i = 0; i < runs; ++i) {
+		XMLNode copy (*tree.root());
+	}
+	double const copy = (now () - start) / runs;
+
+	long found = 0;
+	start = now ();
+	for (int i = 0; i < runs; ++i) {
+		found += walk (*tree.root());
+	}
+	double const search = (now () - start) / runs;
+	CPPUNIT_ASSERT (found > 0);
+
+	start = now ();
+	for (int i = 0; i < runs; ++i) {
+		tree.write_buffer ();
+	}
+	double const write = (now () - start) / runs;
+
+	cout << endl << "XMLLoadBenchmark: load " << (load * 1000) << "ms, copy " << (copy * 1000) << "ms, "
+	     << "search " << (search * 1000) << "ms, write " << (write * 1000) << "ms" << endl;
+}
@@ -0,0 +1,27 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class XMLLoadTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (XMLLoadTest);
+	CPPUNIT_TEST (testLookups);
+	CPPUNIT_TEST (testLoad);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void testLookups ();
+	void testLoad ();
+};
+
+/** Times loading, copying, searching and writing a real session file.
+ *  Not part of the default run; use "run-tests Benchmarks".
+ */
+class XMLLoadBenchmark : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (XMLLoadBenchmark);
+	CPPUNIT_TEST (benchmark);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void benchmark ();
+};
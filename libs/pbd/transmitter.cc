@@ -21,16 +21,97 @@
 #include <cstdlib>
 #include <signal.h>
 #include <iostream>
+#include <map>
 #include <string>
 
+#include <glibmm/thread.h>
+
 #include "pbd/transmitter.h"
 #include "pbd/error.h"
 
 using std::string;
 using std::ios;
 
+namespace {
+
+struct ThreadState {
+	ThreadState () : held (0) {}
+
+	std::map<Transmitter const *, string> text; ///< message being written to each Transmitter
+	TransmitterMessages* held;
+};
+
+Glib::StaticPrivate<ThreadState> thread_state = GLIBMM_STATIC_PRIVATE_INIT;
+
+ThreadState&
+this_thread ()
+{
+	ThreadState* s = thread_state.get ();
+
+	if (!s) {
+		s = new ThreadState;
+		/* deleted by the default handler for GStaticPrivate, when the thread exits */
+		thread_state.set (s);
+	}
+
+	return *s;
+}
+
+}
+
+string&
+Transmitter::ThreadBuffer::text ()
+{
+	return this_thread().text[_transmitter];
+}
+
+Transmitter::ThreadBuffer::int_type
+Transmitter::ThreadBuffer::overflow (int_type c)
+{
+	if (!traits_type::eq_int_type (c, traits_type::eof ())) {
+		text() += traits_type::to_char_type (c);
+	}
+
+	return traits_type::not_eof (c);
+}
+
+std::streamsize
+Transmitter::ThreadBuffer::xsputn (char const * s, std::streamsize n)
+{
+	text().append (s, n);
+	return n;
+}
+
+/** Hold back the messages which the calling thread delivers from now on,
+ *  adding them to m instead of sending them, so that some other thread can
+ *  send them later with TransmitterMessages::deliver().  Fatal messages
+ *  are never held.
+ *  @param m Where to put held messages, or 0 to go back to sending them.
+ */
+void
+Transmitter::hold_messages (TransmitterMessages* m)
+{
+	this_thread().held = m;
+}
+
+/** Send each held message, in order, through the Transmitter it was
+ *  written to.
+ */
+void
+TransmitterMessages::deliver ()
+{
+	for (std::vector<std::pair<Transmitter*, string> >::iterator i = _messages.begin(); i != _messages.end(); ++i) {
+		(*i->first->send) (i->first->channel, i->second.c_str());
+	}
+
+	_messages.clear ();
+}
+
 Transmitter::Transmitter (Channel c)
+	: _buffer (this)
 {
+	std::ios::rdbuf (&_buffer);
+
 	channel = c;
 	switch (c) {
 	case Error:
@@ -66,21 +147,20 @@ Transmitter::deliver ()
 	   other action when deliver() is called. 
 	*/
 
-	*this << '\0';
-
-	/* send the SigC++ signal */
+	foo.swap (_buffer.text ());
 
-	foo = str();
-	(*send) (channel, foo.c_str());
+	TransmitterMessages* held = this_thread().held;
 
-	/* XXX when or how can we delete this ? */
-	// delete foo;
+	if (held && !does_not_return ()) {
+		held->_messages.push_back (std::make_pair (this, foo));
+	} else {
+		/* send the SigC++ signal */
+		(*send) (channel, foo.c_str());
+	}
 
 	/* return to a pristine state */
 
 	clear ();
-	seekp (0, ios::beg);
-	seekg (0, ios::beg);
 
 	/* do the right thing if this should not return */
 	
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <algorithm>
 #include <time.h>
 
 #include "pbd/undo.h"
@@ -33,6 +34,7 @@ using namespace sigc;
 
 UndoTransaction::UndoTransaction ()
 	: _clearing(false)
+	, _charged(0)
 {
 	gettimeofday (&_timestamp, 0);
 }
@@ -40,6 +42,7 @@ UndoTransaction::UndoTransaction ()
 UndoTransaction::UndoTransaction (const UndoTransaction& rhs)
 	: Command(rhs._name)
 	, _clearing(false)
+	, _charged(0)
 {
 	clear ();
 	actions.insert(actions.end(),rhs.actions.begin(),rhs.actions.end());
@@ -132,6 +135,18 @@ UndoTransaction::redo ()
         (*this)();
 }
 
+size_t
+UndoTransaction::footprint () const
+{
+	size_t s = sizeof (*this);
+
+	for (list<Command*>::const_iterator i = actions.begin(); i != actions.end(); ++i) {
+		s += (*i)->footprint ();
+	}
+
+	return s;
+}
+
 XMLNode &UndoTransaction::get_state()
 {
     XMLNode *node = new XMLNode ("UndoTransaction");
@@ -168,6 +183,8 @@ UndoHistory::UndoHistory ()
 {
 	_clearing = false;
 	_depth = 0;
+	_memory_budget = 0;
+	_footprint = 0;
 }
 
 void
@@ -190,11 +207,83 @@ UndoHistory::set_depth (uint32_t d)
 		while (cnt--) {
 			ut = UndoList.front();
 			UndoList.pop_front ();
+			discharge (ut);
 			delete ut;
 		}
 	}
 }
 
+/** Limit the memory used by the history.  Old transactions are dropped
+ *  until the history fits, though the most recent undo is always kept.
+ *  @param bytes Budget, or 0 for no limit.
+ */
+void
+UndoHistory::set_memory_budget (size_t bytes)
+{
+	_memory_budget = bytes;
+	trim_to_budget ();
+}
+
+/** @return rough number of bytes of memory used by the undo and redo lists */
+size_t
+UndoHistory::footprint () const
+{
+	return _footprint;
+}
+
+/** Add a transaction which is joining the history to the running total.
+ *  Its footprint is measured once, here, and remembered so that exactly
+ *  the same amount comes off again when it leaves.
+ */
+void
+UndoHistory::charge (UndoTransaction* ut)
+{
+	ut->_charged = ut->footprint ();
+	_footprint += ut->_charged;
+}
+
+/** Take a transaction which is leaving the history off the running total */
+void
+UndoHistory::discharge (UndoTransaction* ut)
+{
+	_footprint -= ut->_charged;
+	ut->_charged = 0;
+}
+
+void
+UndoHistory::discharge (list<UndoTransaction*> const & l)
+{
+	for (list<UndoTransaction*>::const_iterator i = l.begin(); i != l.end(); ++i) {
+		discharge (*i);
+	}
+}
+
+/** Drop transactions until the history fits its budget.  Both lists count
+ *  towards the budget, so both are trimmed: the oldest undos go first, then
+ *  the redos furthest from the present, but the most recent undo is kept.
+ */
+void
+UndoHistory::trim_to_budget ()
+{
+	if (_memory_budget == 0) {
+		return;
+	}
+
+	while (_footprint > _memory_budget && UndoList.size() > 1) {
+		UndoTransaction* ut = UndoList.front ();
+		UndoList.pop_front ();
+		discharge (ut);
+		delete ut;
+	}
+
+	while (_footprint > _memory_budget && !RedoList.empty()) {
+		UndoTransaction* ut = RedoList.front ();
+		RedoList.pop_front ();
+		discharge (ut);
+		delete ut;
+	}
+}
+
 void
 UndoHistory::add (UndoTransaction* const ut)
 {
@@ -215,11 +304,14 @@ UndoHistory::add (UndoTransaction* const ut)
 			UndoTransaction* ut;
 			ut = UndoList.front ();
 			UndoList.pop_front ();
+			discharge (ut);
 			delete ut;
 		}
 	}
 
 	UndoList.push_back (ut);
+	charge (ut);
+	trim_to_budget ();
 
 	/* we are now owners of the transaction and must delete it when finished with it */
 
@@ -233,8 +325,15 @@ UndoHistory::remove (UndoTransaction* const ut)
 		return;
 	}
 
-	UndoList.remove (ut);
-	RedoList.remove (ut);
+	list<UndoTransaction*>::iterator i;
+
+	if ((i = find (UndoList.begin(), UndoList.end(), ut)) != UndoList.end()) {
+		UndoList.erase (i);
+		discharge (ut);
+	} else if ((i = find (RedoList.begin(), RedoList.end(), ut)) != RedoList.end()) {
+		RedoList.erase (i);
+		discharge (ut);
+	}
 
 	Changed (); /* EMIT SIGNAL */
 }
@@ -294,6 +393,7 @@ void
 UndoHistory::clear_redo ()
 {
 	_clearing = true;
+	discharge (RedoList);
 	RedoList.clear ();
 	_clearing = false;
 
@@ -305,6 +405,7 @@ void
 UndoHistory::clear_undo ()
 {
 	_clearing = true;
+	discharge (UndoList);
 	UndoList.clear ();
 	_clearing = false;
 
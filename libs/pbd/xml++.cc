@@ -6,6 +6,8 @@
  */
 
 #include <iostream>
+#include <cstring>
+#include <pthread.h>
 #include "pbd/xml++.h"
 #include <libxml/debugXML.h>
 #include <libxml/xpath.h>
@@ -191,52 +193,178 @@ XMLTree::write_buffer() const
 	return retval;
 }
 
+/* Node and property names are interned: each different name is stored once,
+ * however many nodes and properties use it.  A session has millions of
+ * properties but only a few hundred names.  Interned names are never freed.
+ *
+ * Each thread keeps its own table of the names that it has already interned,
+ * so the lock on the shared table is only taken the first time that a thread
+ * sees a name, rather than for every node and property that it builds.
+ */
+
+namespace {
+
+struct CStringLess {
+	bool operator() (const char* a, const char* b) const {
+		return strcmp (a, b) < 0;
+	}
+};
+
+typedef map<const char*, const string*, CStringLess> Names;
+
+Names*          names = 0;
+pthread_mutex_t names_lock = PTHREAD_MUTEX_INITIALIZER;
+
+pthread_key_t  thread_names_key;
+pthread_once_t thread_names_once = PTHREAD_ONCE_INIT;
+
+void
+delete_thread_names (void* p)
+{
+	delete static_cast<Names*> (p);
+}
+
+void
+make_thread_names_key ()
+{
+	pthread_key_create (&thread_names_key, delete_thread_names);
+}
+
+}
+
+static const string*
+intern (const char* n)
+{
+	pthread_once (&thread_names_once, make_thread_names_key);
+
+	Names* local = static_cast<Names*> (pthread_getspecific (thread_names_key));
+
+	if (!local) {
+		local = new Names;
+		pthread_setspecific (thread_names_key, local);
+	}
+
+	Names::const_iterator l = local->find (n);
+
+	if (l != local->end()) {
+		return l->second;
+	}
+
+	pthread_mutex_lock (&names_lock);
+
+	if (!names) {
+		names = new Names;
+	}
+
+	Names::const_iterator i = names->find (n);
+
+	if (i == names->end()) {
+		string* s = new string (n);
+		i = names->insert (make_pair (s->c_str(), s)).first;
+	}
+
+	const string* r = i->second;
+
+	pthread_mutex_unlock (&names_lock);
+
+	local->insert (make_pair (r->c_str(), r));
+
+	return r;
+}
+
+/** Intern a property name, after normalizing it (replacing '_' with '-', as
+ *  old sessions are inconsistent).
+ */
+static const string*
+intern_property_name (const char* n)
+{
+	if (!strchr (n, '_')) {
+		return intern (n);
+	}
+
+	string ns (n);
+
+	for (size_t i = 0; i < ns.length(); ++i) {
+		if (ns[i] == '_') {
+			ns[i] = '-';
+		}
+	}
+
+	return intern (ns.c_str());
+}
+
 XMLNode::XMLNode(const string& n)
-	: _name(n)
+	: _name(intern (n.c_str()))
 	, _is_content(false)
+	, _child_index(0)
+	, _child_index_dirty(false)
 {
 }
 
 XMLNode::XMLNode(const string& n, const string& c)
-	: _name(n)
+	: _name(intern (n.c_str()))
 	, _is_content(true)
 	, _content(c)
+	, _child_index(0)
+	, _child_index_dirty(false)
 {
 }
 
 XMLNode::XMLNode(const XMLNode& from)
+	: _name(from._name)
+	, _is_content(false)
+	, _child_index(0)
+	, _child_index_dirty(false)
+{
+	*this = from;
+}
+
+XMLNode::~XMLNode()
 {
-	XMLPropertyList props;
-	XMLPropertyIterator curprop;
-	XMLNodeList nodes;
-	XMLNodeIterator curnode;
+	clear ();
+	delete _child_index;
+}
+
+XMLNode&
+XMLNode::operator= (const XMLNode& from)
+{
+	if (&from == this) {
+		return *this;
+	}
+
+	clear ();
 
-	_name = from.name();
+	_name = from._name;
 	set_content(from.content());
 
-	props = from.properties();
-	for (curprop = props.begin(); curprop != props.end(); ++curprop) {
-		add_property((*curprop)->name().c_str(), (*curprop)->value());
+	const XMLPropertyList& props (from.properties());
+	for (XMLPropertyConstIterator curprop = props.begin(); curprop != props.end(); ++curprop) {
+		_proplist.push_back (new XMLProperty ((*curprop)->_name, (*curprop)->value()));
 	}
 
-	nodes = from.children();
-	for (curnode = nodes.begin(); curnode != nodes.end(); ++curnode) {
+	const XMLNodeList& nodes (from.children());
+	for (XMLNodeConstIterator curnode = nodes.begin(); curnode != nodes.end(); ++curnode) {
 		add_child_copy(**curnode);
 	}
+
+	return *this;
 }
 
-XMLNode::~XMLNode()
+/** Delete our children and properties */
+void
+XMLNode::clear ()
 {
-	XMLNodeIterator curchild;
-	XMLPropertyIterator curprop;
-
-	for (curchild = _children.begin(); curchild != _children.end();	++curchild) {
+	for (XMLNodeIterator curchild = _children.begin(); curchild != _children.end(); ++curchild) {
 		delete *curchild;
 	}
 
-	for (curprop = _proplist.begin(); curprop != _proplist.end(); ++curprop) {
+	for (XMLPropertyIterator curprop = _proplist.begin(); curprop != _proplist.end(); ++curprop) {
 		delete *curprop;
 	}
+
+	_children.clear ();
+	_proplist.clear ();
+	children_changed ();
 }
 
 const string&
@@ -278,40 +406,63 @@ XMLNode::children(const string& n) const
 {
 	/* returns all children matching name */
 
-	XMLNodeConstIterator cur;
+	static const XMLNodeList none;
 
 	if (n.empty()) {
 		return _children;
 	}
 
-	_selected_children.clear();
+	if (!_child_index) {
+		_child_index = new ChildIndex;
+		_child_index_dirty = true;
+	}
 
-	for (cur = _children.begin(); cur != _children.end(); ++cur) {
-		if ((*cur)->name() == n) {
-			_selected_children.insert(_selected_children.end(), *cur);
+	if (_child_index_dirty) {
+
+		/* empty the existing lists rather than removing them, so that
+		   any list that has been handed out stays valid.
+		*/
+
+		for (ChildIndex::iterator i = _child_index->begin(); i != _child_index->end(); ++i) {
+			i->second.clear ();
 		}
+
+		for (XMLNodeConstIterator cur = _children.begin(); cur != _children.end(); ++cur) {
+			(*_child_index)[(*cur)->name()].push_back (*cur);
+		}
+
+		_child_index_dirty = false;
 	}
 
-	return _selected_children;
+	ChildIndex::const_iterator i = _child_index->find (n);
+
+	if (i == _child_index->end()) {
+		return none;
+	}
+
+	return i->second;
 }
 
 XMLNode*
 XMLNode::add_child(const char* n)
 {
-	return add_child_copy(XMLNode (n));
+	XMLNode* child = new XMLNode (n);
+	add_child_nocopy (*child);
+	return child;
 }
 
 void
 XMLNode::add_child_nocopy(XMLNode& n)
 {
-	_children.insert(_children.end(), &n);
+	_children.push_back (&n);
+	children_changed ();
 }
 
 XMLNode*
 XMLNode::add_child_copy(const XMLNode& n)
 {
 	XMLNode *copy = new XMLNode(n);
-	_children.insert(_children.end(), copy);
+	add_child_nocopy (*copy);
 	return copy;
 }
 
@@ -334,7 +485,7 @@ XMLNode::find(const string xpath) const
 std::string
 XMLNode::attribute_value()
 {
-	XMLNodeList children = this->children();
+	const XMLNodeList& children = this->children();
 	assert(!_is_content);
 	assert(children.size() == 1);
 	XMLNode* child = *(children.begin());
@@ -345,17 +496,23 @@ XMLNode::attribute_value()
 XMLNode*
 XMLNode::add_content(const string& c)
 {
-	return add_child_copy(XMLNode (string(), c));
+	XMLNode* child = new XMLNode (string(), c);
+	add_child_nocopy (*child);
+	return child;
 }
 
+/* Nodes have few properties, so looking them up in a list is as quick as
+   using a map, and needs no temporary strings.  Note that, as ever, a name
+   given to property() is not normalized.
+*/
+
 XMLProperty*
 XMLNode::property(const char* n)
 {
-	string ns(n);
-	map<string,XMLProperty*>::iterator iter;
-
-	if ((iter = _propmap.find(ns)) != _propmap.end()) {
-		return iter->second;
+	for (XMLPropertyIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		if ((*i)->name() == n) {
+			return *i;
+		}
 	}
 
 	return 0;
@@ -364,10 +521,10 @@ XMLNode::property(const char* n)
 XMLProperty*
 XMLNode::property(const string& ns)
 {
-	map<string,XMLProperty*>::iterator iter;
-
-	if ((iter = _propmap.find(ns)) != _propmap.end()) {
-		return iter->second;
+	for (XMLPropertyIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		if ((*i)->name() == ns) {
+			return *i;
+		}
 	}
 
 	return 0;
@@ -376,19 +533,24 @@ XMLNode::property(const string& ns)
 XMLProperty*
 XMLNode::add_property(const char* n, const string& v)
 {
-	string ns(n);
-	if (_propmap.find(ns) != _propmap.end()) {
-		remove_property(ns);
-	}
+	return add_property (intern_property_name (n), v);
+}
 
-	XMLProperty* tmp = new XMLProperty(ns, v);
+XMLProperty*
+XMLNode::add_property(const string* name, const string& v)
+{
+	/* an existing property of this name is replaced, and moves to the end */
 
-	if (!tmp) {
-		return 0;
+	for (XMLPropertyIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		if ((*i)->_name == name) {
+			(*i)->set_value (v);
+			_proplist.splice (_proplist.end(), _proplist, i);
+			return _proplist.back ();
+		}
 	}
 
-	_propmap[tmp->name()] = tmp;
-	_proplist.insert(_proplist.end(), tmp);
+	XMLProperty* tmp = new XMLProperty(name, v);
+	_proplist.push_back (tmp);
 
 	return tmp;
 }
@@ -403,19 +565,20 @@ XMLNode::add_property(const char* n, const char* v)
 XMLProperty*
 XMLNode::add_property(const char* name, const long value)
 {
-	static char str[1024];
-	snprintf(str, 1024, "%ld", value);
+	char str[64];
+	snprintf(str, sizeof (str), "%ld", value);
 	return add_property(name, str);
 }
 
 void
 XMLNode::remove_property(const string& n)
 {
-	if (_propmap.find(n) != _propmap.end()) {
-		XMLProperty* p = _propmap[n];
-		_proplist.remove (p);
-		delete p;
-		_propmap.erase(n);
+	for (XMLPropertyIterator i = _proplist.begin(); i != _proplist.end(); ++i) {
+		if ((*i)->name() == n) {
+			delete *i;
+			_proplist.erase (i);
+			return;
+		}
 	}
 }
 
@@ -433,6 +596,8 @@ XMLNode::remove_nodes(const string& n)
 		}
 		i = tmp;
 	}
+
+	children_changed ();
 }
 
 void
@@ -450,6 +615,8 @@ XMLNode::remove_nodes_and_delete(const string& n)
 		}
 		i = tmp;
 	}
+
+	children_changed ();
 }
 
 void
@@ -471,44 +638,61 @@ XMLNode::remove_nodes_and_delete(const string& propname, const string& val)
 
 		i = tmp;
 	}
+
+	children_changed ();
 }
 
 XMLProperty::XMLProperty(const string& n, const string& v)
+	: _name(intern_property_name (n.c_str()))
+	, _value(v)
+{
+}
+
+XMLProperty::XMLProperty(const string* n, const string& v)
 	: _name(n)
 	, _value(v)
 {
-	// Normalize property name (replace '_' with '-' as old session are inconsistent)
-	for (size_t i = 0; i < _name.length(); ++i) {
-		if (_name[i] == '_') {
-			_name[i] = '-';
-		}
-	}
 }
 
 XMLProperty::~XMLProperty()
 {
 }
 
-static XMLNode*
-readnode(xmlNodePtr node)
+/** Builds XMLNodes from libxml's nodes.  libxml keeps one copy of each name
+ *  in a document, so property names can be interned once per document rather
+ *  than once per property.
+ */
+class XMLNodeReader
 {
-	string name, content;
-	xmlNodePtr child;
-	XMLNode* tmp;
-	xmlAttrPtr attr;
+public:
+	XMLNode* read (xmlNodePtr);
 
-	if (node->name) {
-		name = (char*)node->name;
-	}
+private:
+	typedef map<const xmlChar*, const string*> Names;
+	Names _property_names;
+	string _value;
+};
+
+XMLNode*
+XMLNodeReader::read (xmlNodePtr node)
+{
+	XMLNode* tmp = new XMLNode (node->name ? (char*) node->name : "");
 
-	tmp = new XMLNode(name);
+	for (xmlAttrPtr attr = node->properties; attr; attr = attr->next) {
+
+		Names::const_iterator i = _property_names.find (attr->name);
+
+		if (i == _property_names.end()) {
+			i = _property_names.insert (make_pair (attr->name, intern_property_name ((char*) attr->name))).first;
+		}
 
-	for (attr = node->properties; attr; attr = attr->next) {
-		content = "";
-		if (attr->children) {
-			content = (char*)attr->children->content;
+		if (attr->children && attr->children->content) {
+			_value = (char*) attr->children->content;
+		} else {
+			_value.clear ();
 		}
-		tmp->add_property((char*)attr->name, content);
+
+		tmp->add_property (i->second, _value);
 	}
 
 	if (node->content) {
@@ -517,20 +701,25 @@ readnode(xmlNodePtr node)
 		tmp->set_content(string());
 	}
 
-	for (child = node->children; child; child = child->next) {
-		tmp->add_child_nocopy (*readnode(child));
+	for (xmlNodePtr child = node->children; child; child = child->next) {
+		tmp->add_child_nocopy (*read (child));
 	}
 
 	return tmp;
 }
 
+static XMLNode*
+readnode(xmlNodePtr node)
+{
+	XMLNodeReader reader;
+	return reader.read (node);
+}
+
 static void
 writenode(xmlDocPtr doc, XMLNode* n, xmlNodePtr p, int root = 0)
 {
-	XMLPropertyList props;
-	XMLPropertyIterator curprop;
-	XMLNodeList children;
-	XMLNodeIterator curchild;
+	XMLPropertyConstIterator curprop;
+	XMLNodeConstIterator curchild;
 	xmlNodePtr node;
 
 	if (root) {
@@ -544,12 +733,12 @@ writenode(xmlDocPtr doc, XMLNode* n, xmlNodePtr p, int root = 0)
 		xmlNodeSetContentLen(node, (const xmlChar*)n->content().c_str(), n->content().length());
 	}
 
-	props = n->properties();
+	const XMLPropertyList& props (n->properties());
 	for (curprop = props.begin(); curprop != props.end(); ++curprop) {
 		xmlSetProp(node, (xmlChar*) (*curprop)->name().c_str(), (xmlChar*) (*curprop)->value().c_str());
 	}
 
-	children = n->children();
+	const XMLNodeList& children (n->children());
 	for (curchild = children.begin(); curchild != children.end(); ++curchild) {
 		writenode(doc, *curchild, node);
 	}
@@ -594,7 +783,7 @@ static XMLSharedNodeList* find_impl(xmlXPathContext* ctxt, const string& xpath)
 void
 XMLNode::debug (ostream& s, string p)
 {
-	s << p << _name << " ";
+	s << p << name() << " ";
 	for (XMLPropertyList::iterator i = _proplist.begin(); i != _proplist.end(); ++i) {
 		s << (*i)->name() << "=" << (*i)->value() << " ";
 	}
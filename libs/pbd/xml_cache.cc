@@ -0,0 +1,390 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "pbd/xml++.h"
+#include "pbd/xml_cache.h"
+
+using namespace std;
+
+/* A cache file is
+
+     header:
+       char[8]   magic
+       uint32_t  format version
+       uint32_t  byte order mark
+       uint64_t  size of the XML file
+       int64_t   modification time of the XML file
+       uint64_t  hash of the XML file
+     uint32_t    number of names, then each name as a string
+     root node
+
+   where a string is a uint32_t length followed by that many bytes, and a node is
+
+     uint32_t    index of its name
+     string      content
+     uint32_t    number of properties, then for each the index of its name and its value as a string
+     uint32_t    number of children, then each child node
+
+   Node and property names are shared through the table of names, as
+   a session uses only a few hundred different ones.  Everything is
+   in the byte order of the machine that wrote it; a cache from
+   another machine is simply ignored.
+*/
+
+static char const cache_magic[8] = { 'P', 'B', 'D', 'X', 'M', 'L', 'C', '\0' };
+static uint32_t const cache_version = 1;
+static uint32_t const cache_byte_order = 0x01020304;
+
+struct CacheHeader {
+	char     magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint64_t size;
+	int64_t  mtime;
+	uint64_t hash;
+};
+
+static bool
+read_file (string const & path, vector<char>& data)
+{
+	FILE* f = fopen (path.c_str(), "rb");
+	if (!f) {
+		return false;
+	}
+
+	bool ok = (fseek (f, 0, SEEK_END) == 0);
+	long const size = ok ? ftell (f) : -1;
+	ok = ok && size >= 0 && fseek (f, 0, SEEK_SET) == 0;
+
+	if (ok) {
+		data.resize (size);
+		ok = (size == 0 || fread (&data[0], 1, size, f) == (size_t) size);
+	}
+
+	fclose (f);
+	return ok;
+}
+
+/** 64-bit FNV-1a */
+static uint64_t
+hash_data (vector<char> const & data)
+{
+	uint64_t h = 14695981039346656037ULL;
+
+	for (vector<char>::const_iterator i = data.begin(); i != data.end(); ++i) {
+		h ^= (unsigned char) *i;
+		h *= 1099511628211ULL;
+	}
+
+	return h;
+}
+
+/** Fill in the parts of a header which describe an XML file.
+ *  @param data Filled in with the contents of the file.
+ */
+static bool
+describe_xml_file (string const & xml_path, CacheHeader& header, vector<char>& data)
+{
+	struct stat st;
+
+	if (stat (xml_path.c_str(), &st) != 0 || !read_file (xml_path, data) || (uint64_t) st.st_size != data.size()) {
+		return false;
+	}
+
+	header.size = data.size ();
+	header.mtime = st.st_mtime;
+	header.hash = hash_data (data);
+
+	return true;
+}
+
+namespace {
+
+class CacheWriter
+{
+  public:
+	void put (void const * p, size_t n) {
+		_data.append (static_cast<char const *> (p), n);
+	}
+
+	void put (uint32_t n) {
+		put (&n, sizeof (n));
+	}
+
+	void put (string const & s) {
+		put ((uint32_t) s.size());
+		put (s.data(), s.size());
+	}
+
+	void put_name (string const & s) {
+		map<string, uint32_t>::iterator i = _name_index.find (s);
+		if (i == _name_index.end()) {
+			i = _name_index.insert (make_pair (s, (uint32_t) _names.size())).first;
+			_names.push_back (&i->first);
+		}
+		put (i->second);
+	}
+
+	void put_node (XMLNode const & node) {
+		put_name (node.name ());
+		put (node.content ());
+
+		XMLPropertyList const & p (node.properties ());
+		put ((uint32_t) p.size());
+		for (XMLPropertyConstIterator i = p.begin(); i != p.end(); ++i) {
+			put_name ((*i)->name ());
+			put ((*i)->value ());
+		}
+
+		XMLNodeList const & c (node.children ());
+		put ((uint32_t) c.size());
+		for (XMLNodeConstIterator i = c.begin(); i != c.end(); ++i) {
+			put_node (**i);
+		}
+	}
+
+	/** @return the table of names followed by the nodes written so far */
+	string finish () {
+		CacheWriter table;
+		table.put ((uint32_t) _names.size());
+		for (vector<string const *>::const_iterator i = _names.begin(); i != _names.end(); ++i) {
+			table.put (**i);
+		}
+		return table._data + _data;
+	}
+
+  private:
+	string _data;
+	map<string, uint32_t> _name_index;
+	vector<string const *> _names;
+};
+
+class CacheReader
+{
+  public:
+	CacheReader (char const * p, char const * end)
+		: _p (p)
+		, _end (end)
+	{}
+
+	bool get (void* d, size_t n) {
+		if ((size_t) (_end - _p) < n) {
+			return false;
+		}
+		memcpy (d, _p, n);
+		_p += n;
+		return true;
+	}
+
+	bool get (uint32_t& n) {
+		return get (&n, sizeof (n));
+	}
+
+	bool get (string& s) {
+		uint32_t n;
+		if (!get (n) || (size_t) (_end - _p) < n) {
+			return false;
+		}
+		s.assign (_p, n);
+		_p += n;
+		return true;
+	}
+
+	bool get_names () {
+		uint32_t n;
+		if (!get (n)) {
+			return false;
+		}
+		_names.resize (n);
+		for (uint32_t i = 0; i < n; ++i) {
+			if (!get (_names[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	string const * get_name () {
+		uint32_t n;
+		if (!get (n) || n >= _names.size()) {
+			return 0;
+		}
+		return &_names[n];
+	}
+
+	XMLNode* get_node () {
+		string const * name = get_name ();
+		if (!name || !get (_value)) {
+			return 0;
+		}
+
+		XMLNode* node = new XMLNode (*name);
+		node->set_content (_value);
+
+		uint32_t n;
+
+		if (!get (n)) {
+			goto bad;
+		}
+
+		for (uint32_t i = 0; i < n; ++i) {
+			string const * prop = get_name ();
+			if (!prop || !get (_value)) {
+				goto bad;
+			}
+			node->add_property (prop->c_str(), _value);
+		}
+
+		if (!get (n)) {
+			goto bad;
+		}
+
+		for (uint32_t i = 0; i < n; ++i) {
+			XMLNode* child = get_node ();
+			if (!child) {
+				goto bad;
+			}
+			node->add_child_nocopy (*child);
+		}
+
+		return node;
+
+	  bad:
+		delete node;
+		return 0;
+	}
+
+	bool at_end () const {
+		return _p == _end;
+	}
+
+  private:
+	char const * _p;
+	char const * _end;
+	vector<string> _names;
+	string _value; ///< scratch space for content and property values
+};
+
+}
+
+bool
+PBD::xml_write_cache (string const & xml_path, string const & cache_path)
+{
+	CacheHeader header;
+	vector<char> xml;
+
+	memset (&header, 0, sizeof (header));
+	memcpy (header.magic, cache_magic, sizeof (header.magic));
+	header.version = cache_version;
+	header.byte_order = cache_byte_order;
+
+	if (!describe_xml_file (xml_path, header, xml)) {
+		return false;
+	}
+
+	XMLTree tree;
+
+	if (!tree.read (xml_path) || !tree.root()) {
+		return false;
+	}
+
+	CacheWriter writer;
+	writer.put_node (*tree.root());
+	string const body = writer.finish ();
+
+	/* write to a temporary file and then rename it, so that a reader never sees half a cache */
+
+	string const tmp_path = cache_path + ".tmp";
+
+	FILE* f = fopen (tmp_path.c_str(), "wb");
+	if (!f) {
+		return false;
+	}
+
+	bool ok = fwrite (&header, sizeof (header), 1, f) == 1 && fwrite (body.data(), 1, body.size(), f) == body.size();
+
+	if (fclose (f) != 0) {
+		ok = false;
+	}
+
+	if (!ok || rename (tmp_path.c_str(), cache_path.c_str()) != 0) {
+		remove (tmp_path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+XMLNode*
+PBD::xml_read_cache (string const & xml_path, string const & cache_path)
+{
+	vector<char> cache;
+
+	if (!read_file (cache_path, cache) || cache.size() < sizeof (CacheHeader)) {
+		return 0;
+	}
+
+	CacheHeader header;
+	memcpy (&header, &cache[0], sizeof (header));
+
+	if (memcmp (header.magic, cache_magic, sizeof (header.magic)) != 0
+	    || header.version != cache_version
+	    || header.byte_order != cache_byte_order) {
+		return 0;
+	}
+
+	/* check the cheap things first, so that a stale cache is usually
+	   spotted without reading the XML file.
+	*/
+
+	struct stat st;
+
+	if (stat (xml_path.c_str(), &st) != 0 || (uint64_t) st.st_size != header.size || (int64_t) st.st_mtime != header.mtime) {
+		return 0;
+	}
+
+	CacheHeader now;
+	vector<char> xml;
+
+	if (!describe_xml_file (xml_path, now, xml) || now.size != header.size || now.hash != header.hash) {
+		return 0;
+	}
+
+	CacheReader reader (&cache[0] + sizeof (header), &cache[0] + cache.size());
+
+	if (!reader.get_names ()) {
+		return 0;
+	}
+
+	XMLNode* root = reader.get_node ();
+
+	if (root && !reader.at_end ()) {
+		delete root;
+		return 0;
+	}
+
+	return root;
+}
@@ -0,0 +1,348 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include "pbd/xml++.h"
+#include "pbd/xml_delta.h"
+
+#include "i18n.h"
+
+using namespace std;
+
+/* A delta is either
+
+     <Replace> copy of the new node </Replace>
+
+   when the node's name (or kind) has changed, or
+
+     <Delta>
+       <Set name="..." value="..."/>       property added or changed
+       <Unset name="..."/>                 property removed
+       <Text skip="p" remove="n" insert="..."/>   content edited
+       <Splice at="i" remove="n"> new children </Splice>
+       <Patch at="i"> delta for child i </Patch>
+     </Delta>
+
+   Children are compared from both ends, so only those between the common
+   prefix and suffix are stored.  If the same number of children were
+   removed as were added they are patched one by one; otherwise the middle
+   section is spliced in whole.  Child indices always refer to the node
+   that the delta is applied to.
+*/
+
+static void
+node_children (XMLNode const & node, vector<XMLNode const *>& v)
+{
+	XMLNodeList const & c (node.children ());
+	v.assign (c.begin(), c.end());
+}
+
+bool
+PBD::xml_equal (XMLNode const & a, XMLNode const & b)
+{
+	if (a.name() != b.name() || a.is_content() != b.is_content() || a.content() != b.content()) {
+		return false;
+	}
+
+	XMLPropertyList const & pa (a.properties ());
+	XMLPropertyList const & pb (b.properties ());
+
+	if (pa.size() != pb.size()) {
+		return false;
+	}
+
+	/* property order is not significant */
+
+	for (XMLPropertyConstIterator i = pa.begin(); i != pa.end(); ++i) {
+		XMLProperty const * p = b.property ((*i)->name());
+		if (!p || p->value() != (*i)->value()) {
+			return false;
+		}
+	}
+
+	XMLNodeList const & ca (a.children ());
+	XMLNodeList const & cb (b.children ());
+
+	if (ca.size() != cb.size()) {
+		return false;
+	}
+
+	for (XMLNodeConstIterator i = ca.begin(), j = cb.begin(); i != ca.end(); ++i, ++j) {
+		if (!xml_equal (**i, **j)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+size_t
+PBD::xml_size (XMLNode const & node)
+{
+	/* list and map nodes cost about three pointers each */
+	size_t const link = 3 * sizeof (void*);
+
+	size_t s = sizeof (XMLNode) + node.name().size() + node.content().size();
+
+	XMLPropertyList const & p (node.properties ());
+
+	for (XMLPropertyConstIterator i = p.begin(); i != p.end(); ++i) {
+		s += sizeof (XMLProperty) + (*i)->name().size() + (*i)->value().size() + 2 * link;
+	}
+
+	XMLNodeList const & c (node.children ());
+
+	for (XMLNodeConstIterator i = c.begin(); i != c.end(); ++i) {
+		s += xml_size (**i) + link;
+	}
+
+	return s;
+}
+
+XMLNode*
+PBD::xml_delta (XMLNode const & from, XMLNode const & to)
+{
+	if (from.name() != to.name() || from.is_content() != to.is_content()) {
+		XMLNode* r = new XMLNode (X_("Replace"));
+		r->add_child_copy (to);
+		return r;
+	}
+
+	XMLNode* delta = new XMLNode (X_("Delta"));
+
+	/* properties */
+
+	XMLPropertyList const & tp (to.properties ());
+
+	for (XMLPropertyConstIterator i = tp.begin(); i != tp.end(); ++i) {
+		XMLProperty const * p = from.property ((*i)->name());
+		if (!p || p->value() != (*i)->value()) {
+			XMLNode* s = delta->add_child (X_("Set"));
+			s->add_property (X_("name"), (*i)->name());
+			s->add_property (X_("value"), (*i)->value());
+		}
+	}
+
+	XMLPropertyList const & fp (from.properties ());
+
+	for (XMLPropertyConstIterator i = fp.begin(); i != fp.end(); ++i) {
+		if (!to.property ((*i)->name())) {
+			delta->add_child (X_("Unset"))->add_property (X_("name"), (*i)->name());
+		}
+	}
+
+	/* content */
+
+	string const & fc (from.content ());
+	string const & tc (to.content ());
+
+	if (fc != tc) {
+		size_t const shortest = min (fc.size(), tc.size());
+		size_t prefix = 0;
+		while (prefix < shortest && fc[prefix] == tc[prefix]) {
+			++prefix;
+		}
+		size_t suffix = 0;
+		while (prefix + suffix < shortest && fc[fc.size() - suffix - 1] == tc[tc.size() - suffix - 1]) {
+			++suffix;
+		}
+
+		XMLNode* t = delta->add_child (X_("Text"));
+		t->add_property (X_("skip"), (long) prefix);
+		t->add_property (X_("remove"), (long) (fc.size() - prefix - suffix));
+		t->add_property (X_("insert"), tc.substr (prefix, tc.size() - prefix - suffix));
+	}
+
+	/* children */
+
+	vector<XMLNode const *> fk;
+	vector<XMLNode const *> tk;
+	node_children (from, fk);
+	node_children (to, tk);
+
+	size_t const shortest = min (fk.size(), tk.size());
+	size_t prefix = 0;
+	while (prefix < shortest && xml_equal (*fk[prefix], *tk[prefix])) {
+		++prefix;
+	}
+	size_t suffix = 0;
+	while (prefix + suffix < shortest && xml_equal (*fk[fk.size() - suffix - 1], *tk[tk.size() - suffix - 1])) {
+		++suffix;
+	}
+
+	size_t const removed = fk.size() - prefix - suffix;
+	size_t const added = tk.size() - prefix - suffix;
+
+	if (removed == added) {
+		for (size_t i = prefix; i < prefix + removed; ++i) {
+			XMLNode* p = delta->add_child (X_("Patch"));
+			p->add_property (X_("at"), (long) i);
+			p->add_child_nocopy (*xml_delta (*fk[i], *tk[i]));
+		}
+	} else {
+		XMLNode* s = delta->add_child (X_("Splice"));
+		s->add_property (X_("at"), (long) prefix);
+		s->add_property (X_("remove"), (long) removed);
+		for (size_t i = prefix; i < prefix + added; ++i) {
+			s->add_child_copy (*tk[i]);
+		}
+	}
+
+	return delta;
+}
+
+XMLNode*
+PBD::xml_apply_delta (XMLNode const & node, XMLNode const & delta)
+{
+	if (delta.name() == X_("Replace")) {
+		if (delta.children().empty()) {
+			return 0;
+		}
+		return new XMLNode (*delta.children().front());
+	}
+
+	if (delta.name() != X_("Delta")) {
+		return 0;
+	}
+
+	XMLNode* n = new XMLNode (node.name());
+
+	XMLPropertyList const & np (node.properties ());
+
+	for (XMLPropertyConstIterator i = np.begin(); i != np.end(); ++i) {
+		n->add_property ((*i)->name().c_str(), (*i)->value());
+	}
+
+	string content = node.content ();
+
+	vector<XMLNode const *> children;
+	node_children (node, children);
+
+	typedef map<size_t, XMLNode const *> Patches;
+	Patches patches;
+	XMLNode const * splice = 0;
+	size_t splice_at = 0;
+	size_t splice_remove = 0;
+
+	XMLNodeList const & dc (delta.children ());
+
+	for (XMLNodeConstIterator i = dc.begin(); i != dc.end(); ++i) {
+
+		XMLNode const & c (**i);
+		XMLProperty const * name = c.property (X_("name"));
+
+		if (c.name() == X_("Set")) {
+
+			XMLProperty const * value = c.property (X_("value"));
+			if (!name || !value) {
+				goto bad;
+			}
+			n->add_property (name->value().c_str(), value->value());
+
+		} else if (c.name() == X_("Unset")) {
+
+			if (!name) {
+				goto bad;
+			}
+			n->remove_property (name->value());
+
+		} else if (c.name() == X_("Text")) {
+
+			XMLProperty const * skip = c.property (X_("skip"));
+			XMLProperty const * remove = c.property (X_("remove"));
+			XMLProperty const * insert = c.property (X_("insert"));
+			if (!skip || !remove || !insert) {
+				goto bad;
+			}
+			size_t const s = atol (skip->value().c_str());
+			size_t const r = atol (remove->value().c_str());
+			if (s + r > content.size()) {
+				goto bad;
+			}
+			content.replace (s, r, insert->value());
+
+		} else if (c.name() == X_("Splice")) {
+
+			XMLProperty const * at = c.property (X_("at"));
+			XMLProperty const * remove = c.property (X_("remove"));
+			if (!at || !remove) {
+				goto bad;
+			}
+			splice = &c;
+			splice_at = atol (at->value().c_str());
+			splice_remove = atol (remove->value().c_str());
+			if (splice_at + splice_remove > children.size()) {
+				goto bad;
+			}
+
+		} else if (c.name() == X_("Patch")) {
+
+			XMLProperty const * at = c.property (X_("at"));
+			if (!at || c.children().empty()) {
+				goto bad;
+			}
+			size_t const a = atol (at->value().c_str());
+			if (a >= children.size()) {
+				goto bad;
+			}
+			patches[a] = c.children().front();
+		}
+	}
+
+	n->set_content (content);
+
+	for (size_t i = 0; i <= children.size(); ++i) {
+
+		if (splice && i == splice_at) {
+			XMLNodeList const & added (splice->children ());
+			for (XMLNodeConstIterator j = added.begin(); j != added.end(); ++j) {
+				n->add_child_copy (**j);
+			}
+		}
+
+		if (i == children.size()) {
+			break;
+		}
+
+		if (splice && i >= splice_at && i < splice_at + splice_remove) {
+			continue;
+		}
+
+		Patches::const_iterator p = patches.find (i);
+
+		if (p == patches.end()) {
+			n->add_child_copy (*children[i]);
+		} else {
+			XMLNode* c = xml_apply_delta (*children[i], *p->second);
+			if (!c) {
+				goto bad;
+			}
+			n->add_child_nocopy (*c);
+		}
+	}
+
+	return n;
+
+  bad:
+	delete n;
+	return 0;
+}
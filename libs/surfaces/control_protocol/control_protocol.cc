@@ -24,6 +24,7 @@
 #include "ardour/route.h"
 #include "ardour/audio_track.h"
 #include "ardour/meter.h"
+#include "ardour/meter_snapshot.h"
 #include "ardour/amp.h"
 #include "control_protocol/control_protocol.h"
 
@@ -273,7 +274,7 @@ ControlProtocol::route_get_peak_input_power (uint32_t table_index, uint32_t whic
 		return 0.0f;
 	}
 
-	return r->peak_meter().peak_power (which_input);
+	return session->meter_snapshot().peak_power (r, which_input);
 }
 
 
@@ -37,7 +37,7 @@
 #include "midi++/manager.h"
 #include "pbd/pthread_utils.h"
 #include "pbd/error.h"
-#include "pbd/memento_command.h"
+#include "pbd/delta_memento_command.h"
 #include "pbd/convert.h"
 
 #include "ardour/dB.h"
@@ -1580,7 +1580,7 @@ MackieControlProtocol::marker_press (Button &)
 	XMLNode &before = session->locations()->get_state();
 	session->locations()->add (location, true);
 	XMLNode &after = session->locations()->get_state();
-	session->add_command (new MementoCommand<Locations>(*(session->locations()), &before, &after));
+	session->add_command (new DeltaMementoCommand<Locations>(*(session->locations()), &before, &after));
 	session->commit_reversible_command ();
 	return on;
 }
@@ -80,10 +80,12 @@ OSC::OSC (Session& s, uint32_t port)
 	_osc_unix_server = 0;
 	_namespace_root = "/ardour";
 	_send_route_changes = true;
+	_feedback_rate = 10;
 
 	/* glibmm hack */
 	local_server = 0;
 	remote_server = 0;
+	feedback_timer = 0;
 
 	// "Application Hooks"
 	session_loaded (s);
@@ -138,6 +140,65 @@ OSC::get_feedback () const
 	return _send_route_changes;
 }
 
+void
+OSC::set_feedback_rate (uint32_t hz)
+{
+	hz = max (1U, min (hz, 100U));
+
+	if (hz == _feedback_rate) {
+		return;
+	}
+
+	_feedback_rate = hz;
+
+	/* this may be called from set_state() in any thread, but the timer
+	   belongs to our event loop, so it must be changed there.
+	*/
+
+	call_slot (MISSING_INVALIDATOR, boost::bind (&OSC::restart_feedback_timer, this));
+}
+
+void
+OSC::restart_feedback_timer ()
+{
+	if (feedback_timer) {
+		stop_feedback_timer ();
+		start_feedback_timer ();
+	}
+}
+
+void
+OSC::start_feedback_timer ()
+{
+	/* route state is sent from our own event loop, never from the process thread */
+
+	Glib::RefPtr<TimeoutSource> src = TimeoutSource::create (1000 / _feedback_rate);
+	src->connect (sigc::mem_fun (*this, &OSC::send_feedback));
+	src->attach (_main_loop->get_context());
+	feedback_timer = src->gobj();
+	g_source_ref (feedback_timer);
+}
+
+void
+OSC::stop_feedback_timer ()
+{
+	if (feedback_timer) {
+		g_source_destroy (feedback_timer);
+		g_source_unref (feedback_timer);
+		feedback_timer = 0;
+	}
+}
+
+bool
+OSC::send_feedback ()
+{
+	if (_send_route_changes) {
+		_feedback.flush ();
+	}
+
+	return true;
+}
+
 int
 OSC::start ()
 {
@@ -236,6 +297,8 @@ OSC::thread_init ()
 		g_source_ref (remote_server);
 	}
 
+	start_feedback_timer ();
+
 	PBD::notify_gui_about_thread_creation (X_("gui"), pthread_self(), X_("OSC"), 2048);
 	SessionEvent::create_per_thread_pool (X_("OSC"), 128);
 }
@@ -245,6 +308,8 @@ OSC::stop ()
 {	
 	/* stop main loop */
 
+	stop_feedback_timer ();
+
 	if (local_server) {
 		g_source_destroy (local_server);
 		g_source_unref (local_server);
@@ -259,6 +324,10 @@ OSC::stop ()
 
 	BaseUI::quit ();
 
+	/* our thread has finished, so nothing else is using the clients */
+
+	_feedback.clear ();
+
 	if (_osc_server) {
 		int fd = lo_server_get_socket_fd(_osc_server);
 		if (fd >=0) {
@@ -529,6 +598,13 @@ OSC::catchall (const char *path, const char *types, lo_arg **argv, int argc, lo_
 				end_listen (r, lo_message_get_source (msg));
 			}
 		}
+
+	} else if (strcmp (path, "/routes/meters") == 0) {
+
+		/* peak levels for the routes this client listens to */
+
+		_feedback.set_meters (lo_message_get_source (msg), argc > 0 && argv[0]->i);
+		ret = 0;
 	}
 
 	return ret;
@@ -537,57 +613,17 @@ OSC::catchall (const char *path, const char *types, lo_arg **argv, int argc, lo_
 void
 OSC::listen_to_route (boost::shared_ptr<Route> route, lo_address addr)
 {
-	Controllables::iterator x;
-	bool route_exists = false;
-
-	cerr << "listen to route\n";
-
-	/* avoid duplicate listens */
-	
-	for (x = controllables.begin(); x != controllables.end(); ++x) {
-		
-		OSCRouteControllable* rc;
-
-		if ((rc = dynamic_cast<OSCRouteControllable*>(*x)) != 0) {
-			
-			if (rc->route() == route) {
-				route_exists = true;
-				
-				/* XXX NEED lo_address_equal() */
-				
-				if (rc->address() == addr) {
-					return;
-				}
-			}
-		}
-	}
-
-	cerr << "listener binding to signals\n";
-
-	OSCControllable* c;
-	string path;
-
-	path = X_("/route/solo");
-	c = new OSCRouteControllable (addr, path, route->solo_control(), route);
-	controllables.push_back (c);
-
-	path = X_("/route/mute");
-	c = new OSCRouteControllable (addr, path, route->mute_control(), route);
-	controllables.push_back (c);
-
-	path = X_("/route/gain");
-	c = new OSCRouteControllable (addr, path, route->gain_control(), route);
-	controllables.push_back (c);
-
-	cerr << "Now have " << controllables.size() << " controllables\n";
-
-	/* if there is no existing controllable related to this route, make sure we clean up
+	/* if nobody was listening to this route yet, make sure we clean up
 	   if it is ever deleted.
 	*/
-	
-	if (!route_exists) {
+
+	if (!_feedback.listening_to (route)) {
 		route->DropReferences.connect (*this, MISSING_INVALIDATOR, boost::bind (&OSC::drop_route, this, boost::weak_ptr<Route> (route)), this);
 	}
+
+	/* changes are sent, batched, by send_feedback() */
+
+	_feedback.add_listener (route, addr);
 }
 
 void
@@ -599,42 +635,13 @@ OSC::drop_route (boost::weak_ptr<Route> wr)
 		return;
 	}
 
-	for (Controllables::iterator x = controllables.begin(); x != controllables.end();) {
-
-		OSCRouteControllable* rc;
-		
-		if ((rc = dynamic_cast<OSCRouteControllable*>(*x)) != 0) {
-			if (rc->route() == r) {
-				delete *x;
-				x = controllables.erase (x);
-			} else {
-				++x;
-			}
-		} else {
-			++x;
-		}
-	}
+	_feedback.drop_route (r);
 }
 
 void
 OSC::end_listen (boost::shared_ptr<Route> r, lo_address addr)
 {
-	Controllables::iterator x;
-
-	for (x = controllables.begin(); x != controllables.end(); ++x) {
-
-		OSCRouteControllable* rc;
-		
-		if ((rc = dynamic_cast<OSCRouteControllable*>(*x)) != 0) {
-
-			/* XXX NEED lo_address_equal () */
-
-			if (rc->route() == r && rc->address() == addr) {
-				controllables.erase (x);
-				return;
-			}
-		}
-	}
+	_feedback.remove_listener (r, addr);
 }
 
 // "Application Hook" Handlers //
@@ -784,11 +791,23 @@ OSC::route_set_gain_dB (int rid, float dB)
 XMLNode& 
 OSC::get_state () 
 {
-	return *(new XMLNode ("OSC"));
+	XMLNode* node = new XMLNode ("OSC");
+	char buf[16];
+
+	snprintf (buf, sizeof (buf), "%u", _feedback_rate);
+	node->add_property (X_("feedback-rate"), buf);
+
+	return *node;
 }
 		
 int 
-OSC::set_state (const XMLNode&, int /*version*/)
+OSC::set_state (const XMLNode& node, int /*version*/)
 {
+	const XMLProperty* prop;
+
+	if ((prop = node.property (X_("feedback-rate"))) != 0) {
+		set_feedback_rate (atoi (prop->value().c_str()));
+	}
+
 	return 0;
 }
@@ -36,6 +36,8 @@
 #include "ardour/types.h"
 #include "control_protocol/control_protocol.h"
 
+#include "osc_feedback.h"
+
 class OSCControllable;
 
 namespace ARDOUR {
@@ -70,6 +72,10 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	int set_feedback (bool yn);
 	bool get_feedback () const;
 
+	/** Set how many times per second route state is sent to listening clients */
+	void set_feedback_rate (uint32_t hz);
+	uint32_t feedback_rate () const { return _feedback_rate; }
+
 	void set_namespace_root (std::string);
 
 	int start ();
@@ -81,8 +87,13 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 
 	GSource* local_server;
 	GSource* remote_server;
+	GSource* feedback_timer;
 	
 	bool osc_input_handler (Glib::IOCondition, lo_server);
+	bool send_feedback ();
+	void start_feedback_timer ();
+	void restart_feedback_timer ();
+	void stop_feedback_timer ();
 
   private:
 	uint32_t _port;
@@ -94,6 +105,8 @@ class OSC : public ARDOUR::ControlProtocol, public AbstractUI<OSCUIRequest>
 	std::string _osc_url_file;
 	std::string _namespace_root;
 	bool _send_route_changes;
+	uint32_t _feedback_rate;
+	OSCFeedback _feedback;
 
 	void register_callbacks ();
 
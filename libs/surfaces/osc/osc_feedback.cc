@@ -0,0 +1,340 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "ardour/amp.h"
+#include "ardour/meter.h"
+#include "ardour/panner.h"
+#include "ardour/route.h"
+
+#include "osc_feedback.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+const float OSCFeedback::meter_threshold = 0.5f;
+
+/** peak levels below this (dB) are sent as this value, so that clients never see -inf */
+static const float meter_floor = -120.0f;
+
+OSCFeedback::RouteState::RouteState ()
+	: gain (0)
+	, pan (0)
+	, peak (meter_floor)
+	, mute (false)
+	, solo (false)
+	, valid (false)
+{
+}
+
+OSCFeedback::OSCFeedback ()
+{
+}
+
+OSCFeedback::~OSCFeedback ()
+{
+	clear ();
+}
+
+string
+OSCFeedback::address_url (lo_address addr)
+{
+	char* u = lo_address_get_url (addr);
+	string url (u);
+	free (u);
+	return url;
+}
+
+/** @return the Client for addr, creating it if necessary.  addr is not kept;
+ *  it normally belongs to an incoming message, so we make our own copy.
+ */
+OSCFeedback::Client&
+OSCFeedback::client (lo_address addr)
+{
+	string const url = address_url (addr);
+	Clients::iterator c = _clients.find (url);
+
+	if (c == _clients.end()) {
+		c = _clients.insert (make_pair (url, Client())).first;
+		c->second.addr = lo_address_new_from_url (url.c_str());
+	}
+
+	return c->second;
+}
+
+void
+OSCFeedback::add_listener (boost::shared_ptr<Route> route, lo_address addr)
+{
+	Client& c (client (addr));
+
+	for (vector<ListenedRoute>::iterator i = c.routes.begin(); i != c.routes.end(); ++i) {
+		if (i->route.lock() == route) {
+			return;
+		}
+	}
+
+	/* the new entry's state is not valid, so the next flush will send it in full */
+
+	c.routes.push_back (ListenedRoute (route));
+}
+
+void
+OSCFeedback::remove_listener (boost::shared_ptr<Route> route, lo_address addr)
+{
+	Clients::iterator c = _clients.find (address_url (addr));
+
+	if (c == _clients.end()) {
+		return;
+	}
+
+	vector<ListenedRoute>& routes (c->second.routes);
+
+	for (vector<ListenedRoute>::iterator i = routes.begin(); i != routes.end(); ++i) {
+		if (i->route.lock() == route) {
+			routes.erase (i);
+			break;
+		}
+	}
+
+	if (routes.empty()) {
+		lo_address_free (c->second.addr);
+		_clients.erase (c);
+	}
+}
+
+void
+OSCFeedback::drop_route (boost::shared_ptr<Route> route)
+{
+	for (Clients::iterator c = _clients.begin(); c != _clients.end(); ) {
+
+		vector<ListenedRoute>& routes (c->second.routes);
+
+		for (vector<ListenedRoute>::iterator i = routes.begin(); i != routes.end(); ) {
+			boost::shared_ptr<Route> r = i->route.lock ();
+			if (!r || r == route) {
+				i = routes.erase (i);
+			} else {
+				++i;
+			}
+		}
+
+		/* as in remove_listener(), a client listening to nothing is forgotten */
+
+		if (routes.empty()) {
+			lo_address_free (c->second.addr);
+			_clients.erase (c++);
+		} else {
+			++c;
+		}
+	}
+}
+
+/** Turn peak level feedback on or off for one client */
+void
+OSCFeedback::set_meters (lo_address addr, bool yn)
+{
+	if (yn) {
+		client(addr).meters = true;
+		return;
+	}
+
+	Clients::iterator c = _clients.find (address_url (addr));
+
+	if (c == _clients.end()) {
+		return;
+	}
+
+	c->second.meters = false;
+
+	/* a client which only asked for meters, and now does not want them, is forgotten */
+
+	if (c->second.routes.empty()) {
+		lo_address_free (c->second.addr);
+		_clients.erase (c);
+	}
+}
+
+void
+OSCFeedback::clear ()
+{
+	for (Clients::iterator c = _clients.begin(); c != _clients.end(); ++c) {
+		lo_address_free (c->second.addr);
+	}
+
+	_clients.clear ();
+}
+
+bool
+OSCFeedback::listening_to (boost::shared_ptr<Route> route) const
+{
+	for (Clients::const_iterator c = _clients.begin(); c != _clients.end(); ++c) {
+		for (vector<ListenedRoute>::const_iterator i = c->second.routes.begin(); i != c->second.routes.end(); ++i) {
+			if (i->route.lock() == route) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/** @return the state of a route, without its peak level */
+OSCFeedback::RouteState
+OSCFeedback::current_state (Route& route)
+{
+	RouteState s;
+
+	s.gain = route.gain_control()->get_value ();
+	s.mute = route.muted ();
+	s.solo = route.soloed ();
+
+	boost::shared_ptr<Panner> panner = route.panner ();
+
+	if (panner && panner->npanners()) {
+		s.pan = panner->streampanner(0).pan_control()->get_value ();
+	}
+
+	s.valid = true;
+	return s;
+}
+
+/** @return the highest peak level (dB) of any of a route's meter channels */
+float
+OSCFeedback::current_peak (Route& route)
+{
+	PeakMeter& meter (route.peak_meter ());
+	uint32_t const n = meter.input_streams().n_total ();
+	float peak = meter_floor;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		peak = max (peak, meter.peak_power (i));
+	}
+
+	return peak;
+}
+
+static void
+send_bundle (lo_address addr, lo_bundle& bundle, uint32_t& n)
+{
+	if (bundle) {
+		lo_send_bundle (addr, bundle);
+		lo_bundle_free_messages (bundle);
+		bundle = 0;
+	}
+
+	n = 0;
+}
+
+static void
+add_to_bundle (lo_address addr, lo_bundle& bundle, uint32_t& n, const char* path, int32_t rid, float val)
+{
+	if (!bundle) {
+		bundle = lo_bundle_new (LO_TT_IMMEDIATE);
+	}
+
+	lo_message msg = lo_message_new ();
+	lo_message_add_int32 (msg, rid);
+	lo_message_add_float (msg, val);
+	lo_bundle_add_message (bundle, path, msg);
+
+	if (++n == OSCFeedback::max_bundle_size) {
+		/* keep each bundle well inside one UDP datagram */
+		send_bundle (addr, bundle, n);
+	}
+}
+
+void
+OSCFeedback::flush ()
+{
+	/* read each route's state once, however many clients are listening to
+	   it, and its meters only if some client wants them.
+	*/
+
+	typedef map<Route*, RouteState> Snapshot;
+	Snapshot snapshot;
+	typedef map<Route*, float> Peaks;
+	Peaks peaks;
+
+	for (Clients::iterator c = _clients.begin(); c != _clients.end(); ++c) {
+
+		Client& cl (c->second);
+		lo_bundle bundle = 0;
+		uint32_t n = 0;
+
+		for (vector<ListenedRoute>::iterator i = cl.routes.begin(); i != cl.routes.end(); ++i) {
+
+			boost::shared_ptr<Route> r = i->route.lock ();
+
+			if (!r) {
+				continue;
+			}
+
+			Snapshot::iterator s = snapshot.find (r.get());
+
+			if (s == snapshot.end()) {
+				s = snapshot.insert (make_pair (r.get(), current_state (*r))).first;
+			}
+
+			RouteState const & now (s->second);
+			RouteState& sent (i->sent);
+			int32_t const rid = r->remote_control_id ();
+
+			if (!sent.valid || now.gain != sent.gain) {
+				add_to_bundle (cl.addr, bundle, n, "/route/gain", rid, now.gain);
+				sent.gain = now.gain;
+			}
+
+			if (!sent.valid || now.mute != sent.mute) {
+				add_to_bundle (cl.addr, bundle, n, "/route/mute", rid, now.mute ? 1.0f : 0.0f);
+				sent.mute = now.mute;
+			}
+
+			if (!sent.valid || now.solo != sent.solo) {
+				add_to_bundle (cl.addr, bundle, n, "/route/solo", rid, now.solo ? 1.0f : 0.0f);
+				sent.solo = now.solo;
+			}
+
+			if (!sent.valid || now.pan != sent.pan) {
+				add_to_bundle (cl.addr, bundle, n, "/route/pan", rid, now.pan);
+				sent.pan = now.pan;
+			}
+
+			if (cl.meters) {
+
+				Peaks::iterator p = peaks.find (r.get());
+
+				if (p == peaks.end()) {
+					p = peaks.insert (make_pair (r.get(), current_peak (*r))).first;
+				}
+
+				if (!sent.valid || fabsf (p->second - sent.peak) >= meter_threshold) {
+					add_to_bundle (cl.addr, bundle, n, "/route/meter", rid, p->second);
+					sent.peak = p->second;
+				}
+			}
+
+			sent.valid = true;
+		}
+
+		send_bundle (cl.addr, bundle, n);
+	}
+}
@@ -0,0 +1,103 @@
+/*
+    Copyright (C) 2010 Paul Davis
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+*/
+
+#ifndef __osc_oscfeedback_h__
+#define __osc_oscfeedback_h__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <lo/lo.h>
+
+namespace ARDOUR {
+	class Route;
+}
+
+/** Sends the state of routes (gain, mute, solo, pan and, optionally, peak
+ *  level) to the OSC clients which are listening to them.
+ *
+ *  Nothing is sent when a value changes.  Instead flush() is called
+ *  periodically from the OSC thread; it compares each route's current
+ *  state with what each client was last sent and sends only the
+ *  differences, batched into bundles.  However often a value changes
+ *  between two flushes, a client sees it at most once.
+ *
+ *  All methods must be called from the OSC thread.
+ */
+class OSCFeedback
+{
+  public:
+	OSCFeedback ();
+	~OSCFeedback ();
+
+	void add_listener (boost::shared_ptr<ARDOUR::Route>, lo_address);
+	void remove_listener (boost::shared_ptr<ARDOUR::Route>, lo_address);
+	void drop_route (boost::shared_ptr<ARDOUR::Route>);
+	void set_meters (lo_address, bool);
+	void clear ();
+
+	bool listening_to (boost::shared_ptr<ARDOUR::Route>) const;
+
+	void flush ();
+
+	/** maximum number of messages put into a single bundle */
+	static const uint32_t max_bundle_size = 64;
+	/** smallest change in peak level (dB) that is worth sending */
+	static const float meter_threshold;
+
+  private:
+	struct RouteState {
+		RouteState ();
+
+		float gain;
+		float pan;
+		float peak;
+		bool  mute;
+		bool  solo;
+		bool  valid; ///< false until this state has been sent at least once
+	};
+
+	struct ListenedRoute {
+		ListenedRoute (boost::shared_ptr<ARDOUR::Route> r) : route (r) {}
+
+		boost::weak_ptr<ARDOUR::Route> route;
+		RouteState sent;
+	};
+
+	struct Client {
+		Client () : addr (0), meters (false) {}
+
+		lo_address addr;
+		bool meters;
+		std::vector<ListenedRoute> routes;
+	};
+
+	typedef std::map<std::string, Client> Clients; ///< keyed by client URL
+	Clients _clients;
+
+	static std::string address_url (lo_address);
+	static RouteState current_state (ARDOUR::Route&);
+	static float current_peak (ARDOUR::Route&);
+	Client& client (lo_address);
+};
+
+#endif /* __osc_oscfeedback_h__ */